@@ -31,37 +31,37 @@ int main()
     sjsu::Delay(1s);
 
     LOG_INFO("Deleting blocks");
-    card.DeleteBlock(0x00000000, 0x0000A000);
+    card.DeleteBlock(0, 79);
 
     sjsu::Delay(1s);
 
-    LOG_INFO("Writing Hello World to block 0 (0x00000000)");
-    card.WriteBlock(0x00000000, kHelloWorld);
+    LOG_INFO("Writing Hello World to block 0");
+    card.WriteBlock(0, kHelloWorld);
 
     sjsu::Delay(1s);
 
-    LOG_INFO("Reading block 0 (0x00000000)");
-    card.ReadBlock(0x00000000, buffer);
+    LOG_INFO("Reading block 0");
+    card.ReadBlock(0, buffer);
     sjsu::debug::Hexdump(buffer, sizeof(buffer));
 
     sjsu::Delay(1s);
 
     LOG_INFO("Deleting blocks again");
-    card.DeleteBlock(0x00000000, 0x0000A000);
+    card.DeleteBlock(0, 79);
 
     sjsu::Delay(1s);
 
-    LOG_INFO("Reading block 0 after delete (0x00000000)");
-    card.ReadBlock(0x00000000, buffer);
+    LOG_INFO("Reading block 0 after delete");
+    card.ReadBlock(0, buffer);
     sjsu::debug::Hexdump(buffer, sizeof(buffer));
 
-    LOG_INFO("Writing to block 1 after delete (0x00000200)");
-    card.WriteBlock(0x00000200, kLongText);
+    LOG_INFO("Writing to block 1 after delete");
+    card.WriteBlock(1, kLongText);
 
     sjsu::Delay(1s);
 
-    LOG_INFO("Reading block 1 after write (0x00000200)");
-    card.ReadBlock(0x00000200, buffer);
+    LOG_INFO("Reading block 1 after write");
+    card.ReadBlock(1, buffer);
     sjsu::debug::Hexdump(buffer, sizeof(buffer));
 
     LOG_INFO("END SD Card Driver Example...");
@@ -5,6 +5,7 @@
 #include "L0_Platform/ram.hpp"
 #include "L0_Platform/startup.hpp"
 #include "L1_Peripheral/cortex/interrupt.hpp"
+#include "newlib/newlib.hpp"
 #include "utility/log.hpp"
 #include "utility/time.hpp"
 
@@ -28,6 +29,9 @@ extern "C"
     // Program status register.
     volatile uint32_t psr = fault_stack_address[7];
 
+    // Get out whatever was logged before the fault, and make the stdout
+    // backend write directly so the messages below are not held in a buffer.
+    sjsu::newlib::FlushStdout();
     printf(SJ2_BACKGROUND_RED
            "Hard Fault Exception Occurred!\n" SJ2_COLOR_RESET);
     printf("r0: 0x%08" PRIX32 ", r1: 0x%08" PRIX32
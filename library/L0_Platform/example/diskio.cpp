@@ -41,10 +41,38 @@ extern "C" DRESULT disk_write([[maybe_unused]] BYTE drive_number,
 
 // NOLINTNEXTLINE
 extern "C" DRESULT disk_ioctl([[maybe_unused]] BYTE drive_number,
-                              [[maybe_unused]] BYTE command,
-                              [[maybe_unused]] void * buffer)
+                              BYTE command,
+                              void * buffer)
 {
   // Write disk IOCTL here
   // See elm chan's FatFs documentation for what each command represents
-  return RES_PARERR;
+  DRESULT result = RES_PARERR;
+  switch (command)
+  {
+    case CTRL_SYNC:
+      // Write back any cached data and wait for the disk to finish writing
+      result = RES_OK;
+      break;
+    case GET_SECTOR_COUNT:
+      // Store the number of sectors on the disk into the DWORD buffer. For
+      // an SD card, use the CSD register, i.e. csd.GetBlockCount().
+      break;
+    case GET_SECTOR_SIZE:
+      // Store the sector size into the WORD buffer
+      *static_cast<WORD *>(buffer) = FF_MAX_SS;
+      result = RES_OK;
+      break;
+    case GET_BLOCK_SIZE:
+      // Store the erase block size, in sectors, into the DWORD buffer. Store
+      // 1 if it is unknown.
+      *static_cast<DWORD *>(buffer) = 1;
+      result = RES_OK;
+      break;
+    case CTRL_TRIM:
+      // The DWORD buffer holds the first and last sector that are no longer
+      // in use and may be erased
+      break;
+    default: break;
+  }
+  return result;
 }
@@ -78,6 +78,8 @@ to exclude the API function. */
 #define INCLUDE_vTaskDelay 1
 #define INCLUDE_uxTaskGetStackHighWaterMark 1
 #define INCLUDE_xTaskGetSchedulerState 1
+#define INCLUDE_xTaskGetCurrentTaskHandle 1
+#define INCLUDE_xSemaphoreGetMutexHolder 1
 
 /* FreeRTOS Timer or daemon task configuration */
 #define configUSE_TIMERS 1
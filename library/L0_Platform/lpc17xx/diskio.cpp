@@ -50,5 +50,7 @@ extern "C" DRESULT disk_ioctl([[maybe_unused]] BYTE drive_number,
                               [[maybe_unused]] BYTE command,
                               [[maybe_unused]] void * buffer)
 {
-  return RES_PARERR;
+  // disk_initialize() never succeeds on this platform, thus there is no card
+  // to report on.
+  return RES_NOTRDY;
 }
@@ -7,16 +7,71 @@
 /* storage control modules to the FatFs module with a defined API.       */
 /*-----------------------------------------------------------------------*/
 
+#include <FreeRTOS.h>
 #include <diskio.h> /* Declarations of disk functions */
 #include <ff.h>     /* Obtains integer types */
+#include <semphr.h>
+#include <task.h>
 
+#include "L1_Peripheral/cortex/interrupt.hpp"
 #include "L2_HAL/boards/sjtwo.hpp"
+#include "L2_HAL/memory/sd_disk.hpp"
 
 /* Definitions of physical drive number for each drive */
 #define DEV_SD 0 /* Example: Map SD Card to physical drive 0 */
 namespace
 {
-bool initialized = false;
+/// Mounts the card, and caches its sectors, for the disk_* functions below
+sjsu::SdDisk<config::kSdCacheSectors> & SdCardDisk()
+{
+  static sjsu::SdDisk<config::kSdCacheSectors> sd_disk(
+      sjtwo::SdCard(), config::kSdCacheReadAhead);
+  return sd_disk;
+}
+
+/// Mutex behind CardLock. It is created by the first disk_* call made once the
+/// scheduler has started, since creating it earlier, such as along with the
+/// other globals, would leave interrupts masked until the scheduler starts.
+StaticSemaphore_t card_mutex_buffer;
+SemaphoreHandle_t card_mutex = nullptr;
+
+SemaphoreHandle_t CardMutex()
+{
+  // Interrupts are held off, so that two tasks cannot both create the mutex
+  sjsu::cortex::InterruptLock lock;
+  if (card_mutex == nullptr)
+  {
+    card_mutex = xSemaphoreCreateMutexStatic(&card_mutex_buffer);
+  }
+  return card_mutex;
+}
+
+/// FatFs only holds a volume's lock while it works on that volume, so the card
+/// and its cache get a lock of their own, held for one disk_* call at a time.
+/// This keeps them consistent when more than one volume or partition lives on
+/// the card.
+class CardLock
+{
+ public:
+  CardLock() : is_locked_(xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED)
+  {
+    if (is_locked_)
+    {
+      xSemaphoreTake(CardMutex(), portMAX_DELAY);
+    }
+  }
+  ~CardLock()
+  {
+    if (is_locked_)
+    {
+      xSemaphoreGive(card_mutex);
+    }
+  }
+
+ private:
+  // Before the scheduler starts there is nothing to share the card with
+  bool is_locked_;
+};
 }  // namespace
 
 /// @param drive_number - Physical drive number to identify the drive
@@ -32,7 +87,7 @@ extern "C" DSTATUS disk_status([[maybe_unused]] BYTE drive_number)
   if (!card_detect.Read())
   {
     LOG_DEBUG("Card IS present!");
-    result = (initialized) ? 0 : STA_NOINIT;
+    result = (SdCardDisk().IsInitialized()) ? 0 : STA_NOINIT;
   }
   else
   {
@@ -45,14 +100,8 @@ extern "C" DSTATUS disk_status([[maybe_unused]] BYTE drive_number)
 extern "C" DSTATUS disk_initialize([[maybe_unused]] BYTE drive_number)
 {
   LOG_DEBUG("DISK INIT!");
-  sjtwo::SdCard().Initialize();
-  sjsu::Sd::CardInfo_t card_info;
-  DSTATUS status = sjtwo::SdCard().Mount(&card_info) ? 0 : STA_NOINIT;
-  if (status == 0)
-  {
-    initialized = true;
-  }
-  return status;
+  CardLock lock;
+  return SdCardDisk().Initialize();
 }
 
 // NOLINTNEXTLINE
@@ -62,8 +111,8 @@ extern "C" DRESULT disk_read([[maybe_unused]] BYTE drive_number, BYTE * buffer,
   LOG_DEBUG("drive_number: %u :: sector: %ld :: count: %u", drive_number,
             sector, count);
 
-  sjtwo::SdCard().ReadBlock(sector, buffer, static_cast<uint32_t>(count));
-  return RES_OK;
+  CardLock lock;
+  return SdCardDisk().Read(buffer, sector, count);
 }
 
 #if FF_FS_READONLY == 0
@@ -73,15 +122,16 @@ extern "C" DRESULT disk_write([[maybe_unused]] BYTE drive_number,
 {
   LOG_DEBUG("drive_number: %u :: sector: %ld :: count: %u", drive_number,
             sector, count);
-  sjtwo::SdCard().WriteBlock(sector, buffer, static_cast<uint32_t>(count));
-  return RES_OK;
+  CardLock lock;
+  return SdCardDisk().Write(buffer, sector, count);
 }
 
 #endif
 // NOLINTNEXTLINE
 extern "C" DRESULT disk_ioctl([[maybe_unused]] BYTE drive_number,
-                              [[maybe_unused]] BYTE command,
-                              [[maybe_unused]] void * buffer)
+                              BYTE command,
+                              void * buffer)
 {
-  return RES_PARERR;
+  CardLock lock;
+  return SdCardDisk().Ioctl(command, buffer);
 }
@@ -41,8 +41,10 @@
 #include "L1_Peripheral/cortex/fpu.hpp"
 #include "L1_Peripheral/cortex/interrupt.hpp"
 #include "L1_Peripheral/cortex/system_timer.hpp"
+#include "L1_Peripheral/lpc40xx/dma.hpp"
 #include "L1_Peripheral/lpc40xx/system_controller.hpp"
 #include "L1_Peripheral/lpc40xx/uart.hpp"
+#include "L1_Peripheral/lpc40xx/uart_dma_writer.hpp"
 #include "newlib/newlib.hpp"
 #include "utility/log.hpp"
 #include "utility/macros.hpp"
@@ -63,6 +65,16 @@ sjsu::lpc40xx::Uart uart0(sjsu::lpc40xx::Uart::Port::kUart0);
 sjsu::cortex::SystemTimer system_timer(system_controller);
 // Cortex NVIC interrupt controller used to setup FreeRTOS ISRs
 sjsu::cortex::InterruptController interrupt_controller;
+// GPDMA used to drain the stdout buffer into uart0
+sjsu::lpc40xx::Dma dma(system_controller, interrupt_controller);
+// The writer still needs a buffer to compile when stdout is not buffered.
+constexpr size_t kStdoutHalfSize =
+    (config::kStdoutBufferSize > 0) ? config::kStdoutBufferSize : 1;
+using StdoutWriter = sjsu::lpc40xx::UartDmaWriter<kStdoutHalfSize>;
+StdoutWriter stdout_writer(
+    sjsu::lpc40xx::Uart::Port::kUart0,
+    dma,
+    static_cast<StdoutWriter::FullPolicy>(config::kStdoutFullPolicy));
 
 int Lpc40xxStdOut(const char * data, size_t length)
 {
@@ -70,6 +82,17 @@ int Lpc40xxStdOut(const char * data, size_t length)
   return length;
 }
 
+int Lpc40xxBufferedStdOut(const char * data, size_t length)
+{
+  return stdout_writer.Write(reinterpret_cast<const uint8_t *>(data), length);
+}
+
+void Lpc40xxFlushStdOut()
+{
+  stdout_writer.Flush();
+  sjsu::newlib::SetStdout(Lpc40xxStdOut);
+}
+
 int Lpc40xxStdIn(char * data, size_t length)
 {
   uart0.Read(reinterpret_cast<uint8_t *>(data), length);
@@ -203,8 +226,27 @@ void InitializePlatform()
   // fed to all peripherals will be 48Mhz.
   system_controller.SetPeripheralClockDivider({}, 1);
   // Set UART0 baudrate, which is required for printf and scanf to work properly
+  // The peripheral clock matches the system clock, so check at compile time
+  // that the baud rate can be reached with it.
+  constexpr lpc40xx::uart::UartCalibration_t kUart0Calibration =
+      lpc40xx::uart::GenerateUartCalibration(config::kBaudRate,
+                                             config::kSystemClockRateMhz);
+  static_assert(
+      -lpc40xx::uart::kMaxBaudRateErrorPpm <= kUart0Calibration.error_ppm &&
+          kUart0Calibration.error_ppm <= lpc40xx::uart::kMaxBaudRateErrorPpm,
+      "SJ2_BAUD_RATE cannot be reached accurately with the system clock.");
   uart0.Initialize(config::kBaudRate);
   sjsu::newlib::SetStdout(Lpc40xxStdOut);
+  // Buffer stdout and let the GPDMA send it, so that printing does not hold up
+  // the caller for as long as it takes to shift every byte out.
+  if constexpr (config::kStdoutBufferSize > 0)
+  {
+    if (stdout_writer.Initialize() == sjsu::Status::kSuccess)
+    {
+      sjsu::newlib::SetStdout(Lpc40xxBufferedStdOut);
+      sjsu::newlib::SetStdoutFlush(Lpc40xxFlushStdOut);
+    }
+  }
   sjsu::newlib::SetStdin(Lpc40xxStdIn);
 
   system_timer.SetTickFrequency(config::kRtosFrequency);
@@ -5,6 +5,7 @@
 
 #include "L0_Platform/arm_cortex/m4/core_cm4.h"
 #include "L1_Peripheral/interrupt.hpp"
+#include "utility/build_info.hpp"
 #include "utility/log.hpp"
 
 namespace sjsu
@@ -106,5 +107,30 @@ class InterruptController final : public sjsu::InterruptController
     *GetVector(irq) = UnregisteredInterruptHandler;
   }
 };
+
+/// Masks every interrupt for as long as it is alive, for data shared between
+/// tasks and interrupt handlers. Nests, as it restores the mask it found.
+class InterruptLock
+{
+ public:
+  InterruptLock()
+  {
+    if constexpr (build::kTarget != build::Target::HostTest)
+    {
+      primask_ = __get_PRIMASK();
+      __disable_irq();
+    }
+  }
+  ~InterruptLock()
+  {
+    if constexpr (build::kTarget != build::Target::HostTest)
+    {
+      __set_PRIMASK(primask_);
+    }
+  }
+
+ private:
+  uint32_t primask_ = 0;
+};
 }  // namespace cortex
 }  // namespace sjsu
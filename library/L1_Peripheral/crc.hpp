@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "utility/crc.hpp"
+#include "utility/status.hpp"
+
+namespace sjsu
+{
+/// Calculates checksums over blocks of memory. Drivers that check the
+/// integrity of their data, such as Sd, take a Crc so that the board can pick
+/// a hardware CRC engine where one exists and SoftwareCrc everywhere else.
+class Crc
+{
+ public:
+  // ==============================
+  // Interface Defintions
+  // ==============================
+
+  /// CRCs that every implementation must be able to calculate. Each matches
+  /// the software definition of the same name in utility/crc.hpp.
+  enum class Algorithm : uint8_t
+  {
+    kCrc16Ccitt = 0,
+    kCrc16,
+    kCrc32,
+  };
+
+  // ==============================
+  // Interface Methods
+  // ==============================
+
+  /// Initialize and enable hardware. This must be called before any other
+  /// method in this interface is called.
+  virtual Status Initialize() const = 0;
+  /// @param algorithm - CRC to calculate
+  /// @param data - bytes to calculate the CRC of
+  /// @param length - number of bytes in data
+  /// @return the CRC of the data. 16-bit CRCs are returned in the lower half.
+  virtual uint32_t Calculate(Algorithm algorithm,
+                             const void * data,
+                             size_t length) const = 0;
+};
+
+/// Calculates CRCs with the lookup tables from utility/crc.hpp. Holds no
+/// state, so a single instance can be shared between every driver and task.
+class SoftwareCrc final : public sjsu::Crc
+{
+ public:
+  Status Initialize() const override
+  {
+    return Status::kSuccess;
+  }
+
+  uint32_t Calculate(Algorithm algorithm,
+                     const void * data,
+                     size_t length) const override
+  {
+    auto * bytes    = static_cast<const uint8_t *>(data);
+    uint32_t result = 0;
+    switch (algorithm)
+    {
+      case Algorithm::kCrc16Ccitt:
+        result = crc::Crc16Ccitt::Calculate(bytes, length);
+        break;
+      case Algorithm::kCrc16:
+        result = crc::Crc16::Calculate(bytes, length);
+        break;
+      case Algorithm::kCrc32:
+        result = crc::Crc32::Calculate(bytes, length);
+        break;
+    }
+    return result;
+  }
+};
+
+inline const sjsu::Crc & DefaultCrc()
+{
+  static sjsu::SoftwareCrc default_crc = sjsu::SoftwareCrc();
+  return default_crc;
+}
+}  // namespace sjsu
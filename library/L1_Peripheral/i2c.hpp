@@ -24,6 +24,15 @@ class I2c
 
   static constexpr std::chrono::milliseconds kI2cTimeout = 100ms;
 
+  /// SCL frequencies of the I2C specification's bus modes
+  static constexpr units::frequency::hertz_t kStandardMode = 100_kHz;
+  static constexpr units::frequency::hertz_t kFastMode     = 400_kHz;
+  static constexpr units::frequency::hertz_t kFastModePlus = 1_MHz;
+  /// Percent of the SCL period spent high. The I2C specification asks for
+  /// SCL to be low for longer than it is high in fast mode and fast mode
+  /// plus, and 40% meets the minimum high and low times of all three modes.
+  static constexpr uint8_t kDefaultDutyCycle = 40;
+
   struct Transaction_t
   {
     // Returns an 8-bit I2C address with the 0th bit set if the i2c operation
@@ -48,6 +57,10 @@ class I2c
     bool busy                         = false;
     std::chrono::milliseconds timeout = kI2cTimeout;
     Status status                     = Status::kSuccess;
+
+    /// Fastest SCL frequency the device can keep up with. The transaction
+    /// runs at the lower of this and the bus clock. 0_Hz means no limit.
+    units::frequency::hertz_t max_frequency = 0_Hz;
   };
 
   // ==============================
@@ -66,6 +79,16 @@ class I2c
   ///         address on the bus
   ///         Status::kSuccess if transaction was fulfilled.
   virtual Status Transaction(Transaction_t transaction) const = 0;
+  /// Set the SCL frequency used by transactions from here on. A transaction
+  /// with a lower max_frequency runs at that instead.
+  ///
+  /// @param frequency - SCL frequency, up to kFastModePlus. The bus runs at
+  ///        the closest frequency it can make that is not above this.
+  /// @param duty_cycle - percent of the SCL period spent high, from 1 to 99
+  /// @return Status::kInvalidParameters if the frequency or duty cycle cannot
+  ///         be made, otherwise Status::kSuccess.
+  virtual Status SetClock(units::frequency::hertz_t frequency,
+                          uint8_t duty_cycle = kDefaultDutyCycle) const = 0;
 
   // ==============================
   // Utility Methods
@@ -85,17 +108,18 @@ class I2c
               std::chrono::milliseconds timeout = kI2cTimeout) const
   {
     return Transaction({
-        .operation  = Operation::kRead,
-        .address    = address,
-        .data_out   = nullptr,
-        .out_length = 0,
-        .data_in    = transmit_buffer,
-        .in_length  = transmit_buffer_length,
-        .position   = 0,
-        .repeated   = false,
-        .busy       = true,
-        .timeout    = timeout,
-        .status     = Status::kSuccess,
+        .operation     = Operation::kRead,
+        .address       = address,
+        .data_out      = nullptr,
+        .out_length    = 0,
+        .data_in       = transmit_buffer,
+        .in_length     = transmit_buffer_length,
+        .position      = 0,
+        .repeated      = false,
+        .busy          = true,
+        .timeout       = timeout,
+        .status        = Status::kSuccess,
+        .max_frequency = 0_Hz,
     });
   }
 
@@ -112,17 +136,18 @@ class I2c
                std::chrono::milliseconds timeout = kI2cTimeout) const
   {
     return Transaction({
-        .operation  = Operation::kWrite,
-        .address    = address,
-        .data_out   = receive_buffer,
-        .out_length = receive_buffer_length,
-        .data_in    = nullptr,
-        .in_length  = 0,
-        .position   = 0,
-        .repeated   = false,
-        .busy       = true,
-        .timeout    = timeout,
-        .status     = Status::kSuccess,
+        .operation     = Operation::kWrite,
+        .address       = address,
+        .data_out      = receive_buffer,
+        .out_length    = receive_buffer_length,
+        .data_in       = nullptr,
+        .in_length     = 0,
+        .position      = 0,
+        .repeated      = false,
+        .busy          = true,
+        .timeout       = timeout,
+        .status        = Status::kSuccess,
+        .max_frequency = 0_Hz,
     });
   }
   /// Write to a device on the I2C bus
@@ -163,17 +188,18 @@ class I2c
                        std::chrono::milliseconds timeout = kI2cTimeout) const
   {
     return Transaction({
-        .operation  = Operation::kWrite,
-        .address    = address,
-        .data_out   = transmit_buffer,
-        .out_length = transmit_buffer_length,
-        .data_in    = receive_buffer,
-        .in_length  = receive_buffer_length,
-        .position   = 0,
-        .repeated   = true,
-        .busy       = true,
-        .timeout    = timeout,
-        .status     = Status::kSuccess,
+        .operation     = Operation::kWrite,
+        .address       = address,
+        .data_out      = transmit_buffer,
+        .out_length    = transmit_buffer_length,
+        .data_in       = receive_buffer,
+        .in_length     = receive_buffer_length,
+        .position      = 0,
+        .repeated      = true,
+        .busy          = true,
+        .timeout       = timeout,
+        .status        = Status::kSuccess,
+        .max_frequency = 0_Hz,
     });
   }
 
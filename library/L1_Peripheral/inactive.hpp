@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstring>
 #include <type_traits>
 
 #include "config.hpp"
@@ -142,6 +143,10 @@ const sjsu::I2c & GetInactive<sjsu::I2c>()
     {
       return Status::kNotImplemented;
     }
+    Status SetClock(units::frequency::hertz_t, uint8_t) const override
+    {
+      return Status::kNotImplemented;
+    }
   };
 
   static InactiveI2c inactive;
@@ -184,8 +189,22 @@ const sjsu::Spi & GetInactive<sjsu::Spi>()
     {
       return 0xFF;
     }
+    void Transfer(const uint8_t *,
+                  uint8_t * receive,
+                  size_t length,
+                  uint8_t) const override
+    {
+      if (receive != nullptr)
+      {
+        memset(receive, 0xFF, length);
+      }
+    }
     void SetDataSize(DataSize) const override {}
     void SetClock(units::frequency::hertz_t, bool, bool) const override {}
+    units::frequency::hertz_t GetClock() const override
+    {
+      return 0_Hz;
+    }
   };
 
   static InactiveSpi inactive;
@@ -22,6 +22,7 @@ struct I2cBus  // NOLINT
   inline static const Pin kI2c2SclPin = Pin::CreatePin<0, 11>();
 
   inline static I2c::Transaction_t transaction_i2c0;
+  inline static I2c::TransactionQueue_t queue_i2c0;
   inline static const lpc40xx::I2c::PartialBus_t kI2c0Partial = {
     .registers = reinterpret_cast<lpc40xx::LPC_I2C_TypeDef *>(LPC_I2C0),
     .peripheral_power_id = SystemController::Peripherals::kI2c0,
@@ -30,9 +31,11 @@ struct I2cBus  // NOLINT
     .sda_pin             = kI2c0SdaPin,
     .scl_pin             = kI2c0SclPin,
     .pin_function_id     = 0b01,
+    .queue               = &queue_i2c0,
   };
 
   inline static I2c::Transaction_t transaction_i2c1;
+  inline static I2c::TransactionQueue_t queue_i2c1;
   inline static const lpc40xx::I2c::PartialBus_t kI2c1Partial = {
     .registers = reinterpret_cast<lpc40xx::LPC_I2C_TypeDef *>(LPC_I2C1),
     .peripheral_power_id = SystemController::Peripherals::kI2c1,
@@ -41,9 +44,11 @@ struct I2cBus  // NOLINT
     .sda_pin             = kI2c1SdaPin,
     .scl_pin             = kI2c1SclPin,
     .pin_function_id     = 0b11,
+    .queue               = &queue_i2c1,
   };
 
   inline static I2c::Transaction_t transaction_i2c2;
+  inline static I2c::TransactionQueue_t queue_i2c2;
   inline static const lpc40xx::I2c::PartialBus_t kI2c2Partial = {
     .registers = reinterpret_cast<lpc40xx::LPC_I2C_TypeDef *>(LPC_I2C2),
     .peripheral_power_id = SystemController::Peripherals::kI2c2,
@@ -52,6 +57,7 @@ struct I2cBus  // NOLINT
     .sda_pin             = kI2c2SdaPin,
     .scl_pin             = kI2c2SclPin,
     .pin_function_id     = 0b10,
+    .queue               = &queue_i2c2,
   };
 
  public:
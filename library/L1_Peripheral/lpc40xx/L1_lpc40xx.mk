@@ -1,10 +1,13 @@
 TESTS += $(LIBRARY_DIR)/L1_Peripheral/lpc40xx/test/adc_test.cpp
 TESTS += $(LIBRARY_DIR)/L1_Peripheral/lpc40xx/test/can_test.cpp
+TESTS += $(LIBRARY_DIR)/L1_Peripheral/lpc40xx/test/crc_test.cpp
 TESTS += $(LIBRARY_DIR)/L1_Peripheral/lpc40xx/test/dac_test.cpp
+TESTS += $(LIBRARY_DIR)/L1_Peripheral/lpc40xx/test/dma_test.cpp
 TESTS += $(LIBRARY_DIR)/L1_Peripheral/lpc40xx/test/gpio_test.cpp
 TESTS += $(LIBRARY_DIR)/L1_Peripheral/lpc40xx/test/i2c_test.cpp
 TESTS += $(LIBRARY_DIR)/L1_Peripheral/lpc40xx/test/pin_test.cpp
 TESTS += $(LIBRARY_DIR)/L1_Peripheral/lpc40xx/test/pwm_test.cpp
 TESTS += $(LIBRARY_DIR)/L1_Peripheral/lpc40xx/test/spi_test.cpp
 TESTS += $(LIBRARY_DIR)/L1_Peripheral/lpc40xx/test/uart_test.cpp
+TESTS += $(LIBRARY_DIR)/L1_Peripheral/lpc40xx/test/uart_dma_writer_test.cpp
 TESTS += $(LIBRARY_DIR)/L1_Peripheral/lpc40xx/test/system_controller_test.cpp
\ No newline at end of file
@@ -0,0 +1,362 @@
+/// The CRC engine calculates CRC-CCITT, CRC-16 and CRC-32 checksums of data
+/// written to it 8, 16 or 32 bits at a time, at one write per bus cycle. Once
+/// EnableDma() has been called, large buffers are fed to the engine by the
+/// GPDMA while the calling task sleeps.
+///
+/// Order of function calls should be as follows:
+///
+///     1. Constructor (create object)
+///     2. Initialize()
+///     3. EnableDma(...) (optional)
+///     4. Calculate(...) as many times as needed
+///
+/// There is a single engine. Once the scheduler is running, each calculation
+/// holds a mutex, so tasks sharing the engine take turns. Calculations must
+/// not be started from an interrupt.
+/// See the CRC engine chapter of user manual UM10562 for more details.
+#pragma once
+
+#include <FreeRTOS.h>
+#include <semphr.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+
+#include "L1_Peripheral/crc.hpp"
+
+#include "L0_Platform/lpc40xx/LPC40xx.h"
+#include "L1_Peripheral/cortex/interrupt.hpp"
+#include "L1_Peripheral/lpc40xx/dma.hpp"
+#include "utility/bit.hpp"
+#include "utility/crc.hpp"
+#include "utility/enum.hpp"
+#include "utility/log.hpp"
+#include "utility/rtos.hpp"
+#include "utility/status.hpp"
+
+namespace sjsu
+{
+namespace lpc40xx
+{
+class Crc final : public sjsu::Crc
+{
+ public:
+  // CRC Mode Register
+  struct ModeRegister  // NOLINT
+  {
+    static constexpr bit::Mask kPolynomial   = bit::CreateMaskFromRange(0, 1);
+    static constexpr bit::Mask kReverseWrite = bit::CreateMaskFromRange(2);
+    static constexpr bit::Mask kComplementWrite = bit::CreateMaskFromRange(3);
+    static constexpr bit::Mask kReverseSum      = bit::CreateMaskFromRange(4);
+    static constexpr bit::Mask kComplementSum   = bit::CreateMaskFromRange(5);
+  };
+
+  enum class Polynomial : uint8_t
+  {
+    kCcitt = 0b00,
+    kCrc16 = 0b01,
+    kCrc32 = 0b10,
+  };
+
+  /// MODE and SEED register values that make the engine produce the same
+  /// result as the software CRC of the same name.
+  struct Configuration_t
+  {
+    uint32_t mode;
+    uint32_t seed;
+  };
+
+  /// Indexed by sjsu::Crc::Algorithm. LSB first CRCs reverse the bits of
+  /// each byte written and of the sum, CRC-32 also complements the sum.
+  static constexpr Configuration_t kConfigurations[] = {
+    // CRC-16/XMODEM: CCITT polynomial
+    { .mode = 0b00'0000, .seed = 0x0000 },
+    // CRC-16/ARC: CRC-16 polynomial, bit reversed writes and sum
+    { .mode = 0b01'0101, .seed = 0x0000 },
+    // CRC-32: CRC-32 polynomial, bit reversed writes, reversed and complemented
+    // sum
+    { .mode = 0b11'0110, .seed = 0xFFFF'FFFF },
+  };
+
+  /// Buffers shorter than this many bytes are written to the engine by the
+  /// CPU even if DMA has been enabled, as setting up a DMA transfer would
+  /// take longer than writing them.
+  static constexpr size_t kDmaThreshold = 64;
+
+  inline static LPC_CRC_TypeDef * engine = LPC_CRC;
+
+  /// The engine is always powered, so this only checks, with the standard
+  /// "123456789" check message, that it agrees with the software CRCs.
+  ///
+  /// @return Status::kDeviceNotFound if any of the results do not match,
+  ///         otherwise Status::kSuccess.
+  Status Initialize() const override
+  {
+    // Word aligned so that the 32-bit and 16-bit write paths are exercised
+    alignas(4) static constexpr uint8_t kCheckMessage[] = {
+      '1', '2', '3', '4', '5', '6', '7', '8', '9'
+    };
+    constexpr uint32_t kExpected[] = {
+      crc::Crc16Ccitt::Calculate(kCheckMessage, sizeof(kCheckMessage)),
+      crc::Crc16::Calculate(kCheckMessage, sizeof(kCheckMessage)),
+      crc::Crc32::Calculate(kCheckMessage, sizeof(kCheckMessage)),
+    };
+
+    for (uint8_t i = 0; i < std::size(kExpected); i++)
+    {
+      auto algorithm  = static_cast<Algorithm>(i);
+      uint32_t result =
+          Calculate(algorithm, kCheckMessage, sizeof(kCheckMessage));
+      if (result != kExpected[i])
+      {
+        LOG_ERROR("CRC engine gave 0x%08X for algorithm %u, expected 0x%08X",
+                  static_cast<unsigned>(result), i,
+                  static_cast<unsigned>(kExpected[i]));
+        return Status::kDeviceNotFound;
+      }
+    }
+    return Status::kSuccess;
+  }
+
+  /// Allocate a GPDMA channel to feed the engine. After this, buffers of
+  /// kDmaThreshold bytes or more are moved into the engine by the GPDMA, and
+  /// if the scheduler is running, the calling task sleeps until the transfer
+  /// has completed.
+  ///
+  /// @param dma - DMA controller to take the channel from.
+  /// @return Status::kNotReadyYet if there are no free channels, otherwise
+  ///         Status::kSuccess.
+  Status EnableDma(const Dma & dma) const
+  {
+    if (dma_ != nullptr)
+    {
+      return Status::kSuccess;
+    }
+
+    dma.Initialize();
+    uint8_t channel = dma.AllocateChannel();
+    if (channel == Dma::kInvalidChannel)
+    {
+      return Status::kNotReadyYet;
+    }
+
+    channel_ = channel;
+    dma_     = &dma;
+    return Status::kSuccess;
+  }
+
+  uint32_t Calculate(Algorithm algorithm,
+                     const void * data,
+                     size_t length) const override
+  {
+    const Configuration_t & configuration =
+        kConfigurations[util::Value(algorithm)];
+    auto * bytes = static_cast<const uint8_t *>(data);
+
+    EngineLock lock;
+    Start(configuration);
+    if (dma_ != nullptr && length >= kDmaThreshold)
+    {
+      // Bytes before the first word boundary and after the last one are
+      // written by the CPU, everything in between by the GPDMA.
+      size_t head = (sizeof(uint32_t) - (reinterpret_cast<uintptr_t>(bytes) %
+                                         sizeof(uint32_t))) %
+                    sizeof(uint32_t);
+      size_t words = (length - head) / sizeof(uint32_t);
+      size_t tail  = length - head - (words * sizeof(uint32_t));
+
+      Write(bytes, head);
+      if (DmaWrite(&bytes[head], words) == Status::kSuccess)
+      {
+        Write(&bytes[length - tail], tail);
+        return engine->SUM;
+      }
+      // The engine may have been given part of the data, so start over
+      Start(configuration);
+    }
+    Write(bytes, length);
+    return engine->SUM;
+  }
+
+ private:
+  /// Shared between a DMA transfer and the DMA completion handler
+  struct DmaCompletion_t
+  {
+    /// Given by the handler, null when the channel is polled
+    SemaphoreHandle_t done_signal;
+    volatile bool done;
+    volatile Status status;
+  };
+
+  /// Held from writing the seed to reading the sum, so a task cannot mix its
+  /// data into another task's checksum. Before the scheduler starts there is
+  /// nothing to share the engine with.
+  class EngineLock
+  {
+   public:
+    EngineLock()
+        : is_locked_(xTaskGetSchedulerState() == taskSCHEDULER_RUNNING)
+    {
+      if (is_locked_)
+      {
+        xSemaphoreTake(Mutex(), portMAX_DELAY);
+      }
+    }
+    ~EngineLock()
+    {
+      if (is_locked_)
+      {
+        xSemaphoreGive(mutex);
+      }
+    }
+
+   private:
+    /// Created by the first calculation once the scheduler is running, as
+    /// creating it earlier would mask interrupts until the scheduler starts.
+    static SemaphoreHandle_t Mutex()
+    {
+      sjsu::cortex::InterruptLock lock;
+      if (mutex == nullptr)
+      {
+        mutex = xSemaphoreCreateMutexStatic(&mutex_buffer);
+      }
+      return mutex;
+    }
+
+    inline static StaticSemaphore_t mutex_buffer;
+    inline static SemaphoreHandle_t mutex = nullptr;
+
+    bool is_locked_;
+  };
+
+  static void Start(const Configuration_t & configuration)
+  {
+    // Writing the seed also clears the checksum of the last calculation
+    engine->MODE = configuration.mode;
+    engine->SEED = configuration.seed;
+  }
+
+  /// Write bytes to the engine using the widest writes the alignment of the
+  /// data allows.
+  static void Write(const uint8_t * bytes, size_t length)
+  {
+    // The engine takes the bytes of a 16-bit or 32-bit write least
+    // significant byte first. Loading a word from memory therefore adds its
+    // bytes in memory order, for both MSB first and LSB first CRCs.
+    while (length > 0 &&
+           (reinterpret_cast<uintptr_t>(bytes) % sizeof(uint32_t)) != 0)
+    {
+      engine->WR_DATA_BYTE.DATA = *bytes;
+      bytes++;
+      length--;
+    }
+    for (; length >= sizeof(uint32_t); length -= sizeof(uint32_t))
+    {
+      uint32_t word;
+      memcpy(&word, bytes, sizeof(word));
+      engine->WR_DATA_DWORD.DATA = word;
+      bytes += sizeof(uint32_t);
+    }
+    if (length >= sizeof(uint16_t))
+    {
+      uint16_t half_word;
+      memcpy(&half_word, bytes, sizeof(half_word));
+      engine->WR_DATA_WORD.DATA = half_word;
+      bytes += sizeof(uint16_t);
+      length -= sizeof(uint16_t);
+    }
+    if (length > 0)
+    {
+      engine->WR_DATA_BYTE.DATA = *bytes;
+    }
+  }
+
+  static void DmaHandler(Status status, void * context)
+  {
+    auto * completion   = static_cast<DmaCompletion_t *>(context);
+    completion->status = status;
+    completion->done   = true;
+
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    xSemaphoreGiveFromISR(completion->done_signal, &higher_priority_task_woken);
+    rtos::YieldFromIsr(higher_priority_task_woken);
+  }
+
+  /// Write words from word aligned memory into the engine with the GPDMA
+  Status DmaWrite(const uint8_t * words, size_t count) const
+  {
+    // Before the scheduler starts there is no task to put to sleep, so the
+    // channel is polled instead and no completion handler is needed. Waiting
+    // on a semaphore of its own, rather than the task's notification, leaves
+    // notifications meant for something else alone.
+    StaticSemaphore_t done_buffer;
+    SemaphoreHandle_t done_signal  = nullptr;
+    Dma::CompletionHandler handler = nullptr;
+    if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING)
+    {
+      done_signal = xSemaphoreCreateBinaryStatic(&done_buffer);
+      handler     = DmaHandler;
+    }
+
+    while (count > 0)
+    {
+      size_t chunk = (count < Dma::kMaxTransferSize) ? count
+                                                     : Dma::kMaxTransferSize;
+      DmaCompletion_t completion = {
+        .done_signal = done_signal,
+        .done        = false,
+        .status      = Status::kSuccess,
+      };
+
+      Dma::Transfer_t transfer = {
+        .type                  = Dma::TransferType::kMemoryToMemory,
+        .source                = words,
+        .destination           = &engine->WR_DATA_DWORD.DATA,
+        .length                = chunk,
+        .width                 = Dma::Width::kWord,
+        .burst                 = Dma::Burst::k4,
+        .increment_source      = true,
+        .increment_destination = false,
+      };
+      Status status = dma_->Start(channel_, transfer, handler, &completion);
+      if (status != Status::kSuccess)
+      {
+        LOG_ERROR("CRC DMA transfer could not start: %s", Stringify(status));
+        return status;
+      }
+
+      if (handler != nullptr)
+      {
+        while (!completion.done)
+        {
+          xSemaphoreTake(done_signal, portMAX_DELAY);
+        }
+      }
+      else
+      {
+        while (dma_->IsBusy(channel_))
+        {
+          continue;
+        }
+      }
+
+      if (completion.status != Status::kSuccess)
+      {
+        dma_->Stop(channel_);
+        LOG_ERROR("CRC DMA transfer failed: %s", Stringify(completion.status));
+        return completion.status;
+      }
+
+      count -= chunk;
+      words += chunk * sizeof(uint32_t);
+    }
+    return Status::kSuccess;
+  }
+
+  mutable const Dma * dma_ = nullptr;
+  mutable uint8_t channel_ = Dma::kInvalidChannel;
+};
+}  // namespace lpc40xx
+}  // namespace sjsu
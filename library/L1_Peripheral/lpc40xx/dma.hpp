@@ -0,0 +1,449 @@
+/// GPDMA provides eight DMA channels that can move data between memory and
+/// the peripherals of the LPC40xx without CPU intervention. Channel 0 has the
+/// highest priority and channel 7 the lowest.
+///
+/// Order of function calls should be as follows:
+///
+///     1. Constructor (create object)
+///     2. Initialize()
+///     3. AllocateChannel()
+///     4. Start(...) as many times as needed
+///     5. ReleaseChannel(...) when the channel is no longer needed
+///
+/// Transfers larger than kMaxTransferSize, or transfers that must gather data
+/// from several buffers, are performed with a chain of LinkedListItem_t
+/// descriptors which the controller loads one after the other.
+/// See chapter 33 of user manual UM10562 for more details.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "L0_Platform/lpc40xx/LPC40xx.h"
+#include "L1_Peripheral/cortex/interrupt.hpp"
+#include "L1_Peripheral/lpc40xx/system_controller.hpp"
+#include "utility/bit.hpp"
+#include "utility/enum.hpp"
+#include "utility/log.hpp"
+#include "utility/status.hpp"
+
+namespace sjsu
+{
+namespace lpc40xx
+{
+class Dma final
+{
+ public:
+  static constexpr uint8_t kNumberOfChannels = 8;
+  static constexpr uint8_t kInvalidChannel   = 0xFF;
+  static constexpr size_t kMaxTransferSize   = 4095;
+  /// Completion handlers may call FreeRTOS "FromISR" functions, thus the
+  /// DMA interrupt must not be more urgent than
+  /// configMAX_SYSCALL_INTERRUPT_PRIORITY (5).
+  static constexpr int kInterruptPriority = 5;
+
+  // DMACConfig: DMA Configuration Register
+  struct ControllerConfig  // NOLINT
+  {
+    static constexpr bit::Mask kEnable     = bit::CreateMaskFromRange(0);
+    static constexpr bit::Mask kEndianness = bit::CreateMaskFromRange(1);
+  };
+  // DMACCxControl: DMA Channel Control Register
+  struct Control  // NOLINT
+  {
+    static constexpr bit::Mask kTransferSize = bit::CreateMaskFromRange(0, 11);
+    static constexpr bit::Mask kSourceBurst  = bit::CreateMaskFromRange(12, 14);
+    static constexpr bit::Mask kDestinationBurst =
+        bit::CreateMaskFromRange(15, 17);
+    static constexpr bit::Mask kSourceWidth = bit::CreateMaskFromRange(18, 20);
+    static constexpr bit::Mask kDestinationWidth =
+        bit::CreateMaskFromRange(21, 23);
+    static constexpr bit::Mask kSourceIncrement = bit::CreateMaskFromRange(26);
+    static constexpr bit::Mask kDestinationIncrement =
+        bit::CreateMaskFromRange(27);
+    static constexpr bit::Mask kTerminalCountInterrupt =
+        bit::CreateMaskFromRange(31);
+  };
+  // DMACCxConfig: DMA Channel Configuration Register
+  struct ChannelConfig  // NOLINT
+  {
+    static constexpr bit::Mask kEnable = bit::CreateMaskFromRange(0);
+    static constexpr bit::Mask kSourcePeripheral =
+        bit::CreateMaskFromRange(1, 5);
+    static constexpr bit::Mask kDestinationPeripheral =
+        bit::CreateMaskFromRange(6, 10);
+    static constexpr bit::Mask kTransferType = bit::CreateMaskFromRange(11, 13);
+    static constexpr bit::Mask kErrorInterruptMask =
+        bit::CreateMaskFromRange(14);
+    static constexpr bit::Mask kTerminalCountInterruptMask =
+        bit::CreateMaskFromRange(15);
+    static constexpr bit::Mask kLock   = bit::CreateMaskFromRange(16);
+    static constexpr bit::Mask kActive = bit::CreateMaskFromRange(17);
+    static constexpr bit::Mask kHalt   = bit::CreateMaskFromRange(18);
+  };
+
+  enum class TransferType : uint8_t
+  {
+    kMemoryToMemory         = 0b000,
+    kMemoryToPeripheral     = 0b001,
+    kPeripheralToMemory     = 0b010,
+    kPeripheralToPeripheral = 0b011,
+    /// The peripheral, rather than the transfer size, decides when the
+    /// transfer is complete. Only the SD card interface supports this.
+    kMemoryToPeripheralByPeripheral = 0b101,
+    kPeripheralToMemoryByPeripheral = 0b110,
+  };
+
+  enum class Width : uint8_t
+  {
+    kByte     = 0b000,
+    kHalfWord = 0b001,
+    kWord     = 0b010,
+  };
+
+  enum class Burst : uint8_t
+  {
+    k1   = 0b000,
+    k4   = 0b001,
+    k8   = 0b010,
+    k16  = 0b011,
+    k32  = 0b100,
+    k64  = 0b101,
+    k128 = 0b110,
+    k256 = 0b111,
+  };
+
+  /// A DMA request line and the state of its DMAREQSEL bit. Request lines 0
+  /// through 15 are shared between two peripherals each, the alternate flag
+  /// selects the second peripheral. See table 696 of user manual UM10562.
+  struct Request_t
+  {
+    uint8_t line;
+    bool alternate;
+  };
+
+  struct Request  // NOLINT
+  {
+    static constexpr Request_t kNone       = { .line = 0, .alternate = false };
+    static constexpr Request_t kSdCard     = { .line = 1, .alternate = false };
+    static constexpr Request_t kSsp0Tx     = { .line = 2, .alternate = false };
+    static constexpr Request_t kSsp0Rx     = { .line = 3, .alternate = false };
+    static constexpr Request_t kSsp1Tx     = { .line = 4, .alternate = false };
+    static constexpr Request_t kSsp1Rx     = { .line = 5, .alternate = false };
+    static constexpr Request_t kSsp2Tx     = { .line = 6, .alternate = false };
+    static constexpr Request_t kSsp2Rx     = { .line = 7, .alternate = false };
+    static constexpr Request_t kAdc        = { .line = 8, .alternate = false };
+    static constexpr Request_t kDac        = { .line = 9, .alternate = false };
+    static constexpr Request_t kUart0Tx    = { .line = 10, .alternate = false };
+    static constexpr Request_t kUart0Rx    = { .line = 11, .alternate = false };
+    static constexpr Request_t kUart1Tx    = { .line = 12, .alternate = false };
+    static constexpr Request_t kUart1Rx    = { .line = 13, .alternate = false };
+    static constexpr Request_t kUart2Tx    = { .line = 14, .alternate = false };
+    static constexpr Request_t kUart2Rx    = { .line = 15, .alternate = false };
+    static constexpr Request_t kTimer0Mat0 = { .line = 0, .alternate = true };
+    static constexpr Request_t kTimer0Mat1 = { .line = 1, .alternate = true };
+    static constexpr Request_t kTimer1Mat0 = { .line = 2, .alternate = true };
+    static constexpr Request_t kTimer1Mat1 = { .line = 3, .alternate = true };
+    static constexpr Request_t kTimer2Mat0 = { .line = 4, .alternate = true };
+    static constexpr Request_t kTimer2Mat1 = { .line = 5, .alternate = true };
+    static constexpr Request_t kI2s0      = { .line = 6, .alternate = true };
+    static constexpr Request_t kI2s1      = { .line = 7, .alternate = true };
+    static constexpr Request_t kUart3Tx    = { .line = 10, .alternate = true };
+    static constexpr Request_t kUart3Rx    = { .line = 11, .alternate = true };
+    static constexpr Request_t kUart4Tx    = { .line = 12, .alternate = true };
+    static constexpr Request_t kUart4Rx    = { .line = 13, .alternate = true };
+    static constexpr Request_t kTimer3Mat0 = { .line = 14, .alternate = true };
+    static constexpr Request_t kTimer3Mat1 = { .line = 15, .alternate = true };
+  };
+
+  /// Hardware descriptor loaded by the controller at the end of each
+  /// transfer when the channel's LLI register is non-zero. Descriptors must be
+  /// word aligned and must stay alive until the whole chain has completed.
+  struct alignas(4) LinkedListItem_t
+  {
+    uintptr_t source;
+    uintptr_t destination;
+    uintptr_t next;
+    uint32_t control;
+  };
+
+  struct Transfer_t
+  {
+    TransferType type             = TransferType::kMemoryToMemory;
+    const volatile void * source  = nullptr;
+    volatile void * destination   = nullptr;
+    /// Number of transfers of size "width" to perform
+    size_t length                 = 0;
+    Width width                   = Width::kByte;
+    Burst burst                   = Burst::k1;
+    bool increment_source         = true;
+    bool increment_destination    = true;
+    Request_t source_request      = Request::kNone;
+    Request_t destination_request = Request::kNone;
+    /// Optional descriptor to load after this transfer completes.
+    const LinkedListItem_t * next = nullptr;
+  };
+
+  /// Called from the DMA interrupt once the last descriptor of a channel's
+  /// transfer has completed or if the channel stopped due to a bus error.
+  using CompletionHandler = void (*)(Status status, void * context);
+
+  inline static LPC_GPDMA_TypeDef * gpdma = LPC_GPDMA;
+  inline static LPC_GPDMACH_TypeDef * channels[kNumberOfChannels] = {
+    LPC_GPDMACH0, LPC_GPDMACH1, LPC_GPDMACH2, LPC_GPDMACH3,
+    LPC_GPDMACH4, LPC_GPDMACH5, LPC_GPDMACH6, LPC_GPDMACH7,
+  };
+
+  /// Bit n is set if channel n has been handed out by AllocateChannel()
+  inline static uint8_t allocated_channels = 0;
+  inline static CompletionHandler handlers[kNumberOfChannels] = { nullptr };
+  inline static void * contexts[kNumberOfChannels]            = { nullptr };
+
+  static constexpr sjsu::cortex::InterruptController kInterruptController =
+      sjsu::cortex::InterruptController();
+
+  static void DmaHandler()
+  {
+    uint32_t terminal_count = gpdma->IntTCStat;
+    uint32_t error          = gpdma->IntErrStat;
+    gpdma->IntTCClear       = terminal_count;
+    gpdma->IntErrClr        = error;
+
+    for (uint8_t channel = 0; channel < kNumberOfChannels; channel++)
+    {
+      bool had_error    = bit::Read(error, channel);
+      bool has_finished = bit::Read(terminal_count, channel);
+      if ((had_error || has_finished) && handlers[channel] != nullptr)
+      {
+        Status status = (had_error) ? Status::kBusError : Status::kSuccess;
+        handlers[channel](status, contexts[channel]);
+      }
+    }
+  }
+
+  /// @returns the DMACCxControl word that would perform the transfer.
+  ///          The terminal count interrupt is only enabled on the last
+  ///          descriptor of a chain.
+  static constexpr uint32_t CreateControl(const Transfer_t & transfer)
+  {
+    uint32_t control = 0;
+    control = bit::Insert(control, static_cast<uint32_t>(transfer.length),
+                          Control::kTransferSize);
+    control = bit::Insert(control, util::Value(transfer.burst),
+                          Control::kSourceBurst);
+    control = bit::Insert(control, util::Value(transfer.burst),
+                          Control::kDestinationBurst);
+    control = bit::Insert(control, util::Value(transfer.width),
+                          Control::kSourceWidth);
+    control = bit::Insert(control, util::Value(transfer.width),
+                          Control::kDestinationWidth);
+    control = bit::Insert(control, transfer.increment_source,
+                          Control::kSourceIncrement);
+    control = bit::Insert(control, transfer.increment_destination,
+                          Control::kDestinationIncrement);
+    control = bit::Insert(control, transfer.next == nullptr,
+                          Control::kTerminalCountInterrupt);
+    return control;
+  }
+
+  /// Fill in a scatter-gather descriptor. The type and request fields of the
+  /// transfer are ignored as they are shared by every descriptor in a chain
+  /// and are taken from the Transfer_t given to Start().
+  static LinkedListItem_t CreateLinkedListItem(const Transfer_t & transfer)
+  {
+    return LinkedListItem_t{
+      .source      = reinterpret_cast<uintptr_t>(transfer.source),
+      .destination = reinterpret_cast<uintptr_t>(transfer.destination),
+      .next        = reinterpret_cast<uintptr_t>(transfer.next),
+      .control     = CreateControl(transfer),
+    };
+  }
+
+  explicit constexpr Dma(const sjsu::SystemController & system_controller =
+                             DefaultSystemController(),
+                         const sjsu::InterruptController &
+                             interrupt_controller = kInterruptController)
+      : system_controller_(system_controller),
+        interrupt_controller_(interrupt_controller)
+  {
+  }
+
+  /// Powers on the GPDMA, enables the controller and registers the DMA
+  /// interrupt handler. Safe to call more than once, allowing every driver
+  /// that makes use of DMA to initialize it.
+  Status Initialize() const
+  {
+    system_controller_.PowerUpPeripheral(
+        sjsu::lpc40xx::SystemController::Peripherals::kGpdma);
+
+    if (!bit::Read(gpdma->Config, ControllerConfig::kEnable.position))
+    {
+      // Clear any interrupts that may be left over from before a reset
+      gpdma->IntTCClear = 0xFF;
+      gpdma->IntErrClr  = 0xFF;
+      // Little endian mode with the controller enabled
+      gpdma->Config =
+          bit::Set(uint32_t{ 0 }, ControllerConfig::kEnable.position);
+    }
+
+    interrupt_controller_.Register({
+        .interrupt_request_number  = DMA_IRQn,
+        .interrupt_service_routine = DmaHandler,
+        .priority                  = kInterruptPriority,
+    });
+
+    return Status::kSuccess;
+  }
+
+  /// Hand out an unused channel, starting with the highest priority channel.
+  /// This should be called during initialization and not from an ISR.
+  ///
+  /// @return the channel number or kInvalidChannel if all of the channels
+  ///         are in use.
+  uint8_t AllocateChannel() const
+  {
+    for (uint8_t channel = 0; channel < kNumberOfChannels; channel++)
+    {
+      if (!bit::Read(allocated_channels, channel))
+      {
+        allocated_channels = bit::Set(allocated_channels, channel);
+        return channel;
+      }
+    }
+    LOG_ERROR("All %u DMA channels are already allocated!", kNumberOfChannels);
+    return kInvalidChannel;
+  }
+
+  /// Stop any transfer running on the channel and return it to the pool.
+  void ReleaseChannel(uint8_t channel) const
+  {
+    if (channel >= kNumberOfChannels)
+    {
+      return;
+    }
+    Stop(channel);
+    handlers[channel]  = nullptr;
+    contexts[channel]  = nullptr;
+    allocated_channels = bit::Clear(allocated_channels, channel);
+  }
+
+  /// Program a channel and start the transfer.
+  ///
+  /// @param channel - channel returned by AllocateChannel()
+  /// @param transfer - description of the first (or only) block of the
+  ///        transfer. Additional blocks can be chained via transfer.next.
+  /// @param handler - optional function called from the DMA interrupt when
+  ///        the transfer completes or fails.
+  /// @param context - pointer passed to the handler.
+  ///
+  /// @return Status::kInvalidParameters if the channel was not allocated or
+  ///         the length exceeds kMaxTransferSize.
+  ///         Status::kNotReadyYet if the channel is still busy.
+  ///         Status::kSuccess if the transfer has started.
+  Status Start(uint8_t channel,
+               const Transfer_t & transfer,
+               CompletionHandler handler = nullptr,
+               void * context            = nullptr) const
+  {
+    if (channel >= kNumberOfChannels ||
+        !bit::Read(allocated_channels, channel) ||
+        transfer.length > kMaxTransferSize)
+    {
+      return Status::kInvalidParameters;
+    }
+    if (IsBusy(channel))
+    {
+      return Status::kNotReadyYet;
+    }
+
+    SelectRequest(transfer.source_request);
+    SelectRequest(transfer.destination_request);
+
+    handlers[channel] = handler;
+    contexts[channel] = context;
+
+    // Clear any stale interrupt flags for this channel
+    gpdma->IntTCClear = (1 << channel);
+    gpdma->IntErrClr  = (1 << channel);
+
+    LPC_GPDMACH_TypeDef * registers = channels[channel];
+    registers->CSrcAddr =
+        static_cast<uint32_t>(reinterpret_cast<uintptr_t>(transfer.source));
+    registers->CDestAddr = static_cast<uint32_t>(
+        reinterpret_cast<uintptr_t>(transfer.destination));
+    registers->CLLI =
+        static_cast<uint32_t>(reinterpret_cast<uintptr_t>(transfer.next));
+    registers->CControl = CreateControl(transfer);
+
+    uint32_t config = 0;
+    config = bit::Insert(config, transfer.source_request.line,
+                         ChannelConfig::kSourcePeripheral);
+    config = bit::Insert(config, transfer.destination_request.line,
+                         ChannelConfig::kDestinationPeripheral);
+    config = bit::Insert(config, util::Value(transfer.type),
+                         ChannelConfig::kTransferType);
+    config = bit::Set(config, ChannelConfig::kErrorInterruptMask.position);
+    config =
+        bit::Set(config, ChannelConfig::kTerminalCountInterruptMask.position);
+    registers->CConfig = config;
+    registers->CConfig = bit::Set(config, ChannelConfig::kEnable.position);
+
+    return Status::kSuccess;
+  }
+
+  /// @returns true if the channel is enabled and has not finished its
+  ///          transfer.
+  bool IsBusy(uint8_t channel) const
+  {
+    return bit::Read(gpdma->EnbldChns, channel);
+  }
+
+  /// Immediately disable the channel. Data left in the channel FIFO is lost.
+  void Stop(uint8_t channel) const
+  {
+    channels[channel]->CConfig = bit::Clear(channels[channel]->CConfig,
+                                            ChannelConfig::kEnable.position);
+  }
+
+  /// Stop the channel without losing data. New requests are ignored, and
+  /// anything already in the channel FIFO is written out before the channel
+  /// is disabled.
+  void Halt(uint8_t channel) const
+  {
+    LPC_GPDMACH_TypeDef * registers = channels[channel];
+    registers->CConfig =
+        bit::Set(registers->CConfig, ChannelConfig::kHalt.position);
+    while (bit::Read(registers->CConfig, ChannelConfig::kActive.position))
+    {
+      continue;
+    }
+    Stop(channel);
+    registers->CConfig =
+        bit::Clear(registers->CConfig, ChannelConfig::kHalt.position);
+  }
+
+  /// @return the number of transfers the channel has yet to perform. Only
+  ///         meaningful once the channel is halted or has finished.
+  size_t GetRemainingLength(uint8_t channel) const
+  {
+    return bit::Extract(channels[channel]->CControl, Control::kTransferSize);
+  }
+
+ private:
+  static void SelectRequest(Request_t request)
+  {
+    // Memory endpoints do not use a request line
+    if (request.line == Request::kNone.line && !request.alternate)
+    {
+      return;
+    }
+    auto * system_controller = SystemController::system_controller;
+    system_controller->DMAREQSEL = bit::Insert(
+        system_controller->DMAREQSEL, request.alternate, request.line, 1);
+  }
+
+  const sjsu::SystemController & system_controller_;
+  const sjsu::InterruptController & interrupt_controller_;
+};
+}  // namespace lpc40xx
+}  // namespace sjsu
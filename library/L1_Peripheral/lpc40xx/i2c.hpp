@@ -1,5 +1,25 @@
+/// Transactions on a bus that has a TransactionQueue_t run one after the
+/// other from the I2C interrupt. When one ends with a stop, the interrupt
+/// starts the next one waiting, so tasks sharing the bus never see each
+/// other's transfers:
+///
+///   - Transaction() (and Read(), Write() and WriteThenRead()) queue the
+///     transaction, then put the calling task to sleep until it is over.
+///     Before the scheduler starts, they run the bus from the SI flag
+///     instead of waiting for the interrupt.
+///   - Enqueue() queues the transaction and returns right away. A completion
+///     handler is called from the interrupt once it is over.
+///
+/// Buses without a queue poll the transaction as it runs.
+///
+/// Each transaction runs at the bus clock given to SetClock(), or at its own
+/// max_frequency if that is lower. The SCL counts are loaded right before the
+/// transaction starts, so devices of different speeds can share a bus.
 #pragma once
 
+#include <FreeRTOS.h>
+#include <semphr.h>
+
 #include <cmath>
 #include <cstdint>
 #include <cstdio>
@@ -15,6 +35,7 @@
 #include "utility/build_info.hpp"
 #include "utility/enum.hpp"
 #include "utility/log.hpp"
+#include "utility/rtos.hpp"
 #include "utility/status.hpp"
 #include "utility/time.hpp"
 
@@ -58,6 +79,85 @@ class I2c final : public sjsu::I2c
     kDoNothing                         = 0xF8
   };
 
+  /// Number of peripheral clock cycles SCL is held high and low for, as
+  /// written to the SCLH and SCLL registers
+  struct SclCounts_t
+  {
+    uint16_t high;
+    uint16_t low;
+  };
+
+  /// Smallest count the SCLH and SCLL registers take.
+  /// Source: "UM10562 LPC408x/407x User manual" chapter 19, I2C
+  static constexpr uint32_t kMinimumSclCount = 4;
+
+  /// Queued transactions wake their task from the I2C interrupt through
+  /// FreeRTOS, which is only allowed at or below
+  /// configMAX_SYSCALL_INTERRUPT_PRIORITY (5).
+  static constexpr int kInterruptPriority = 5;
+
+  /// Work out the SCLH and SCLL counts for an SCL frequency. The period is
+  /// rounded up, so the bus never runs faster than asked.
+  ///
+  /// @param peripheral_frequency - clock rate of the I2C peripheral
+  /// @param frequency - SCL frequency
+  /// @param duty_cycle - percent of the SCL period spent high
+  /// @return counts of zero if the frequency or duty cycle cannot be made
+  static constexpr SclCounts_t CalculateSclCounts(
+      units::frequency::hertz_t peripheral_frequency,
+      units::frequency::hertz_t frequency,
+      uint8_t duty_cycle)
+  {
+    constexpr uint32_t kMaximumSclCount = UINT16_MAX;
+
+    uint32_t peripheral_hz = peripheral_frequency.to<uint32_t>();
+    uint32_t scl_hz        = frequency.to<uint32_t>();
+    if (scl_hz == 0 || frequency > kFastModePlus || duty_cycle == 0 ||
+        duty_cycle >= 100)
+    {
+      return { .high = 0, .low = 0 };
+    }
+    uint32_t period = (peripheral_hz + scl_hz - 1) / scl_hz;
+    if (period > 2 * kMaximumSclCount)
+    {
+      return { .high = 0, .low = 0 };
+    }
+    uint32_t high = (period * duty_cycle + 50) / 100;
+    uint32_t low  = period - high;
+    if (high < kMinimumSclCount || low < kMinimumSclCount ||
+        high > kMaximumSclCount || low > kMaximumSclCount)
+    {
+      return { .high = 0, .low = 0 };
+    }
+    return { .high = static_cast<uint16_t>(high),
+             .low  = static_cast<uint16_t>(low) };
+  }
+
+  /// Called from the I2C interrupt when a transaction given to Enqueue() is
+  /// over. transaction.status says how it went.
+  using CompletionHandler = void (*)(const Transaction_t & transaction,
+                                     void * context);
+
+  /// A transaction waiting for its turn on the bus
+  struct QueuedTransaction_t
+  {
+    Transaction_t transaction;
+    CompletionHandler handler;
+    void * context;
+    /// Loaded into SCLH and SCLL when the transaction starts
+    SclCounts_t scl;
+    /// Skipped when its turn comes, as its caller stopped waiting for it
+    bool cancelled;
+  };
+
+  /// Transactions for a bus, oldest first. The one at head is on the bus.
+  struct TransactionQueue_t
+  {
+    QueuedTransaction_t entries[config::kI2cQueueDepth];
+    volatile size_t head;
+    volatile size_t count;
+  };
+
   struct PartialBus_t
   {
     LPC_I2C_TypeDef * registers;
@@ -67,6 +167,7 @@ class I2c final : public sjsu::I2c
     const sjsu::Pin & sda_pin;
     const sjsu::Pin & scl_pin;
     uint8_t pin_function_id;
+    TransactionQueue_t * queue = nullptr;
   };
 
   struct Bus_t
@@ -98,6 +199,7 @@ class I2c final : public sjsu::I2c
         sjsu::lpc40xx::Pin::CreatePin<0, 11>();
     // UM10562: Chapter 7: LPC408x/407x I/O configuration page 133
     inline static Transaction_t transaction_i2c0;
+    inline static TransactionQueue_t queue_i2c0;
     inline static const PartialBus_t kI2c0Partial = {
       .registers = LPC_I2C0,
       .peripheral_power_id =
@@ -107,9 +209,11 @@ class I2c final : public sjsu::I2c
       .sda_pin         = kI2c0SdaPin,
       .scl_pin         = kI2c0SclPin,
       .pin_function_id = 0b010,
+      .queue           = &queue_i2c0,
     };
 
     inline static Transaction_t transaction_i2c1;
+    inline static TransactionQueue_t queue_i2c1;
     inline static const PartialBus_t kI2c1Partial = {
       .registers = LPC_I2C1,
       .peripheral_power_id =
@@ -119,9 +223,11 @@ class I2c final : public sjsu::I2c
       .sda_pin         = kI2c1SdaPin,
       .scl_pin         = kI2c1SclPin,
       .pin_function_id = 0b011,
+      .queue           = &queue_i2c1,
     };
 
     inline static Transaction_t transaction_i2c2;
+    inline static TransactionQueue_t queue_i2c2;
     inline static const PartialBus_t kI2c2Partial = {
       .registers = LPC_I2C2,
       .peripheral_power_id =
@@ -131,6 +237,7 @@ class I2c final : public sjsu::I2c
       .sda_pin         = kI2c2SdaPin,
       .scl_pin         = kI2c2SclPin,
       .pin_function_id = 0b010,
+      .queue           = &queue_i2c2,
     };
 
    public:
@@ -301,9 +408,79 @@ class I2c final : public sjsu::I2c
     }
     // Clear I2C Interrupt flag
     clear_mask |= Control::kInterrupt;
+    // A stop ends the transaction. Setting start along with stop sends the
+    // stop, then starts the next transaction waiting.
+    QueuedTransaction_t finished = {};
+    if (i2c.queue != nullptr && (set_mask & Control::kStop) &&
+        FinishQueued(i2c, &finished))
+    {
+      set_mask |= Control::kStart;
+      clear_mask &= ~uint32_t{ Control::kStart };
+    }
     // Set register controls
     i2c.registers->CONSET = set_mask;
     i2c.registers->CONCLR = clear_mask;
+    // Called last, so that a handler that queues another transaction is not
+    // undone by the writes above.
+    if (finished.handler != nullptr)
+    {
+      finished.handler(finished.transaction, finished.context);
+    }
+  }
+
+  /// Take the transaction that just ended off the queue, and load the next
+  /// one waiting onto the bus.
+  ///
+  /// @param finished - set to the transaction that ended, along with its
+  ///        completion handler
+  /// @return true if there is a transaction to start
+  static bool FinishQueued(const PartialBus_t & i2c,
+                           QueuedTransaction_t * finished)
+  {
+    TransactionQueue_t & queue = *i2c.queue;
+    sjsu::cortex::InterruptLock lock;
+    if (queue.count == 0)
+    {
+      return false;
+    }
+    i2c.transaction.busy  = false;
+    *finished             = queue.entries[queue.head];
+    finished->transaction = i2c.transaction;
+    Pop(queue);
+    return LoadNext(i2c);
+  }
+
+  /// Must be called with interrupts masked.
+  static void Pop(TransactionQueue_t & queue)
+  {
+    queue.head = (queue.head + 1) % config::kI2cQueueDepth;
+    queue.count--;
+  }
+
+  /// Copy the oldest transaction that is still wanted to the bus's
+  /// transaction. Must be called with interrupts masked.
+  ///
+  /// @return false if there is none
+  static bool LoadNext(const PartialBus_t & i2c)
+  {
+    TransactionQueue_t & queue = *i2c.queue;
+    while (queue.count != 0 && queue.entries[queue.head].cancelled)
+    {
+      Pop(queue);
+    }
+    if (queue.count == 0)
+    {
+      return false;
+    }
+    i2c.transaction = queue.entries[queue.head].transaction;
+    LoadSclCounts(i2c, queue.entries[queue.head].scl);
+    return true;
+  }
+
+  static void LoadSclCounts(const PartialBus_t & i2c, SclCounts_t scl)
+  {
+    i2c.registers->SCLH = scl.high;
+    i2c.registers->SCLL = scl.low;
   }
 
   static constexpr sjsu::cortex::InterruptController kInterruptController =
@@ -332,14 +509,14 @@ class I2c final : public sjsu::I2c
 
     system_controller_.PowerUpPeripheral(i2c_.bus.peripheral_power_id);
 
-    float peripheral_frequency =
-        static_cast<float>(system_controller_.GetPeripheralFrequency(
-            i2c_.bus.peripheral_power_id));
-    float scll = ((peripheral_frequency / 75'000.0f) / 2.0f) * 0.7f;
-    float sclh = ((peripheral_frequency / 75'000.0f) / 2.0f) * 1.3f;
-
-    i2c_.bus.registers->SCLL = static_cast<uint32_t>(scll);
-    i2c_.bus.registers->SCLH = static_cast<uint32_t>(sclh);
+    // Drivers sharing the bus each call Initialize(), so the clock given to
+    // SetClock() is kept rather than reset.
+    Status status = SetClock(clock_rate_, duty_cycle_);
+    if (status != Status::kSuccess)
+    {
+      return status;
+    }
+    LoadSclCounts(i2c_.bus, scl_counts_);
 
     i2c_.bus.registers->CONCLR = Control::kAssertAcknowledge | Control::kStart |
                                  Control::kStop | Control::kInterrupt;
@@ -348,6 +525,7 @@ class I2c final : public sjsu::I2c
     interrupt_controller_.Register({
         .interrupt_request_number  = i2c_.bus.irq_number,
         .interrupt_service_routine = i2c_.handler,
+        .priority                  = kInterruptPriority,
     });
 
     return Status::kSuccess;
@@ -355,11 +533,61 @@ class I2c final : public sjsu::I2c
 
   Status Transaction(Transaction_t transaction) const override
   {
-    i2c_.bus.transaction       = transaction;
+    if (i2c_.bus.queue != nullptr)
+    {
+      return QueuedTransaction(transaction);
+    }
+    SclCounts_t scl = SclCountsFor(transaction);
+    if (scl.high == 0)
+    {
+      return Status::kInvalidParameters;
+    }
+    i2c_.bus.transaction = transaction;
+    LoadSclCounts(i2c_.bus, scl);
     i2c_.bus.registers->CONSET = Control::kStart;
     return BlockUntilFinished();
   }
 
+  Status SetClock(units::frequency::hertz_t frequency,
+                  uint8_t duty_cycle = kDefaultDutyCycle) const override
+  {
+    peripheral_frequency_ =
+        system_controller_.GetPeripheralFrequency(i2c_.bus.peripheral_power_id);
+    SclCounts_t scl =
+        CalculateSclCounts(peripheral_frequency_, frequency, duty_cycle);
+    if (scl.high == 0)
+    {
+      return Status::kInvalidParameters;
+    }
+    clock_rate_ = frequency;
+    duty_cycle_ = duty_cycle;
+    scl_counts_ = scl;
+    return Status::kSuccess;
+  }
+
+  /// @return the bus clock last given to SetClock()
+  units::frequency::hertz_t GetClock() const
+  {
+    return clock_rate_;
+  }
+
+  /// Queue a transaction behind those already waiting for the bus, and return
+  /// without waiting for it. The handler is called from the I2C interrupt
+  /// once it is over. The transaction's buffers must stay valid until then.
+  ///
+  /// @return Status::kNotImplemented if the bus has no queue,
+  ///         Status::kNotReadyYet if the queue is full,
+  ///         Status::kInvalidParameters if the transaction's max_frequency
+  ///         cannot be made,
+  ///         otherwise Status::kSuccess.
+  Status Enqueue(Transaction_t transaction,
+                 CompletionHandler handler,
+                 void * context = nullptr) const
+  {
+    size_t index;
+    return Push(transaction, handler, context, &index);
+  }
+
   const Transaction_t GetTransactionInfo()
   {
     return i2c_.bus.transaction;
@@ -371,6 +599,20 @@ class I2c final : public sjsu::I2c
   }
 
  protected:
+  /// @return the SCL counts for the lower of the bus clock and the
+  ///         transaction's max_frequency, or counts of zero if that cannot be
+  ///         made
+  SclCounts_t SclCountsFor(const Transaction_t & transaction) const
+  {
+    if (transaction.max_frequency == 0_Hz ||
+        transaction.max_frequency >= clock_rate_)
+    {
+      return scl_counts_;
+    }
+    return CalculateSclCounts(
+        peripheral_frequency_, transaction.max_frequency, duty_cycle_);
+  }
+
   Status BlockUntilFinished() const
   {
     // Skip waiting on the interrupt if running a host unit test
@@ -405,9 +647,160 @@ class I2c final : public sjsu::I2c
     i2c_.bus.registers->CONCLR = Control::kStart;
     return i2c_.bus.transaction.status;
   }
+  /// Lets a task sleep on a queued transaction
+  struct Waiter_t
+  {
+    /// Given by the interrupt once the transaction is over. Null when the
+    /// transaction is polled.
+    SemaphoreHandle_t signal;
+    volatile bool done;
+    Status status;
+  };
+
+  static void WakeWaiter(const Transaction_t & transaction, void * context)
+  {
+    auto * waiter  = static_cast<Waiter_t *>(context);
+    waiter->status = transaction.status;
+    waiter->done   = true;
+    if (waiter->signal != nullptr)
+    {
+      BaseType_t higher_priority_task_woken = pdFALSE;
+      xSemaphoreGiveFromISR(waiter->signal, &higher_priority_task_woken);
+      rtos::YieldFromIsr(higher_priority_task_woken);
+    }
+  }
+
+  Status Push(const Transaction_t & transaction,
+              CompletionHandler handler,
+              void * context,
+              size_t * index) const
+  {
+    TransactionQueue_t * queue = i2c_.bus.queue;
+    if (queue == nullptr)
+    {
+      return Status::kNotImplemented;
+    }
+    SclCounts_t scl = SclCountsFor(transaction);
+    if (scl.high == 0)
+    {
+      return Status::kInvalidParameters;
+    }
+    sjsu::cortex::InterruptLock lock;
+    if (queue->count == config::kI2cQueueDepth)
+    {
+      return Status::kNotReadyYet;
+    }
+    *index = (queue->head + queue->count) % config::kI2cQueueDepth;
+    queue->entries[*index] = {
+      .transaction = transaction,
+      .handler     = handler,
+      .context     = context,
+      .scl         = scl,
+      .cancelled   = false,
+    };
+    queue->entries[*index].transaction.busy = true;
+    queue->count++;
+    // An empty queue means the bus is idle, so nothing else will start it.
+    if (queue->count == 1)
+    {
+      i2c_.bus.transaction = queue->entries[*index].transaction;
+      LoadSclCounts(i2c_.bus, scl);
+      i2c_.bus.registers->CONSET = Control::kStart;
+    }
+    return Status::kSuccess;
+  }
+
+  /// Queue the transaction and wait for it. The calling task sleeps if the
+  /// scheduler is running, otherwise the transaction is polled.
+  Status QueuedTransaction(const Transaction_t & transaction) const
+  {
+    SJ2_ASSERT_FATAL(IsIntialized(),
+                     "Attempted to use I2C, but peripheral was not "
+                     "initialized! Be sure to run the Initialize() method "
+                     "of this class, before using it.");
+    StaticSemaphore_t signal_buffer;
+    Waiter_t waiter = { .signal = nullptr, .done = false, .status = {} };
+    bool can_sleep  = (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING);
+    if (can_sleep)
+    {
+      // Each transaction has a semaphore of its own, so a completion that
+      // arrives after its caller gave up cannot wake a later wait.
+      waiter.signal = xSemaphoreCreateBinaryStatic(&signal_buffer);
+    }
+    size_t index;
+    Status status = Push(transaction, WakeWaiter, &waiter, &index);
+    if (status != Status::kSuccess)
+    {
+      return status;
+    }
+
+    if (can_sleep)
+    {
+      xSemaphoreTake(waiter.signal,
+                     pdMS_TO_TICKS(transaction.timeout.count()));
+    }
+    else
+    {
+      // Before the scheduler starts, creating any FreeRTOS object masks the
+      // interrupts that may call FreeRTOS, the I2C interrupt among them, so
+      // the state machine is run from here instead.
+      Wait(transaction.timeout, [this, &waiter]() -> bool {
+        PollInterrupt();
+        return waiter.done;
+      });
+    }
+
+    sjsu::cortex::InterruptLock lock;
+    if (!waiter.done)
+    {
+      Cancel(index);
+      return Status::kTimedOut;
+    }
+    return waiter.status;
+  }
+
+  /// Run the interrupt handler if the bus is waiting on it
+  void PollInterrupt() const
+  {
+    // Keeps the interrupt, should it be unmasked, from handling the same
+    // state
+    sjsu::cortex::InterruptLock lock;
+    if (i2c_.bus.registers->CONSET & Control::kInterrupt)
+    {
+      i2c_.handler();
+    }
+  }
+
+  /// Take back a transaction whose caller stopped waiting for it. One that is
+  /// on the bus is aborted. Must be called with interrupts masked.
+  void Cancel(size_t index) const
+  {
+    TransactionQueue_t & queue   = *i2c_.bus.queue;
+    queue.entries[index].handler = nullptr;
+    if (index != queue.head)
+    {
+      queue.entries[index].cancelled = true;
+      return;
+    }
+    i2c_.bus.registers->CONSET  = Control::kAssertAcknowledge | Control::kStop;
+    i2c_.bus.registers->CONCLR  = Control::kStart;
+    i2c_.bus.transaction.busy   = false;
+    i2c_.bus.transaction.status = Status::kTimedOut;
+    Pop(queue);
+    if (LoadNext(i2c_.bus))
+    {
+      i2c_.bus.registers->CONSET = Control::kStart;
+    }
+  }
+
   const Bus_t & i2c_;
   const sjsu::SystemController & system_controller_;
   const sjsu::InterruptController & interrupt_controller_;
+  mutable units::frequency::hertz_t clock_rate_ = config::kI2cClockRate;
+  mutable uint8_t duty_cycle_                   = kDefaultDutyCycle;
+  mutable SclCounts_t scl_counts_               = { .high = 0, .low = 0 };
+
+  mutable units::frequency::hertz_t peripheral_frequency_ = 0_Hz;
 };
 }  // namespace lpc40xx
 }  // namespace sjsu
@@ -13,6 +13,11 @@
 ///     3. SetPull(...)
 ///     4. Initialize()
 ///
+/// Block transfers longer than the FIFO need not hold the CPU in a polling
+/// loop. After EnableDma(), long transfers are moved by the GPDMA; after
+/// EnableInterrupts(), the rest are moved by the SSP interrupt. Either way the
+/// calling task sleeps until the transfer is over.
+///
 /// Note that all register modifications must be made before the SSP
 /// is enabled in the CR1 register (see page 612 of user manual UM10562)
 /// If changes are desired after the Initialize function is called, the
@@ -20,13 +25,23 @@
 
 #pragma once
 
+#include <FreeRTOS.h>
+#include <semphr.h>
+
+#include <cstddef>
+#include <cstdint>
+
 #include "L1_Peripheral/spi.hpp"
 
 #include "L0_Platform/lpc40xx/LPC40xx.h"
+#include "L1_Peripheral/cortex/interrupt.hpp"
+#include "L1_Peripheral/lpc40xx/dma.hpp"
 #include "L1_Peripheral/lpc40xx/pin.hpp"
 #include "L1_Peripheral/lpc40xx/system_controller.hpp"
 #include "utility/bit.hpp"
 #include "utility/enum.hpp"
+#include "utility/log.hpp"
+#include "utility/rtos.hpp"
 #include "utility/status.hpp"
 
 namespace sjsu
@@ -36,6 +51,10 @@ namespace lpc40xx
 class Spi final : public sjsu::Spi
 {
  public:
+  // Bringing in the Spi interface's Transfer() that sends 0xFF when there is
+  // nothing to transmit.
+  using sjsu::Spi::Transfer;
+
   // SSPn Control Register 0
   struct ControlRegister0  // NOLINT
   {
@@ -54,8 +73,37 @@ class Spi final : public sjsu::Spi
   // SSPn Status Register
   struct StatusRegister  // NOLINT
   {
+    static constexpr bit::Mask kTransmitFifoNotFull =
+        bit::CreateMaskFromRange(1);
+    static constexpr bit::Mask kReceiveFifoNotEmpty =
+        bit::CreateMaskFromRange(2);
     static constexpr bit::Mask kDataLineIdleBit = bit::CreateMaskFromRange(4);
   };
+  // SSPn Interrupt Mask Set/Clear, Raw and Masked Status and Clear Registers
+  struct InterruptRegister  // NOLINT
+  {
+    static constexpr bit::Mask kReceiveOverrun = bit::CreateMaskFromRange(0);
+    /// The receive FIFO is not empty and has not been read for 32 bit times
+    static constexpr bit::Mask kReceiveTimeout = bit::CreateMaskFromRange(1);
+    /// The receive FIFO is at least half full
+    static constexpr bit::Mask kReceiveHalfFull = bit::CreateMaskFromRange(2);
+    /// The transmit FIFO is at least half empty
+    static constexpr bit::Mask kTransmitHalfEmpty =
+        bit::CreateMaskFromRange(3);
+  };
+  // SSPn DMA Control Register
+  struct DmaControlRegister  // NOLINT
+  {
+    static constexpr bit::Mask kReceiveEnable  = bit::CreateMaskFromRange(0);
+    static constexpr bit::Mask kTransmitEnable = bit::CreateMaskFromRange(1);
+  };
+
+  /// Number of frames the transmit and receive FIFOs can each hold
+  static constexpr size_t kFifoDepth = 8;
+  /// Block transfers of at least this many frames are moved by the GPDMA if
+  /// it has been enabled with EnableDma(). Shorter transfers, such as command
+  /// frames, are cheaper to push through the FIFO directly.
+  static constexpr size_t kDmaThreshold = 16;
 
   // SSP data size for frame packets
   static constexpr uint8_t kDataSizeLUT[] = {
@@ -74,6 +122,65 @@ class Spi final : public sjsu::Spi
     0b1111,  // 16-bit transfer
   };
 
+  /// Block transfers longer than the FIFO are moved by the SSP interrupt if it
+  /// has been enabled with EnableInterrupts() and the scheduler is running.
+  /// Anything that fits in the FIFO is over before a task switch would be.
+  static constexpr size_t kInterruptThreshold = kFifoDepth + 1;
+
+  /// State of a block transfer moved by the SSP interrupt, shared between the
+  /// waiting task and the interrupt handler.
+  struct InterruptTransfer_t
+  {
+    const uint8_t * transmit;
+    uint8_t * receive;
+    size_t length;
+    volatile size_t transmitted;
+    volatile size_t received;
+    uint8_t fill_byte;
+    /// Binary semaphore given once every frame has been received. It belongs
+    /// to this transfer alone, so the waiting task's notifications are left
+    /// for whoever else uses them.
+    SemaphoreHandle_t done;
+  };
+
+  /// Clock dividers of the SSP, which runs the bus at
+  /// PCLK / (prescaler * (rate + 1))
+  struct Prescaler_t
+  {
+    /// CPSDVSR, an even number from 2 to 254
+    uint8_t prescaler;
+    /// SCR, the serial clock rate from 0 to 255
+    uint8_t rate;
+  };
+
+  /// Finds the smallest overall divider that is at least minimum_divider, so
+  /// that the bus never runs faster than requested. On ties the largest
+  /// prescaler is used.
+  static constexpr Prescaler_t CalculatePrescaler(uint32_t minimum_divider)
+  {
+    Prescaler_t best      = { 254, 255 };
+    uint32_t best_divider = 254 * 256;
+    for (uint32_t prescaler = 254; prescaler >= 2; prescaler -= 2)
+    {
+      // The rate multiplier, SCR + 1, rounded up
+      uint32_t multiplier = minimum_divider / prescaler +
+                            ((minimum_divider % prescaler != 0) ? 1 : 0);
+      multiplier = (multiplier == 0) ? 1 : multiplier;
+      if (multiplier > 256)
+      {
+        // Smaller prescalers only need larger multipliers
+        break;
+      }
+      if (prescaler * multiplier < best_divider)
+      {
+        best = { static_cast<uint8_t>(prescaler),
+                 static_cast<uint8_t>(multiplier - 1) };
+        best_divider = prescaler * multiplier;
+      }
+    }
+    return best;
+  }
+
   struct Bus_t
   {
     LPC_SSP_TypeDef * registers;
@@ -82,8 +189,69 @@ class Spi final : public sjsu::Spi
     const sjsu::Pin & miso;
     const sjsu::Pin & sck;
     uint8_t pin_function_id;
+    Dma::Request_t transmit_request = Dma::Request::kNone;
+    Dma::Request_t receive_request  = Dma::Request::kNone;
+    sjsu::cortex::IRQn_Type irq_number      = sjsu::cortex::Reset_IRQn;
+    InterruptTransfer_t * interrupt_transfer = nullptr;
+    IsrPointer handler                       = nullptr;
   };
 
+  /// Moves frames for the interrupt driven transfer in progress on the bus.
+  /// The receive FIFO raises the interrupt when it is half full, or when the
+  /// last few frames of a transfer have sat in it for 32 bit times. Each time,
+  /// the received frames are drained and the transmit FIFO is topped back up,
+  /// so the bus keeps running while the task that started the transfer
+  /// sleeps.
+  static void SspHandler(const Bus_t & bus)
+  {
+    InterruptTransfer_t & transfer = *bus.interrupt_transfer;
+    bus.registers->ICR =
+        bit::Set(uint32_t{ 0 }, InterruptRegister::kReceiveTimeout.position);
+    MoveFrames(bus);
+    if (transfer.received < transfer.length)
+    {
+      return;
+    }
+
+    bus.registers->IMSC = 0;
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    xSemaphoreGiveFromISR(transfer.done, &higher_priority_task_woken);
+    rtos::YieldFromIsr(higher_priority_task_woken);
+  }
+
+  /// Drain the receive FIFO, then refill the transmit FIFO. No more than
+  /// kFifoDepth frames are ever in flight, so the receive FIFO cannot
+  /// overflow.
+  static void MoveFrames(const Bus_t & bus)
+  {
+    InterruptTransfer_t & transfer = *bus.interrupt_transfer;
+    size_t transmitted             = transfer.transmitted;
+    size_t received                = transfer.received;
+    while (received < transmitted &&
+           bit::Read(bus.registers->SR,
+                     StatusRegister::kReceiveFifoNotEmpty.position))
+    {
+      uint8_t data = static_cast<uint8_t>(bus.registers->DR);
+      if (transfer.receive != nullptr)
+      {
+        transfer.receive[received] = data;
+      }
+      received++;
+    }
+    while (transmitted < transfer.length &&
+           (transmitted - received) < kFifoDepth &&
+           bit::Read(bus.registers->SR,
+                     StatusRegister::kTransmitFifoNotFull.position))
+    {
+      bus.registers->DR = (transfer.transmit != nullptr)
+                              ? transfer.transmit[transmitted]
+                              : transfer.fill_byte;
+      transmitted++;
+    }
+    transfer.transmitted = transmitted;
+    transfer.received    = received;
+  }
+
   struct Bus  // NOLINT
   {
    private:
@@ -109,37 +277,76 @@ class Spi final : public sjsu::Spi
     inline static const sjsu::lpc40xx::Pin kSck2 =
         sjsu::lpc40xx::Pin::CreatePin<1, 0>();
 
+    inline static InterruptTransfer_t interrupt_transfer_spi0;
+    inline static InterruptTransfer_t interrupt_transfer_spi1;
+    inline static InterruptTransfer_t interrupt_transfer_spi2;
+
+    static void Ssp0Handler()
+    {
+      SspHandler(kSpi0);
+    }
+    static void Ssp1Handler()
+    {
+      SspHandler(kSpi1);
+    }
+    static void Ssp2Handler()
+    {
+      SspHandler(kSpi2);
+    }
+
    public:
     inline static const Bus_t kSpi0 = {
-      .registers       = LPC_SSP0,
-      .power_on_bit    = sjsu::lpc40xx::SystemController::Peripherals::kSsp0,
-      .mosi            = kMosi0,
-      .miso            = kMiso0,
-      .sck             = kSck0,
-      .pin_function_id = 0b010,
+      .registers          = LPC_SSP0,
+      .power_on_bit       = sjsu::lpc40xx::SystemController::Peripherals::kSsp0,
+      .mosi               = kMosi0,
+      .miso               = kMiso0,
+      .sck                = kSck0,
+      .pin_function_id    = 0b010,
+      .transmit_request   = Dma::Request::kSsp0Tx,
+      .receive_request    = Dma::Request::kSsp0Rx,
+      .irq_number         = SSP0_IRQn,
+      .interrupt_transfer = &interrupt_transfer_spi0,
+      .handler            = Ssp0Handler,
     };
     inline static const Bus_t kSpi1 = {
-      .registers       = LPC_SSP1,
-      .power_on_bit    = sjsu::lpc40xx::SystemController::Peripherals::kSsp1,
-      .mosi            = kMosi1,
-      .miso            = kMiso1,
-      .sck             = kSck1,
-      .pin_function_id = 0b010,
+      .registers          = LPC_SSP1,
+      .power_on_bit       = sjsu::lpc40xx::SystemController::Peripherals::kSsp1,
+      .mosi               = kMosi1,
+      .miso               = kMiso1,
+      .sck                = kSck1,
+      .pin_function_id    = 0b010,
+      .transmit_request   = Dma::Request::kSsp1Tx,
+      .receive_request    = Dma::Request::kSsp1Rx,
+      .irq_number         = SSP1_IRQn,
+      .interrupt_transfer = &interrupt_transfer_spi1,
+      .handler            = Ssp1Handler,
     };
     inline static const Bus_t kSpi2 = {
-      .registers       = LPC_SSP2,
-      .power_on_bit    = sjsu::lpc40xx::SystemController::Peripherals::kSsp2,
-      .mosi            = kMosi2,
-      .miso            = kMiso2,
-      .sck             = kSck2,
-      .pin_function_id = 0b100,
+      .registers          = LPC_SSP2,
+      .power_on_bit       = sjsu::lpc40xx::SystemController::Peripherals::kSsp2,
+      .mosi               = kMosi2,
+      .miso               = kMiso2,
+      .sck                = kSck2,
+      .pin_function_id    = 0b100,
+      .transmit_request   = Dma::Request::kSsp2Tx,
+      .receive_request    = Dma::Request::kSsp2Rx,
+      .irq_number         = SSP2_IRQn,
+      .interrupt_transfer = &interrupt_transfer_spi2,
+      .handler            = Ssp2Handler,
     };
   };
 
+  static constexpr sjsu::cortex::InterruptController kInterruptController =
+      sjsu::cortex::InterruptController();
+
   explicit constexpr Spi(const Bus_t & bus,
                          const sjsu::SystemController & system_controller =
-                             DefaultSystemController())
-      : bus_(bus), system_controller_(system_controller)
+                             DefaultSystemController(),
+                         const sjsu::InterruptController &
+                             interrupt_controller = kInterruptController)
+      : bus_(bus),
+        system_controller_(system_controller),
+        interrupt_controller_(interrupt_controller)
   {
   }
 
@@ -169,6 +376,70 @@ class Spi final : public sjsu::Spi
     return Status::kSuccess;
   }
 
+  /// Allocate a transmit and a receive GPDMA channel for this bus. After
+  /// this, block transfers of kDmaThreshold frames or more are moved by the
+  /// GPDMA, and if the scheduler is running, the calling task sleeps until
+  /// the transfer has completed rather than spinning on the FIFO.
+  ///
+  /// @param dma - DMA controller to take the channels from.
+  /// @return Status::kNotImplemented if the bus has no DMA request lines,
+  ///         Status::kNotReadyYet if there are not enough free channels,
+  ///         otherwise Status::kSuccess.
+  Status EnableDma(const Dma & dma) const
+  {
+    if (bus_.transmit_request.line == Dma::Request::kNone.line ||
+        bus_.receive_request.line == Dma::Request::kNone.line)
+    {
+      return Status::kNotImplemented;
+    }
+    if (dma_ != nullptr)
+    {
+      return Status::kSuccess;
+    }
+
+    dma.Initialize();
+    uint8_t transmit_channel = dma.AllocateChannel();
+    uint8_t receive_channel  = dma.AllocateChannel();
+    if (transmit_channel == Dma::kInvalidChannel ||
+        receive_channel == Dma::kInvalidChannel)
+    {
+      dma.ReleaseChannel(transmit_channel);
+      dma.ReleaseChannel(receive_channel);
+      return Status::kNotReadyYet;
+    }
+
+    transmit_channel_ = transmit_channel;
+    receive_channel_  = receive_channel;
+    dma_              = &dma;
+    return Status::kSuccess;
+  }
+
+  /// Register the SSP interrupt handler. After this, block transfers of
+  /// kInterruptThreshold frames or more that are not moved by the GPDMA are
+  /// moved by the interrupt handler while the calling task sleeps, provided
+  /// the scheduler is running.
+  ///
+  /// @return Status::kNotImplemented if the bus has no interrupt handler,
+  ///         otherwise Status::kSuccess.
+  Status EnableInterrupts() const
+  {
+    if (bus_.handler == nullptr || bus_.interrupt_transfer == nullptr)
+    {
+      return Status::kNotImplemented;
+    }
+    bus_.registers->IMSC = 0;
+    // The handler wakes the waiting task through FreeRTOS, so, like the DMA
+    // handler, it must not be more urgent than
+    // configMAX_SYSCALL_INTERRUPT_PRIORITY.
+    interrupt_controller_.Register({
+        .interrupt_request_number  = bus_.irq_number,
+        .interrupt_service_routine = bus_.handler,
+        .priority                  = Dma::kInterruptPriority,
+    });
+    interrupts_enabled_ = true;
+    return Status::kSuccess;
+  }
+
   /// An easy way to sets up an SPI peripheral as SPI master with default clock
   /// rate at 1Mhz.
   void SetSpiDefault() const
@@ -206,6 +477,42 @@ class Spi final : public sjsu::Spi
     return static_cast<uint16_t>(bus_.registers->DR);
   }
 
+  /// Exchange a block of frames, keeping the transmit FIFO full so that frames
+  /// are clocked out back to back rather than waiting for the bus to go idle
+  /// after each one. Received frames are drained in lockstep, and no more than
+  /// kFifoDepth frames are ever in flight, so the receive FIFO cannot
+  /// overflow. It is recommended this region be protected by a mutex.
+  ///
+  /// @param transmit - bytes to send, or nullptr to send fill_byte.
+  /// @param receive - buffer for received bytes, or nullptr to discard them.
+  /// @param length - number of frames to exchange.
+  /// @param fill_byte - value sent for each frame when transmit is nullptr.
+  void Transfer(const uint8_t * transmit,
+                uint8_t * receive,
+                size_t length,
+                uint8_t fill_byte) const override
+  {
+    // Throw away anything left in the receive FIFO so the received frames
+    // line up with the transmitted ones.
+    for (size_t i = 0; i < kFifoDepth && ReceiveFifoHasData(); i++)
+    {
+      bus_.registers->DR;
+    }
+
+    if (dma_ != nullptr && length >= kDmaThreshold)
+    {
+      DmaTransfer(transmit, receive, length, fill_byte);
+      return;
+    }
+    if (interrupts_enabled_ && length >= kInterruptThreshold &&
+        xTaskGetSchedulerState() == taskSCHEDULER_RUNNING)
+    {
+      InterruptDrivenTransfer(transmit, receive, length, fill_byte);
+      return;
+    }
+    PolledTransfer(transmit, receive, length, fill_byte);
+  }
+
   /// Sets the various modes for the Peripheral
   /// @param size - number of bits per frame
   void SetDataSize(DataSize size) const override
@@ -231,27 +538,266 @@ class Spi final : public sjsu::Spi
                 bool positive_clock_on_idle = false,
                 bool read_miso_on_rising    = false) const override
   {
-    bus_.registers->CR0 = bit::Insert(bus_.registers->CR0,
-                                      positive_clock_on_idle,
-                                      ControlRegister0::kPolarityBit);
+    uint32_t peripheral_frequency =
+        system_controller_.GetPeripheralFrequency(bus_.power_on_bit)
+            .to<uint32_t>();
+    uint32_t target = frequency.to<uint32_t>();
+    // Round the divider up, so the bus is never faster than requested
+    uint32_t minimum_divider =
+        (target == 0) ? UINT32_MAX
+                      : peripheral_frequency / target +
+                            ((peripheral_frequency % target != 0) ? 1 : 0);
+    Prescaler_t prescaler = CalculatePrescaler(minimum_divider);
 
-    bus_.registers->CR0 = bit::Insert(
-        bus_.registers->CR0, read_miso_on_rising, ControlRegister0::kPhaseBit);
-
-    uint16_t prescaler =
-        (system_controller_.GetPeripheralFrequency(bus_.power_on_bit) /
-         frequency)
-            .to<uint16_t>();
-    // Store lower half of precalar in clock prescalar register
-    bus_.registers->CPSR = prescaler & 0xFF;
-    // Store upper 8 bit half of the prescalar in control register 0
-    bus_.registers->CR0 = bit::Insert(
-        bus_.registers->CR0, prescaler >> 8, ControlRegister0::kDividerBit);
+    // Mode and rate share CR0, so they are updated with a single write
+    uint32_t control = bus_.registers->CR0;
+    control          = bit::Insert(control, positive_clock_on_idle,
+                                   ControlRegister0::kPolarityBit);
+    control          = bit::Insert(control, read_miso_on_rising,
+                                   ControlRegister0::kPhaseBit);
+    control          = bit::Insert(control, prescaler.rate,
+                                   ControlRegister0::kDividerBit);
+
+    bus_.registers->CPSR = prescaler.prescaler;
+    bus_.registers->CR0  = control;
+  }
+
+  units::frequency::hertz_t GetClock() const override
+  {
+    uint32_t prescaler = bus_.registers->CPSR;
+    uint32_t multiplier =
+        bit::Extract(bus_.registers->CR0, ControlRegister0::kDividerBit) + 1;
+    if (prescaler == 0)
+    {
+      return 0_Hz;
+    }
+    return system_controller_.GetPeripheralFrequency(bus_.power_on_bit) /
+           (prescaler * multiplier);
   }
 
  private:
+  /// Shared between a DMA transfer and the DMA completion handler
+  struct DmaCompletion_t
+  {
+    /// Binary semaphore given once both channels are done
+    SemaphoreHandle_t done;
+    volatile uint8_t pending_channels;
+    volatile Status status;
+  };
+
+  static void DmaHandler(Status status, void * context)
+  {
+    auto * completion = static_cast<DmaCompletion_t *>(context);
+    if (status != Status::kSuccess)
+    {
+      // A failed channel will never finish, so do not wait for the other one
+      completion->status           = status;
+      completion->pending_channels = 0;
+    }
+    else
+    {
+      completion->pending_channels = completion->pending_channels - 1;
+    }
+
+    if (completion->pending_channels == 0)
+    {
+      BaseType_t higher_priority_task_woken = pdFALSE;
+      xSemaphoreGiveFromISR(completion->done, &higher_priority_task_woken);
+      rtos::YieldFromIsr(higher_priority_task_woken);
+    }
+  }
+
+  void PolledTransfer(const uint8_t * transmit,
+                      uint8_t * receive,
+                      size_t length,
+                      uint8_t fill_byte) const
+  {
+    size_t transmitted = 0;
+    size_t received    = 0;
+    while (received < length)
+    {
+      while (transmitted < length && (transmitted - received) < kFifoDepth &&
+             TransmitFifoHasSpace())
+      {
+        bus_.registers->DR =
+            (transmit != nullptr) ? transmit[transmitted] : fill_byte;
+        transmitted++;
+      }
+      while (received < transmitted && ReceiveFifoHasData())
+      {
+        uint8_t data = static_cast<uint8_t>(bus_.registers->DR);
+        if (receive != nullptr)
+        {
+          receive[received] = data;
+        }
+        received++;
+      }
+    }
+  }
+
+  void DmaTransfer(const uint8_t * transmit,
+                   uint8_t * receive,
+                   size_t length,
+                   uint8_t fill_byte) const
+  {
+    // Source of the frames to send and destination of received frames when
+    // the caller has not supplied a buffer. Both must live until the DMA
+    // transfer has finished.
+    const uint8_t kFill = fill_byte;
+    uint8_t discard;
+    // Before the scheduler starts there is no task to put to sleep, so the
+    // channels are polled instead and no completion handler is needed.
+    StaticSemaphore_t done_buffer;
+    SemaphoreHandle_t done         = nullptr;
+    Dma::CompletionHandler handler = nullptr;
+    if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING)
+    {
+      done    = xSemaphoreCreateBinaryStatic(&done_buffer);
+      handler = DmaHandler;
+    }
+
+    while (length > 0)
+    {
+      size_t chunk = (length < Dma::kMaxTransferSize) ? length
+                                                      : Dma::kMaxTransferSize;
+      DmaCompletion_t completion = {
+        .done             = done,
+        .pending_channels = 2,
+        .status           = Status::kSuccess,
+      };
+
+      Dma::Transfer_t receive_transfer = {
+        .type                  = Dma::TransferType::kPeripheralToMemory,
+        .source                = &bus_.registers->DR,
+        .destination           = (receive != nullptr) ? receive : &discard,
+        .length                = chunk,
+        .increment_source      = false,
+        .increment_destination = (receive != nullptr),
+        .source_request        = bus_.receive_request,
+      };
+      Dma::Transfer_t transmit_transfer = {
+        .type                  = Dma::TransferType::kMemoryToPeripheral,
+        .source                = (transmit != nullptr) ? transmit : &kFill,
+        .destination           = &bus_.registers->DR,
+        .length                = chunk,
+        .increment_source      = (transmit != nullptr),
+        .increment_destination = false,
+        .destination_request   = bus_.transmit_request,
+      };
+
+      // Start the receive channel first so that no frame is missed, then let
+      // the SSP request data from both channels.
+      Status status =
+          dma_->Start(receive_channel_, receive_transfer, handler, &completion);
+      if (status == Status::kSuccess)
+      {
+        status = dma_->Start(transmit_channel_, transmit_transfer, handler,
+                             &completion);
+        if (status != Status::kSuccess)
+        {
+          dma_->Stop(receive_channel_);
+        }
+      }
+      if (status != Status::kSuccess)
+      {
+        // Nothing has been requested from the channels yet, so the frames
+        // left can still go through the FIFO.
+        LOG_WARNING("SPI DMA transfer could not start: %s", Stringify(status));
+        PolledTransfer(transmit, receive, length, fill_byte);
+        return;
+      }
+      bus_.registers->DMACR =
+          bit::Set(bit::Set(uint32_t{ 0 },
+                            DmaControlRegister::kReceiveEnable.position),
+                   DmaControlRegister::kTransmitEnable.position);
+
+      if (handler != nullptr)
+      {
+        while (completion.pending_channels != 0)
+        {
+          xSemaphoreTake(done, portMAX_DELAY);
+        }
+      }
+      else
+      {
+        while (dma_->IsBusy(receive_channel_) ||
+               dma_->IsBusy(transmit_channel_))
+        {
+          continue;
+        }
+      }
+
+      bus_.registers->DMACR = 0;
+      if (completion.status != Status::kSuccess)
+      {
+        dma_->Stop(transmit_channel_);
+        dma_->Stop(receive_channel_);
+        LOG_ERROR("SPI DMA transfer failed: %s", Stringify(completion.status));
+        return;
+      }
+
+      length -= chunk;
+      if (transmit != nullptr)
+      {
+        transmit += chunk;
+      }
+      if (receive != nullptr)
+      {
+        receive += chunk;
+      }
+    }
+  }
+
+  void InterruptDrivenTransfer(const uint8_t * transmit,
+                               uint8_t * receive,
+                               size_t length,
+                               uint8_t fill_byte) const
+  {
+    StaticSemaphore_t done_buffer;
+    InterruptTransfer_t & transfer = *bus_.interrupt_transfer;
+    transfer = {
+      .transmit    = transmit,
+      .receive     = receive,
+      .length      = length,
+      .transmitted = 0,
+      .received    = 0,
+      .fill_byte   = fill_byte,
+      .done        = xSemaphoreCreateBinaryStatic(&done_buffer),
+    };
+
+    // Fill the transmit FIFO, then let the receive FIFO take over. If the
+    // handler finishes before the task sleeps, the semaphore is already given
+    // and the task does not sleep at all.
+    MoveFrames(bus_);
+    bus_.registers->IMSC =
+        bit::Set(bit::Set(uint32_t{ 0 },
+                          InterruptRegister::kReceiveHalfFull.position),
+                 InterruptRegister::kReceiveTimeout.position);
+    while (transfer.received < transfer.length)
+    {
+      xSemaphoreTake(transfer.done, portMAX_DELAY);
+    }
+  }
+
+  bool TransmitFifoHasSpace() const
+  {
+    return bit::Read(bus_.registers->SR,
+                     StatusRegister::kTransmitFifoNotFull.position);
+  }
+
+  bool ReceiveFifoHasData() const
+  {
+    return bit::Read(bus_.registers->SR,
+                     StatusRegister::kReceiveFifoNotEmpty.position);
+  }
+
   const Bus_t & bus_;
   const sjsu::SystemController & system_controller_;
+  const sjsu::InterruptController & interrupt_controller_;
+  mutable bool interrupts_enabled_   = false;
+  mutable const Dma * dma_           = nullptr;
+  mutable uint8_t transmit_channel_ = Dma::kInvalidChannel;
+  mutable uint8_t receive_channel_  = Dma::kInvalidChannel;
 };
 }  // namespace lpc40xx
 }  // namespace sjsu
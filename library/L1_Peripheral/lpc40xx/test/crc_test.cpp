@@ -0,0 +1,300 @@
+#include <cstdint>
+#include <cstring>
+
+#include "L0_Platform/lpc40xx/LPC40xx.h"
+#include "L1_Peripheral/lpc40xx/crc.hpp"
+#include "L4_Testing/testing_frameworks.hpp"
+
+namespace sjsu::lpc40xx
+{
+EMIT_ALL_METHODS(Crc);
+
+namespace
+{
+constexpr uint8_t kCheckMessage[] = { '1', '2', '3', '4', '5',
+                                      '6', '7', '8', '9' };
+
+template <typename T>
+T ReverseBits(T value, uint8_t width)
+{
+  T result = 0;
+  for (uint8_t bit = 0; bit < width; bit++)
+  {
+    result = static_cast<T>((result << 1) | ((value >> bit) & 1));
+  }
+  return result;
+}
+
+/// Bit by bit model of the CRC engine as described by the user manual, fed
+/// one byte at a time. Used to check that the MODE and SEED values chosen for
+/// each algorithm reproduce the software CRCs.
+uint32_t ModelEngine(const Crc::Configuration_t & configuration,
+                     const uint8_t * data,
+                     size_t length)
+{
+  uint32_t mode   = configuration.mode;
+  auto polynomial = static_cast<Crc::Polynomial>(
+      bit::Extract(mode, Crc::ModeRegister::kPolynomial));
+  uint8_t width      = (polynomial == Crc::Polynomial::kCrc32) ? 32 : 16;
+  uint32_t generator = 0x1021;
+  if (polynomial == Crc::Polynomial::kCrc16)
+  {
+    generator = 0x8005;
+  }
+  else if (polynomial == Crc::Polynomial::kCrc32)
+  {
+    generator = 0x04C1'1DB7;
+  }
+  uint32_t top_bit = uint32_t{ 1 } << (width - 1);
+  uint32_t mask    = (width == 32) ? 0xFFFF'FFFF : 0xFFFF;
+
+  uint32_t crc = configuration.seed & mask;
+  for (size_t i = 0; i < length; i++)
+  {
+    uint8_t byte = data[i];
+    if (bit::Read(mode, Crc::ModeRegister::kReverseWrite.position))
+    {
+      byte = ReverseBits<uint8_t>(byte, 8);
+    }
+    if (bit::Read(mode, Crc::ModeRegister::kComplementWrite.position))
+    {
+      byte = static_cast<uint8_t>(~byte);
+    }
+    for (int bit = 7; bit >= 0; bit--)
+    {
+      bool feedback = ((crc & top_bit) != 0) != (((byte >> bit) & 1) != 0);
+      crc           = (crc << 1) & mask;
+      if (feedback)
+      {
+        crc ^= generator;
+      }
+    }
+  }
+
+  if (bit::Read(mode, Crc::ModeRegister::kReverseSum.position))
+  {
+    crc = ReverseBits<uint32_t>(crc, width);
+  }
+  if (bit::Read(mode, Crc::ModeRegister::kComplementSum.position))
+  {
+    crc = ~crc & mask;
+  }
+  return crc;
+}
+
+/// The binary semaphore a DMA transfer waits on
+QueueHandle_t completion_semaphore = nullptr;
+
+QueueHandle_t CreateCompletionSemaphore(UBaseType_t,
+                                        UBaseType_t,
+                                        uint8_t *,
+                                        StaticQueue_t * buffer,
+                                        uint8_t)
+{
+  completion_semaphore = reinterpret_cast<QueueHandle_t>(buffer);
+  return completion_semaphore;
+}
+
+QueueHandle_t CreateMutexStatic(uint8_t, StaticQueue_t * buffer)
+{
+  return reinterpret_cast<QueueHandle_t>(buffer);
+}
+
+BaseType_t CompleteCrcDmaTransfer(QueueHandle_t semaphore, TickType_t)
+{
+  // Taking the engine's mutex never blocks here
+  if (semaphore == completion_semaphore)
+  {
+    // Simulate the first channel finishing while the task is asleep.
+    // This register is read only, thus the cast.
+    *const_cast<volatile uint32_t *>(&Dma::gpdma->IntTCStat) = 0b1;
+    Dma::DmaHandler();
+  }
+  return pdTRUE;
+}
+}  // namespace
+
+TEST_CASE("Testing lpc40xx CRC", "[lpc40xx-crc]")
+{
+  // Simulate local version of LPC_CRC. The SUM register shares its address
+  // with the write registers, so it holds whatever was written last.
+  LPC_CRC_TypeDef local_crc;
+  memset(&local_crc, 0, sizeof(local_crc));
+  Crc::engine = &local_crc;
+
+  Crc test_subject;
+
+  SECTION("Configurations reproduce the software CRCs")
+  {
+    const SoftwareCrc kSoftware;
+    uint8_t data[64];
+    for (size_t i = 0; i < sizeof(data); i++)
+    {
+      data[i] = static_cast<uint8_t>(i * 37 + 11);
+    }
+
+    for (uint8_t i = 0; i < std::size(Crc::kConfigurations); i++)
+    {
+      auto algorithm             = static_cast<sjsu::Crc::Algorithm>(i);
+      const auto & configuration = Crc::kConfigurations[i];
+      CHECK(ModelEngine(configuration, kCheckMessage, sizeof(kCheckMessage)) ==
+            kSoftware.Calculate(algorithm, kCheckMessage,
+                                sizeof(kCheckMessage)));
+      CHECK(ModelEngine(configuration, data, sizeof(data)) ==
+            kSoftware.Calculate(algorithm, data, sizeof(data)));
+    }
+  }
+  SECTION("Calculate programs the mode and seed")
+  {
+    test_subject.Calculate(sjsu::Crc::Algorithm::kCrc32, kCheckMessage, 1);
+
+    CHECK(local_crc.MODE == 0b11'0110);
+    CHECK(local_crc.SEED == 0xFFFF'FFFF);
+
+    test_subject.Calculate(sjsu::Crc::Algorithm::kCrc16Ccitt, kCheckMessage,
+                           1);
+
+    CHECK(local_crc.MODE == 0b00'0000);
+    CHECK(local_crc.SEED == 0x0000);
+  }
+  SECTION("Calculate uses the widest writes the alignment allows")
+  {
+    alignas(4) uint8_t data[8] = { 0x11, 0x22, 0x33, 0x44,
+                                   0x55, 0x66, 0x77, 0x88 };
+
+    // One word, one half word and then one byte. Each write overwrites the
+    // low bits of the previous one.
+    uint32_t result =
+        test_subject.Calculate(sjsu::Crc::Algorithm::kCrc16, data, 7);
+    CHECK(result == 0x4433'6677);
+
+    // A single byte brings the rest of the data onto a word boundary
+    result = test_subject.Calculate(sjsu::Crc::Algorithm::kCrc16, &data[3], 5);
+    CHECK(result == 0x8877'6655);
+  }
+  SECTION("Initialize rejects an engine that disagrees with the software")
+  {
+    CHECK(test_subject.Initialize() == Status::kDeviceNotFound);
+  }
+
+  Crc::engine = LPC_CRC;
+}
+
+TEST_CASE("Testing lpc40xx CRC with DMA", "[lpc40xx-crc]")
+{
+  RESET_FAKE(xTaskGetSchedulerState);
+  RESET_FAKE(ulTaskNotifyTake);
+  RESET_FAKE(xQueueGenericCreateStatic);
+  RESET_FAKE(xQueueCreateMutexStatic);
+  RESET_FAKE(xQueueGiveFromISR);
+  RESET_FAKE(xQueueGenericSend);
+  RESET_FAKE(xQueueSemaphoreTake);
+  completion_semaphore                       = nullptr;
+  xQueueGenericCreateStatic_fake.custom_fake = CreateCompletionSemaphore;
+  xQueueCreateMutexStatic_fake.custom_fake   = CreateMutexStatic;
+
+  // Simulate local version of the CRC and GPDMA registers
+  LPC_CRC_TypeDef local_crc;
+  LPC_GPDMA_TypeDef local_gpdma;
+  LPC_GPDMACH_TypeDef local_channels[Dma::kNumberOfChannels];
+  memset(&local_crc, 0, sizeof(local_crc));
+  memset(&local_gpdma, 0, sizeof(local_gpdma));
+  memset(&local_channels, 0, sizeof(local_channels));
+
+  Crc::engine = &local_crc;
+  Dma::gpdma  = &local_gpdma;
+  for (uint8_t i = 0; i < Dma::kNumberOfChannels; i++)
+  {
+    Dma::channels[i] = &local_channels[i];
+  }
+  Dma::allocated_channels = 0;
+
+  Mock<sjsu::SystemController> mock_system_controller;
+  Fake(Method(mock_system_controller, PowerUpPeripheral));
+  Mock<sjsu::InterruptController> mock_interrupt_controller;
+  Fake(Method(mock_interrupt_controller, Register));
+
+  Dma dma(mock_system_controller.get(), mock_interrupt_controller.get());
+  Crc test_subject;
+  REQUIRE(test_subject.EnableDma(dma) == Status::kSuccess);
+
+  constexpr uint8_t kChannel    = 0;
+  const uint32_t kWriteRegister = static_cast<uint32_t>(
+      reinterpret_cast<uintptr_t>(&local_crc.WR_DATA_DWORD.DATA));
+  alignas(4) uint8_t buffer[520] = { 0 };
+
+  SECTION("Short buffers do not use DMA")
+  {
+    test_subject.Calculate(sjsu::Crc::Algorithm::kCrc16Ccitt, buffer,
+                           Crc::kDmaThreshold - 1);
+
+    CHECK(local_channels[kChannel].CConfig == 0);
+  }
+  SECTION("Block before the scheduler starts")
+  {
+    // Starts 3 bytes before a word boundary and ends 1 byte after one
+    const uint8_t * start = &buffer[1];
+
+    test_subject.Calculate(sjsu::Crc::Algorithm::kCrc16Ccitt, start, 512);
+
+    CHECK(local_channels[kChannel].CSrcAddr ==
+          static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&buffer[4])));
+    CHECK(local_channels[kChannel].CDestAddr == kWriteRegister);
+    uint32_t control = local_channels[kChannel].CControl;
+    CHECK(bit::Extract(control, Dma::Control::kTransferSize) == 127);
+    CHECK(bit::Extract(control, Dma::Control::kSourceWidth) ==
+          util::Value(Dma::Width::kWord));
+    CHECK(bit::Read(control, Dma::Control::kSourceIncrement.position));
+    CHECK(!bit::Read(control, Dma::Control::kDestinationIncrement.position));
+    CHECK(bit::Extract(local_channels[kChannel].CConfig,
+                       Dma::ChannelConfig::kTransferType) ==
+          util::Value(Dma::TransferType::kMemoryToMemory));
+    // The last byte is written by the CPU after the transfer
+    CHECK(local_crc.WR_DATA_BYTE.DATA == buffer[512]);
+    // Nothing may be created or locked before the scheduler starts
+    CHECK(xQueueGenericCreateStatic_fake.call_count == 0);
+    CHECK(xQueueCreateMutexStatic_fake.call_count == 0);
+    CHECK(xQueueSemaphoreTake_fake.call_count == 0);
+  }
+  SECTION("Block sleeps until the DMA completes")
+  {
+    xTaskGetSchedulerState_fake.return_val = taskSCHEDULER_RUNNING;
+    xQueueSemaphoreTake_fake.custom_fake   = CompleteCrcDmaTransfer;
+
+    test_subject.Calculate(sjsu::Crc::Algorithm::kCrc32, buffer, 512);
+
+    CHECK(bit::Extract(local_channels[kChannel].CControl,
+                       Dma::Control::kTransferSize) == 128);
+    // The engine's mutex is held around the calculation
+    REQUIRE(xQueueSemaphoreTake_fake.call_count == 2);
+    QueueHandle_t mutex = xQueueSemaphoreTake_fake.arg0_history[0];
+    CHECK(mutex != nullptr);
+    CHECK(mutex != completion_semaphore);
+    CHECK(xQueueGenericSend_fake.call_count == 1);
+    CHECK(xQueueGenericSend_fake.arg0_val == mutex);
+    // The transfer waits on a semaphore of its own, not the task's
+    // notification
+    CHECK(xQueueSemaphoreTake_fake.arg0_history[1] == completion_semaphore);
+    CHECK(xQueueGiveFromISR_fake.call_count == 1);
+    CHECK(xQueueGiveFromISR_fake.arg0_val == completion_semaphore);
+    CHECK(completion_semaphore != nullptr);
+    CHECK(ulTaskNotifyTake_fake.call_count == 0);
+  }
+
+  RESET_FAKE(xTaskGetSchedulerState);
+  RESET_FAKE(xQueueGenericCreateStatic);
+  RESET_FAKE(xQueueCreateMutexStatic);
+  RESET_FAKE(xQueueSemaphoreTake);
+  Crc::engine             = LPC_CRC;
+  Dma::allocated_channels = 0;
+  Dma::gpdma              = LPC_GPDMA;
+  Dma::channels[0]        = LPC_GPDMACH0;
+  Dma::channels[1]        = LPC_GPDMACH1;
+  Dma::channels[2]        = LPC_GPDMACH2;
+  Dma::channels[3]        = LPC_GPDMACH3;
+  Dma::channels[4]        = LPC_GPDMACH4;
+  Dma::channels[5]        = LPC_GPDMACH5;
+  Dma::channels[6]        = LPC_GPDMACH6;
+  Dma::channels[7]        = LPC_GPDMACH7;
+}
+}  // namespace sjsu::lpc40xx
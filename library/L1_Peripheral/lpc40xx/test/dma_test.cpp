@@ -0,0 +1,280 @@
+#include <cstdint>
+#include <cstring>
+
+#include "L0_Platform/lpc40xx/LPC40xx.h"
+#include "L1_Peripheral/lpc40xx/dma.hpp"
+#include "L4_Testing/testing_frameworks.hpp"
+
+namespace sjsu::lpc40xx
+{
+namespace
+{
+struct HandlerResult_t
+{
+  int calls     = 0;
+  Status status = Status::kNotReadyYet;
+};
+
+void RecordCompletion(Status status, void * context)
+{
+  auto * result = static_cast<HandlerResult_t *>(context);
+  result->calls++;
+  result->status = status;
+}
+}  // namespace
+
+TEST_CASE("Testing lpc40xx GPDMA", "[lpc40xx-dma]")
+{
+  // Simulate local version of the GPDMA controller and channels
+  LPC_GPDMA_TypeDef local_gpdma;
+  LPC_GPDMACH_TypeDef local_channels[Dma::kNumberOfChannels];
+  LPC_SC_TypeDef local_sc;
+  memset(&local_gpdma, 0, sizeof(local_gpdma));
+  memset(&local_channels, 0, sizeof(local_channels));
+  memset(&local_sc, 0, sizeof(local_sc));
+
+  Dma::gpdma = &local_gpdma;
+  for (uint8_t i = 0; i < Dma::kNumberOfChannels; i++)
+  {
+    Dma::channels[i] = &local_channels[i];
+  }
+  Dma::allocated_channels             = 0;
+  SystemController::system_controller = &local_sc;
+
+  Mock<sjsu::SystemController> mock_system_controller;
+  Fake(Method(mock_system_controller, PowerUpPeripheral));
+
+  Mock<sjsu::InterruptController> mock_interrupt_controller;
+  Fake(Method(mock_interrupt_controller, Register));
+  Fake(Method(mock_interrupt_controller, Deregister));
+
+  Dma test_subject(mock_system_controller.get(),
+                   mock_interrupt_controller.get());
+
+  SECTION("Initialize")
+  {
+    test_subject.Initialize();
+
+    Verify(Method(mock_system_controller, PowerUpPeripheral)
+               .Matching([](sjsu::SystemController::PeripheralID id) {
+                 return SystemController::Peripherals::kGpdma.device_id ==
+                        id.device_id;
+               }));
+    Verify(
+        Method(mock_interrupt_controller, Register)
+            .Matching([](sjsu::InterruptController::RegistrationInfo_t info) {
+              return info.interrupt_request_number == DMA_IRQn &&
+                     info.interrupt_service_routine == Dma::DmaHandler &&
+                     info.priority == Dma::kInterruptPriority;
+            }));
+    CHECK(local_gpdma.Config == 0b01);
+  }
+  SECTION("Allocate and release channels")
+  {
+    // Channels should be handed out from highest to lowest priority
+    for (uint8_t i = 0; i < Dma::kNumberOfChannels; i++)
+    {
+      CHECK(test_subject.AllocateChannel() == i);
+    }
+    CHECK(test_subject.AllocateChannel() == Dma::kInvalidChannel);
+
+    test_subject.ReleaseChannel(3);
+    CHECK(test_subject.AllocateChannel() == 3);
+  }
+  SECTION("Start memory to memory transfer")
+  {
+    uint8_t source[16]      = { 0 };
+    uint8_t destination[16] = { 0 };
+    uint8_t channel         = test_subject.AllocateChannel();
+
+    Dma::Transfer_t transfer = {
+      .type        = Dma::TransferType::kMemoryToMemory,
+      .source      = source,
+      .destination = destination,
+      .length      = sizeof(source),
+      .width       = Dma::Width::kByte,
+      .burst       = Dma::Burst::k4,
+    };
+
+    Status status = test_subject.Start(channel, transfer);
+
+    CHECK(status == Status::kSuccess);
+    CHECK(local_channels[channel].CSrcAddr ==
+          static_cast<uint32_t>(reinterpret_cast<uintptr_t>(source)));
+    CHECK(local_channels[channel].CDestAddr ==
+          static_cast<uint32_t>(reinterpret_cast<uintptr_t>(destination)));
+    CHECK(local_channels[channel].CLLI == 0);
+    // Source "UM10562 LPC408x/407x User manual" table 707 page 883
+    uint32_t control = local_channels[channel].CControl;
+    CHECK(bit::Extract(control, Dma::Control::kTransferSize) == 16);
+    CHECK(bit::Extract(control, Dma::Control::kSourceBurst) == 0b001);
+    CHECK(bit::Extract(control, Dma::Control::kDestinationBurst) == 0b001);
+    CHECK(bit::Extract(control, Dma::Control::kSourceWidth) == 0);
+    CHECK(bit::Extract(control, Dma::Control::kDestinationWidth) == 0);
+    CHECK(bit::Read(control, Dma::Control::kSourceIncrement.position));
+    CHECK(bit::Read(control, Dma::Control::kDestinationIncrement.position));
+    CHECK(bit::Read(control, Dma::Control::kTerminalCountInterrupt.position));
+    // Source "UM10562 LPC408x/407x User manual" table 708 page 885
+    uint32_t config = local_channels[channel].CConfig;
+    CHECK(bit::Read(config, Dma::ChannelConfig::kEnable.position));
+    CHECK(bit::Extract(config, Dma::ChannelConfig::kTransferType) == 0b000);
+    CHECK(bit::Read(config,
+                    Dma::ChannelConfig::kTerminalCountInterruptMask.position));
+    CHECK(bit::Read(config, Dma::ChannelConfig::kErrorInterruptMask.position));
+    // No peripheral should have been selected
+    CHECK(local_sc.DMAREQSEL == 0);
+  }
+  SECTION("Halt a transfer and see how far it got")
+  {
+    uint8_t source[16]      = { 0 };
+    uint8_t destination[16] = { 0 };
+    uint8_t channel         = test_subject.AllocateChannel();
+    REQUIRE(test_subject.Start(channel, {
+                                            .source      = source,
+                                            .destination = destination,
+                                            .length      = sizeof(source),
+                                        }) == Status::kSuccess);
+    // Simulate the channel getting through 6 bytes
+    local_channels[channel].CControl = bit::Insert(
+        local_channels[channel].CControl, 10, Dma::Control::kTransferSize);
+
+    test_subject.Halt(channel);
+
+    uint32_t config = local_channels[channel].CConfig;
+    CHECK(!bit::Read(config, Dma::ChannelConfig::kEnable.position));
+    CHECK(!bit::Read(config, Dma::ChannelConfig::kHalt.position));
+    CHECK(test_subject.GetRemainingLength(channel) == 10);
+  }
+  SECTION("Start memory to peripheral transfer")
+  {
+    uint8_t source[8] = { 0 };
+    uint32_t data_register;
+    uint8_t channel = test_subject.AllocateChannel();
+
+    Dma::Transfer_t transfer = {
+      .type                  = Dma::TransferType::kMemoryToPeripheral,
+      .source                = source,
+      .destination           = &data_register,
+      .length                = sizeof(source),
+      .increment_destination = false,
+      .destination_request   = Dma::Request::kUart4Tx,
+    };
+
+    Status status = test_subject.Start(channel, transfer);
+
+    CHECK(status == Status::kSuccess);
+    uint32_t config = local_channels[channel].CConfig;
+    CHECK(bit::Extract(config, Dma::ChannelConfig::kTransferType) == 0b001);
+    CHECK(bit::Extract(config, Dma::ChannelConfig::kDestinationPeripheral) ==
+          Dma::Request::kUart4Tx.line);
+    CHECK(!bit::Read(local_channels[channel].CControl,
+                     Dma::Control::kDestinationIncrement.position));
+    // UART4 Tx shares request line 12 with UART1 Tx and must be selected
+    CHECK(local_sc.DMAREQSEL == (1 << 12));
+  }
+  SECTION("Start rejects invalid transfers")
+  {
+    uint8_t buffer[4];
+    Dma::Transfer_t transfer = {
+      .source      = buffer,
+      .destination = buffer,
+      .length      = sizeof(buffer),
+    };
+    // Channel has not been allocated
+    CHECK(test_subject.Start(0, transfer) == Status::kInvalidParameters);
+
+    uint8_t channel = test_subject.AllocateChannel();
+    // Channel is still running a previous transfer.
+    // This register is read only, thus the cast.
+    *const_cast<volatile uint32_t *>(&local_gpdma.EnbldChns) = (1 << channel);
+    CHECK(test_subject.Start(channel, transfer) == Status::kNotReadyYet);
+
+    // Transfer is too large for a single descriptor
+    transfer.length = Dma::kMaxTransferSize + 1;
+    CHECK(test_subject.Start(channel, transfer) == Status::kInvalidParameters);
+  }
+  SECTION("Scatter gather linked list")
+  {
+    uint8_t source_a[4], source_b[4], source_c[4];
+    uint8_t destination[12];
+    uint8_t channel = test_subject.AllocateChannel();
+
+    Dma::LinkedListItem_t lli[2];
+    lli[1] = Dma::CreateLinkedListItem({
+        .source      = source_c,
+        .destination = &destination[8],
+        .length      = 4,
+    });
+    lli[0] = Dma::CreateLinkedListItem({
+        .source      = source_b,
+        .destination = &destination[4],
+        .length      = 4,
+        .next        = &lli[1],
+    });
+
+    // Only the last item in the chain should raise an interrupt
+    CHECK(!bit::Read(lli[0].control,
+                     Dma::Control::kTerminalCountInterrupt.position));
+    CHECK(bit::Read(lli[1].control,
+                    Dma::Control::kTerminalCountInterrupt.position));
+    CHECK(lli[0].next == reinterpret_cast<uintptr_t>(&lli[1]));
+    CHECK(lli[1].next == 0);
+    CHECK(lli[1].source == reinterpret_cast<uintptr_t>(source_c));
+
+    Dma::Transfer_t transfer = {
+      .source      = source_a,
+      .destination = destination,
+      .length      = 4,
+      .next        = &lli[0],
+    };
+    test_subject.Start(channel, transfer);
+
+    CHECK(local_channels[channel].CLLI ==
+          static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&lli[0])));
+    CHECK(!bit::Read(local_channels[channel].CControl,
+                     Dma::Control::kTerminalCountInterrupt.position));
+  }
+  SECTION("Completion handler")
+  {
+    uint8_t buffer[4];
+    HandlerResult_t result_a;
+    HandlerResult_t result_b;
+    uint8_t channel_a = test_subject.AllocateChannel();
+    uint8_t channel_b = test_subject.AllocateChannel();
+    Dma::Transfer_t transfer = {
+      .source      = buffer,
+      .destination = buffer,
+      .length      = sizeof(buffer),
+    };
+    test_subject.Start(channel_a, transfer, RecordCompletion, &result_a);
+    test_subject.Start(channel_b, transfer, RecordCompletion, &result_b);
+
+    // Simulate channel A finishing and channel B reporting a bus error.
+    // These registers are read only, thus the cast.
+    using Register = volatile uint32_t;
+    *const_cast<Register *>(&local_gpdma.IntTCStat)  = (1 << channel_a);
+    *const_cast<Register *>(&local_gpdma.IntErrStat) = (1 << channel_b);
+
+    Dma::DmaHandler();
+
+    CHECK(result_a.calls == 1);
+    CHECK(result_a.status == Status::kSuccess);
+    CHECK(result_b.calls == 1);
+    CHECK(result_b.status == Status::kBusError);
+    CHECK(local_gpdma.IntTCClear == (1 << channel_a));
+    CHECK(local_gpdma.IntErrClr == (1 << channel_b));
+  }
+
+  Dma::allocated_channels = 0;
+  Dma::gpdma              = LPC_GPDMA;
+  Dma::channels[0]        = LPC_GPDMACH0;
+  Dma::channels[1]        = LPC_GPDMACH1;
+  Dma::channels[2]        = LPC_GPDMACH2;
+  Dma::channels[3]        = LPC_GPDMACH3;
+  Dma::channels[4]        = LPC_GPDMACH4;
+  Dma::channels[5]        = LPC_GPDMACH5;
+  Dma::channels[6]        = LPC_GPDMACH6;
+  Dma::channels[7]        = LPC_GPDMACH7;
+  sjsu::lpc40xx::SystemController::system_controller = LPC_SC;
+}
+}  // namespace sjsu::lpc40xx
@@ -1,15 +1,40 @@
+#include <chrono>
 #include <cstdint>
+#include <vector>
+
 #include "L1_Peripheral/cortex/interrupt.hpp"
 #include "L0_Platform/lpc40xx/LPC40xx.h"
 #include "L1_Peripheral/lpc40xx/i2c.hpp"
 #include "L4_Testing/testing_frameworks.hpp"
 #include "utility/enum.hpp"
 #include "utility/status.hpp"
+#include "utility/time.hpp"
 
 namespace sjsu::lpc40xx
 {
 EMIT_ALL_METHODS(I2c);
 
+namespace
+{
+constexpr bool SclCountsEqual(I2c::SclCounts_t counts,
+                              uint16_t high,
+                              uint16_t low)
+{
+  return counts.high == high && counts.low == low;
+}
+
+// SJTwo's 48 MHz peripheral clock, with SCL high for 40% of the period
+static_assert(SclCountsEqual(
+    I2c::CalculateSclCounts(48_MHz, I2c::kStandardMode, 40), 192, 288));
+static_assert(SclCountsEqual(
+    I2c::CalculateSclCounts(48_MHz, I2c::kFastMode, 40), 48, 72));
+static_assert(SclCountsEqual(
+    I2c::CalculateSclCounts(48_MHz, I2c::kFastModePlus, 40), 19, 29));
+// The period is rounded up, so 48 MHz / 130 kHz = 369.2 becomes 370
+static_assert(SclCountsEqual(
+    I2c::CalculateSclCounts(48_MHz, 130_kHz, 50), 185, 185));
+}  // namespace
+
 TEST_CASE("Testing lpc40xx I2C", "[lpc40xx-i2c]")
 {
   // Dummy address used by test sections
@@ -65,6 +90,7 @@ TEST_CASE("Testing lpc40xx I2C", "[lpc40xx-i2c]")
 
   I2c test_subject(
       kMockI2c, mock_system_controller.get(), mock_interrupt_controller.get());
+  REQUIRE(test_subject.SetClock(I2c::kFastMode) == Status::kSuccess);
 
   SECTION("Initialize")
   {
@@ -74,14 +100,9 @@ TEST_CASE("Testing lpc40xx I2C", "[lpc40xx-i2c]")
         I2c::Control::kStop | I2c::Control::kInterrupt;
     test_subject.Initialize();
 
-    constexpr float kSystemFrequency =
-        kDummySystemControllerClockFrequency.to<uint32_t>();
-
-    constexpr float kScll = ((kSystemFrequency / 75'000.0f) / 2.0f) * 0.7f;
-    constexpr float kSclh = ((kSystemFrequency / 75'000.0f) / 2.0f) * 1.3f;
-
-    constexpr uint32_t kLow  = static_cast<uint32_t>(kScll);
-    constexpr uint32_t kHigh = static_cast<uint32_t>(kSclh);
+    // 12 MHz / 400 kHz = 30 cycles, 40% of which are spent high
+    constexpr uint32_t kLow  = 18;
+    constexpr uint32_t kHigh = 12;
 
     Verify(Method(mock_system_controller, PowerUpPeripheral)
                .Matching([](sjsu::SystemController::PeripheralID id) {
@@ -101,7 +122,8 @@ TEST_CASE("Testing lpc40xx I2C", "[lpc40xx-i2c]")
               return (info.interrupt_request_number ==
                       kMockI2c.bus.irq_number) &&
                      (info.interrupt_service_routine == kMockI2c.handler) &&
-                     (info.enable_interrupt == true) && (info.priority == -1);
+                     (info.enable_interrupt == true) &&
+                     (info.priority == I2c::kInterruptPriority);
             }));
 
     Verify(Method(mock_sda_pin, SetPinFunction)
@@ -487,4 +509,513 @@ TEST_CASE("Testing lpc40xx I2C", "[lpc40xx-i2c]")
 
   sjsu::lpc40xx::SystemController::system_controller = LPC_SC;
 }
+
+TEST_CASE("Testing lpc40xx I2C clock", "[lpc40xx-i2c]")
+{
+  constexpr uint8_t kAddress = 0x33;
+  constexpr units::frequency::hertz_t kPeripheralFrequency = 12_MHz;
+  // The bus below is made once, so everything it refers to must outlive
+  // each run through the sections.
+  static LPC_I2C_TypeDef local_i2c;
+  static Mock<sjsu::Pin> mock_pin;
+  memset(&local_i2c, 0, sizeof(local_i2c));
+  Fake(Method(mock_pin, SetPinFunction),
+       Method(mock_pin, SetAsOpenDrain),
+       Method(mock_pin, SetPull));
+
+  Mock<sjsu::SystemController> mock_system_controller;
+  Fake(Method(mock_system_controller, PowerUpPeripheral));
+  When(Method(mock_system_controller, GetSystemFrequency))
+      .AlwaysReturn(kPeripheralFrequency);
+  When(Method(mock_system_controller, GetPeripheralClockDivider))
+      .AlwaysReturn(1);
+  Mock<sjsu::InterruptController> mock_interrupt_controller;
+  Fake(Method(mock_interrupt_controller, Register));
+
+  static I2c::Transaction_t transaction;
+  static const I2c::PartialBus_t kPartial = {
+    .registers           = &local_i2c,
+    .peripheral_power_id = sjsu::lpc40xx::SystemController::Peripherals::kI2c2,
+    .irq_number          = I2C2_IRQn,
+    .transaction         = transaction,
+    .sda_pin             = mock_pin.get(),
+    .scl_pin             = mock_pin.get(),
+    .pin_function_id     = 0b010,
+  };
+  const I2c::Bus_t kI2c = {
+    .bus     = kPartial,
+    .handler = I2c::I2cHandler<kPartial>,
+  };
+  I2c test_subject(kI2c, mock_system_controller.get(),
+                   mock_interrupt_controller.get());
+  REQUIRE(test_subject.SetClock(I2c::kFastMode) == Status::kSuccess);
+
+  SECTION("Initialize starts out at the configured clock rate")
+  {
+    I2c fresh_subject(kI2c,
+                      mock_system_controller.get(),
+                      mock_interrupt_controller.get());
+
+    CHECK(fresh_subject.Initialize() == Status::kSuccess);
+
+    constexpr I2c::SclCounts_t kExpected = I2c::CalculateSclCounts(
+        kPeripheralFrequency, config::kI2cClockRate,
+        I2c::kDefaultDutyCycle);
+    CHECK(fresh_subject.GetClock() == config::kI2cClockRate);
+    CHECK(local_i2c.SCLH == kExpected.high);
+    CHECK(local_i2c.SCLL == kExpected.low);
+  }
+  SECTION("SetClock")
+  {
+    struct Clock_t
+    {
+      units::frequency::hertz_t frequency;
+      uint8_t duty_cycle;
+      uint32_t high;
+      uint32_t low;
+    };
+    const Clock_t kClocks[] = {
+      { I2c::kStandardMode, 40, 48, 72 },
+      { I2c::kFastMode, 40, 12, 18 },
+      { I2c::kFastModePlus, 40, 5, 7 },
+      { I2c::kStandardMode, 50, 60, 60 },
+    };
+    for (const auto & clock : kClocks)
+    {
+      INFO("frequency " << clock.frequency.to<uint32_t>());
+      CHECK(test_subject.SetClock(clock.frequency, clock.duty_cycle) ==
+            Status::kSuccess);
+      CHECK(test_subject.Initialize() == Status::kSuccess);
+      CHECK(test_subject.GetClock() == clock.frequency);
+      CHECK(local_i2c.SCLH == clock.high);
+      CHECK(local_i2c.SCLL == clock.low);
+    }
+
+    // Faster than fast mode plus, slower than the counts can hold, too few
+    // cycles to spend high or low, and duty cycles that leave no high or low.
+    CHECK(test_subject.SetClock(0_Hz) == Status::kInvalidParameters);
+    CHECK(test_subject.SetClock(2_MHz) == Status::kInvalidParameters);
+    CHECK(test_subject.SetClock(50_Hz) == Status::kInvalidParameters);
+    CHECK(test_subject.SetClock(I2c::kFastModePlus, 20) ==
+          Status::kInvalidParameters);
+    CHECK(test_subject.SetClock(I2c::kStandardMode, 0) ==
+          Status::kInvalidParameters);
+    CHECK(test_subject.SetClock(I2c::kStandardMode, 100) ==
+          Status::kInvalidParameters);
+    // The last good clock is kept
+    CHECK(test_subject.GetClock() == I2c::kStandardMode);
+  }
+  SECTION("Transactions slow down to their max_frequency")
+  {
+    uint8_t read_buffer[2];
+    I2c::Transaction_t read_transaction = {
+      .operation = I2c::Operation::kRead,
+      .address   = kAddress,
+      .data_in   = read_buffer,
+      .in_length = sizeof(read_buffer),
+    };
+
+    // No limit, so the bus clock is used
+    test_subject.Transaction(read_transaction);
+    CHECK(local_i2c.SCLH == 12);
+    CHECK(local_i2c.SCLL == 18);
+
+    read_transaction.max_frequency = I2c::kStandardMode;
+    test_subject.Transaction(read_transaction);
+    CHECK(local_i2c.SCLH == 48);
+    CHECK(local_i2c.SCLL == 72);
+
+    // Devices faster than the bus run at the bus clock
+    read_transaction.max_frequency = I2c::kFastModePlus;
+    test_subject.Transaction(read_transaction);
+    CHECK(local_i2c.SCLH == 12);
+    CHECK(local_i2c.SCLL == 18);
+
+    local_i2c.CONSET               = 0;
+    read_transaction.max_frequency = 50_Hz;
+    CHECK(test_subject.Transaction(read_transaction) ==
+          Status::kInvalidParameters);
+    CHECK(local_i2c.CONSET == 0);
+  }
+}
+
+namespace
+{
+/// A bus event the I2C interrupt handles: the state it reports, and the byte
+/// in its data register
+struct BusEvent_t
+{
+  I2c::MasterState state;
+  uint8_t data;
+};
+
+LPC_I2C_TypeDef * queued_registers = nullptr;
+IsrPointer queued_handler          = nullptr;
+/// Events that happen on the bus while the task sleeps
+std::vector<BusEvent_t> bus_events;
+/// Address of each transaction that completed, in order
+std::vector<uint8_t> completed_addresses;
+std::vector<Status> completed_statuses;
+
+void RunEvent(const BusEvent_t & event)
+{
+  queued_registers->STAT   = util::Value(event.state);
+  queued_registers->DAT    = event.data;
+  queued_registers->CONSET = 0;
+  queued_registers->CONCLR = 0;
+  queued_handler();
+}
+
+/// Gives each semaphore a handle of its own, so that the tests can tell which
+/// one is given and taken.
+QueueHandle_t CreateSemaphore(UBaseType_t,
+                              UBaseType_t,
+                              uint8_t *,
+                              StaticQueue_t * buffer,
+                              uint8_t)
+{
+  return reinterpret_cast<QueueHandle_t>(buffer);
+}
+
+BaseType_t RunBusWhileAsleep(QueueHandle_t, TickType_t)
+{
+  if (bus_events.empty())
+  {
+    return pdFALSE;
+  }
+  for (const auto & event : bus_events)
+  {
+    RunEvent(event);
+  }
+  bus_events.clear();
+  return pdTRUE;
+}
+
+/// Stands in for the uptime while a transaction is polled. Each reading moves
+/// the bus on to its next event and raises SI, as the hardware does between
+/// two polls.
+std::chrono::microseconds AdvanceBus()
+{
+  static std::chrono::microseconds now = 0us;
+  if (!bus_events.empty() &&
+      !(queued_registers->CONSET & I2c::Control::kInterrupt))
+  {
+    queued_registers->STAT = util::Value(bus_events.front().state);
+    queued_registers->DAT  = bus_events.front().data;
+    queued_registers->CONSET |= I2c::Control::kInterrupt;
+    bus_events.erase(bus_events.begin());
+  }
+  now += 1ms;
+  return now;
+}
+
+void RecordCompletion(const I2c::Transaction_t & transaction, void * context)
+{
+  completed_addresses.push_back(transaction.address);
+  completed_statuses.push_back(transaction.status);
+  if (context != nullptr)
+  {
+    *static_cast<int *>(context) += 1;
+  }
+}
+}  // namespace
+
+TEST_CASE("Testing lpc40xx I2C transaction queue", "[lpc40xx-i2c]")
+{
+  RESET_FAKE(xTaskGetSchedulerState);
+  RESET_FAKE(ulTaskNotifyTake);
+  RESET_FAKE(xQueueGenericCreateStatic);
+  RESET_FAKE(xQueueGiveFromISR);
+  RESET_FAKE(xQueueSemaphoreTake);
+  xQueueGenericCreateStatic_fake.custom_fake = CreateSemaphore;
+  bus_events.clear();
+  completed_addresses.clear();
+  completed_statuses.clear();
+
+  LPC_I2C_TypeDef local_i2c;
+  memset(&local_i2c, 0, sizeof(local_i2c));
+
+  Mock<sjsu::SystemController> mock_system_controller;
+  When(Method(mock_system_controller, GetSystemFrequency))
+      .AlwaysReturn(12_MHz);
+  When(Method(mock_system_controller, GetPeripheralClockDivider))
+      .AlwaysReturn(1);
+  Mock<sjsu::Pin> mock_pin;
+  Mock<sjsu::InterruptController> mock_interrupt_controller;
+
+  static I2c::Transaction_t transaction;
+  static I2c::TransactionQueue_t queue;
+  transaction = {};
+  queue       = {};
+  static const I2c::PartialBus_t kQueuedPartial = {
+    .registers           = &local_i2c,
+    .peripheral_power_id = sjsu::lpc40xx::SystemController::Peripherals::kI2c1,
+    .irq_number          = I2C1_IRQn,
+    .transaction         = transaction,
+    .sda_pin             = mock_pin.get(),
+    .scl_pin             = mock_pin.get(),
+    .pin_function_id     = 0b011,
+    .queue               = &queue,
+  };
+  const I2c::Bus_t kQueuedI2c = {
+    .bus     = kQueuedPartial,
+    .handler = I2c::I2cHandler<kQueuedPartial>,
+  };
+  queued_registers = &local_i2c;
+  queued_handler   = kQueuedI2c.handler;
+
+  I2c test_subject(kQueuedI2c, mock_system_controller.get(),
+                   mock_interrupt_controller.get());
+  REQUIRE(test_subject.SetClock(I2c::kFastModePlus) == Status::kSuccess);
+
+  constexpr uint8_t kFirstAddress  = 0x10;
+  constexpr uint8_t kSecondAddress = 0x20;
+  const uint8_t kWriteData[]       = { 0xA5 };
+  uint8_t read_buffer[1]           = { 0 };
+  I2c::Transaction_t write_transaction = {
+    .operation  = I2c::Operation::kWrite,
+    .address    = kFirstAddress,
+    .data_out   = kWriteData,
+    .out_length = sizeof(kWriteData),
+  };
+  I2c::Transaction_t read_transaction = {
+    .operation = I2c::Operation::kRead,
+    .address   = kSecondAddress,
+    .data_in   = read_buffer,
+    .in_length = sizeof(read_buffer),
+  };
+  // Events for a one byte write, then a one byte read, that are acknowledged
+  const std::vector<BusEvent_t> kWriteEvents = {
+    { I2c::MasterState::kStartCondition, 0 },
+    { I2c::MasterState::kSlaveAddressWriteSentRecievedAck, 0 },
+    { I2c::MasterState::kTransmittedDataRecievedAck, 0 },
+  };
+  const std::vector<BusEvent_t> kReadEvents = {
+    { I2c::MasterState::kStartCondition, 0 },
+    { I2c::MasterState::kSlaveAddressReadSentRecievedAck, 0 },
+    { I2c::MasterState::kRecievedDataRecievedNack, 0x5A },
+  };
+
+  SECTION("Enqueue starts an idle bus")
+  {
+    int completions = 0;
+
+    CHECK(test_subject.Enqueue(write_transaction, RecordCompletion,
+                               &completions) == Status::kSuccess);
+
+    CHECK(local_i2c.CONSET == I2c::Control::kStart);
+    CHECK(queue.count == 1);
+    CHECK(test_subject.GetTransactionInfo().address == kFirstAddress);
+    CHECK(test_subject.GetTransactionInfo().busy);
+    CHECK(completions == 0);
+  }
+  SECTION("Queued transactions run back to back")
+  {
+    int completions = 0;
+    REQUIRE(test_subject.Enqueue(write_transaction, RecordCompletion,
+                                 &completions) == Status::kSuccess);
+    local_i2c.CONSET = 0;
+    REQUIRE(test_subject.Enqueue(read_transaction, RecordCompletion,
+                                 &completions) == Status::kSuccess);
+    // The bus is busy with the first transaction, so the second must wait
+    CHECK(local_i2c.CONSET == 0);
+    CHECK(queue.count == 2);
+
+    RunEvent(kWriteEvents[0]);
+    CHECK(local_i2c.DAT == kFirstAddress << 1);
+    RunEvent(kWriteEvents[1]);
+    CHECK(local_i2c.DAT == kWriteData[0]);
+    RunEvent(kWriteEvents[2]);
+
+    // The stop is sent along with the start of the next transaction
+    CHECK(completed_addresses == std::vector<uint8_t>{ kFirstAddress });
+    CHECK(completed_statuses == std::vector<Status>{ Status::kSuccess });
+    CHECK_BITS(I2c::Control::kStop, local_i2c.CONSET);
+    CHECK_BITS(I2c::Control::kStart, local_i2c.CONSET);
+    CHECK(!(local_i2c.CONCLR & I2c::Control::kStart));
+    CHECK(queue.count == 1);
+    CHECK(test_subject.GetTransactionInfo().address == kSecondAddress);
+
+    for (const auto & event : kReadEvents)
+    {
+      RunEvent(event);
+    }
+
+    CHECK(read_buffer[0] == 0x5A);
+    CHECK(completed_addresses ==
+          std::vector<uint8_t>{ kFirstAddress, kSecondAddress });
+    CHECK(completions == 2);
+    CHECK_BITS(I2c::Control::kStop, local_i2c.CONSET);
+    CHECK(!(local_i2c.CONSET & I2c::Control::kStart));
+    CHECK(queue.count == 0);
+  }
+  SECTION("Each queued transaction runs at its own speed")
+  {
+    write_transaction.max_frequency = I2c::kStandardMode;
+    REQUIRE(test_subject.Enqueue(write_transaction, RecordCompletion) ==
+            Status::kSuccess);
+    REQUIRE(test_subject.Enqueue(read_transaction, RecordCompletion) ==
+            Status::kSuccess);
+
+    // 12 MHz / 100 kHz = 120 cycles, for the write's slower device
+    CHECK(local_i2c.SCLH == 48);
+    CHECK(local_i2c.SCLL == 72);
+
+    for (const auto & event : kWriteEvents)
+    {
+      RunEvent(event);
+    }
+
+    // The read runs at the 1 MHz bus clock, which is 12 cycles
+    CHECK(test_subject.GetTransactionInfo().address == kSecondAddress);
+    CHECK(local_i2c.SCLH == 5);
+    CHECK(local_i2c.SCLL == 7);
+
+    write_transaction.max_frequency = 50_Hz;
+    CHECK(test_subject.Enqueue(write_transaction, RecordCompletion) ==
+          Status::kInvalidParameters);
+    CHECK(queue.count == 1);
+  }
+  SECTION("Failed transactions report their status")
+  {
+    REQUIRE(test_subject.Enqueue(write_transaction, RecordCompletion) ==
+            Status::kSuccess);
+
+    RunEvent({ I2c::MasterState::kStartCondition, 0 });
+    RunEvent({ I2c::MasterState::kSlaveAddressWriteSentRecievedNack, 0 });
+
+    CHECK(completed_statuses == std::vector<Status>{ Status::kDeviceNotFound });
+    CHECK(queue.count == 0);
+  }
+  SECTION("A full queue turns transactions away")
+  {
+    for (size_t i = 0; i < config::kI2cQueueDepth; i++)
+    {
+      CHECK(test_subject.Enqueue(write_transaction, RecordCompletion) ==
+            Status::kSuccess);
+    }
+    CHECK(test_subject.Enqueue(write_transaction, RecordCompletion) ==
+          Status::kNotReadyYet);
+    CHECK(queue.count == config::kI2cQueueDepth);
+  }
+  SECTION("Blocking transactions sleep until the interrupt finishes them")
+  {
+    xTaskGetSchedulerState_fake.return_val = taskSCHEDULER_RUNNING;
+    xQueueSemaphoreTake_fake.custom_fake   = RunBusWhileAsleep;
+    local_i2c.CONSET                       = I2c::Control::kInterfaceEnable;
+    bus_events                             = kReadEvents;
+
+    CHECK(test_subject.Read(kSecondAddress, read_buffer,
+                            sizeof(read_buffer)) == Status::kSuccess);
+
+    CHECK(read_buffer[0] == 0x5A);
+    CHECK(xQueueGiveFromISR_fake.call_count == 1);
+    CHECK(xQueueGiveFromISR_fake.arg0_val != nullptr);
+    CHECK(xQueueGiveFromISR_fake.arg0_val ==
+          xQueueSemaphoreTake_fake.arg0_val);
+    CHECK(xQueueSemaphoreTake_fake.arg1_history[0] ==
+          pdMS_TO_TICKS(I2c::kI2cTimeout.count()));
+    CHECK(ulTaskNotifyTake_fake.call_count == 0);
+    CHECK(queue.count == 0);
+
+    // A device that does not answer
+    bus_events = {
+      { I2c::MasterState::kStartCondition, 0 },
+      { I2c::MasterState::kSlaveAddressWriteSentRecievedNack, 0 },
+    };
+    local_i2c.CONSET = I2c::Control::kInterfaceEnable;
+    CHECK(test_subject.Write(kFirstAddress, { 0x01 }) ==
+          Status::kDeviceNotFound);
+  }
+  SECTION("Blocking transactions are polled before the scheduler starts")
+  {
+    xTaskGetSchedulerState_fake.return_val = taskSCHEDULER_NOT_STARTED;
+    local_i2c.CONSET                       = I2c::Control::kInterfaceEnable;
+    bus_events                             = kReadEvents;
+
+    SetUptimeFunction(AdvanceBus);
+    Status status =
+        test_subject.Read(kSecondAddress, read_buffer, sizeof(read_buffer));
+    SetUptimeFunction(DefaultUptime);
+
+    CHECK(status == Status::kSuccess);
+    CHECK(read_buffer[0] == 0x5A);
+    CHECK(bus_events.empty());
+    CHECK(queue.count == 0);
+    // No FreeRTOS object is created, as that would mask the interrupts
+    CHECK(xQueueGenericCreateStatic_fake.call_count == 0);
+    CHECK(xQueueSemaphoreTake_fake.call_count == 0);
+  }
+  SECTION("Blocking transactions that time out give up their place")
+  {
+    xTaskGetSchedulerState_fake.return_val = taskSCHEDULER_RUNNING;
+    xQueueSemaphoreTake_fake.custom_fake   = RunBusWhileAsleep;
+
+    SECTION("While on the bus")
+    {
+      local_i2c.CONSET = I2c::Control::kInterfaceEnable;
+      CHECK(test_subject.Read(kSecondAddress, read_buffer,
+                              sizeof(read_buffer)) == Status::kTimedOut);
+
+      CHECK(queue.count == 0);
+      CHECK_BITS(I2c::Control::kStop, local_i2c.CONSET);
+      CHECK_BITS(I2c::Control::kStart, local_i2c.CONCLR);
+    }
+    SECTION("While waiting behind another transaction")
+    {
+      REQUIRE(test_subject.Enqueue(write_transaction, RecordCompletion) ==
+              Status::kSuccess);
+      local_i2c.CONSET = I2c::Control::kInterfaceEnable;
+
+      CHECK(test_subject.Read(kSecondAddress, read_buffer,
+                              sizeof(read_buffer)) == Status::kTimedOut);
+      CHECK(test_subject.GetTransactionInfo().address == kFirstAddress);
+
+      for (const auto & event : kWriteEvents)
+      {
+        RunEvent(event);
+      }
+
+      // The read is skipped, so the bus stops
+      CHECK(completed_addresses == std::vector<uint8_t>{ kFirstAddress });
+      CHECK(!(local_i2c.CONSET & I2c::Control::kStart));
+      CHECK(queue.count == 0);
+      CHECK(xQueueGiveFromISR_fake.call_count == 0);
+    }
+  }
+
+  RESET_FAKE(xTaskGetSchedulerState);
+  RESET_FAKE(xQueueGenericCreateStatic);
+  RESET_FAKE(xQueueGiveFromISR);
+  RESET_FAKE(xQueueSemaphoreTake);
+}
+
+TEST_CASE("Testing lpc40xx I2C without a transaction queue", "[lpc40xx-i2c]")
+{
+  LPC_I2C_TypeDef local_i2c;
+  memset(&local_i2c, 0, sizeof(local_i2c));
+  Mock<sjsu::SystemController> mock_system_controller;
+  Mock<sjsu::Pin> mock_pin;
+  Mock<sjsu::InterruptController> mock_interrupt_controller;
+
+  static I2c::Transaction_t transaction;
+  static const I2c::PartialBus_t kPartial = {
+    .registers           = &local_i2c,
+    .peripheral_power_id = sjsu::lpc40xx::SystemController::Peripherals::kI2c1,
+    .irq_number          = I2C1_IRQn,
+    .transaction         = transaction,
+    .sda_pin             = mock_pin.get(),
+    .scl_pin             = mock_pin.get(),
+    .pin_function_id     = 0b011,
+  };
+  const I2c::Bus_t kI2c = {
+    .bus     = kPartial,
+    .handler = I2c::I2cHandler<kPartial>,
+  };
+  I2c test_subject(kI2c, mock_system_controller.get(),
+                   mock_interrupt_controller.get());
+
+  CHECK(test_subject.Enqueue({}, RecordCompletion) == Status::kNotImplemented);
+  CHECK(local_i2c.CONSET == 0);
+}
 }  // namespace sjsu::lpc40xx
@@ -1,5 +1,8 @@
 // this is the ssp.hpp test file
 
+#include <algorithm>
+#include <vector>
+
 #include "L0_Platform/lpc40xx/LPC40xx.h"
 #include "L1_Peripheral/lpc40xx/spi.hpp"
 #include "L4_Testing/testing_frameworks.hpp"
@@ -88,6 +91,29 @@ TEST_CASE("Testing lpc40xx SPI", "[lpc40xx-Spi]")
     CHECK(local_ssp.CPSR == (kPrescaler & 0xFF));
   }
 
+  SECTION("SetClock never exceeds the requested frequency")
+  {
+    // 12MHz / 5MHz rounds up to a divider of 3, which the even prescaler
+    // turns into 4.
+    test_spi.SetClock(5_MHz);
+    CHECK(local_ssp.CPSR == 4);
+    CHECK(bit::Extract(local_ssp.CR0, Spi::ControlRegister0::kDividerBit) ==
+          0);
+    CHECK(test_spi.GetClock() == 3_MHz);
+
+    // The SSP cannot run faster than half of its peripheral clock
+    test_spi.SetClock(25_MHz);
+    CHECK(local_ssp.CPSR == 2);
+    CHECK(test_spi.GetClock() == 6_MHz);
+
+    // Dividers larger than 254 need the serial clock rate as well
+    test_spi.SetClock(10_kHz);
+    CHECK(local_ssp.CPSR == 240);
+    CHECK(bit::Extract(local_ssp.CR0, Spi::ControlRegister0::kDividerBit) ==
+          4);
+    CHECK(test_spi.GetClock() == 10_kHz);
+  }
+
   SECTION("Check Transfer Register")
   {
     constexpr uint8_t kIdle    = 0;
@@ -96,6 +122,505 @@ TEST_CASE("Testing lpc40xx SPI", "[lpc40xx-Spi]")
     CHECK((local_ssp.SR & (0x1 << kIdleBit)) == kIdle);
   }
 
+  SECTION("Block Transfer")
+  {
+    // Setup: Report that the transmit FIFO always has space and the receive
+    //        FIFO always has data. As the local registers are plain memory,
+    //        every frame read from DR is the last frame written to it.
+    constexpr uint8_t kTransmitFifoNotFull = 1 << 1;
+    constexpr uint8_t kReceiveFifoNotEmpty = 1 << 2;
+    local_ssp.SR = kTransmitFifoNotFull | kReceiveFifoNotEmpty;
+
+    SECTION("Transmit and receive")
+    {
+      // Setup: Send more frames than the FIFO holds, each one different, so
+      //        that each batch of frames in flight loops back different data.
+      uint8_t transmit[20];
+      uint8_t receive[20] = { 0 };
+      for (uint8_t i = 0; i < sizeof(transmit); i++)
+      {
+        transmit[i] = static_cast<uint8_t>(0x40 + i);
+      }
+
+      test_spi.Transfer(transmit, receive, sizeof(transmit));
+
+      // Verify: The FIFO is filled, then drained, before the next batch is
+      //         sent, and each received frame lands in its own slot.
+      CHECK(local_ssp.DR == transmit[19]);
+      for (size_t i = 0; i < sizeof(receive); i++)
+      {
+        INFO("frame " << i);
+        size_t last_frame_in_batch =
+            std::min(i / Spi::kFifoDepth * Spi::kFifoDepth + Spi::kFifoDepth,
+                     sizeof(transmit)) - 1;
+        CHECK(receive[i] == transmit[last_frame_in_batch]);
+      }
+    }
+    SECTION("Write only")
+    {
+      uint8_t transmit[20];
+      memset(transmit, 0, sizeof(transmit));
+      transmit[19] = 0xAB;
+
+      test_spi.Write(transmit, sizeof(transmit));
+
+      CHECK(local_ssp.DR == 0xAB);
+    }
+    SECTION("Read only with fill byte")
+    {
+      uint8_t receive[12];
+      memset(receive, 0, sizeof(receive));
+
+      test_spi.Read(receive, sizeof(receive), 0x5A);
+
+      for (size_t i = 0; i < sizeof(receive); i++)
+      {
+        CHECK(receive[i] == 0x5A);
+      }
+    }
+  }
+
   sjsu::lpc40xx::SystemController::system_controller = LPC_SC;
 }
+
+namespace
+{
+/// Gives each semaphore a handle of its own, so that the tests can tell which
+/// one is given and taken.
+QueueHandle_t CreateSemaphore(UBaseType_t,
+                              UBaseType_t,
+                              uint8_t *,
+                              StaticQueue_t * buffer,
+                              uint8_t)
+{
+  return reinterpret_cast<QueueHandle_t>(buffer);
+}
+
+BaseType_t CompleteDmaTransfer(QueueHandle_t, TickType_t)
+{
+  // Simulate both SPI channels finishing while the task is asleep.
+  // This register is read only, thus the cast.
+  *const_cast<volatile uint32_t *>(&Dma::gpdma->IntTCStat) = 0b11;
+  Dma::DmaHandler();
+  return pdTRUE;
+}
+}  // namespace
+
+TEST_CASE("Testing lpc40xx SPI with DMA", "[lpc40xx-Spi]")
+{
+  RESET_FAKE(xTaskGetSchedulerState);
+  RESET_FAKE(ulTaskNotifyTake);
+  RESET_FAKE(xQueueGenericCreateStatic);
+  RESET_FAKE(xQueueGiveFromISR);
+  RESET_FAKE(xQueueSemaphoreTake);
+  xQueueGenericCreateStatic_fake.custom_fake = CreateSemaphore;
+
+  // Simulate local version of the SSP and GPDMA registers
+  LPC_SSP_TypeDef local_ssp;
+  LPC_GPDMA_TypeDef local_gpdma;
+  LPC_GPDMACH_TypeDef local_channels[Dma::kNumberOfChannels];
+  LPC_SC_TypeDef local_sc;
+  memset(&local_ssp, 0, sizeof(local_ssp));
+  memset(&local_gpdma, 0, sizeof(local_gpdma));
+  memset(&local_channels, 0, sizeof(local_channels));
+  memset(&local_sc, 0, sizeof(local_sc));
+
+  Dma::gpdma = &local_gpdma;
+  for (uint8_t i = 0; i < Dma::kNumberOfChannels; i++)
+  {
+    Dma::channels[i] = &local_channels[i];
+  }
+  Dma::allocated_channels             = 0;
+  SystemController::system_controller = &local_sc;
+
+  Mock<sjsu::SystemController> mock_system_controller;
+  Fake(Method(mock_system_controller, PowerUpPeripheral));
+  Mock<sjsu::InterruptController> mock_interrupt_controller;
+  Fake(Method(mock_interrupt_controller, Register));
+  Mock<sjsu::Pin> mock_pin;
+  Fake(Method(mock_pin, SetPinFunction));
+
+  const Spi::Bus_t kMockSpi = {
+    .registers        = &local_ssp,
+    .power_on_bit     = sjsu::lpc40xx::SystemController::Peripherals::kSsp0,
+    .mosi             = mock_pin.get(),
+    .miso             = mock_pin.get(),
+    .sck              = mock_pin.get(),
+    .pin_function_id  = 0b010,
+    .transmit_request = Dma::Request::kSsp0Tx,
+    .receive_request  = Dma::Request::kSsp0Rx,
+  };
+
+  Dma dma(mock_system_controller.get(), mock_interrupt_controller.get());
+  Spi test_spi(kMockSpi, mock_system_controller.get());
+  REQUIRE(test_spi.EnableDma(dma) == Status::kSuccess);
+
+  // Channels are handed out in order: transmit first, then receive.
+  constexpr uint8_t kTransmitChannel = 0;
+  constexpr uint8_t kReceiveChannel  = 1;
+  const uint32_t kDataRegister =
+      static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&local_ssp.DR));
+
+  SECTION("Bus without DMA request lines")
+  {
+    const Spi::Bus_t kNoDmaSpi = {
+      .registers       = &local_ssp,
+      .power_on_bit    = sjsu::lpc40xx::SystemController::Peripherals::kSsp0,
+      .mosi            = mock_pin.get(),
+      .miso            = mock_pin.get(),
+      .sck             = mock_pin.get(),
+      .pin_function_id = 0b010,
+    };
+    Spi no_dma_spi(kNoDmaSpi, mock_system_controller.get());
+    CHECK(no_dma_spi.EnableDma(dma) == Status::kNotImplemented);
+  }
+  SECTION("Short transfers do not use DMA")
+  {
+    constexpr uint8_t kTransmitFifoNotFull = 1 << 1;
+    constexpr uint8_t kReceiveFifoNotEmpty = 1 << 2;
+    local_ssp.SR = kTransmitFifoNotFull | kReceiveFifoNotEmpty;
+    uint8_t buffer[Spi::kDmaThreshold - 1];
+
+    test_spi.Read(buffer, sizeof(buffer));
+
+    CHECK(local_channels[kReceiveChannel].CConfig == 0);
+    CHECK(local_channels[kTransmitChannel].CConfig == 0);
+  }
+  SECTION("Read block before the scheduler starts")
+  {
+    uint8_t buffer[512];
+
+    test_spi.Read(buffer, sizeof(buffer));
+
+    // Receive channel drains the data register into the buffer
+    CHECK(local_channels[kReceiveChannel].CSrcAddr == kDataRegister);
+    CHECK(local_channels[kReceiveChannel].CDestAddr ==
+          static_cast<uint32_t>(reinterpret_cast<uintptr_t>(buffer)));
+    uint32_t receive_control = local_channels[kReceiveChannel].CControl;
+    CHECK(bit::Extract(receive_control, Dma::Control::kTransferSize) == 512);
+    CHECK(!bit::Read(receive_control, Dma::Control::kSourceIncrement.position));
+    CHECK(bit::Read(receive_control,
+                    Dma::Control::kDestinationIncrement.position));
+    CHECK(bit::Extract(local_channels[kReceiveChannel].CConfig,
+                       Dma::ChannelConfig::kSourcePeripheral) ==
+          Dma::Request::kSsp0Rx.line);
+    // Transmit channel repeatedly sends the fill byte
+    CHECK(local_channels[kTransmitChannel].CDestAddr == kDataRegister);
+    uint32_t transmit_control = local_channels[kTransmitChannel].CControl;
+    CHECK(!bit::Read(transmit_control,
+                     Dma::Control::kSourceIncrement.position));
+    CHECK(bit::Extract(local_channels[kTransmitChannel].CConfig,
+                       Dma::ChannelConfig::kDestinationPeripheral) ==
+          Dma::Request::kSsp0Tx.line);
+    // SSP DMA requests are disabled once the transfer is over
+    CHECK(local_ssp.DMACR == 0);
+    CHECK(xQueueSemaphoreTake_fake.call_count == 0);
+  }
+  SECTION("Write block sleeps until the DMA completes")
+  {
+    xTaskGetSchedulerState_fake.return_val = taskSCHEDULER_RUNNING;
+    xQueueSemaphoreTake_fake.custom_fake   = CompleteDmaTransfer;
+    uint8_t buffer[512];
+
+    test_spi.Write(buffer, sizeof(buffer));
+
+    CHECK(local_channels[kTransmitChannel].CSrcAddr ==
+          static_cast<uint32_t>(reinterpret_cast<uintptr_t>(buffer)));
+    CHECK(bit::Read(local_channels[kTransmitChannel].CControl,
+                    Dma::Control::kSourceIncrement.position));
+    CHECK(!bit::Read(local_channels[kReceiveChannel].CControl,
+                     Dma::Control::kDestinationIncrement.position));
+    // The task sleeps on a semaphore of its own, which the handler gives, and
+    // leaves its notifications alone.
+    CHECK(xQueueSemaphoreTake_fake.call_count == 1);
+    CHECK(xQueueGiveFromISR_fake.call_count == 1);
+    CHECK(xQueueGiveFromISR_fake.arg0_val != nullptr);
+    CHECK(xQueueGiveFromISR_fake.arg0_val ==
+          xQueueSemaphoreTake_fake.arg0_val);
+    CHECK(ulTaskNotifyTake_fake.call_count == 0);
+    CHECK(local_ssp.DMACR == 0);
+  }
+  SECTION("Transfers fall back to the FIFO when the DMA cannot start")
+  {
+    constexpr uint8_t kTransmitFifoNotFull = 1 << 1;
+    constexpr uint8_t kReceiveFifoNotEmpty = 1 << 2;
+    local_ssp.SR = kTransmitFifoNotFull | kReceiveFifoNotEmpty;
+    xTaskGetSchedulerState_fake.return_val = taskSCHEDULER_RUNNING;
+    uint8_t transmit[512];
+    uint8_t receive[512] = { 0 };
+    memset(transmit, 0x3C, sizeof(transmit));
+
+    SECTION("Receive channel")
+    {
+      local_gpdma.EnbldChns = 1 << kReceiveChannel;
+
+      test_spi.Transfer(transmit, receive, sizeof(transmit));
+
+      CHECK(local_channels[kReceiveChannel].CConfig == 0);
+    }
+    SECTION("Transmit channel")
+    {
+      local_gpdma.EnbldChns = 1 << kTransmitChannel;
+
+      test_spi.Transfer(transmit, receive, sizeof(transmit));
+
+      // The receive channel had already started, and is stopped again
+      CHECK(!bit::Read(local_channels[kReceiveChannel].CConfig,
+                       Dma::ChannelConfig::kEnable.position));
+    }
+
+    CHECK(local_channels[kTransmitChannel].CConfig == 0);
+    CHECK(local_ssp.DMACR == 0);
+    CHECK(xQueueSemaphoreTake_fake.call_count == 0);
+    CHECK(receive[0] == 0x3C);
+    CHECK(receive[sizeof(receive) - 1] == 0x3C);
+  }
+
+  RESET_FAKE(xTaskGetSchedulerState);
+  RESET_FAKE(xQueueGenericCreateStatic);
+  RESET_FAKE(xQueueGiveFromISR);
+  RESET_FAKE(xQueueSemaphoreTake);
+  Dma::allocated_channels = 0;
+  Dma::gpdma              = LPC_GPDMA;
+  Dma::channels[0]        = LPC_GPDMACH0;
+  Dma::channels[1]        = LPC_GPDMACH1;
+  Dma::channels[2]        = LPC_GPDMACH2;
+  Dma::channels[3]        = LPC_GPDMACH3;
+  Dma::channels[4]        = LPC_GPDMACH4;
+  Dma::channels[5]        = LPC_GPDMACH5;
+  Dma::channels[6]        = LPC_GPDMACH6;
+  Dma::channels[7]        = LPC_GPDMACH7;
+  sjsu::lpc40xx::SystemController::system_controller = LPC_SC;
+}
+
+namespace
+{
+constexpr uint32_t kTransmitFifoNotFull = 1 << 1;
+constexpr uint32_t kReceiveFifoNotEmpty = 1 << 2;
+
+const Spi::Bus_t * interrupting_bus = nullptr;
+/// Status register values the SSP reports to each interrupt, in order. Once
+/// they run out, both FIFOs are always ready.
+std::vector<uint32_t> interrupt_status;
+/// Transfer state seen by the task each time it went to sleep
+std::vector<Spi::InterruptTransfer_t> sleeps;
+/// Interrupt mask set each time the task went to sleep
+std::vector<uint32_t> sleep_masks;
+
+void SspInterrupt()
+{
+  Spi::SspHandler(*interrupting_bus);
+}
+
+BaseType_t RunSspInterrupt(QueueHandle_t, TickType_t)
+{
+  const Spi::InterruptTransfer_t & transfer =
+      *interrupting_bus->interrupt_transfer;
+  sleeps.push_back({ .transmit    = transfer.transmit,
+                     .receive     = transfer.receive,
+                     .length      = transfer.length,
+                     .transmitted = transfer.transmitted,
+                     .received    = transfer.received,
+                     .fill_byte   = transfer.fill_byte,
+                     .done        = transfer.done });
+  sleep_masks.push_back(static_cast<uint32_t>(
+      interrupting_bus->registers->IMSC));
+  interrupting_bus->registers->SR = kTransmitFifoNotFull | kReceiveFifoNotEmpty;
+  if (!interrupt_status.empty())
+  {
+    interrupting_bus->registers->SR = interrupt_status.front();
+    interrupt_status.erase(interrupt_status.begin());
+  }
+  SspInterrupt();
+  return 1;
+}
+}  // namespace
+
+TEST_CASE("Testing lpc40xx SPI with interrupts", "[lpc40xx-Spi]")
+{
+  RESET_FAKE(xTaskGetSchedulerState);
+  RESET_FAKE(ulTaskNotifyTake);
+  RESET_FAKE(xQueueGenericCreateStatic);
+  RESET_FAKE(xQueueGiveFromISR);
+  RESET_FAKE(xQueueSemaphoreTake);
+  xQueueGenericCreateStatic_fake.custom_fake = CreateSemaphore;
+  interrupt_status.clear();
+  sleeps.clear();
+  sleep_masks.clear();
+
+  LPC_SSP_TypeDef local_ssp;
+  memset(&local_ssp, 0, sizeof(local_ssp));
+
+  Mock<sjsu::SystemController> mock_system_controller;
+  Fake(Method(mock_system_controller, PowerUpPeripheral));
+  Mock<sjsu::InterruptController> mock_interrupt_controller;
+  Fake(Method(mock_interrupt_controller, Register));
+  Mock<sjsu::Pin> mock_pin;
+  Fake(Method(mock_pin, SetPinFunction));
+
+  Spi::InterruptTransfer_t transfer;
+  const Spi::Bus_t kMockSpi = {
+    .registers          = &local_ssp,
+    .power_on_bit       = sjsu::lpc40xx::SystemController::Peripherals::kSsp1,
+    .mosi               = mock_pin.get(),
+    .miso               = mock_pin.get(),
+    .sck                = mock_pin.get(),
+    .pin_function_id    = 0b010,
+    .irq_number         = SSP1_IRQn,
+    .interrupt_transfer = &transfer,
+    .handler            = SspInterrupt,
+  };
+  interrupting_bus = &kMockSpi;
+
+  Spi test_spi(kMockSpi, mock_system_controller.get(),
+               mock_interrupt_controller.get());
+  REQUIRE(test_spi.EnableInterrupts() == Status::kSuccess);
+
+  xTaskGetSchedulerState_fake.return_val = taskSCHEDULER_RUNNING;
+  xQueueSemaphoreTake_fake.custom_fake   = RunSspInterrupt;
+  local_ssp.SR = kTransmitFifoNotFull | kReceiveFifoNotEmpty;
+
+  constexpr uint32_t kReceiveInterrupts = 0b0110;
+
+  SECTION("EnableInterrupts registers the handler")
+  {
+    Verify(Method(mock_interrupt_controller, Register)
+               .Matching([](sjsu::InterruptController::RegistrationInfo_t
+                                info) {
+                 return info.interrupt_request_number == SSP1_IRQn &&
+                        info.interrupt_service_routine ==
+                            SspInterrupt &&
+                        info.priority == Dma::kInterruptPriority;
+               }))
+        .Once();
+  }
+  SECTION("Bus without an interrupt handler")
+  {
+    const Spi::Bus_t kNoInterruptSpi = {
+      .registers       = &local_ssp,
+      .power_on_bit    = sjsu::lpc40xx::SystemController::Peripherals::kSsp1,
+      .mosi            = mock_pin.get(),
+      .miso            = mock_pin.get(),
+      .sck             = mock_pin.get(),
+      .pin_function_id = 0b010,
+    };
+    Spi no_interrupt_spi(kNoInterruptSpi, mock_system_controller.get(),
+                         mock_interrupt_controller.get());
+    CHECK(no_interrupt_spi.EnableInterrupts() == Status::kNotImplemented);
+  }
+  SECTION("Transfers that fit in the FIFO are polled")
+  {
+    uint8_t buffer[Spi::kFifoDepth];
+
+    test_spi.Read(buffer, sizeof(buffer));
+
+    CHECK(xQueueSemaphoreTake_fake.call_count == 0);
+    CHECK(local_ssp.IMSC == 0);
+  }
+  SECTION("Transfers before the scheduler starts are polled")
+  {
+    xTaskGetSchedulerState_fake.return_val = taskSCHEDULER_NOT_STARTED;
+    uint8_t buffer[64];
+
+    test_spi.Read(buffer, sizeof(buffer));
+
+    CHECK(xQueueSemaphoreTake_fake.call_count == 0);
+    CHECK(local_ssp.IMSC == 0);
+  }
+  SECTION("The task sleeps while the interrupt moves the frames")
+  {
+    uint8_t transmit[20];
+    uint8_t receive[20] = { 0 };
+    for (uint8_t i = 0; i < sizeof(transmit); i++)
+    {
+      transmit[i] = static_cast<uint8_t>(0x40 + i);
+    }
+
+    test_spi.Transfer(transmit, receive, sizeof(transmit));
+
+    // The transmit FIFO is filled before the task sleeps, then each interrupt
+    // drains the receive FIFO and tops the transmit FIFO back up.
+    REQUIRE(sleeps.size() == 3);
+    CHECK(sleeps[0].transmitted == Spi::kFifoDepth);
+    CHECK(sleeps[0].received == 0);
+    CHECK(sleeps[1].transmitted == 16);
+    CHECK(sleeps[1].received == 8);
+    CHECK(sleeps[2].transmitted == 20);
+    CHECK(sleeps[2].received == 16);
+    CHECK(transfer.received == 20);
+    // As the local registers are plain memory, every frame read from DR is
+    // the last frame written to it before the interrupt.
+    CHECK(receive[0] == transmit[7]);
+    CHECK(receive[8] == transmit[15]);
+    CHECK(receive[19] == transmit[19]);
+    // Once every frame has been received, the interrupt is masked and the
+    // task is woken.
+    CHECK(local_ssp.IMSC == 0);
+    CHECK(local_ssp.ICR == 0b0010);
+    CHECK(xQueueGiveFromISR_fake.call_count == 1);
+    CHECK(xQueueGiveFromISR_fake.arg0_val != nullptr);
+    CHECK(xQueueGiveFromISR_fake.arg0_val == transfer.done);
+    CHECK(ulTaskNotifyTake_fake.call_count == 0);
+  }
+  SECTION("The receive FIFO interrupts are unmasked while the task sleeps")
+  {
+    uint8_t buffer[40];
+
+    test_spi.Write(buffer, sizeof(buffer));
+
+    // Only the receive FIFO half full and timeout interrupts are used, as
+    // draining the receive FIFO is what makes room in the transmit FIFO.
+    REQUIRE(!sleep_masks.empty());
+    for (uint32_t mask : sleep_masks)
+    {
+      CHECK(mask == kReceiveInterrupts);
+    }
+    CHECK(local_ssp.IMSC == 0);
+  }
+  SECTION("The transmit FIFO is only refilled while it has space")
+  {
+    uint8_t buffer[24];
+    // First interrupt: frames are waiting, but the transmit FIFO is full
+    interrupt_status = { kReceiveFifoNotEmpty };
+
+    test_spi.Read(buffer, sizeof(buffer), 0xA5);
+
+    REQUIRE(sleeps.size() >= 2);
+    CHECK(sleeps[1].transmitted == Spi::kFifoDepth);
+    CHECK(sleeps[1].received == Spi::kFifoDepth);
+    CHECK(transfer.received == sizeof(buffer));
+    CHECK(buffer[sizeof(buffer) - 1] == 0xA5);
+  }
+  SECTION("Frames still in the receive FIFO are left for the next interrupt")
+  {
+    uint8_t buffer[16];
+    // First interrupt: the receive FIFO runs dry straight away
+    interrupt_status = { kTransmitFifoNotFull };
+
+    test_spi.Read(buffer, sizeof(buffer));
+
+    REQUIRE(sleeps.size() >= 2);
+    CHECK(sleeps[1].transmitted == Spi::kFifoDepth);
+    CHECK(sleeps[1].received == 0);
+    CHECK(transfer.received == sizeof(buffer));
+  }
+  SECTION("No more than a FIFO's worth of frames is ever in flight")
+  {
+    uint8_t buffer[100];
+
+    test_spi.Read(buffer, sizeof(buffer));
+
+    for (const auto & sleep : sleeps)
+    {
+      CHECK(sleep.transmitted - sleep.received <= Spi::kFifoDepth);
+    }
+    CHECK(transfer.received == sizeof(buffer));
+  }
+
+  RESET_FAKE(xTaskGetSchedulerState);
+  RESET_FAKE(xQueueGenericCreateStatic);
+  RESET_FAKE(xQueueGiveFromISR);
+  RESET_FAKE(xQueueSemaphoreTake);
+  interrupting_bus = nullptr;
+}
 }  // namespace sjsu::lpc40xx
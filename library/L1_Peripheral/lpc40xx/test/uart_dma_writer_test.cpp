@@ -0,0 +1,322 @@
+#include <cstdint>
+#include <cstring>
+
+#include "L0_Platform/lpc40xx/LPC40xx.h"
+#include "L1_Peripheral/lpc40xx/uart_dma_writer.hpp"
+#include "L4_Testing/testing_frameworks.hpp"
+
+namespace sjsu::lpc40xx
+{
+namespace
+{
+constexpr size_t kHalfSize = 16;
+using TestWriter           = UartDmaWriter<kHalfSize>;
+
+void FinishDmaTransfer()
+{
+  // These registers are read only, thus the cast.
+  *const_cast<volatile uint32_t *>(&Dma::gpdma->EnbldChns) = 0;
+  *const_cast<volatile uint32_t *>(&Dma::gpdma->IntTCStat) = 0b1;
+  Dma::DmaHandler();
+  *const_cast<volatile uint32_t *>(&Dma::gpdma->IntTCStat) = 0;
+}
+
+/// Gives each semaphore a handle of its own, so that the tests can tell which
+/// one is given and taken.
+QueueHandle_t CreateSemaphore(UBaseType_t,
+                              UBaseType_t,
+                              uint8_t *,
+                              StaticQueue_t * buffer,
+                              uint8_t)
+{
+  return reinterpret_cast<QueueHandle_t>(buffer);
+}
+
+BaseType_t FinishDmaTransferWhileAsleep(QueueHandle_t, TickType_t)
+{
+  FinishDmaTransfer();
+  return pdTRUE;
+}
+}  // namespace
+
+TEST_CASE("Testing lpc40xx UART DMA writer", "[lpc40xx-uart-dma-writer]")
+{
+  RESET_FAKE(xTaskGetSchedulerState);
+  RESET_FAKE(ulTaskNotifyTake);
+  RESET_FAKE(xQueueGenericCreateStatic);
+  RESET_FAKE(xQueueGiveFromISR);
+  RESET_FAKE(xQueueGenericSend);
+  RESET_FAKE(xQueueSemaphoreTake);
+  xQueueGenericCreateStatic_fake.custom_fake = CreateSemaphore;
+
+  // Simulate local version of the UART and GPDMA registers
+  LPC_UART_TypeDef local_uart;
+  LPC_GPDMA_TypeDef local_gpdma;
+  LPC_GPDMACH_TypeDef local_channels[Dma::kNumberOfChannels];
+  LPC_SC_TypeDef local_sc;
+  memset(&local_uart, 0, sizeof(local_uart));
+  memset(&local_gpdma, 0, sizeof(local_gpdma));
+  memset(&local_channels, 0, sizeof(local_channels));
+  memset(&local_sc, 0, sizeof(local_sc));
+
+  Dma::gpdma = &local_gpdma;
+  for (uint8_t i = 0; i < Dma::kNumberOfChannels; i++)
+  {
+    Dma::channels[i] = &local_channels[i];
+  }
+  Dma::allocated_channels             = 0;
+  SystemController::system_controller = &local_sc;
+
+  Mock<sjsu::SystemController> mock_system_controller;
+  Fake(Method(mock_system_controller, PowerUpPeripheral));
+  Mock<sjsu::InterruptController> mock_interrupt_controller;
+  Fake(Method(mock_interrupt_controller, Register));
+  Mock<sjsu::Pin> mock_pin;
+
+  const Uart::Port_t kMockPort = {
+    .registers        = &local_uart,
+    .power_on_id      = SystemController::Peripherals::kUart0,
+    .tx               = mock_pin.get(),
+    .rx               = mock_pin.get(),
+    .tx_function_id   = 0b001,
+    .rx_function_id   = 0b001,
+    .transmit_request = Dma::Request::kUart0Tx,
+  };
+
+  Dma dma(mock_system_controller.get(), mock_interrupt_controller.get());
+
+  // The only channel allocated in this test
+  constexpr uint8_t kChannel = 0;
+  LPC_GPDMACH_TypeDef & channel = local_channels[kChannel];
+  const uint32_t kTransmitRegister =
+      static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&local_uart.THR));
+
+  uint8_t payload[64];
+  for (size_t i = 0; i < sizeof(payload); i++)
+  {
+    payload[i] = static_cast<uint8_t>(i);
+  }
+
+  // CSrcAddr only keeps the lower 32 bits of a host pointer. The buffers live
+  // inside the writer, so borrow the upper bits from the writer's address.
+  auto sent_data = [&channel](const TestWriter & writer) {
+    uintptr_t upper_bits = reinterpret_cast<uintptr_t>(&writer) &
+                           ~uintptr_t{ 0xFFFF'FFFF };
+    return reinterpret_cast<const uint8_t *>(upper_bits | channel.CSrcAddr);
+  };
+  auto sent_length = [&channel]() {
+    return bit::Extract(channel.CControl, Dma::Control::kTransferSize);
+  };
+
+  SECTION("Initialize")
+  {
+    TestWriter test_subject(kMockPort, dma);
+
+    CHECK(test_subject.Initialize() == Status::kSuccess);
+    CHECK(Dma::allocated_channels == (1 << kChannel));
+    // FIFOs enabled and reset with DMA mode on
+    CHECK(local_uart.FCR == 0b1111);
+    Verify(Method(mock_interrupt_controller, Register));
+
+    // Initializing again keeps the channel it has
+    CHECK(test_subject.Initialize() == Status::kSuccess);
+    CHECK(Dma::allocated_channels == (1 << kChannel));
+  }
+  SECTION("Port without a DMA request line")
+  {
+    Uart::Port_t no_dma_port = kMockPort;
+    no_dma_port.transmit_request = Dma::Request::kNone;
+    TestWriter test_subject(no_dma_port, dma);
+
+    CHECK(test_subject.Initialize() == Status::kNotImplemented);
+    CHECK(Dma::allocated_channels == 0);
+  }
+  SECTION("All DMA channels are in use")
+  {
+    Dma::allocated_channels = 0xFF;
+    TestWriter test_subject(kMockPort, dma);
+
+    CHECK(test_subject.Initialize() == Status::kNotReadyYet);
+  }
+  SECTION("Write starts sending right away")
+  {
+    TestWriter test_subject(kMockPort, dma);
+    REQUIRE(test_subject.Initialize() == Status::kSuccess);
+
+    CHECK(test_subject.Write(payload, 10) == 10);
+
+    CHECK(test_subject.IsSending());
+    CHECK(test_subject.GetPendingCount() == 0);
+    CHECK(sent_length() == 10);
+    CHECK(memcmp(sent_data(test_subject), payload, 10) == 0);
+    CHECK(channel.CDestAddr == kTransmitRegister);
+    CHECK(bit::Read(channel.CControl, Dma::Control::kSourceIncrement.position));
+    CHECK(!bit::Read(channel.CControl,
+                     Dma::Control::kDestinationIncrement.position));
+    CHECK(bit::Extract(channel.CConfig,
+                       Dma::ChannelConfig::kDestinationPeripheral) ==
+          Dma::Request::kUart0Tx.line);
+    CHECK(bit::Extract(channel.CConfig, Dma::ChannelConfig::kTransferType) ==
+          util::Value(Dma::TransferType::kMemoryToPeripheral));
+  }
+  SECTION("Writes during a transfer are sent when it completes")
+  {
+    TestWriter test_subject(kMockPort, dma);
+    REQUIRE(test_subject.Initialize() == Status::kSuccess);
+    REQUIRE(test_subject.Write(payload, 4) == 4);
+    const uint8_t * first_half = sent_data(test_subject);
+    local_gpdma.EnbldChns      = (1 << kChannel);
+
+    CHECK(test_subject.Write(&payload[4], 6) == 6);
+    CHECK(test_subject.Write(&payload[10], 3) == 3);
+    CHECK(test_subject.GetPendingCount() == 9);
+    // The transfer in progress has not been touched
+    CHECK(sent_data(test_subject) == first_half);
+    CHECK(sent_length() == 4);
+
+    FinishDmaTransfer();
+
+    CHECK(test_subject.IsSending());
+    CHECK(test_subject.GetPendingCount() == 0);
+    CHECK(sent_data(test_subject) != first_half);
+    CHECK(sent_length() == 9);
+    CHECK(memcmp(sent_data(test_subject), &payload[4], 9) == 0);
+
+    FinishDmaTransfer();
+
+    CHECK(!test_subject.IsSending());
+  }
+  SECTION("Drop policy drops what does not fit")
+  {
+    TestWriter test_subject(kMockPort, dma, TestWriter::FullPolicy::kDrop);
+    REQUIRE(test_subject.Initialize() == Status::kSuccess);
+    REQUIRE(test_subject.Write(payload, kHalfSize) == kHalfSize);
+    local_gpdma.EnbldChns = (1 << kChannel);
+
+    CHECK(test_subject.Write(&payload[kHalfSize], kHalfSize + 5) == kHalfSize);
+    CHECK(test_subject.GetDroppedCount() == 5);
+    CHECK(test_subject.Write(payload, 3) == 0);
+    CHECK(test_subject.GetDroppedCount() == 8);
+
+    FinishDmaTransfer();
+
+    CHECK(sent_length() == kHalfSize);
+    CHECK(memcmp(sent_data(test_subject), &payload[kHalfSize], kHalfSize) == 0);
+  }
+  SECTION("Overwrite policy drops the oldest unsent data")
+  {
+    TestWriter test_subject(kMockPort, dma,
+                            TestWriter::FullPolicy::kOverwrite);
+    REQUIRE(test_subject.Initialize() == Status::kSuccess);
+    REQUIRE(test_subject.Write(payload, kHalfSize) == kHalfSize);
+    local_gpdma.EnbldChns = (1 << kChannel);
+
+    CHECK(test_subject.Write(&payload[kHalfSize], kHalfSize) == kHalfSize);
+    CHECK(test_subject.Write(&payload[40], 5) == 5);
+    // Only the 5 oldest bytes make way for the new ones
+    CHECK(test_subject.GetDroppedCount() == 5);
+    CHECK(test_subject.GetPendingCount() == kHalfSize);
+
+    FinishDmaTransfer();
+
+    CHECK(sent_length() == kHalfSize);
+    CHECK(memcmp(sent_data(test_subject), &payload[kHalfSize + 5],
+                 kHalfSize - 5) == 0);
+    CHECK(memcmp(&sent_data(test_subject)[kHalfSize - 5], &payload[40], 5) ==
+          0);
+  }
+  SECTION("Block policy polls the GPDMA before the scheduler runs")
+  {
+    xTaskGetSchedulerState_fake.return_val = taskSCHEDULER_NOT_STARTED;
+    TestWriter test_subject(kMockPort, dma, TestWriter::FullPolicy::kBlock);
+    REQUIRE(test_subject.Initialize() == Status::kSuccess);
+
+    // The simulated channel is never busy, so each poll finds the transfer
+    // finished and starts the next half.
+    CHECK(test_subject.Write(payload, 40) == 40);
+
+    CHECK(test_subject.GetDroppedCount() == 0);
+    CHECK(xQueueSemaphoreTake_fake.call_count == 0);
+    CHECK(xQueueGenericCreateStatic_fake.call_count == 0);
+    CHECK(test_subject.GetPendingCount() == 0);
+    CHECK(sent_length() == 40 - 2 * kHalfSize);
+    CHECK(memcmp(sent_data(test_subject), &payload[2 * kHalfSize],
+                 40 - 2 * kHalfSize) == 0);
+  }
+  SECTION("Writes before the scheduler runs send without the DMA interrupt")
+  {
+    xTaskGetSchedulerState_fake.return_val = taskSCHEDULER_NOT_STARTED;
+    TestWriter test_subject(kMockPort, dma);
+    REQUIRE(test_subject.Initialize() == Status::kSuccess);
+    REQUIRE(test_subject.Write(payload, 4) == 4);
+    // The GPDMA finishes, but its interrupt is masked
+    local_gpdma.EnbldChns = 0;
+
+    CHECK(test_subject.Write(&payload[4], 6) == 6);
+
+    CHECK(test_subject.IsSending());
+    CHECK(test_subject.GetPendingCount() == 0);
+    CHECK(sent_length() == 6);
+    CHECK(memcmp(sent_data(test_subject), &payload[4], 6) == 0);
+  }
+  SECTION("Block policy sleeps until the GPDMA frees up a half")
+  {
+    xTaskGetSchedulerState_fake.return_val = taskSCHEDULER_RUNNING;
+    xQueueSemaphoreTake_fake.custom_fake   = FinishDmaTransferWhileAsleep;
+    TestWriter test_subject(kMockPort, dma, TestWriter::FullPolicy::kBlock);
+    REQUIRE(test_subject.Initialize() == Status::kSuccess);
+    REQUIRE(test_subject.Write(payload, kHalfSize) == kHalfSize);
+    local_gpdma.EnbldChns = (1 << kChannel);
+
+    CHECK(test_subject.Write(&payload[kHalfSize], 24) == 24);
+
+    CHECK(test_subject.GetDroppedCount() == 0);
+    CHECK(xQueueSemaphoreTake_fake.call_count == 1);
+    CHECK(xQueueSemaphoreTake_fake.arg1_val == portMAX_DELAY);
+    CHECK(xQueueGiveFromISR_fake.call_count == 1);
+    CHECK(xQueueGiveFromISR_fake.arg0_val != nullptr);
+    CHECK(xQueueGiveFromISR_fake.arg0_val ==
+          xQueueSemaphoreTake_fake.arg0_val);
+    // The task's notification is left alone for whatever else it waits on
+    CHECK(ulTaskNotifyTake_fake.call_count == 0);
+    // Room is left, so the wake up is passed on to any other waiting writer
+    CHECK(xQueueGenericSend_fake.call_count == 1);
+    CHECK(xQueueGenericSend_fake.arg0_val == xQueueSemaphoreTake_fake.arg0_val);
+    CHECK(test_subject.GetPendingCount() == 40 - 2 * kHalfSize);
+    CHECK(memcmp(sent_data(test_subject), &payload[kHalfSize], kHalfSize) == 0);
+  }
+  SECTION("Flush sends everything without the DMA interrupt")
+  {
+    TestWriter test_subject(kMockPort, dma);
+    REQUIRE(test_subject.Initialize() == Status::kSuccess);
+    REQUIRE(test_subject.Write(payload, 4) == 4);
+    local_gpdma.EnbldChns = (1 << kChannel);
+    REQUIRE(test_subject.Write(&payload[4], kHalfSize) == kHalfSize);
+    local_gpdma.EnbldChns = 0;
+
+    test_subject.Flush();
+
+    CHECK(!test_subject.IsSending());
+    CHECK(test_subject.GetPendingCount() == 0);
+    CHECK(sent_length() == kHalfSize);
+    CHECK(memcmp(sent_data(test_subject), &payload[4], kHalfSize) == 0);
+  }
+
+  RESET_FAKE(xTaskGetSchedulerState);
+  RESET_FAKE(xQueueGenericCreateStatic);
+  RESET_FAKE(xQueueGiveFromISR);
+  RESET_FAKE(xQueueGenericSend);
+  RESET_FAKE(xQueueSemaphoreTake);
+  Dma::allocated_channels = 0;
+  Dma::gpdma              = LPC_GPDMA;
+  Dma::channels[0]        = LPC_GPDMACH0;
+  Dma::channels[1]        = LPC_GPDMACH1;
+  Dma::channels[2]        = LPC_GPDMACH2;
+  Dma::channels[3]        = LPC_GPDMACH3;
+  Dma::channels[4]        = LPC_GPDMACH4;
+  Dma::channels[5]        = LPC_GPDMACH5;
+  Dma::channels[6]        = LPC_GPDMACH6;
+  Dma::channels[7]        = LPC_GPDMACH7;
+  SystemController::system_controller = LPC_SC;
+}
+}  // namespace sjsu::lpc40xx
@@ -1,3 +1,9 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+
 #include "L0_Platform/lpc40xx/LPC40xx.h"
 #include "L1_Peripheral/lpc40xx/uart.hpp"
 #include "L4_Testing/testing_frameworks.hpp"
@@ -42,16 +48,17 @@ TEST_CASE("Testing lpc40xx Uart", "[lpc40xx-Uart]")
   constexpr uint32_t kBaudRate = 9600;
 
   Uart uart_test(kMockUart2, mock_system_controller.get());
-  uart_test.Initialize(kBaudRate);
+  Status initialize_status = uart_test.Initialize(kBaudRate);
 
   SECTION("Initialize")
   {
     constexpr uint32_t kFifo              = 1 << 0;
     constexpr uint32_t kBits8DlabClear    = 3;
     constexpr uint32_t kExpectedUpperByte = 0;
-    constexpr uint32_t kExpectedLowerByte = 208;
+    // 48 MHz / (16 * 250 * (1 + 1 / 4)) is exactly 9600 baud
+    constexpr uint32_t kExpectedLowerByte = 250;
     constexpr uint32_t kExpectedDivAdd    = 1;
-    constexpr uint32_t kExpectedMul       = 2;
+    constexpr uint32_t kExpectedMul       = 4;
     constexpr uint32_t kExpectedFdr = (kExpectedMul << 4) | kExpectedDivAdd;
 
     Verify(Method(mock_system_controller, PowerUpPeripheral)
@@ -72,8 +79,763 @@ TEST_CASE("Testing lpc40xx Uart", "[lpc40xx-Uart]")
     CHECK(kExpectedFdr == local_uart.FDR);
     CHECK(kBits8DlabClear == local_uart.LCR);
     CHECK(kFifo == (local_uart.FCR & kFifo));
+    CHECK(initialize_status == Status::kSuccess);
+  }
+  SECTION("Baud rate out of reach")
+  {
+    // The fastest 48 MHz can go is 48 MHz / 16 = 3 Mbaud
+    CHECK(!uart_test.SetBaudRate(4'000'000));
+    CHECK(local_uart.DLL == 1);
+    CHECK(local_uart.DLM == 0);
+    CHECK(!uart_test.SetBaudRate(0));
+    CHECK(uart_test.Initialize(4'000'000) == Status::kInvalidParameters);
+  }
+  SECTION("Set precomputed calibration")
+  {
+    constexpr uart::UartCalibration_t kCalibration = {
+      .divide_latch = 0x1234,
+      .divide_add   = 3,
+      .multiply     = 7,
+    };
+
+    uart_test.SetCalibration(kCalibration);
+
+    CHECK(local_uart.DLM == 0x12);
+    CHECK(local_uart.DLL == 0x34);
+    CHECK(local_uart.FDR == 0x73);
+    CHECK(local_uart.LCR == 3);
+  }
+
+  sjsu::lpc40xx::SystemController::system_controller = LPC_SC;
+}
+
+namespace
+{
+double CalibratedBaudRate(const uart::UartCalibration_t & calibration,
+                          double frequency)
+{
+  double fraction = 1.0 + static_cast<double>(calibration.divide_add) /
+                              static_cast<double>(calibration.multiply);
+  return frequency / (16.0 * calibration.divide_latch * fraction);
+}
+
+/// Smallest baud rate error any legal register combination can reach
+double BruteForceBestError(uint32_t baud_rate, double frequency)
+{
+  double best = std::numeric_limits<double>::max();
+  for (uint32_t multiply = 1; multiply <= 15; multiply++)
+  {
+    for (uint32_t divide_add = 0; divide_add < multiply; divide_add++)
+    {
+      uint32_t minimum_latch = (divide_add == 0) ? 1 : 3;
+      for (uint32_t latch = minimum_latch; latch <= 0xFFFF; latch++)
+      {
+        double rate = CalibratedBaudRate(
+            { .divide_latch = latch,
+              .divide_add   = divide_add,
+              .multiply     = multiply },
+            frequency);
+        best = std::min(best, std::abs(rate - baud_rate));
+      }
+    }
+  }
+  return best;
+}
+}  // namespace
+
+TEST_CASE("Testing lpc40xx Uart baud rate calibration", "[lpc40xx-Uart]")
+{
+  SECTION("Calibration can be worked out at compile time")
+  {
+    constexpr uart::UartCalibration_t kCalibration =
+        uart::GenerateUartCalibration(921'600, 48_MHz);
+
+    static_assert(kCalibration.divide_latch == 3);
+    static_assert(kCalibration.divide_add == 1);
+    static_assert(kCalibration.multiply == 12);
+    // 48 MHz / (16 * 3 * (1 + 1 / 12)) = 923076.9 baud
+    static_assert(kCalibration.baud_rate == 923'077);
+    static_assert(kCalibration.error_ppm == 1'602);
+  }
+  SECTION("Exact baud rates have no error")
+  {
+    constexpr uart::UartCalibration_t kCalibration =
+        uart::GenerateUartCalibration(3'000'000, 48_MHz);
+
+    CHECK(kCalibration.divide_latch == 1);
+    CHECK(kCalibration.divide_add == 0);
+    CHECK(kCalibration.baud_rate == 3'000'000);
+    CHECK(kCalibration.error_ppm == 0);
+  }
+  SECTION("Fractional divider is only used with a divide latch of 3 or more")
+  {
+    // 2 * (1 + 1 / 4) would be exact, but the hardware does not allow it,
+    // leaving a divide latch of 3 as the closest.
+    uart::UartCalibration_t calibration =
+        uart::GenerateUartCalibration(1'200'000, 48_MHz);
+
+    CHECK(calibration.divide_latch == 3);
+    CHECK(calibration.divide_add == 0);
+    CHECK(calibration.baud_rate == 1'000'000);
+    CHECK(calibration.error_ppm == -166'666);
+  }
+  SECTION("Baud rate of 0")
+  {
+    CHECK(uart::GenerateUartCalibration(0, 48_MHz).divide_latch == 0);
+  }
+  SECTION("Finds the smallest error of any register combination")
+  {
+    struct Case_t
+    {
+      uint32_t baud_rate;
+      units::frequency::hertz_t frequency;
+    };
+    const Case_t kCases[] = {
+      { 9'600, 48_MHz },       { 115'200, 48_MHz },  { 460'800, 48_MHz },
+      { 921'600, 60_MHz },     { 1'500'000, 96_MHz }, { 38'400, 12_MHz },
+      { 300, 120_MHz },
+    };
+
+    for (const auto & test : kCases)
+    {
+      INFO("baud rate = " << test.baud_rate
+                          << ", frequency = " << test.frequency.to<double>());
+      double frequency = test.frequency.to<double>();
+      uart::UartCalibration_t calibration =
+          uart::GenerateUartCalibration(test.baud_rate, test.frequency);
+
+      double rate  = CalibratedBaudRate(calibration, frequency);
+      double error = rate - test.baud_rate;
+      CHECK(calibration.baud_rate == Approx(rate).margin(0.5));
+      CHECK(calibration.error_ppm ==
+            Approx(error / test.baud_rate * 1e6).margin(1));
+      // Allow for the milli-baud rounding of the solver
+      CHECK(std::abs(error) <=
+            BruteForceBestError(test.baud_rate, frequency) + 0.001);
+      if (calibration.divide_add != 0)
+      {
+        CHECK(calibration.divide_latch >= 3);
+        CHECK(calibration.divide_add < calibration.multiply);
+      }
+    }
+  }
+}
+
+namespace
+{
+constexpr uint8_t kReceiveDataReady     = 1 << 0;
+constexpr uint8_t kTransmitHoldingEmpty = 1 << 5;
+constexpr uint32_t kBothInterrupts      = 0b11;
+
+const Uart::Port_t * interrupting_port = nullptr;
+
+void UartInterrupt()
+{
+  Uart::UartHandler(*interrupting_port);
+}
+
+void SetLineStatus(uint8_t status)
+{
+  // This register is read only, thus the cast.
+  *const_cast<volatile uint8_t *>(&interrupting_port->registers->LSR) = status;
+}
+
+QueueHandle_t CreateSemaphore(UBaseType_t,
+                              UBaseType_t,
+                              uint8_t *,
+                              StaticQueue_t * buffer,
+                              uint8_t)
+{
+  return reinterpret_cast<QueueHandle_t>(buffer);
+}
+
+/// Simulates a byte arriving while the reading task is asleep
+BaseType_t ReceiveWhileAsleep(QueueHandle_t, TickType_t)
+{
+  *const_cast<volatile uint8_t *>(&interrupting_port->registers->RBR) = 'K';
+  SetLineStatus(kReceiveDataReady);
+  UartInterrupt();
+  return pdTRUE;
+}
+}  // namespace
+
+TEST_CASE("Testing lpc40xx Uart with interrupts", "[lpc40xx-Uart]")
+{
+  RESET_FAKE(xTaskGetSchedulerState);
+  RESET_FAKE(xTaskGetTickCount);
+  RESET_FAKE(ulTaskNotifyTake);
+  RESET_FAKE(xQueueGenericCreateStatic);
+  RESET_FAKE(xQueueGiveFromISR);
+  RESET_FAKE(xQueueSemaphoreTake);
+  xQueueGenericCreateStatic_fake.custom_fake = CreateSemaphore;
+
+  LPC_UART_TypeDef local_uart;
+  memset(&local_uart, 0, sizeof(local_uart));
+
+  Mock<sjsu::SystemController> mock_system_controller;
+  Fake(Method(mock_system_controller, PowerUpPeripheral));
+  When(Method(mock_system_controller, GetSystemFrequency))
+      .AlwaysReturn(48_MHz);
+  When(Method(mock_system_controller, GetPeripheralClockDivider))
+      .AlwaysReturn(1);
+  Mock<sjsu::InterruptController> mock_interrupt_controller;
+  Fake(Method(mock_interrupt_controller, Register));
+  Mock<sjsu::Pin> mock_pin;
+  Fake(Method(mock_pin, SetPinFunction));
+  Fake(Method(mock_pin, SetPull));
+
+  auto buffers = std::make_unique<Uart::InterruptBuffers_t>();
+  const Uart::Port_t kMockUart2 = {
+    .registers      = &local_uart,
+    .power_on_id    = sjsu::lpc40xx::SystemController::Peripherals::kUart2,
+    .tx             = mock_pin.get(),
+    .rx             = mock_pin.get(),
+    .tx_function_id = 0b001,
+    .rx_function_id = 0b001,
+    .irq_number     = UART2_IRQn,
+    .buffers        = buffers.get(),
+    .handler        = UartInterrupt,
+  };
+  interrupting_port = &kMockUart2;
+
+  Uart uart_test(kMockUart2, mock_system_controller.get(),
+                 mock_interrupt_controller.get());
+  uart_test.Initialize(38'400);
+  REQUIRE(uart_test.EnableInterrupts() == Status::kSuccess);
+
+  xTaskGetSchedulerState_fake.return_val = taskSCHEDULER_RUNNING;
+
+  SECTION("EnableInterrupts")
+  {
+    Verify(Method(mock_interrupt_controller, Register)
+               .Matching([](sjsu::InterruptController::RegistrationInfo_t
+                                info) {
+                 return info.interrupt_request_number == UART2_IRQn &&
+                        info.interrupt_service_routine == UartInterrupt &&
+                        info.priority == Dma::kInterruptPriority;
+               }))
+        .Once();
+    CHECK(local_uart.IER == kBothInterrupts);
+    // FIFOs enabled, with the receive interrupt at 8 bytes
+    CHECK(local_uart.FCR == 0b1000'0111);
+  }
+  SECTION("Port without interrupt buffers")
+  {
+    const Uart::Port_t kPolledUart = {
+      .registers      = &local_uart,
+      .power_on_id    = sjsu::lpc40xx::SystemController::Peripherals::kUart2,
+      .tx             = mock_pin.get(),
+      .rx             = mock_pin.get(),
+      .tx_function_id = 0b001,
+      .rx_function_id = 0b001,
+    };
+    Uart polled_uart(kPolledUart, mock_system_controller.get(),
+                     mock_interrupt_controller.get());
+    CHECK(polled_uart.EnableInterrupts() == Status::kNotImplemented);
+    CHECK(polled_uart.GetTransmitOverflowCount() == 0);
+  }
+  SECTION("Writes before the scheduler starts are polled")
+  {
+    xTaskGetSchedulerState_fake.return_val = taskSCHEDULER_NOT_STARTED;
+    SetLineStatus(kTransmitHoldingEmpty);
+
+    uart_test.Write({ 'a', 'b', 'c' });
+
+    CHECK(local_uart.THR == 'c');
+    CHECK(buffers->transmit.IsEmpty());
+  }
+  SECTION("Reads before the scheduler starts take the buffered bytes first")
+  {
+    xTaskGetSchedulerState_fake.return_val = taskSCHEDULER_NOT_STARTED;
+    // The interrupt got to the first two bytes
+    buffers->receive.Push('a');
+    buffers->receive.Push('b');
+    *const_cast<volatile uint8_t *>(&local_uart.RBR) = 'c';
+    SetLineStatus(kReceiveDataReady);
+    uint8_t data[3] = { 0 };
+
+    CHECK(uart_test.Read(data, sizeof(data)) == Status::kSuccess);
+
+    CHECK(data[0] == 'a');
+    CHECK(data[1] == 'b');
+    CHECK(data[2] == 'c');
+    CHECK(buffers->receive.IsEmpty());
+    CHECK(xQueueSemaphoreTake_fake.call_count == 0);
+  }
+  SECTION("HasData sees bytes in the buffer and in the FIFO")
+  {
+    xTaskGetSchedulerState_fake.return_val = taskSCHEDULER_NOT_STARTED;
+    CHECK(!uart_test.HasData());
+
+    // Before the scheduler starts, Read() polls the FIFO
+    SetLineStatus(kReceiveDataReady);
+    CHECK(uart_test.HasData());
+
+    SetLineStatus(0);
+    buffers->receive.Push('a');
+    CHECK(uart_test.HasData());
+  }
+  SECTION("Write returns while the transmit FIFO is busy")
+  {
+    SetLineStatus(0);
+    local_uart.THR = 0;
+
+    uart_test.Write({ 'a', 'b', 'c' });
+
+    CHECK(buffers->transmit.Size() == 3);
+    CHECK(local_uart.THR == 0);
+    CHECK(local_uart.IER == kBothInterrupts);
+  }
+  SECTION("Write fills an empty transmit FIFO")
+  {
+    SetLineStatus(kTransmitHoldingEmpty);
+    uint8_t data[40];
+    memset(data, 'x', sizeof(data));
+    data[Uart::kFifoDepth - 1] = 'y';
+
+    uart_test.Write(data, sizeof(data));
+
+    // The interrupt takes it from there
+    CHECK(local_uart.THR == 'y');
+    CHECK(buffers->transmit.Size() == sizeof(data) - Uart::kFifoDepth);
+    CHECK(local_uart.IER == kBothInterrupts);
+  }
+  SECTION("The interrupt refills the transmit FIFO as it empties")
+  {
+    SetLineStatus(0);
+    uint8_t data[40];
+    for (uint8_t i = 0; i < sizeof(data); i++)
+    {
+      data[i] = i;
+    }
+    uart_test.Write(data, sizeof(data));
+
+    SetLineStatus(kTransmitHoldingEmpty);
+    UartInterrupt();
+    CHECK(local_uart.THR == Uart::kFifoDepth - 1);
+    CHECK(buffers->transmit.Size() == sizeof(data) - Uart::kFifoDepth);
+    UartInterrupt();
+    UartInterrupt();
+    CHECK(local_uart.THR == sizeof(data) - 1);
+    CHECK(buffers->transmit.IsEmpty());
+
+    // Nothing left to send
+    local_uart.THR = 0;
+    UartInterrupt();
+    CHECK(local_uart.THR == 0);
+  }
+  SECTION("The interrupt leaves the transmit FIFO alone while Write fills it")
+  {
+    SetLineStatus(0);
+    uart_test.Write({ 'a', 'b', 'c' });
+    local_uart.IER = 0b01;
+    SetLineStatus(kTransmitHoldingEmpty);
+
+    UartInterrupt();
+
+    CHECK(buffers->transmit.Size() == 3);
+  }
+  SECTION("Writes that do not fit are dropped and counted")
+  {
+    SetLineStatus(0);
+    constexpr size_t kCapacity = decltype(buffers->transmit)::Capacity();
+    std::vector<uint8_t> data(kCapacity + 10, 'z');
+
+    uart_test.Write(data.data(), data.size());
+    uart_test.Write('!');
+
+    CHECK(buffers->transmit.IsFull());
+    CHECK(uart_test.GetTransmitOverflowCount() == 11);
+  }
+  SECTION("The interrupt moves received bytes into the buffer")
+  {
+    *const_cast<volatile uint8_t *>(&local_uart.RBR) = 'R';
+    SetLineStatus(kReceiveDataReady);
+
+    UartInterrupt();
+
+    // No more than a FIFO's worth per interrupt
+    CHECK(buffers->receive.Size() == Uart::kFifoDepth);
+    CHECK(uart_test.HasData());
+    // Nobody is waiting
+    CHECK(xQueueGiveFromISR_fake.call_count == 0);
+
+    uint8_t data[Uart::kFifoDepth] = { 0 };
+    CHECK(uart_test.Read(data, sizeof(data)) == Status::kSuccess);
+    CHECK(data[Uart::kFifoDepth - 1] == 'R');
+    CHECK(xQueueSemaphoreTake_fake.call_count == 0);
+    // Nothing left in the FIFO either
+    SetLineStatus(0);
+    CHECK(!uart_test.HasData());
+  }
+  SECTION("Read sleeps until the bytes arrive")
+  {
+    xQueueSemaphoreTake_fake.custom_fake = ReceiveWhileAsleep;
+    uint8_t data[20] = { 0 };
+
+    CHECK(uart_test.Read(data, sizeof(data)) == Status::kSuccess);
+
+    CHECK(xQueueSemaphoreTake_fake.call_count == 2);
+    CHECK(xQueueSemaphoreTake_fake.arg1_val == portMAX_DELAY);
+    CHECK(xQueueGiveFromISR_fake.call_count == 2);
+    // The interrupt wakes the reader through a semaphore of the port's own,
+    // leaving the task's notification alone.
+    CHECK(xQueueGiveFromISR_fake.arg0_val != nullptr);
+    CHECK(xQueueGiveFromISR_fake.arg0_val == xQueueSemaphoreTake_fake.arg0_val);
+    CHECK(ulTaskNotifyTake_fake.call_count == 0);
+    CHECK(data[19] == 'K');
+    CHECK(!buffers->reading);
+  }
+  SECTION("Read times out")
+  {
+    xQueueSemaphoreTake_fake.return_val = pdFALSE;
+    uint8_t data[4];
+
+    CHECK(uart_test.Read(data, sizeof(data), 25ms) == Status::kTimedOut);
+
+    CHECK(xQueueSemaphoreTake_fake.call_count == 1);
+    CHECK(xQueueSemaphoreTake_fake.arg1_val == 25);
+    CHECK(!buffers->reading);
+  }
+  SECTION("Received bytes that do not fit are dropped and counted")
+  {
+    SetLineStatus(kReceiveDataReady);
+    constexpr size_t kCapacity = decltype(buffers->receive)::Capacity();
+
+    for (size_t i = 0; i < kCapacity / Uart::kFifoDepth + 1; i++)
+    {
+      UartInterrupt();
+    }
+
+    CHECK(buffers->receive.IsFull());
+    CHECK(uart_test.GetReceiveOverflowCount() == Uart::kFifoDepth);
+  }
+
+  RESET_FAKE(xTaskGetSchedulerState);
+  RESET_FAKE(xQueueGenericCreateStatic);
+  RESET_FAKE(xQueueGiveFromISR);
+  RESET_FAKE(xQueueSemaphoreTake);
+  interrupting_port = nullptr;
+  sjsu::lpc40xx::SystemController::system_controller = LPC_SC;
+}
+
+namespace
+{
+constexpr size_t kFrameBufferSize = config::kUartFrameBufferSize;
+/// IIR with a character timeout interrupt pending
+constexpr uint32_t kCharacterTimeoutId = 0b1100;
+/// IIR with a receive data available interrupt pending
+constexpr uint32_t kReceiveDataId = 0b0100;
+/// IIR with no interrupt pending
+constexpr uint32_t kNonePendingId = 0b0001;
+
+void RecordFrame(const uint8_t * frame, size_t length, void * context)
+{
+  auto * frames = static_cast<std::vector<std::vector<uint8_t>> *>(context);
+  frames->emplace_back(frame, frame + length);
+}
+
+/// Simulate the GPDMA moving bytes into the half of the frame buffer it is
+/// filling.
+void ReceiveWithDma(Uart::FrameReceiver_t & frames,
+                    const std::vector<uint8_t> & bytes)
+{
+  LPC_GPDMACH_TypeDef * channel = Dma::channels[frames.channel];
+  size_t remaining =
+      bit::Extract(channel->CControl, Dma::Control::kTransferSize);
+  size_t received = kFrameBufferSize - remaining;
+  for (uint8_t byte : bytes)
+  {
+    frames.halves[frames.filling][received++] = byte;
+  }
+  channel->CControl =
+      bit::Insert(channel->CControl,
+                  static_cast<uint32_t>(kFrameBufferSize - received),
+                  Dma::Control::kTransferSize);
+}
+
+void LineGoesIdle()
+{
+  // This register is read only, thus the cast.
+  *const_cast<volatile uint32_t *>(&interrupting_port->registers->IIR) =
+      kCharacterTimeoutId;
+  UartInterrupt();
+}
+
+/// The GPDMA emptied the FIFO, and so cleared the interrupt, before the
+/// handler got to read IIR
+void DmaClearsInterrupt()
+{
+  *const_cast<volatile uint32_t *>(&interrupting_port->registers->IIR) =
+      kNonePendingId;
+  UartInterrupt();
+}
+
+void DmaFillsHalf()
+{
+  *const_cast<volatile uint32_t *>(&Dma::gpdma->IntTCStat) = 0b1;
+  Dma::DmaHandler();
+  *const_cast<volatile uint32_t *>(&Dma::gpdma->IntTCStat) = 0;
+}
+}  // namespace
+
+TEST_CASE("Testing lpc40xx Uart frame mode", "[lpc40xx-Uart]")
+{
+  // Simulate local version of the UART and GPDMA registers
+  LPC_UART_TypeDef local_uart;
+  LPC_GPDMA_TypeDef local_gpdma;
+  LPC_GPDMACH_TypeDef local_channels[Dma::kNumberOfChannels];
+  LPC_SC_TypeDef local_sc;
+  memset(&local_uart, 0, sizeof(local_uart));
+  memset(&local_gpdma, 0, sizeof(local_gpdma));
+  memset(&local_channels, 0, sizeof(local_channels));
+  memset(&local_sc, 0, sizeof(local_sc));
+
+  Dma::gpdma = &local_gpdma;
+  for (uint8_t i = 0; i < Dma::kNumberOfChannels; i++)
+  {
+    Dma::channels[i] = &local_channels[i];
+  }
+  Dma::allocated_channels             = 0;
+  SystemController::system_controller = &local_sc;
+
+  Mock<sjsu::SystemController> mock_system_controller;
+  Fake(Method(mock_system_controller, PowerUpPeripheral));
+  When(Method(mock_system_controller, GetSystemFrequency))
+      .AlwaysReturn(48_MHz);
+  When(Method(mock_system_controller, GetPeripheralClockDivider))
+      .AlwaysReturn(1);
+  Mock<sjsu::InterruptController> mock_interrupt_controller;
+  Fake(Method(mock_interrupt_controller, Register));
+  Mock<sjsu::Pin> mock_pin;
+  Fake(Method(mock_pin, SetPinFunction));
+  Fake(Method(mock_pin, SetPull));
+
+  auto frames = std::make_unique<Uart::FrameReceiver_t>();
+  const Uart::Port_t kMockUart2 = {
+    .registers       = &local_uart,
+    .power_on_id     = sjsu::lpc40xx::SystemController::Peripherals::kUart2,
+    .tx              = mock_pin.get(),
+    .rx              = mock_pin.get(),
+    .tx_function_id  = 0b001,
+    .rx_function_id  = 0b001,
+    .irq_number      = UART2_IRQn,
+    .handler         = UartInterrupt,
+    .receive_request = Dma::Request::kUart2Rx,
+    .frames          = frames.get(),
+  };
+  interrupting_port = &kMockUart2;
+
+  Dma dma(mock_system_controller.get(), mock_interrupt_controller.get());
+  Uart uart_test(kMockUart2, mock_system_controller.get(),
+                 mock_interrupt_controller.get());
+  uart_test.Initialize(115'200);
+
+  std::vector<std::vector<uint8_t>> received;
+  LPC_GPDMACH_TypeDef & channel = local_channels[0];
+  auto half_address             = [&frames](uint8_t half) {
+    return static_cast<uint32_t>(
+        reinterpret_cast<uintptr_t>(frames->halves[half]));
+  };
+
+  SECTION("Enable frame mode")
+  {
+    CHECK(uart_test.EnableFrameMode(dma, {}, RecordFrame, &received) ==
+          Status::kSuccess);
+
+    // FIFOs reset, DMA mode and an 8 byte receive trigger level
+    CHECK(local_uart.FCR == 0b1000'1111);
+    CHECK(bit::Read(local_uart.IER,
+                    Uart::InterruptEnable::kReceiveData.position));
+    Verify(
+        Method(mock_interrupt_controller, Register)
+            .Matching([](sjsu::InterruptController::RegistrationInfo_t info) {
+              return info.interrupt_request_number == UART2_IRQn &&
+                     info.interrupt_service_routine == UartInterrupt &&
+                     info.priority == Dma::kInterruptPriority;
+            }));
+    CHECK(channel.CSrcAddr == static_cast<uint32_t>(reinterpret_cast<uintptr_t>(
+                                  &local_uart.RBR)));
+    CHECK(channel.CDestAddr == half_address(0));
+    CHECK(bit::Extract(channel.CControl, Dma::Control::kTransferSize) ==
+          kFrameBufferSize);
+    CHECK(!bit::Read(channel.CControl,
+                     Dma::Control::kSourceIncrement.position));
+    CHECK(
+        bit::Extract(channel.CConfig, Dma::ChannelConfig::kSourcePeripheral) ==
+        Dma::Request::kUart2Rx.line);
+    CHECK(bit::Extract(channel.CConfig, Dma::ChannelConfig::kTransferType) ==
+          util::Value(Dma::TransferType::kPeripheralToMemory));
+  }
+  SECTION("Ports and formats that frame mode cannot handle")
+  {
+    Uart::Port_t no_dma_port     = kMockUart2;
+    no_dma_port.receive_request  = Dma::Request::kNone;
+    Uart no_dma_uart(no_dma_port, mock_system_controller.get(),
+                     mock_interrupt_controller.get());
+    const uint8_t kHeader[]      = { 0xAA };
+
+    CHECK(no_dma_uart.EnableFrameMode(dma, {}, RecordFrame) ==
+          Status::kNotImplemented);
+    CHECK(uart_test.EnableFrameMode(dma, {}, nullptr) ==
+          Status::kInvalidParameters);
+    CHECK(uart_test.EnableFrameMode(dma,
+                                    { .header        = nullptr,
+                                      .header_length = 0,
+                                      .length        = kFrameBufferSize + 1 },
+                                    RecordFrame) == Status::kInvalidParameters);
+    CHECK(uart_test.EnableFrameMode(
+              dma, { .header = kHeader, .header_length = 2, .length = 1 },
+              RecordFrame) == Status::kInvalidParameters);
+    CHECK(Dma::allocated_channels == 0);
+  }
+  SECTION("Line going idle ends a frame")
+  {
+    REQUIRE(uart_test.EnableFrameMode(dma, {}, RecordFrame, &received) ==
+            Status::kSuccess);
+
+    ReceiveWithDma(*frames, { 1, 2, 3 });
+    // Reaching the trigger level does not end the frame
+    *const_cast<volatile uint32_t *>(&local_uart.IIR) = kReceiveDataId;
+    UartInterrupt();
+    CHECK(received.empty());
+
+    ReceiveWithDma(*frames, { 4, 5 });
+    LineGoesIdle();
+
+    REQUIRE(received.size() == 1);
+    CHECK(received[0] == std::vector<uint8_t>{ 1, 2, 3, 4, 5 });
+    // The GPDMA moves on to the other half right away
+    CHECK(channel.CDestAddr == half_address(1));
+    CHECK(bit::Extract(channel.CControl, Dma::Control::kTransferSize) ==
+          kFrameBufferSize);
+
+    ReceiveWithDma(*frames, { 6 });
+    LineGoesIdle();
+    // Nothing received since the last frame
+    LineGoesIdle();
+
+    REQUIRE(received.size() == 2);
+    CHECK(received[1] == std::vector<uint8_t>{ 6 });
+    CHECK(channel.CDestAddr == half_address(0));
+  }
+  SECTION("A burst taken before the handler runs does not end a frame")
+  {
+    REQUIRE(uart_test.EnableFrameMode(dma, {}, RecordFrame, &received) ==
+            Status::kSuccess);
+
+    // Receive data available, cleared by a burst of 8 bytes
+    ReceiveWithDma(*frames, { 1, 2, 3, 4, 5, 6, 7, 8 });
+    DmaClearsInterrupt();
+    CHECK(received.empty());
+    ReceiveWithDma(*frames, { 9, 10, 11, 12, 13, 14, 15, 16 });
+    DmaClearsInterrupt();
+    CHECK(received.empty());
+
+    // Character timeout, cleared by the GPDMA taking the last byte
+    ReceiveWithDma(*frames, { 17 });
+    DmaClearsInterrupt();
+
+    REQUIRE(received.size() == 1);
+    CHECK(received[0].size() == 17);
+    CHECK(received[0].back() == 17);
+  }
+  SECTION("Fixed length frames longer than a burst come out whole")
+  {
+    const uint8_t kHeader[] = { 0x59, 0x59 };
+    REQUIRE(uart_test.EnableFrameMode(
+                dma, { .header = kHeader, .header_length = 2, .length = 9 },
+                RecordFrame, &received) == Status::kSuccess);
+
+    ReceiveWithDma(*frames, { 0x59, 0x59, 1, 2, 3, 4, 5, 6 });
+    DmaClearsInterrupt();
+    ReceiveWithDma(*frames, { 7 });
+    DmaClearsInterrupt();
+
+    REQUIRE(received.size() == 1);
+    CHECK(received[0] == std::vector<uint8_t>{ 0x59, 0x59, 1, 2, 3, 4, 5, 6,
+                                               7 });
+    CHECK(uart_test.GetFrameDiscardCount() == 0);
+  }
+  SECTION("Nothing pending with bytes left in the FIFO does not end a frame")
+  {
+    REQUIRE(uart_test.EnableFrameMode(dma, {}, RecordFrame, &received) ==
+            Status::kSuccess);
+
+    ReceiveWithDma(*frames, { 1, 2, 3 });
+    local_uart.LSR = bit::Set(uint32_t{ 0 },
+                              Uart::LineStatus::kReceiveDataReady.position);
+    DmaClearsInterrupt();
+    CHECK(received.empty());
+    local_uart.LSR = 0;
+  }
+  SECTION("Filling up half of the buffer ends a frame")
+  {
+    REQUIRE(uart_test.EnableFrameMode(dma, {}, RecordFrame, &received) ==
+            Status::kSuccess);
+    std::vector<uint8_t> bytes(kFrameBufferSize, 0x42);
+
+    ReceiveWithDma(*frames, bytes);
+    DmaFillsHalf();
+
+    REQUIRE(received.size() == 1);
+    CHECK(received[0] == bytes);
+    CHECK(channel.CDestAddr == half_address(1));
+  }
+  SECTION("Fixed length frames resynchronize on their header")
+  {
+    const uint8_t kHeader[] = { 0x59, 0x59 };
+    REQUIRE(uart_test.EnableFrameMode(
+                dma, { .header = kHeader, .header_length = 2, .length = 5 },
+                RecordFrame, &received) == Status::kSuccess);
+
+    // Garbage, a lone header byte, then two back to back frames with the
+    // second split across two DMA transfers
+    const std::vector<uint8_t> kFrames = { 0x59, 0x02, 0x59, 0x59, 1,
+                                           2,    3,    0x59 };
+    std::vector<uint8_t> bytes(kFrameBufferSize - kFrames.size(), 0x00);
+    bytes.insert(bytes.end(), kFrames.begin(), kFrames.end());
+    ReceiveWithDma(*frames, bytes);
+    DmaFillsHalf();
+    CHECK(received.size() == 1);
+    ReceiveWithDma(*frames, { 0x59, 4, 5, 6 });
+    LineGoesIdle();
+
+    REQUIRE(received.size() == 2);
+    CHECK(received[0] == std::vector<uint8_t>{ 0x59, 0x59, 1, 2, 3 });
+    CHECK(received[1] == std::vector<uint8_t>{ 0x59, 0x59, 4, 5, 6 });
+    CHECK(uart_test.GetFrameDiscardCount() ==
+          kFrameBufferSize - kFrames.size() + 2);
+  }
+  SECTION("Idle line drops a partial frame")
+  {
+    const uint8_t kHeader[] = { 0x59 };
+    REQUIRE(uart_test.EnableFrameMode(
+                dma, { .header = kHeader, .header_length = 1, .length = 4 },
+                RecordFrame, &received) == Status::kSuccess);
+
+    // Frame missing a byte, followed by a whole frame after a gap
+    ReceiveWithDma(*frames, { 0x59, 1, 2 });
+    LineGoesIdle();
+    ReceiveWithDma(*frames, { 0x59, 3, 4, 5 });
+    LineGoesIdle();
+
+    REQUIRE(received.size() == 1);
+    CHECK(received[0] == std::vector<uint8_t>{ 0x59, 3, 4, 5 });
+    CHECK(uart_test.GetFrameDiscardCount() == 3);
   }
 
+  interrupting_port       = nullptr;
+  Dma::allocated_channels = 0;
+  Dma::gpdma              = LPC_GPDMA;
+  Dma::channels[0]        = LPC_GPDMACH0;
+  Dma::channels[1]        = LPC_GPDMACH1;
+  Dma::channels[2]        = LPC_GPDMACH2;
+  Dma::channels[3]        = LPC_GPDMACH3;
+  Dma::channels[4]        = LPC_GPDMACH4;
+  Dma::channels[5]        = LPC_GPDMACH5;
+  Dma::channels[6]        = LPC_GPDMACH6;
+  Dma::channels[7]        = LPC_GPDMACH7;
   sjsu::lpc40xx::SystemController::system_controller = LPC_SC;
 }
 }  // namespace sjsu::lpc40xx
@@ -1,14 +1,22 @@
 #pragma once
 
-#include <cmath>
+#include <FreeRTOS.h>
+#include <semphr.h>
+
 #include <cstdint>
 #include <limits>
 
+#include "config.hpp"
 #include "L0_Platform/lpc40xx/LPC40xx.h"
 #include "L0_Platform/lpc17xx/LPC17xx.h"
+#include "L1_Peripheral/cortex/interrupt.hpp"
+#include "L1_Peripheral/lpc40xx/dma.hpp"
 #include "L1_Peripheral/lpc40xx/pin.hpp"
 #include "L1_Peripheral/lpc40xx/system_controller.hpp"
 #include "L1_Peripheral/uart.hpp"
+#include "utility/bit.hpp"
+#include "utility/ring_buffer.hpp"
+#include "utility/rtos.hpp"
 #include "utility/status.hpp"
 #include "utility/time.hpp"
 
@@ -20,167 +28,122 @@ namespace lpc40xx
 {
 namespace uart
 {
-constexpr float kThreshold = 0.05f;
-
+/// Largest baud rate error, in parts per million, that SetBaudRate() accepts.
+/// A receiver samples the middle of each bit, so the two ends of a link can
+/// only drift apart by about half a bit over a frame. Keeping each end within
+/// 1.5% leaves room for the other end's error.
+constexpr int32_t kMaxBaudRateErrorPpm = 15'000;
+
+/// Register values that produce a baud rate along with how close they get:
+///
+///     baud_rate = peripheral_frequency /
+///                 (16 * divide_latch * (1 + divide_add / multiply))
 struct UartCalibration_t
 {
   uint32_t divide_latch = 0;
   uint32_t divide_add   = 0;
   uint32_t multiply     = 1;
+  /// Baud rate the registers above produce, rounded to the nearest integer
+  uint32_t baud_rate = 0;
+  /// Difference between the produced and the requested baud rate, in parts
+  /// per million of the requested baud rate
+  int32_t error_ppm = 0;
 };
 
-constexpr UartCalibration_t FindClosestFractional(float decimal)
+/// Search every divide latch and fractional divider combination for the one
+/// that comes closest to the baud rate. Only integer math is used, so with a
+/// constant baud rate and frequency this can run at compile time:
+///
+///     constexpr auto kCalibration = GenerateUartCalibration(921'600, 48_MHz);
+///     static_assert(kCalibration.error_ppm < kMaxBaudRateErrorPpm);
+///
+/// @return a calibration with a divide_latch of 0 if the baud rate is 0,
+///         otherwise the calibration with the smallest error. The error can
+///         still be large if the baud rate is out of reach of the peripheral
+///         frequency.
+constexpr UartCalibration_t GenerateUartCalibration(
+    uint32_t baud_rate, units::frequency::hertz_t peripheral_frequency)
 {
-  UartCalibration_t result;
-  bool finished = false;
-  for (int div = 0; div < 15 && !finished; div++)
+  UartCalibration_t best;
+  if (baud_rate == 0)
   {
-    for (int mul = div + 1; mul < 15 && !finished; mul++)
-    {
-      float divf         = static_cast<float>(div);
-      float mulf         = static_cast<float>(mul);
-      float test_decimal = 1.0f + divf / mulf;
-      if (decimal <= test_decimal + kThreshold &&
-          decimal >= test_decimal - kThreshold)
-      {
-        result.divide_add = div;
-        result.multiply   = mul;
-        finished          = true;
-      }
-    }
+    return best;
   }
-  return result;
-}
 
-constexpr float DividerEstimate(float baud_rate,
-                                float fraction_estimate       = 1,
-                                uint32_t peripheral_frequency = 1)
-{
-  float clock_frequency = static_cast<float>(peripheral_frequency);
-  return clock_frequency / (16.0f * baud_rate * fraction_estimate);
-}
-
-constexpr float FractionalEstimate(float baud_rate,
-                                   float divider,
-                                   uint32_t peripheral_frequency)
-{
-  float clock_frequency = static_cast<float>(peripheral_frequency);
-  return clock_frequency / (16.0f * baud_rate * divider);
-}
-
-constexpr float RoundFloat(float value)
-{
-  return static_cast<float>(static_cast<int>(value + 0.5f));
-}
+  // Rates are compared in milli-baud to keep a fraction of a baud of
+  // precision for slow baud rates.
+  const uint64_t kFrequency =
+      units::unit_cast<uint32_t>(peripheral_frequency);
+  const uint64_t kTarget   = uint64_t{ baud_rate } * 1000;
+  uint64_t best_rate       = 0;
+  uint64_t best_difference = std::numeric_limits<uint64_t>::max();
 
-constexpr bool IsDecmial(float value)
-{
-  bool result         = false;
-  float rounded_value = RoundFloat(value);
-  float error         = value - rounded_value;
-  if (-kThreshold <= error && error <= kThreshold)
+  for (uint32_t multiply = 1; multiply <= 15; multiply++)
   {
-    result = true;
-  }
-  return result;
-}
-
-enum class States
-{
-  kCalculateIntegerDivideLatch,
-  kCalculateDivideLatchWithDecimal,
-  kDecimalFailedGenerateNewDecimal,
-  kGenerateFractionFromDecimal,
-  kDone
-};
-
-constexpr static UartCalibration_t GenerateUartCalibration(
-    uint32_t baud_rate, units::frequency::hertz_t peripheral_frequency)
-{
-  uint32_t integer_peripheral_frequency =
-      units::unit_cast<uint32_t>(peripheral_frequency);
-  States state = States::kCalculateIntegerDivideLatch;
-  UartCalibration_t uart_calibration;
-  float baud_rate_float = static_cast<float>(baud_rate);
-  float divide_estimate = 0;
-  float decimal         = 1.5;
-  float div             = 1;
-  float mul             = 2;
-  while (state != States::kDone)
-  {
-    switch (state)
+    for (uint32_t divide_add = 0; divide_add < multiply; divide_add++)
     {
-      case States::kCalculateIntegerDivideLatch:
+      // Without a divide_add, multiply has no effect, so try it only once.
+      if (divide_add == 0 && multiply != 1)
       {
-        divide_estimate =
-            DividerEstimate(baud_rate_float, 1, integer_peripheral_frequency);
-
-        if (divide_estimate < 1.0f)
-        {
-          uart_calibration.divide_latch = 0;
-          state                         = States::kDone;
-        }
-        else if (IsDecmial(divide_estimate))
-        {
-          uart_calibration.divide_latch =
-              static_cast<uint32_t>(divide_estimate);
-          state = States::kDone;
-        }
-        else
-        {
-          state = States::kCalculateDivideLatchWithDecimal;
-        }
-        break;
+        continue;
       }
-      case States::kCalculateDivideLatchWithDecimal:
+      // The fractional divider only works with a divide latch of 3 or more.
+      const uint64_t kMinimumLatch = (divide_add == 0) ? 1 : 3;
+      const uint64_t kNumerator    = kFrequency * multiply * 1000;
+      const uint64_t kPerLatch     = 16 * uint64_t{ multiply + divide_add };
+      // The ideal divide latch falls between these two.
+      const uint64_t kLowerLatch = kNumerator / (kTarget * kPerLatch);
+      for (uint64_t latch = kLowerLatch; latch <= kLowerLatch + 1; latch++)
       {
-        divide_estimate = RoundFloat(DividerEstimate(
-            baud_rate_float, decimal, integer_peripheral_frequency));
-        decimal         = FractionalEstimate(
-            baud_rate_float, divide_estimate, integer_peripheral_frequency);
-        if (1.1f <= decimal && decimal <= 1.9f)
+        uint64_t clamped_latch = latch;
+        if (clamped_latch < kMinimumLatch)
         {
-          state = States::kGenerateFractionFromDecimal;
+          clamped_latch = kMinimumLatch;
         }
-        else
+        if (clamped_latch > 0xFFFF)
         {
-          state = States::kDecimalFailedGenerateNewDecimal;
+          clamped_latch = 0xFFFF;
         }
-        break;
-      }
-      case States::kDecimalFailedGenerateNewDecimal:
-      {
-        mul += 1;
-
-        if (div > 15)
+        const uint64_t kDenominator = clamped_latch * kPerLatch;
+        const uint64_t kRate = (kNumerator + kDenominator / 2) / kDenominator;
+        const uint64_t kDifference =
+            (kRate > kTarget) ? kRate - kTarget : kTarget - kRate;
+        if (kDifference < best_difference)
         {
-          state = States::kDone;
-          break;
+          best_difference   = kDifference;
+          best_rate         = kRate;
+          best.divide_latch = static_cast<uint32_t>(clamped_latch);
+          best.divide_add   = divide_add;
+          best.multiply     = multiply;
         }
-        else if (mul > 15)
-        {
-          div += 1;
-          mul = div + 1;
-        }
-        decimal = div / mul;
-        state   = States::kCalculateDivideLatchWithDecimal;
-        break;
       }
-      case States::kGenerateFractionFromDecimal:
-      {
-        uart_calibration              = FindClosestFractional(decimal);
-        uart_calibration.divide_latch = static_cast<uint32_t>(divide_estimate);
-        state                         = States::kDone;
-        break;
-      }
-      case States::kDone:
-      default: break;
     }
   }
-  return uart_calibration;
+
+  best.baud_rate = static_cast<uint32_t>((best_rate + 500) / 1000);
+  best.error_ppm = static_cast<int32_t>(
+      (static_cast<int64_t>(best_rate) - static_cast<int64_t>(kTarget)) *
+      1000 / baud_rate);
+  return best;
 }
 }  // namespace uart
 
+/// By default every byte is written and read by polling the line status
+/// register. After EnableInterrupts(), the port runs from its interrupt
+/// instead:
+///
+///   - Write() copies the data into a transmit ring buffer and returns at once.
+///     The transmit holding register empty interrupt moves the buffer into
+///     the 16 byte transmit FIFO as it drains.
+///   - The receive data available and character timeout interrupts move
+///     received bytes into a receive ring buffer. Read() sleeps on a binary
+///     semaphore, which the interrupt gives as bytes arrive, until enough
+///     have arrived.
+///
+/// Bytes that do not fit in either buffer are dropped and counted, see
+/// GetTransmitOverflowCount() and GetReceiveOverflowCount(). The buffers are
+/// lock free for one writer and one reader, so tasks sharing a port must take
+/// turns. Until the scheduler starts, the port is polled as before.
 class Uart final : public sjsu::Uart
 {
  public:
@@ -189,6 +152,106 @@ class Uart final : public sjsu::Uart
 
   static constexpr uint8_t kStandardUart = 0b011;
 
+  /// Number of bytes each of the transmit and receive FIFOs can hold
+  static constexpr size_t kFifoDepth = 16;
+  /// Bytes the receive FIFO hands the GPDMA at a time in frame mode, which is
+  /// also its trigger level
+  static constexpr size_t kFrameBurstSize = 8;
+
+  // UARTn Interrupt Enable Register
+  struct InterruptEnable  // NOLINT
+  {
+    /// Receive data available and character timeout interrupts
+    static constexpr bit::Mask kReceiveData = bit::CreateMaskFromRange(0);
+    /// Transmit holding register empty interrupt
+    static constexpr bit::Mask kTransmitHoldingEmpty =
+        bit::CreateMaskFromRange(1);
+  };
+  // UARTn FIFO Control Register
+  struct FifoControl  // NOLINT
+  {
+    /// Enable both FIFOs and reset their contents
+    static constexpr uint8_t kEnableAndReset = 0b111;
+    /// Let the FIFOs raise GPDMA requests
+    static constexpr bit::Mask kDmaMode = bit::CreateMaskFromRange(3);
+    /// Number of received bytes that raise the receive data available
+    /// interrupt: 0 = 1 byte, 1 = 4 bytes, 2 = 8 bytes, 3 = 14 bytes
+    static constexpr bit::Mask kReceiveTriggerLevel =
+        bit::CreateMaskFromRange(6, 7);
+  };
+  // UARTn Line Status Register
+  struct LineStatus  // NOLINT
+  {
+    static constexpr bit::Mask kReceiveDataReady = bit::CreateMaskFromRange(0);
+    static constexpr bit::Mask kTransmitHoldingEmpty =
+        bit::CreateMaskFromRange(5);
+  };
+  // UARTn Interrupt Identification Register
+  struct InterruptId  // NOLINT
+  {
+    /// Cleared while an interrupt is pending
+    static constexpr bit::Mask kNonePending = bit::CreateMaskFromRange(0);
+    static constexpr bit::Mask kId          = bit::CreateMaskFromRange(1, 3);
+    /// The receive FIFO holds data, but nothing has arrived for 3.5 to 4.5
+    /// character times
+    static constexpr uint8_t kCharacterTimeout = 0b110;
+  };
+
+  /// Buffers and counters of a port running from its interrupt, shared
+  /// between the tasks using the port and its interrupt handler.
+  struct InterruptBuffers_t
+  {
+    RingBuffer<uint8_t, config::kUartTransmitBufferSize> transmit;
+    RingBuffer<uint8_t, config::kUartReceiveBufferSize> receive;
+    /// Given by the interrupt when bytes arrive while a task is in Read().
+    /// Created by the first Read() that has to wait.
+    StaticSemaphore_t data_ready_buffer;
+    SemaphoreHandle_t volatile data_ready;
+    /// Set while a task is in Read()
+    volatile bool reading;
+    volatile uint32_t transmit_overflows;
+    volatile uint32_t receive_overflows;
+  };
+
+  /// Called from the interrupt with each frame received in frame mode. The
+  /// frame is only valid until the handler returns.
+  using FrameHandler = void (*)(const uint8_t * frame,
+                                size_t length,
+                                void * context);
+
+  /// How frame mode splits the received bytes into frames
+  struct FrameFormat_t
+  {
+    /// Bytes every frame starts with. Bytes that do not lead up to a header
+    /// are discarded, which brings the stream back in line after a byte is
+    /// lost. Only used when length is set.
+    const uint8_t * header;
+    size_t header_length;
+    /// Length of every frame. If 0, a frame ends whenever the line goes idle
+    /// or the frame buffer fills up.
+    size_t length;
+  };
+
+  /// State of a port receiving frames, shared between the port's interrupt
+  /// and the DMA interrupt. Like InterruptBuffers_t, it lives in static
+  /// storage and relies on being zeroed.
+  struct FrameReceiver_t
+  {
+    /// The GPDMA fills one half while the other is handed out
+    uint8_t halves[2][config::kUartFrameBufferSize];
+    /// Frame being put together when frames have a fixed length
+    uint8_t frame[config::kUartFrameBufferSize];
+    size_t frame_position;
+    volatile uint8_t filling;
+    const Dma * dma;
+    bool has_channel;
+    uint8_t channel;
+    FrameFormat_t format;
+    FrameHandler handler;
+    void * context;
+    volatile uint32_t discarded;
+  };
+
   struct Port_t
   {
     LPC_UART_TypeDef * registers;
@@ -197,8 +260,45 @@ class Uart final : public sjsu::Uart
     const sjsu::Pin & rx;
     uint8_t tx_function_id : 3;
     uint8_t rx_function_id : 3;
+    sjsu::cortex::IRQn_Type irq_number = sjsu::cortex::Reset_IRQn;
+    InterruptBuffers_t * buffers       = nullptr;
+    IsrPointer handler                 = nullptr;
+    /// GPDMA request line of the transmit FIFO, see UartDmaWriter
+    Dma::Request_t transmit_request = Dma::Request::kNone;
+    /// GPDMA request line of the receive FIFO, see EnableFrameMode()
+    Dma::Request_t receive_request = Dma::Request::kNone;
+    FrameReceiver_t * frames       = nullptr;
   };
 
+  /// Moves bytes between the FIFOs and the ring buffers of the port. Reading
+  /// IIR acknowledges a transmit holding register empty interrupt, and the
+  /// receive interrupts are acknowledged by emptying the receive FIFO, so
+  /// the handler does both on every interrupt. Each FIFO is serviced at most
+  /// once per interrupt; if more bytes arrive in the meantime, the interrupt
+  /// fires again.
+  ///
+  /// In frame mode, the GPDMA empties the receive FIFO instead, and the
+  /// handler only looks for the line going idle.
+  static void UartHandler(const Port_t & port)
+  {
+    uint32_t interrupt_id = port.registers->IIR;
+    if (port.frames != nullptr && port.frames->dma != nullptr)
+    {
+      ReceiveFrames(port, interrupt_id);
+    }
+    else
+    {
+      ReceiveIntoBuffer(port);
+    }
+    // Write() masks the transmit interrupt while it fills the FIFO itself
+    if (bit::Read(port.registers->IER,
+                  InterruptEnable::kTransmitHoldingEmpty.position) &&
+        TransmitHoldingEmpty(port))
+    {
+      FillTransmitFifo(port);
+    }
+  }
+
   struct Port  // NOLINT
   {
    private:
@@ -214,61 +314,122 @@ class Uart final : public sjsu::Uart
     inline static const Pin kUart4Tx = Pin(1, 29);
     inline static const Pin kUart4Rx = Pin(2, 9);
 
+    inline static InterruptBuffers_t uart0_buffers;
+    inline static InterruptBuffers_t uart2_buffers;
+    inline static InterruptBuffers_t uart3_buffers;
+    inline static InterruptBuffers_t uart4_buffers;
+
+    inline static FrameReceiver_t uart0_frames;
+    inline static FrameReceiver_t uart2_frames;
+    inline static FrameReceiver_t uart3_frames;
+    inline static FrameReceiver_t uart4_frames;
+
+    static void Uart0Handler()
+    {
+      UartHandler(kUart0);
+    }
+    static void Uart2Handler()
+    {
+      UartHandler(kUart2);
+    }
+    static void Uart3Handler()
+    {
+      UartHandler(kUart3);
+    }
+    static void Uart4Handler()
+    {
+      UartHandler(kUart4);
+    }
+
    public:
     inline static const Port_t kUart0 = {
       // NOTE: required since LPC_UART0 is of type LPC_UART0_TypeDef in lpc17xx
       // and LPC_UART_TypeDef in lpc40xx causing a "useless cast" warning when
       // compiled for, some odd reason, for either one being compiled, which
       // would make more sense if it only warned us with lpc40xx.
-      .registers      = reinterpret_cast<LPC_UART_TypeDef *>(LPC_UART0_BASE),
-      .power_on_id    = sjsu::lpc40xx::SystemController::Peripherals::kUart0,
-      .tx             = kUart0Tx,
-      .rx             = kUart0Rx,
-      .tx_function_id = 0b001,
-      .rx_function_id = 0b001,
+      .registers        = reinterpret_cast<LPC_UART_TypeDef *>(LPC_UART0_BASE),
+      .power_on_id      = sjsu::lpc40xx::SystemController::Peripherals::kUart0,
+      .tx               = kUart0Tx,
+      .rx               = kUart0Rx,
+      .tx_function_id   = 0b001,
+      .rx_function_id   = 0b001,
+      .irq_number       = UART0_IRQn,
+      .buffers          = &uart0_buffers,
+      .handler          = Uart0Handler,
+      .transmit_request = Dma::Request::kUart0Tx,
+      .receive_request  = Dma::Request::kUart0Rx,
+      .frames           = &uart0_frames,
     };
 
     inline static const Port_t kUart2 = {
-      .registers      = LPC_UART2,
-      .power_on_id    = sjsu::lpc40xx::SystemController::Peripherals::kUart2,
-      .tx             = kUart2Tx,
-      .rx             = kUart2Rx,
-      .tx_function_id = 0b010,
-      .rx_function_id = 0b010,
+      .registers        = LPC_UART2,
+      .power_on_id      = sjsu::lpc40xx::SystemController::Peripherals::kUart2,
+      .tx               = kUart2Tx,
+      .rx               = kUart2Rx,
+      .tx_function_id   = 0b010,
+      .rx_function_id   = 0b010,
+      .irq_number       = UART2_IRQn,
+      .buffers          = &uart2_buffers,
+      .handler          = Uart2Handler,
+      .transmit_request = Dma::Request::kUart2Tx,
+      .receive_request  = Dma::Request::kUart2Rx,
+      .frames           = &uart2_frames,
     };
 
     inline static const Port_t kUart3 = {
-      .registers      = LPC_UART3,
-      .power_on_id    = sjsu::lpc40xx::SystemController::Peripherals::kUart3,
-      .tx             = kUart3Tx,
-      .rx             = kUart3Rx,
-      .tx_function_id = 0b010,
-      .rx_function_id = 0b010,
+      .registers        = LPC_UART3,
+      .power_on_id      = sjsu::lpc40xx::SystemController::Peripherals::kUart3,
+      .tx               = kUart3Tx,
+      .rx               = kUart3Rx,
+      .tx_function_id   = 0b010,
+      .rx_function_id   = 0b010,
+      .irq_number       = UART3_IRQn,
+      .buffers          = &uart3_buffers,
+      .handler          = Uart3Handler,
+      .transmit_request = Dma::Request::kUart3Tx,
+      .receive_request  = Dma::Request::kUart3Rx,
+      .frames           = &uart3_frames,
     };
 
     inline static const Port_t kUart4 = {
-      .registers      = reinterpret_cast<LPC_UART_TypeDef *>(LPC_UART4),
-      .power_on_id    = sjsu::lpc40xx::SystemController::Peripherals::kUart4,
-      .tx             = kUart4Tx,
-      .rx             = kUart4Rx,
-      .tx_function_id = 0b101,
-      .rx_function_id = 0b011,
+      .registers        = reinterpret_cast<LPC_UART_TypeDef *>(LPC_UART4),
+      .power_on_id      = sjsu::lpc40xx::SystemController::Peripherals::kUart4,
+      .tx               = kUart4Tx,
+      .rx               = kUart4Rx,
+      .tx_function_id   = 0b101,
+      .rx_function_id   = 0b011,
+      .irq_number       = UART4_IRQn,
+      .buffers          = &uart4_buffers,
+      .handler          = Uart4Handler,
+      .transmit_request = Dma::Request::kUart4Tx,
+      .receive_request  = Dma::Request::kUart4Rx,
+      .frames           = &uart4_frames,
     };
   };
 
+  static constexpr sjsu::cortex::InterruptController kInterruptController =
+      sjsu::cortex::InterruptController();
+
   explicit constexpr Uart(const Port_t & port,
                           const sjsu::SystemController & system_controller =
-                              DefaultSystemController())
-      : port_(port), system_controller_(system_controller)
+                              DefaultSystemController(),
+                          const sjsu::InterruptController &
+                              interrupt_controller = kInterruptController)
+      : port_(port),
+        system_controller_(system_controller),
+        interrupt_controller_(interrupt_controller)
   {
   }
 
+  /// @return Status::kInvalidParameters if the baud rate cannot be reached
+  ///         within uart::kMaxBaudRateErrorPpm, in which case the closest
+  ///         baud rate is still used, otherwise Status::kSuccess.
   Status Initialize(uint32_t baud_rate) const override
   {
     constexpr uint8_t kFIFOEnableAndReset = 0b111;
     system_controller_.PowerUpPeripheral(port_.power_on_id);
 
-    SetBaudRate(baud_rate);
+    bool baud_rate_is_accurate = SetBaudRate(baud_rate);
 
     port_.rx.SetPinFunction(port_.rx_function_id);
     port_.tx.SetPinFunction(port_.tx_function_id);
@@ -276,15 +437,31 @@ class Uart final : public sjsu::Uart
     port_.tx.SetPull(sjsu::Pin::Resistor::kPullUp);
     port_.registers->FCR |= kFIFOEnableAndReset;
 
-    return Status::kSuccess;
+    return baud_rate_is_accurate ? Status::kSuccess
+                                 : Status::kInvalidParameters;
   }
 
+  /// @return false if the closest baud rate the peripheral clock can produce
+  ///         is off by more than uart::kMaxBaudRateErrorPpm. The closest baud
+  ///         rate is used either way.
   bool SetBaudRate(uint32_t baud_rate) const override
   {
     uart::UartCalibration_t calibration = uart::GenerateUartCalibration(
         baud_rate,
         system_controller_.GetPeripheralFrequency(port_.power_on_id));
+    SetCalibration(calibration);
 
+    int32_t error_ppm = calibration.error_ppm;
+    return calibration.divide_latch != 0 &&
+           -uart::kMaxBaudRateErrorPpm <= error_ppm &&
+           error_ppm <= uart::kMaxBaudRateErrorPpm;
+  }
+
+  /// Program divider values worked out ahead of time, such as a constexpr
+  /// uart::GenerateUartCalibration() result, skipping the search that
+  /// SetBaudRate() does.
+  void SetCalibration(const uart::UartCalibration_t & calibration) const
+  {
     constexpr uint8_t kDlabBit = (1 << 7);
 
     uint8_t dlm = static_cast<uint8_t>((calibration.divide_latch >> 8) & 0xFF);
@@ -297,11 +474,50 @@ class Uart final : public sjsu::Uart
     port_.registers->DLL = dll;
     port_.registers->FDR = fdr;
     port_.registers->LCR = kStandardUart;
-    return true;
   }
 
+  /// Run the port from its interrupt. Must be called after Initialize().
+  ///
+  /// @return Status::kNotImplemented if the port has no interrupt buffers,
+  ///         otherwise Status::kSuccess.
+  Status EnableInterrupts() const
+  {
+    if (port_.buffers == nullptr || port_.handler == nullptr)
+    {
+      return Status::kNotImplemented;
+    }
+    // Interrupt once 8 bytes have arrived, leaving the other half of the
+    // receive FIFO to absorb the interrupt latency. The character timeout
+    // interrupt picks up anything less.
+    constexpr uint8_t kEightBytes = 0b10;
+    port_.registers->FCR =
+        bit::Insert(uint32_t{ FifoControl::kEnableAndReset }, kEightBytes,
+                    FifoControl::kReceiveTriggerLevel);
+    // The handler wakes waiting tasks through FreeRTOS, so it must not be
+    // more urgent than configMAX_SYSCALL_INTERRUPT_PRIORITY.
+    interrupt_controller_.Register({
+        .interrupt_request_number  = port_.irq_number,
+        .interrupt_service_routine = port_.handler,
+        .priority                  = Dma::kInterruptPriority,
+    });
+    port_.registers->IER =
+        bit::Set(bit::Set(uint32_t{ 0 },
+                          InterruptEnable::kReceiveData.position),
+                 InterruptEnable::kTransmitHoldingEmpty.position);
+    interrupts_enabled_ = true;
+    return Status::kSuccess;
+  }
+
+  /// When the port runs from its interrupt, queue the data to be sent and
+  /// return without waiting for it to go out. Bytes that do not fit in the
+  /// transmit buffer are dropped.
   void Write(const uint8_t * data, size_t size) const override
   {
+    if (IsInterruptDriven())
+    {
+      BufferedWrite(data, size);
+      return;
+    }
     for (size_t i = 0; i < size; i++)
     {
       port_.registers->THR = data[i];
@@ -316,10 +532,27 @@ class Uart final : public sjsu::Uart
               size_t size,
               std::chrono::microseconds timeout = MaxDelay()) const override
   {
+    if (IsInterruptDriven())
+    {
+      return BufferedRead(data, size, timeout);
+    }
     uint32_t position = 0;
     // NOTE: Consider changing this to using a Wait() call.
     return Wait(timeout, [this, &data, size, &position]() -> bool {
-      if (HasData())
+      if (interrupts_enabled_)
+      {
+        // Bytes the interrupt already moved out of the FIFO arrived first.
+        // The interrupt is held off, so that it cannot move the next byte
+        // into the buffer between the two reads.
+        sjsu::cortex::InterruptLock lock;
+        position += static_cast<uint32_t>(
+            port_.buffers->receive.Pop(&data[position], size - position));
+        if (position < size && HasData(port_))
+        {
+          data[position++] = static_cast<uint8_t>(port_.registers->RBR);
+        }
+      }
+      else if (HasData(port_))
       {
         data[position++] = static_cast<uint8_t>(port_.registers->RBR);
       }
@@ -332,17 +565,390 @@ class Uart final : public sjsu::Uart
   }
   bool HasData() const override
   {
-    return bit::Read(port_.registers->LSR, 0);
+    // As with Read(), a byte may be in the buffer or still in the FIFO, which
+    // is polled before the scheduler starts or waits for the interrupt
+    // otherwise.
+    if (interrupts_enabled_ && !port_.buffers->receive.IsEmpty())
+    {
+      return true;
+    }
+    return HasData(port_);
+  }
+
+  /// @return the number of bytes dropped because the transmit buffer was full
+  uint32_t GetTransmitOverflowCount() const
+  {
+    return (port_.buffers != nullptr) ? port_.buffers->transmit_overflows : 0;
+  }
+
+  /// @return the number of bytes dropped because the receive buffer was full
+  uint32_t GetReceiveOverflowCount() const
+  {
+    return (port_.buffers != nullptr) ? port_.buffers->receive_overflows : 0;
+  }
+
+  /// Receive whole frames instead of bytes. The GPDMA moves received bytes
+  /// into one half of a double buffer, and the port's character timeout
+  /// interrupt marks the end of a burst of bytes, so the CPU is only
+  /// involved once per burst rather than once per byte. Each frame is passed
+  /// to the handler from the interrupt.
+  ///
+  /// Frame mode replaces Read() and the receive side of EnableInterrupts().
+  /// Must be called after Initialize() and, if used, EnableInterrupts().
+  ///
+  /// @param dma - GPDMA controller to take a channel from
+  /// @param format - where frames start and end
+  /// @param handler - called with every frame received
+  /// @param context - passed to the handler
+  ///
+  /// @return Status::kNotImplemented if the port cannot receive with DMA,
+  ///         Status::kInvalidParameters if frames would not fit in
+  ///         config::kUartFrameBufferSize or there is no handler,
+  ///         Status::kNotReadyYet if every GPDMA channel is in use,
+  ///         otherwise Status::kSuccess.
+  Status EnableFrameMode(const Dma & dma,
+                         const FrameFormat_t & format,
+                         FrameHandler handler,
+                         void * context = nullptr) const
+  {
+    if (port_.frames == nullptr || port_.handler == nullptr ||
+        (port_.receive_request.line == Dma::Request::kNone.line &&
+         !port_.receive_request.alternate))
+    {
+      return Status::kNotImplemented;
+    }
+    if (handler == nullptr ||
+        format.length > config::kUartFrameBufferSize ||
+        format.header_length > format.length ||
+        (format.header_length != 0 && format.header == nullptr))
+    {
+      return Status::kInvalidParameters;
+    }
+
+    FrameReceiver_t & frames = *port_.frames;
+    if (!frames.has_channel)
+    {
+      dma.Initialize();
+      frames.channel = dma.AllocateChannel();
+      if (frames.channel == Dma::kInvalidChannel)
+      {
+        return Status::kNotReadyYet;
+      }
+      frames.has_channel = true;
+    }
+    frames.format         = format;
+    frames.handler        = handler;
+    frames.context        = context;
+    frames.frame_position = 0;
+    frames.filling        = 0;
+    frames.discarded      = 0;
+    frames.dma            = &dma;
+
+    // The receive FIFO asks the GPDMA for a burst of 8 bytes at a time,
+    // leaving anything less for the character timeout to pick up. Were it to
+    // ask for every byte, the FIFO would never hold any data for the
+    // character timeout to notice.
+    constexpr uint8_t kEightBytes = 0b10;
+    uint32_t fifo_control =
+        bit::Set(uint32_t{ FifoControl::kEnableAndReset },
+                 FifoControl::kDmaMode.position);
+    port_.registers->FCR = static_cast<uint8_t>(bit::Insert(
+        fifo_control, kEightBytes, FifoControl::kReceiveTriggerLevel));
+    StartFrameChunk(port_);
+
+    // Matching the DMA interrupt priority keeps the two handlers from
+    // preempting each other while they swap the buffer halves.
+    interrupt_controller_.Register({
+        .interrupt_request_number  = port_.irq_number,
+        .interrupt_service_routine = port_.handler,
+        .priority                  = Dma::kInterruptPriority,
+    });
+    port_.registers->IER =
+        bit::Set(port_.registers->IER, InterruptEnable::kReceiveData.position);
+    return Status::kSuccess;
+  }
+
+  /// @return the number of received bytes thrown away in frame mode while
+  ///         looking for the start of a frame
+  uint32_t GetFrameDiscardCount() const
+  {
+    return (port_.frames != nullptr) ? port_.frames->discarded : 0;
   }
 
  private:
+  static bool HasData(const Port_t & port)
+  {
+    return bit::Read(port.registers->LSR,
+                     LineStatus::kReceiveDataReady.position);
+  }
+
+  static bool TransmitHoldingEmpty(const Port_t & port)
+  {
+    return bit::Read(port.registers->LSR,
+                     LineStatus::kTransmitHoldingEmpty.position);
+  }
+
+  static void ReceiveIntoBuffer(const Port_t & port)
+  {
+    InterruptBuffers_t & buffers = *port.buffers;
+    bool received                = false;
+    for (size_t i = 0; i < kFifoDepth && HasData(port); i++)
+    {
+      uint8_t byte = static_cast<uint8_t>(port.registers->RBR);
+      if (!buffers.receive.Push(byte))
+      {
+        buffers.receive_overflows = buffers.receive_overflows + 1;
+      }
+      received = true;
+    }
+
+    if (received && buffers.reading)
+    {
+      BaseType_t higher_priority_task_woken = pdFALSE;
+      xSemaphoreGiveFromISR(buffers.data_ready, &higher_priority_task_woken);
+      rtos::YieldFromIsr(higher_priority_task_woken);
+    }
+  }
+
+  static void ReceiveFrames(const Port_t & port, uint32_t interrupt_id)
+  {
+    bool none_pending =
+        bit::Read(interrupt_id, InterruptId::kNonePending.position);
+    bool timed_out = !none_pending &&
+                     bit::Extract(interrupt_id, InterruptId::kId) ==
+                         InterruptId::kCharacterTimeout;
+    if (timed_out || (none_pending && DrainedAfterTimeout(port)))
+    {
+      EndFrameChunk(port, true);
+    }
+  }
+
+  /// The GPDMA reads the receive FIFO on its own, so it can clear the
+  /// interrupt that brought the handler in before the handler reads IIR, and
+  /// finding nothing pending does not say which interrupt it was. Receive
+  /// data available is cleared by a whole burst, in the middle of a stream.
+  /// The character timeout is cleared by the GPDMA taking the last few bytes
+  /// one at a time, which leaves the chunk short of a whole number of bursts.
+  static bool DrainedAfterTimeout(const Port_t & port)
+  {
+    const FrameReceiver_t & frames = *port.frames;
+    size_t moved = config::kUartFrameBufferSize -
+                   frames.dma->GetRemainingLength(frames.channel);
+    return !HasData(port) && (moved % kFrameBurstSize) != 0;
+  }
+
+  /// Point the GPDMA at the half of the frame buffer being filled.
+  static void StartFrameChunk(const Port_t & port)
+  {
+    FrameReceiver_t & frames = *port.frames;
+    frames.dma->Start(
+        frames.channel,
+        {
+            .type                  = Dma::TransferType::kPeripheralToMemory,
+            .source                = &port.registers->RBR,
+            .destination           = frames.halves[frames.filling],
+            .length                = config::kUartFrameBufferSize,
+            .burst                 = Dma::Burst::k8,
+            .increment_source      = false,
+            .increment_destination = true,
+            .source_request        = port.receive_request,
+        },
+        FrameDmaHandler, const_cast<Port_t *>(&port));
+  }
+
+  /// Called from the DMA interrupt when a frame buffer half fills up before
+  /// the line goes idle.
+  static void FrameDmaHandler(Status, void * context)
+  {
+    EndFrameChunk(*static_cast<const Port_t *>(context), false);
+  }
+
+  /// Take the half the GPDMA has been filling, along with anything left in
+  /// the receive FIFO, start the GPDMA on the other half and hand out the
+  /// frames received.
+  ///
+  /// @param idle - true if the line went idle, which ends any frame in
+  ///        progress
+  static void EndFrameChunk(const Port_t & port, bool idle)
+  {
+    FrameReceiver_t & frames = *port.frames;
+    const Dma & dma          = *frames.dma;
+    dma.Halt(frames.channel);
+    size_t length = config::kUartFrameBufferSize -
+                    dma.GetRemainingLength(frames.channel);
+
+    uint8_t * chunk = frames.halves[frames.filling];
+    while (length < config::kUartFrameBufferSize && HasData(port))
+    {
+      chunk[length++] = static_cast<uint8_t>(port.registers->RBR);
+    }
+
+    // Keep filling the same half if nothing arrived
+    if (length != 0)
+    {
+      frames.filling = frames.filling ^ 1;
+    }
+    StartFrameChunk(port);
+    DeliverFrames(frames, chunk, length, idle);
+  }
+
+  static void DeliverFrames(FrameReceiver_t & frames,
+                            const uint8_t * chunk,
+                            size_t length,
+                            bool idle)
+  {
+    const FrameFormat_t & format = frames.format;
+    if (format.length == 0)
+    {
+      if (length != 0)
+      {
+        frames.handler(chunk, length, frames.context);
+      }
+      return;
+    }
+
+    size_t position = frames.frame_position;
+    for (size_t i = 0; i < length; i++)
+    {
+      uint8_t byte = chunk[i];
+      if (position < format.header_length && byte != format.header[position])
+      {
+        // Start over, possibly with this byte as the start of a header.
+        frames.discarded = frames.discarded + static_cast<uint32_t>(position);
+        position         = 0;
+        if (byte != format.header[0])
+        {
+          frames.discarded = frames.discarded + 1;
+          continue;
+        }
+      }
+      frames.frame[position++] = byte;
+      if (position == format.length)
+      {
+        frames.handler(frames.frame, format.length, frames.context);
+        position = 0;
+      }
+    }
+    frames.frame_position = position;
+
+    // Frames are sent back to back, so a gap in the middle of one means
+    // bytes were lost.
+    if (idle && frames.frame_position != 0)
+    {
+      frames.discarded =
+          frames.discarded + static_cast<uint32_t>(frames.frame_position);
+      frames.frame_position = 0;
+    }
+  }
+
+  /// Move up to a FIFO's worth of bytes from the transmit buffer into the
+  /// transmit FIFO, which must be empty.
+  static void FillTransmitFifo(const Port_t & port)
+  {
+    uint8_t byte;
+    for (size_t i = 0; i < kFifoDepth && port.buffers->transmit.Pop(&byte);
+         i++)
+    {
+      port.registers->THR = byte;
+    }
+  }
+
   bool TransmissionComplete() const
   {
-    return bit::Read(port_.registers->LSR, 5);
+    return TransmitHoldingEmpty(port_);
+  }
+
+  /// Before the scheduler starts, interrupts may still be masked by the RTOS,
+  /// so the port is polled until then.
+  bool IsInterruptDriven() const
+  {
+    return interrupts_enabled_ &&
+           xTaskGetSchedulerState() == taskSCHEDULER_RUNNING;
+  }
+
+  void BufferedWrite(const uint8_t * data, size_t size) const
+  {
+    InterruptBuffers_t & buffers = *port_.buffers;
+    size_t queued                = buffers.transmit.Push(data, size);
+    if (queued < size)
+    {
+      buffers.transmit_overflows =
+          buffers.transmit_overflows + static_cast<uint32_t>(size - queued);
+    }
+
+    // The transmit holding register empty interrupt only fires when the FIFO
+    // runs dry, so if it is already empty nothing would ever start sending
+    // the new data. In that case, fill the FIFO here with the interrupt
+    // masked, so that the buffer only has one reader at a time.
+    port_.registers->IER = bit::Clear(
+        port_.registers->IER, InterruptEnable::kTransmitHoldingEmpty.position);
+    if (TransmitHoldingEmpty(port_))
+    {
+      FillTransmitFifo(port_);
+    }
+    port_.registers->IER = bit::Set(
+        port_.registers->IER, InterruptEnable::kTransmitHoldingEmpty.position);
+  }
+
+  Status BufferedRead(uint8_t * data,
+                      size_t size,
+                      std::chrono::microseconds timeout) const
+  {
+    InterruptBuffers_t & buffers = *port_.buffers;
+    const TickType_t kTimeout    = ToTicks(timeout);
+    const TickType_t kStart      = xTaskGetTickCount();
+
+    {
+      sjsu::cortex::InterruptLock lock;
+      if (buffers.data_ready == nullptr)
+      {
+        buffers.data_ready =
+            xSemaphoreCreateBinaryStatic(&buffers.data_ready_buffer);
+      }
+    }
+    // Register as the reader before checking the buffer, so that bytes that
+    // arrive in between still give the semaphore.
+    buffers.reading = true;
+    size_t position = buffers.receive.Pop(data, size);
+    Status status   = Status::kSuccess;
+    while (position < size)
+    {
+      TickType_t elapsed = xTaskGetTickCount() - kStart;
+      TickType_t wait    = portMAX_DELAY;
+      if (kTimeout != portMAX_DELAY)
+      {
+        wait = (elapsed < kTimeout) ? kTimeout - elapsed : 0;
+      }
+      bool notified =
+          (wait != 0 && xSemaphoreTake(buffers.data_ready, wait) == pdTRUE);
+      position += buffers.receive.Pop(&data[position], size - position);
+      if (!notified && position < size)
+      {
+        status = Status::kTimedOut;
+        break;
+      }
+    }
+    buffers.reading = false;
+    return status;
+  }
+
+  /// @return the timeout in RTOS ticks, rounded up
+  static TickType_t ToTicks(std::chrono::microseconds timeout)
+  {
+    constexpr int64_t kMicrosecondsPerTick = 1'000'000 / configTICK_RATE_HZ;
+    if (timeout >= std::chrono::microseconds(static_cast<int64_t>(
+                       portMAX_DELAY - 1) * kMicrosecondsPerTick))
+    {
+      return portMAX_DELAY;
+    }
+    return static_cast<TickType_t>(
+        (timeout.count() + kMicrosecondsPerTick - 1) / kMicrosecondsPerTick);
   }
 
   const Port_t & port_;
   const sjsu::SystemController & system_controller_;
+  const sjsu::InterruptController & interrupt_controller_;
+  mutable bool interrupts_enabled_ = false;
 };
 }  // namespace lpc40xx
 }  // namespace sjsu
@@ -0,0 +1,338 @@
+/// UartDmaWriter lets tasks write to a UART without waiting for the bytes to
+/// be shifted out. Data is appended to one half of a double buffer while the
+/// GPDMA drains the other half into the UART's transmit FIFO. When the GPDMA
+/// finishes, the halves swap and whatever has been appended since is sent.
+///
+/// Order of function calls should be as follows:
+///
+///     1. Constructor (create object)
+///     2. Uart::Initialize(...) for the port
+///     3. Initialize()
+///     4. Write(...) as many times as needed
+///     5. Flush() to push everything out without relying on interrupts, such
+///        as from a fault handler
+///
+/// The buffers are guarded by masking interrupts for a few bytes at a time,
+/// so any task or interrupt may write.
+#pragma once
+
+#include <FreeRTOS.h>
+#include <semphr.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "L1_Peripheral/cortex/interrupt.hpp"
+#include "L1_Peripheral/lpc40xx/dma.hpp"
+#include "L1_Peripheral/lpc40xx/uart.hpp"
+#include "utility/bit.hpp"
+#include "utility/build_info.hpp"
+#include "utility/rtos.hpp"
+#include "utility/status.hpp"
+
+namespace sjsu
+{
+namespace lpc40xx
+{
+template <size_t kBufferSize>
+class UartDmaWriter
+{
+ public:
+  static_assert(0 < kBufferSize && kBufferSize <= Dma::kMaxTransferSize,
+                "Each half of the buffer must fit in a single DMA transfer.");
+
+  /// What Write() does when both halves of the buffer are full
+  enum class FullPolicy : uint8_t
+  {
+    /// Drop the data that does not fit
+    kDrop = 0,
+    /// Wait for the GPDMA to free up a half. Writers that cannot sleep, such
+    /// as interrupts or code running before the scheduler, poll the GPDMA
+    /// instead.
+    kBlock = 1,
+    /// Drop the oldest data that has not started sending, only as much as the
+    /// new data needs
+    kOverwrite = 2,
+  };
+
+  /// Bytes appended with interrupts masked, at most
+  static constexpr size_t kLockedCopySize = 32;
+
+  constexpr UartDmaWriter(const Uart::Port_t & port,
+                          const Dma & dma,
+                          FullPolicy policy = FullPolicy::kBlock)
+      : port_(port), dma_(dma), policy_(policy)
+  {
+  }
+
+  /// Allocate a GPDMA channel and let the UART's transmit FIFO request data
+  /// from it. The UART must already be initialized.
+  ///
+  /// @return Status::kNotImplemented if the port has no GPDMA request line,
+  ///         Status::kNotReadyYet if every GPDMA channel is in use,
+  ///         otherwise Status::kSuccess.
+  Status Initialize()
+  {
+    if (port_.transmit_request.line == Dma::Request::kNone.line &&
+        !port_.transmit_request.alternate)
+    {
+      return Status::kNotImplemented;
+    }
+    if (channel_ != Dma::kInvalidChannel)
+    {
+      return Status::kSuccess;
+    }
+
+    dma_.Initialize();
+    uint8_t channel = dma_.AllocateChannel();
+    if (channel == Dma::kInvalidChannel)
+    {
+      return Status::kNotReadyYet;
+    }
+    port_.registers->FCR =
+        bit::Set(uint32_t{ Uart::FifoControl::kEnableAndReset },
+                 Uart::FifoControl::kDmaMode.position);
+    channel_ = channel;
+    return Status::kSuccess;
+  }
+
+  /// Append data to the buffer and start sending it if the GPDMA is idle.
+  ///
+  /// @return the number of bytes that made it into the buffer, which is less
+  ///         than length if the policy is kDrop and the buffer filled up.
+  size_t Write(const uint8_t * data, size_t length)
+  {
+    // Before the scheduler starts, creating any FreeRTOS object masks the DMA
+    // interrupt, so writers that cannot sleep move the halves along
+    // themselves.
+    bool can_sleep = CanSleep();
+    bool waited    = false;
+    size_t written = 0;
+    while (written < length)
+    {
+      size_t appended;
+      {
+        sjsu::cortex::InterruptLock lock;
+        if (!can_sleep)
+        {
+          PollCompletion();
+        }
+        appended = Append(&data[written], length - written);
+        StartIfIdle();
+      }
+      written += appended;
+      if (appended != 0)
+      {
+        continue;
+      }
+
+      switch (policy_)
+      {
+        case FullPolicy::kDrop:
+          dropped_ += static_cast<uint32_t>(length - written);
+          return written;
+        case FullPolicy::kOverwrite: DropOldest(length - written); break;
+        case FullPolicy::kBlock:
+          WaitForSpace();
+          waited = can_sleep;
+          break;
+      }
+    }
+    if (waited)
+    {
+      PassOnSpace();
+    }
+    return written;
+  }
+
+  /// Send everything in the buffer by polling the GPDMA, then return. Works
+  /// with interrupts masked, so a fault handler can call it to get the last
+  /// output out before it writes to the UART directly.
+  void Flush()
+  {
+    while (true)
+    {
+      sjsu::cortex::InterruptLock lock;
+      PollCompletion();
+      if (!is_sending_ && fill_length_ == 0)
+      {
+        return;
+      }
+    }
+  }
+
+  /// @return the number of bytes dropped because the buffer was full
+  uint32_t GetDroppedCount() const
+  {
+    return dropped_;
+  }
+
+  /// @return the number of bytes waiting to be sent, not counting those the
+  ///         GPDMA is working on
+  size_t GetPendingCount() const
+  {
+    return fill_length_;
+  }
+
+  bool IsSending() const
+  {
+    return is_sending_;
+  }
+
+  /// Called from the DMA interrupt when a half has been sent
+  static void DmaHandler(Status, void * context)
+  {
+    auto * writer = static_cast<UartDmaWriter *>(context);
+    writer->CompleteTransfer();
+
+    SemaphoreHandle_t space = writer->space_;
+    if (space != nullptr)
+    {
+      BaseType_t higher_priority_task_woken = pdFALSE;
+      xSemaphoreGiveFromISR(space, &higher_priority_task_woken);
+      rtos::YieldFromIsr(higher_priority_task_woken);
+    }
+  }
+
+ private:
+  /// Must be called with interrupts masked.
+  size_t Append(const uint8_t * data, size_t length)
+  {
+    size_t space = kBufferSize - fill_length_;
+    size_t count = (length < space) ? length : space;
+    if (count > kLockedCopySize)
+    {
+      count = kLockedCopySize;
+    }
+    memcpy(&buffers_[filling_][fill_length_], data, count);
+    fill_length_ += count;
+    return count;
+  }
+
+  /// Make room for up to length bytes, kLockedCopySize at most, by dropping
+  /// the oldest bytes of the filling half. The bytes after them are moved
+  /// down with interrupts masked, as the DMA interrupt may hand the half to
+  /// the GPDMA at any time.
+  void DropOldest(size_t length)
+  {
+    sjsu::cortex::InterruptLock lock;
+    size_t count = (length < kLockedCopySize) ? length : kLockedCopySize;
+    if (count > fill_length_)
+    {
+      count = fill_length_;
+    }
+    uint8_t * buffer = buffers_[filling_];
+    memmove(buffer, &buffer[count], fill_length_ - count);
+    fill_length_ -= count;
+    dropped_ += static_cast<uint32_t>(count);
+  }
+
+  /// Hand the filling half to the GPDMA if it is idle and there is anything
+  /// to send. Must be called with interrupts masked.
+  void StartIfIdle()
+  {
+    if (is_sending_ || fill_length_ == 0)
+    {
+      return;
+    }
+    Dma::Transfer_t transfer = {
+      .type                  = Dma::TransferType::kMemoryToPeripheral,
+      .source                = buffers_[filling_],
+      .destination           = &port_.registers->THR,
+      .length                = fill_length_,
+      .increment_source      = true,
+      .increment_destination = false,
+      .destination_request   = port_.transmit_request,
+    };
+    if (dma_.Start(channel_, transfer, DmaHandler, this) != Status::kSuccess)
+    {
+      return;
+    }
+    is_sending_  = true;
+    filling_     = filling_ ^ 1;
+    fill_length_ = 0;
+  }
+
+  void CompleteTransfer()
+  {
+    sjsu::cortex::InterruptLock lock;
+    is_sending_ = false;
+    StartIfIdle();
+  }
+
+  /// Finish the transfer in progress if the GPDMA is done with it, for when
+  /// the DMA interrupt cannot run. Must be called with interrupts masked.
+  void PollCompletion()
+  {
+    if (channel_ != Dma::kInvalidChannel && !dma_.IsBusy(channel_))
+    {
+      CompleteTransfer();
+    }
+  }
+
+  void WaitForSpace()
+  {
+    if (CanSleep())
+    {
+      // The semaphore belongs to the writer rather than the task, so waiting
+      // on it cannot use up a notification meant for something else. The
+      // buffer was full, so a half is on its way out and its DMA interrupt
+      // will give the semaphore.
+      xSemaphoreTake(SpaceSemaphore(), portMAX_DELAY);
+      return;
+    }
+    sjsu::cortex::InterruptLock lock;
+    PollCompletion();
+  }
+
+  /// Each half sent wakes a single waiting writer. A writer that waited
+  /// passes the wake up on once it is done, if it left room in the buffer,
+  /// so another writer waiting for space does not sleep through it.
+  void PassOnSpace()
+  {
+    if (fill_length_ < kBufferSize)
+    {
+      xSemaphoreGive(space_);
+    }
+  }
+
+  /// Created on the first wait, once the scheduler is running, as creating it
+  /// earlier would mask the DMA interrupt until the scheduler starts.
+  SemaphoreHandle_t SpaceSemaphore()
+  {
+    sjsu::cortex::InterruptLock lock;
+    if (space_ == nullptr)
+    {
+      space_ = xSemaphoreCreateBinaryStatic(&space_buffer_);
+    }
+    return space_;
+  }
+
+  bool CanSleep() const
+  {
+    bool in_interrupt = false;
+    if constexpr (build::kTarget != build::Target::HostTest)
+    {
+      in_interrupt = (sjsu::cortex::__get_IPSR() != 0);
+    }
+    return !in_interrupt && xTaskGetSchedulerState() == taskSCHEDULER_RUNNING;
+  }
+
+  const Uart::Port_t & port_;
+  const Dma & dma_;
+  FullPolicy policy_;
+  uint8_t channel_ = Dma::kInvalidChannel;
+  uint8_t buffers_[2][kBufferSize];
+  /// Half that Write() appends to, the other half belongs to the GPDMA while
+  /// is_sending_ is true
+  volatile uint8_t filling_     = 0;
+  volatile size_t fill_length_  = 0;
+  volatile bool is_sending_     = false;
+  volatile uint32_t dropped_    = 0;
+  /// Given by the DMA interrupt each time a half has been sent
+  StaticSemaphore_t space_buffer_;
+  SemaphoreHandle_t volatile space_ = nullptr;
+};
+}  // namespace lpc40xx
+}  // namespace sjsu
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+
 #include "L1_Peripheral/lpc40xx/pin.hpp"
 #include "utility/status.hpp"
 #include "utility/units.hpp"
@@ -44,6 +47,19 @@ class Spi
   ///
   /// @return byte read from the external device.
   virtual uint16_t Transfer(uint16_t data) const = 0;
+  /// Exchange a block of frames with the external device. Intended for data
+  /// sizes of 8 bits or less, where each frame fits in a single byte.
+  ///
+  /// @param transmit - bytes to send. If nullptr, fill_byte is sent in place
+  ///        of each frame.
+  /// @param receive - buffer to store the received bytes. If nullptr, the
+  ///        received bytes are discarded.
+  /// @param length - number of frames to exchange.
+  /// @param fill_byte - value sent for each frame when transmit is nullptr.
+  virtual void Transfer(const uint8_t * transmit,
+                        uint8_t * receive,
+                        size_t length,
+                        uint8_t fill_byte) const = 0;
   /// Set the number of bits to transmit over SPI
   ///
   /// @param size - number of bits to transmit over spi
@@ -58,5 +74,39 @@ class Spi
   virtual void SetClock(units::frequency::hertz_t frequency,
                         bool positive_clock_on_idle = false,
                         bool read_miso_on_rising    = false) const = 0;
+  /// @returns the clock frequency the bus is actually running at, which may
+  ///          be lower than the frequency given to SetClock().
+  virtual units::frequency::hertz_t GetClock() const = 0;
+
+  // ==============================
+  // Utility Methods
+  // ==============================
+
+  /// Exchange a block of frames, sending 0xFF for each frame when transmit is
+  /// nullptr. See the virtual Transfer() above.
+  void Transfer(const uint8_t * transmit,
+                uint8_t * receive,
+                size_t length) const
+  {
+    Transfer(transmit, receive, length, 0xFF);
+  }
+  /// Send a block of bytes and discard everything received.
+  ///
+  /// @param transmit - bytes to send.
+  /// @param length - number of bytes to send.
+  void Write(const uint8_t * transmit, size_t length) const
+  {
+    Transfer(transmit, nullptr, length);
+  }
+  /// Read a block of bytes, clocking out fill_byte for each byte read.
+  ///
+  /// @param receive - buffer to store the received bytes.
+  /// @param length - number of bytes to read.
+  /// @param fill_byte - value to send while reading, most devices expect
+  ///        MOSI to be held high (0xFF).
+  void Read(uint8_t * receive, size_t length, uint8_t fill_byte = 0xFF) const
+  {
+    Transfer(nullptr, receive, length, fill_byte);
+  }
 };
 }  // namespace sjsu
@@ -8,6 +8,7 @@ TESTS += $(LIBRARY_DIR)/L2_HAL/test/example_test.cpp
 TESTS += $(LIBRARY_DIR)/L2_HAL/audio/test/buzzer_test.cpp
 
 TESTS += $(LIBRARY_DIR)/L2_HAL/communication/test/esp8266_test.cpp
+TESTS += $(LIBRARY_DIR)/L2_HAL/communication/test/spi_bus_test.cpp
 
 # TESTS += $(LIBRARY_DIR)/L2_HAL/displays/lcd/test/st7066u_test.cpp
 TESTS += $(LIBRARY_DIR)/L2_HAL/displays/led/test/onboard_led_test.cpp
@@ -23,5 +24,10 @@ TESTS += $(LIBRARY_DIR)/L2_HAL/sensors/distance/time_of_flight/test/tfmini_test.
 TESTS += $(LIBRARY_DIR)/L2_HAL/switches/test/button_test.cpp
 
 TESTS += $(LIBRARY_DIR)/L2_HAL/memory/test/sd_test.cpp
+TESTS += $(LIBRARY_DIR)/L2_HAL/memory/test/sd_mci_test.cpp
+TESTS += $(LIBRARY_DIR)/L2_HAL/memory/test/sector_cache_test.cpp
+TESTS += $(LIBRARY_DIR)/L2_HAL/memory/test/sd_disk_test.cpp
+TESTS += $(LIBRARY_DIR)/L2_HAL/memory/test/sd_request_queue_test.cpp
+TESTS += $(LIBRARY_DIR)/L2_HAL/memory/test/block_log_test.cpp
 
 TESTS += $(LIBRARY_DIR)/L2_HAL/actuators/servo/test/servo_test.cpp
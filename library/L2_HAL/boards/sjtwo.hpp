@@ -1,12 +1,17 @@
 #pragma once
 
+#include "L1_Peripheral/crc.hpp"
+#include "L1_Peripheral/lpc40xx/crc.hpp"
+#include "L1_Peripheral/lpc40xx/dma.hpp"
 #include "L1_Peripheral/lpc40xx/gpio.hpp"
 #include "L1_Peripheral/lpc40xx/i2c.hpp"
 #include "L1_Peripheral/lpc40xx/spi.hpp"
 
+#include "L2_HAL/communication/spi_bus.hpp"
 #include "L2_HAL/displays/led/onboard_led.hpp"
 #include "L2_HAL/displays/oled/ssd1306.hpp"
 #include "L2_HAL/memory/sd.hpp"
+#include "L2_HAL/memory/sd_mci.hpp"
 #include "L2_HAL/sensors/environment/temperature/si7060.hpp"
 #include "L2_HAL/sensors/movement/accelerometer/mma8452q.hpp"
 #include "L2_HAL/sensors/optical/apds9960.hpp"
@@ -15,6 +20,8 @@
 
 struct sjtwo // NOLINT
 {
+  inline static sjsu::lpc40xx::Dma dma = sjsu::lpc40xx::Dma();
+
   inline static sjsu::lpc40xx::Spi spi0 =
       sjsu::lpc40xx::Spi(sjsu::lpc40xx::Spi::Bus::kSpi0);
   inline static sjsu::lpc40xx::Spi spi1 =
@@ -22,6 +29,11 @@ struct sjtwo // NOLINT
   inline static sjsu::lpc40xx::Spi spi2 =
       sjsu::lpc40xx::Spi(sjsu::lpc40xx::Spi::Bus::kSpi2);
 
+  // Devices on the same SPI bus take turns through these, rather than using
+  // the peripherals above directly.
+  inline static sjsu::SpiBus spi1_bus = sjsu::SpiBus(spi1);
+  inline static sjsu::SpiBus spi2_bus = sjsu::SpiBus(spi2);
+
   inline static sjsu::lpc40xx::I2c i2c0 =
       sjsu::lpc40xx::I2c(sjsu::lpc40xx::I2c::Bus::kI2c0);
   inline static sjsu::lpc40xx::I2c i2c1 =
@@ -33,7 +45,13 @@ struct sjtwo // NOLINT
   {
     static sjsu::lpc40xx::Gpio oled_cs = sjsu::lpc40xx::Gpio(1, 22);
     static sjsu::lpc40xx::Gpio oled_dc = sjsu::lpc40xx::Gpio(1, 25);
-    static sjsu::Ssd1306 oled_display(spi1, oled_cs, oled_dc);
+    // Page writes are longer than the SSP FIFO, so let the SSP interrupt feed
+    // them while the drawing task sleeps.
+    [[maybe_unused]] static sjsu::Status interrupt_status =
+        spi1.EnableInterrupts();
+    static sjsu::SpiDevice oled_spi(spi1_bus, oled_cs, { .frequency = 2_MHz });
+    static sjsu::Ssd1306 oled_display(oled_spi, oled_spi.GetChipSelect(),
+                                      oled_dc);
     static sjsu::Graphics oled(&oled_display);
     return oled;
   }
@@ -50,11 +68,42 @@ struct sjtwo // NOLINT
     return accelerometer;
   }
 
-  [[gnu::always_inline]] inline static sjsu::Sd & SdCard()
+  [[gnu::always_inline]] inline static const sjsu::Crc & Crc()
+  {
+    if constexpr (config::kUseHardwareCrc)
+    {
+      static sjsu::lpc40xx::Crc crc = sjsu::lpc40xx::Crc();
+      // Fall back to the lookup tables if the engine fails its self check
+      static bool is_usable = (crc.Initialize() == sjsu::Status::kSuccess);
+      if (is_usable)
+      {
+        [[maybe_unused]] static sjsu::Status dma_status = crc.EnableDma(dma);
+        return crc;
+      }
+    }
+    return sjsu::DefaultCrc();
+  }
+
+  [[gnu::always_inline]] inline static sjsu::SdInterface & SdCard()
   {
-    static sjsu::lpc40xx::Gpio sd_cs = sjsu::lpc40xx::Gpio(1, 8);
-    static sjsu::Sd sd(spi2, sd_cs);
-    return sd;
+    if constexpr (config::kSdUseMci)
+    {
+      static sjsu::lpc40xx::SdMci sd(sjsu::lpc40xx::SdMci::Bus::kSdCard, dma);
+      return sd;
+    }
+    else
+    {
+      static sjsu::lpc40xx::Gpio sd_cs = sjsu::lpc40xx::Gpio(1, 8);
+      // Let the GPDMA move block data so the calling task can sleep while the
+      // card is streaming a block.
+      [[maybe_unused]] static sjsu::Status dma_status = spi2.EnableDma(dma);
+      [[maybe_unused]] static sjsu::Status interrupt_status =
+          spi2.EnableInterrupts();
+      static sjsu::SpiDevice sd_spi(
+          spi2_bus, sd_cs, { .frequency = sjsu::Sd::kIdentificationClock });
+      static sjsu::Sd sd(sd_spi, sd_spi.GetChipSelect(), Crc());
+      return sd;
+    }
   }
 
   [[gnu::always_inline]] inline static sjsu::Apds9960 & Gesture()
@@ -0,0 +1,368 @@
+/// SpiBus and SpiDevice let several devices, used from several tasks, share a
+/// single SPI bus.
+///
+///   - Each device declares its clock, mode and frame size once, in a
+///     SpiDevice::Configuration_t.
+///   - A device holds the bus from the moment its chip select is asserted
+///     until it is deasserted, so no other task can clock the bus while the
+///     device is selected.
+///   - The bus remembers the configuration it was last given, and only writes
+///     the peripheral's registers when a device with a different
+///     configuration takes it over.
+///
+/// SpiDevice is itself a sjsu::Spi, and GetChipSelect() is a sjsu::Gpio, so
+/// drivers written against those interfaces share a bus without changes:
+///
+///     SpiBus bus(spi2);
+///     SpiDevice sd_spi(bus, sd_cs, { .frequency = 400_kHz });
+///     Sd sd(sd_spi, sd_spi.GetChipSelect());
+///
+/// A driver calling SetClock() or SetDataSize() on its SpiDevice only changes
+/// that device's configuration, which is applied the next time the device
+/// takes the bus.
+#pragma once
+
+#include <FreeRTOS.h>
+#include <semphr.h>
+#include <task.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "L1_Peripheral/cortex/interrupt.hpp"
+#include "L1_Peripheral/gpio.hpp"
+#include "L1_Peripheral/spi.hpp"
+#include "utility/rtos.hpp"
+#include "utility/status.hpp"
+#include "utility/units.hpp"
+
+namespace sjsu
+{
+class SpiBus
+{
+ public:
+  /// Settings a device needs the bus to be in while it is selected
+  struct Configuration_t
+  {
+    units::frequency::hertz_t frequency = 1_MHz;
+    Spi::DataSize data_size             = Spi::DataSize::kEight;
+    bool positive_clock_on_idle         = false;
+    bool read_miso_on_rising            = false;
+
+    bool operator==(const Configuration_t & other) const
+    {
+      return frequency == other.frequency && data_size == other.data_size &&
+             positive_clock_on_idle == other.positive_clock_on_idle &&
+             read_miso_on_rising == other.read_miso_on_rising;
+    }
+  };
+
+  explicit constexpr SpiBus(const Spi & spi) : spi_(spi) {}
+
+  /// Initialize the peripheral. Only the first call does anything, so every
+  /// device on the bus can call it.
+  Status Initialize() const
+  {
+    if (is_initialized_)
+    {
+      return Status::kSuccess;
+    }
+    Status status = spi_.Initialize();
+    if (status == Status::kSuccess)
+    {
+      is_initialized_ = true;
+    }
+    return status;
+  }
+
+  /// Wait until the bus is free, then bring it to the given configuration.
+  /// Every call must be paired with a call to Release().
+  void Acquire(const Configuration_t & configuration) const
+  {
+    if (IsShared())
+    {
+      xSemaphoreTake(Mutex(), portMAX_DELAY);
+      is_locked_ = true;
+    }
+    Configure(configuration);
+  }
+
+  /// Bring the bus to the given configuration, if it is not in it already.
+  /// Must only be called while the bus is held.
+  void Configure(const Configuration_t & configuration) const
+  {
+    if (!is_configured_ || !(configuration == configuration_))
+    {
+      spi_.SetDataSize(configuration.data_size);
+      spi_.SetClock(configuration.frequency,
+                    configuration.positive_clock_on_idle,
+                    configuration.read_miso_on_rising);
+      configuration_ = configuration;
+      is_configured_ = true;
+      reconfigurations_++;
+    }
+  }
+
+  /// Let other devices use the bus. Does nothing if the calling task is not
+  /// the one holding the bus.
+  void Release() const
+  {
+    // A device that took the bus before the scheduler started never took the
+    // mutex, so there is nothing to give back. Neither is there for a task
+    // that does not hold the mutex, as giving it would let the task that
+    // does share the bus with a third.
+    if (is_locked_ && IsHeldByCallingTask())
+    {
+      is_locked_ = false;
+      xSemaphoreGive(mutex_);
+    }
+  }
+
+  /// @return the peripheral, which must only be used while the bus is held
+  const Spi & GetSpi() const
+  {
+    return spi_;
+  }
+
+  /// @return the number of times Acquire() had to reconfigure the peripheral
+  uint32_t GetReconfigurationCount() const
+  {
+    return reconfigurations_;
+  }
+
+ private:
+  /// Before the scheduler starts there is only one thread of execution, so
+  /// there is nothing to lock against.
+  bool IsShared() const
+  {
+    return xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED;
+  }
+
+  bool IsHeldByCallingTask() const
+  {
+    return xSemaphoreGetMutexHolder(mutex_) == xTaskGetCurrentTaskHandle();
+  }
+
+  /// The mutex is created the first time the bus is shared. Creating it any
+  /// earlier, such as in Initialize(), would mask interrupts until the
+  /// scheduler starts.
+  SemaphoreHandle_t Mutex() const
+  {
+    // Interrupts are held off, so that two tasks cannot both create it
+    sjsu::cortex::InterruptLock lock;
+    if (mutex_ == nullptr)
+    {
+      mutex_ = xSemaphoreCreateMutexStatic(&mutex_buffer_);
+    }
+    return mutex_;
+  }
+
+  const Spi & spi_;
+  mutable StaticSemaphore_t mutex_buffer_ = {};
+  mutable SemaphoreHandle_t mutex_        = nullptr;
+  mutable bool is_locked_                 = false;
+  mutable bool is_initialized_            = false;
+  mutable bool is_configured_             = false;
+  mutable Configuration_t configuration_;
+  mutable uint32_t reconfigurations_ = 0;
+};
+
+class SpiDevice final : public Spi
+{
+ public:
+  using Spi::Transfer;
+  using Configuration_t = SpiBus::Configuration_t;
+
+  /// Chip select to hand to the device's driver. Asserting it takes the bus
+  /// and deasserting it gives the bus back.
+  class ChipSelect final : public Gpio
+  {
+   public:
+    explicit constexpr ChipSelect(const SpiDevice & device) : device_(device)
+    {
+    }
+    void SetDirection(Direction direction) const override
+    {
+      device_.chip_select_.SetDirection(direction);
+    }
+    void Set(State output) const override
+    {
+      if (output == State::kLow)
+      {
+        device_.Select();
+      }
+      else
+      {
+        device_.Deselect();
+      }
+    }
+    void Toggle() const override
+    {
+      Set(device_.IsSelected() ? State::kHigh : State::kLow);
+    }
+    bool Read() const override
+    {
+      return device_.chip_select_.Read();
+    }
+    const sjsu::Pin & GetPin() const override
+    {
+      return device_.chip_select_.GetPin();
+    }
+    void AttachInterrupt(IsrPointer function, Edge edge) const override
+    {
+      device_.chip_select_.AttachInterrupt(function, edge);
+    }
+    void DetachInterrupt() const override
+    {
+      device_.chip_select_.DetachInterrupt();
+    }
+
+   private:
+    const SpiDevice & device_;
+  };
+
+  /// @param bus - bus the device is on
+  /// @param chip_select - active low chip select of the device
+  /// @param configuration - settings the device needs, which the device's
+  ///        driver can change with SetClock() and SetDataSize()
+  constexpr SpiDevice(const SpiBus & bus,
+                      const Gpio & chip_select,
+                      Configuration_t configuration)
+      : bus_(bus),
+        chip_select_(chip_select),
+        configuration_(configuration),
+        chip_select_adapter_(*this)
+  {
+  }
+
+  /// Deselect the device and initialize the bus, if it has not been already
+  Status Initialize() const override
+  {
+    chip_select_.SetDirection(Gpio::Direction::kOutput);
+    chip_select_.Set(Gpio::State::kHigh);
+    return bus_.Initialize();
+  }
+
+  uint16_t Transfer(uint16_t data) const override
+  {
+    Hold hold(*this);
+    return bus_.GetSpi().Transfer(data);
+  }
+
+  void Transfer(const uint8_t * transmit,
+                uint8_t * receive,
+                size_t length,
+                uint8_t fill_byte) const override
+  {
+    Hold hold(*this);
+    bus_.GetSpi().Transfer(transmit, receive, length, fill_byte);
+  }
+
+  /// Takes effect the next time the device takes the bus, or at once if the
+  /// device is selected
+  void SetDataSize(DataSize size) const override
+  {
+    configuration_.data_size = size;
+    ApplyIfSelected();
+  }
+
+  /// Takes effect the next time the device takes the bus, or at once if the
+  /// device is selected
+  void SetClock(units::frequency::hertz_t frequency,
+                bool positive_clock_on_idle = false,
+                bool read_miso_on_rising    = false) const override
+  {
+    configuration_.frequency              = frequency;
+    configuration_.positive_clock_on_idle = positive_clock_on_idle;
+    configuration_.read_miso_on_rising    = read_miso_on_rising;
+    ApplyIfSelected();
+  }
+
+  /// @returns the clock the bus runs at for this device
+  units::frequency::hertz_t GetClock() const override
+  {
+    Hold hold(*this);
+    return bus_.GetSpi().GetClock();
+  }
+
+  /// Take the bus and assert the chip select
+  void Select() const
+  {
+    if (!is_selected_)
+    {
+      bus_.Acquire(configuration_);
+      is_selected_ = true;
+    }
+    chip_select_.Set(Gpio::State::kLow);
+  }
+
+  /// Deassert the chip select and give the bus back
+  void Deselect() const
+  {
+    chip_select_.Set(Gpio::State::kHigh);
+    if (is_selected_)
+    {
+      is_selected_ = false;
+      bus_.Release();
+    }
+  }
+
+  bool IsSelected() const
+  {
+    return is_selected_;
+  }
+
+  const Configuration_t & GetConfiguration() const
+  {
+    return configuration_;
+  }
+
+  /// @return the chip select to give to the device's driver in place of the
+  ///         real one
+  ChipSelect & GetChipSelect()
+  {
+    return chip_select_adapter_;
+  }
+
+ private:
+  void ApplyIfSelected() const
+  {
+    if (is_selected_)
+    {
+      bus_.Configure(configuration_);
+    }
+  }
+
+  /// Holds the bus for a transfer made while the device is not selected, such
+  /// as the clocks an SD card needs before its first command.
+  class Hold
+  {
+   public:
+    explicit Hold(const SpiDevice & device)
+        : device_(device), is_holding_(!device.is_selected_)
+    {
+      if (is_holding_)
+      {
+        device_.bus_.Acquire(device_.configuration_);
+      }
+    }
+    ~Hold()
+    {
+      if (is_holding_)
+      {
+        device_.bus_.Release();
+      }
+    }
+
+   private:
+    const SpiDevice & device_;
+    bool is_holding_;
+  };
+
+  const SpiBus & bus_;
+  const Gpio & chip_select_;
+  mutable Configuration_t configuration_;
+  mutable bool is_selected_ = false;
+  ChipSelect chip_select_adapter_;
+};
+}  // namespace sjsu
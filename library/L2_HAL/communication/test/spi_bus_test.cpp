@@ -0,0 +1,310 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "L2_HAL/communication/spi_bus.hpp"
+#include "L2_HAL/memory/sd.hpp"
+#include "L4_Testing/sd_card_emulator.hpp"
+#include "L4_Testing/testing_frameworks.hpp"
+
+namespace sjsu
+{
+namespace
+{
+/// Everything the peripheral, chip selects and bus mutex were asked to do, in
+/// order
+std::vector<std::string> events;
+
+class RecordingSpi final : public Spi
+{
+ public:
+  Status Initialize() const override
+  {
+    events.push_back("initialize");
+    return Status::kSuccess;
+  }
+  uint16_t Transfer(uint16_t data) const override
+  {
+    events.push_back("transfer " + std::to_string(data));
+    return static_cast<uint16_t>(data + 1);
+  }
+  void Transfer(const uint8_t *, uint8_t *, size_t length, uint8_t) const
+      override
+  {
+    events.push_back("block " + std::to_string(length));
+  }
+  void SetDataSize(DataSize size) const override
+  {
+    events.push_back("size " + std::to_string(util::Value(size) + 4));
+  }
+  void SetClock(units::frequency::hertz_t frequency,
+                bool positive_clock_on_idle,
+                bool read_miso_on_rising) const override
+  {
+    clock_ = frequency;
+    events.push_back("clock " + std::to_string(frequency.to<uint32_t>()) +
+                     (positive_clock_on_idle ? " cpol" : "") +
+                     (read_miso_on_rising ? " cpha" : ""));
+  }
+  units::frequency::hertz_t GetClock() const override
+  {
+    return clock_;
+  }
+
+ private:
+  mutable units::frequency::hertz_t clock_ = 0_Hz;
+};
+
+class RecordingGpio final : public Gpio
+{
+ public:
+  explicit RecordingGpio(const char * name) : name_(name) {}
+  void SetDirection(Direction) const override {}
+  void Set(State output) const override
+  {
+    level_ = output;
+    events.push_back(name_ + ((output == State::kLow) ? " low" : " high"));
+  }
+  void Toggle() const override {}
+  bool Read() const override
+  {
+    return level_ == State::kHigh;
+  }
+  const sjsu::Pin & GetPin() const override
+  {
+    return pin_;
+  }
+  void AttachInterrupt(IsrPointer, Edge) const override {}
+  void DetachInterrupt() const override {}
+
+ private:
+  std::string name_;
+  mutable State level_ = State::kHigh;
+  lpc40xx::Pin pin_    = lpc40xx::Pin(0, 0);
+};
+
+QueueHandle_t CreateMutexStatic(uint8_t, StaticQueue_t * buffer)
+{
+  return reinterpret_cast<QueueHandle_t>(buffer);
+}
+
+BaseType_t TakeMutex(QueueHandle_t, TickType_t)
+{
+  events.push_back("take");
+  return pdTRUE;
+}
+
+BaseType_t GiveMutex(QueueHandle_t, const void *, TickType_t, BaseType_t)
+{
+  events.push_back("give");
+  return pdTRUE;
+}
+}  // namespace
+
+TEST_CASE("Testing SPI bus manager", "[spi-bus]")
+{
+  RESET_FAKE(xTaskGetSchedulerState);
+  RESET_FAKE(xQueueCreateMutexStatic);
+  RESET_FAKE(xQueueSemaphoreTake);
+  RESET_FAKE(xQueueGenericSend);
+  xTaskGetSchedulerState_fake.return_val   = taskSCHEDULER_NOT_STARTED;
+  xQueueCreateMutexStatic_fake.custom_fake = CreateMutexStatic;
+  xQueueSemaphoreTake_fake.custom_fake     = TakeMutex;
+  xQueueGenericSend_fake.custom_fake       = GiveMutex;
+
+  RecordingSpi spi;
+  RecordingGpio flash_cs("flash");
+  RecordingGpio display_cs("display");
+  SpiBus bus(spi);
+  SpiDevice flash(bus, flash_cs, { .frequency = 8_MHz });
+  SpiDevice display(bus, display_cs,
+                    { .frequency              = 2_MHz,
+                      .data_size              = Spi::DataSize::kNine,
+                      .positive_clock_on_idle = true });
+  REQUIRE(flash.Initialize() == Status::kSuccess);
+  REQUIRE(display.Initialize() == Status::kSuccess);
+  events.clear();
+
+  SECTION("The peripheral is initialized once")
+  {
+    REQUIRE(flash.Initialize() == Status::kSuccess);
+
+    CHECK(events == std::vector<std::string>{ "flash high" });
+    // The mutex waits for the scheduler
+    CHECK(xQueueCreateMutexStatic_fake.call_count == 0);
+  }
+  SECTION("The bus is configured when the chip select is asserted")
+  {
+    flash.GetChipSelect().Set(Gpio::State::kLow);
+    CHECK(flash.Transfer(0x9F) == 0xA0);
+    flash.Read(nullptr, 3);
+    flash.GetChipSelect().Set(Gpio::State::kHigh);
+
+    CHECK(events == std::vector<std::string>{ "size 8", "clock 8000000",
+                                              "flash low", "transfer 159",
+                                              "block 3", "flash high" });
+  }
+  SECTION("The registers are only written when the configuration changes")
+  {
+    for (int i = 0; i < 3; i++)
+    {
+      flash.GetChipSelect().Set(Gpio::State::kLow);
+      flash.GetChipSelect().Set(Gpio::State::kHigh);
+    }
+    display.GetChipSelect().Set(Gpio::State::kLow);
+    display.GetChipSelect().Set(Gpio::State::kHigh);
+    flash.GetChipSelect().Set(Gpio::State::kLow);
+    flash.GetChipSelect().Set(Gpio::State::kHigh);
+
+    CHECK(bus.GetReconfigurationCount() == 3);
+    CHECK(events[8] == "size 9");
+    CHECK(events[9] == "clock 2000000 cpol");
+  }
+  SECTION("Devices with the same configuration share it")
+  {
+    RecordingGpio sensor_cs("sensor");
+    SpiDevice sensor(bus, sensor_cs, flash.GetConfiguration());
+
+    flash.Transfer(0x00);
+    sensor.Transfer(0x00);
+    flash.Transfer(0x00);
+
+    CHECK(bus.GetReconfigurationCount() == 1);
+  }
+  SECTION("A driver's settings apply the next time it takes the bus")
+  {
+    flash.SetClock(20_MHz, false, true);
+    flash.SetDataSize(Spi::DataSize::kSixteen);
+    CHECK(events.empty());
+
+    CHECK(flash.GetClock() == 20_MHz);
+
+    CHECK(events ==
+          std::vector<std::string>{ "size 16", "clock 20000000 cpha" });
+  }
+  SECTION("A driver's settings apply at once while it is selected")
+  {
+    flash.GetChipSelect().Set(Gpio::State::kLow);
+    events.clear();
+
+    flash.SetClock(25_MHz);
+
+    CHECK(events == std::vector<std::string>{ "size 8", "clock 25000000" });
+  }
+  SECTION("The bus is held while a device is selected")
+  {
+    xTaskGetSchedulerState_fake.return_val = taskSCHEDULER_RUNNING;
+
+    display.GetChipSelect().Set(Gpio::State::kLow);
+    display.Write(nullptr, 0);
+    display.GetChipSelect().Set(Gpio::State::kLow);
+    display.GetChipSelect().Set(Gpio::State::kHigh);
+    display.GetChipSelect().Set(Gpio::State::kHigh);
+    flash.Transfer(0x05);
+
+    CHECK(events == std::vector<std::string>{
+                        "take", "size 9", "clock 2000000 cpol", "display low",
+                        "block 0", "display low", "display high", "give",
+                        "display high", "take", "size 8", "clock 8000000",
+                        "transfer 5", "give" });
+    CHECK(xQueueCreateMutexStatic_fake.call_count == 1);
+  }
+  SECTION("The bus is not locked before the scheduler starts")
+  {
+    flash.GetChipSelect().Set(Gpio::State::kLow);
+    flash.GetChipSelect().Set(Gpio::State::kHigh);
+
+    CHECK(xQueueCreateMutexStatic_fake.call_count == 0);
+    CHECK(xQueueSemaphoreTake_fake.call_count == 0);
+    CHECK(xQueueGenericSend_fake.call_count == 0);
+  }
+  SECTION("A device selected before the scheduler starts gives nothing back")
+  {
+    flash.GetChipSelect().Set(Gpio::State::kLow);
+    xTaskGetSchedulerState_fake.return_val = taskSCHEDULER_RUNNING;
+    flash.GetChipSelect().Set(Gpio::State::kHigh);
+
+    CHECK(xQueueGenericSend_fake.call_count == 0);
+    flash.Transfer(0x05);
+    CHECK(xQueueSemaphoreTake_fake.call_count == 1);
+    CHECK(xQueueGenericSend_fake.call_count == 1);
+  }
+  SECTION("Only the task holding the bus gives it back")
+  {
+    int task_a = 0;
+    int task_b = 0;
+    xTaskGetSchedulerState_fake.return_val    = taskSCHEDULER_RUNNING;
+    xQueueGetMutexHolder_fake.return_val      = &task_a;
+    xTaskGetCurrentTaskHandle_fake.return_val = &task_a;
+    flash.GetChipSelect().Set(Gpio::State::kLow);
+
+    xTaskGetCurrentTaskHandle_fake.return_val = &task_b;
+    bus.Release();
+    CHECK(xQueueGenericSend_fake.call_count == 0);
+
+    xTaskGetCurrentTaskHandle_fake.return_val = &task_a;
+    flash.GetChipSelect().Set(Gpio::State::kHigh);
+    CHECK(xQueueGenericSend_fake.call_count == 1);
+  }
+
+  RESET_FAKE(xQueueGetMutexHolder);
+  RESET_FAKE(xTaskGetCurrentTaskHandle);
+}
+
+TEST_CASE("Testing SPI bus shared with an SD card", "[spi-bus]")
+{
+  RESET_FAKE(xTaskGetSchedulerState);
+  RESET_FAKE(xQueueCreateMutexStatic);
+  RESET_FAKE(xQueueSemaphoreTake);
+  RESET_FAKE(xQueueGenericSend);
+  xTaskGetSchedulerState_fake.return_val   = taskSCHEDULER_NOT_STARTED;
+  xQueueCreateMutexStatic_fake.custom_fake = CreateMutexStatic;
+
+  std::FILE * image = std::tmpfile();
+  REQUIRE(image != nullptr);
+  std::vector<uint8_t> blank(SdCardEmulator::kCapacityUnit * Sd::kBlockSize,
+                             0);
+  std::fwrite(blank.data(), 1, blank.size(), image);
+
+  SdCardEmulator card(image);
+  RecordingGpio flash_cs("flash");
+  SpiBus bus(card);
+  SpiDevice sd_spi(bus, card.GetChipSelect(), { .frequency = 400_kHz });
+  SpiDevice flash(bus, flash_cs, { .frequency = 8_MHz });
+  Sd sd(sd_spi, sd_spi.GetChipSelect());
+  Sd::CardInfo_t card_info;
+  sd.Initialize();
+  REQUIRE(flash.Initialize() == Status::kSuccess);
+  REQUIRE(sd.Mount(&card_info));
+  xTaskGetSchedulerState_fake.return_val = taskSCHEDULER_RUNNING;
+
+  uint8_t data[2 * Sd::kBlockSize] = { 0 };
+
+  SECTION("Another device takes the bus after a write")
+  {
+    CHECK(sd.WriteBlock(10, data, 2) == 0x00);
+    CHECK(sd.WriteBlock(12, data) == 0x00);
+
+    // Every take was matched by a give, so the bus is free
+    CHECK(!sd_spi.IsSelected());
+    CHECK(xQueueSemaphoreTake_fake.call_count ==
+          xQueueGenericSend_fake.call_count);
+
+    flash.Transfer(0x9F);
+    CHECK(xQueueSemaphoreTake_fake.call_count == 3);
+    CHECK(xQueueGenericSend_fake.call_count == 3);
+  }
+  SECTION("Another device takes the bus after an erase")
+  {
+    CHECK(sd.DeleteBlock(10, 20) == 0x00);
+    sd.WaitWhileBusy();
+
+    CHECK(!sd_spi.IsSelected());
+    CHECK(xQueueSemaphoreTake_fake.call_count == 2);
+    CHECK(xQueueGenericSend_fake.call_count == 2);
+    CHECK(card.GetStatistics().blocks_erased == 11);
+  }
+
+  std::fclose(image);
+}
+}  // namespace sjsu
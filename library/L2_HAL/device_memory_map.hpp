@@ -9,6 +9,7 @@
 #include <type_traits>
 
 #include "L1_Peripheral/lpc40xx/i2c.hpp"
+#include "utility/enum.hpp"
 #include "utility/macros.hpp"
 #include "utility/status.hpp"
 
@@ -169,6 +170,216 @@ Array_t
   std::array<Register_t<Int, Endian::kLittle, write, read>, kLength> member_;
 };
 
+/// How a ShadowCache treats the bytes of a register
+enum class CachePolicy : uint8_t
+{
+  /// Every read and write goes to the device. For registers the device
+  /// changes on its own, such as status and data registers.
+  kVolatile = 0,
+  /// The first read comes from the device, later reads come from the shadow.
+  /// Writes only change the shadow until Commit().
+  kCached,
+  /// Never read from the device. Reads give back what was last written, or
+  /// zero before that. For registers that do not read back what was written.
+  kWriteOnly,
+};
+
+/// A copy of a device's registers, so that read-modify-write operations on
+/// configuration registers, such as `memory.control |= 0x01`, do not take a
+/// bus transaction each. Writes to kCached and kWriteOnly registers are held
+/// until Commit(), which writes each run of contiguous changed bytes in one
+/// burst. The device must step through its register addresses on its own
+/// during a burst write, as most I2C devices do.
+///
+/// Every register starts out kVolatile, so a shadow changes nothing until its
+/// registers are given another policy with SetPolicy(). Commit() writes in
+/// address order, so commit before a write that must come after the ones
+/// held, such as one that powers the device on once it is configured.
+template <size_t kSize>
+class ShadowCache
+{
+ public:
+  /// @param address - address of the first byte of the register
+  /// @param size - number of bytes the policy applies to
+  void SetPolicy(intptr_t address, size_t size, CachePolicy policy)
+  {
+    if (!IsInRange(address, size))
+    {
+      return;
+    }
+    for (size_t i = 0; i < size; i++)
+    {
+      values_[address + i] = 0;
+      flags_[address + i]  = util::Value(policy);
+      if (policy == CachePolicy::kWriteOnly)
+      {
+        flags_[address + i] |= Flags::kValid;
+      }
+    }
+  }
+
+  CachePolicy GetPolicy(intptr_t address) const
+  {
+    if (!IsInRange(address, 1))
+    {
+      return CachePolicy::kVolatile;
+    }
+    return static_cast<CachePolicy>(flags_[address] & Flags::kPolicy);
+  }
+
+  /// Hold the write in the shadow if none of its bytes are kVolatile,
+  /// otherwise write it all to the device.
+  ///
+  /// @return false if the device write failed
+  bool Write(intptr_t address,
+             size_t size,
+             uint8_t * data,
+             WriteFnt write_to_device)
+  {
+    if (IsHeld(address, size, 0))
+    {
+      for (size_t i = 0; i < size; i++)
+      {
+        values_[address + i] = data[i];
+        flags_[address + i] |= Flags::kValid | Flags::kDirty;
+      }
+      return true;
+    }
+    bool status = write_to_device(address, size, data);
+    if (status)
+    {
+      for (size_t i = 0; IsInRange(address, size) && i < size; i++)
+      {
+        if (GetPolicy(address + i) != CachePolicy::kVolatile)
+        {
+          values_[address + i] = data[i];
+          flags_[address + i]  = static_cast<uint8_t>(
+              (flags_[address + i] | Flags::kValid) & ~Flags::kDirty);
+        }
+      }
+    }
+    return status;
+  }
+
+  /// Read from the shadow if it holds every byte, otherwise read from the
+  /// device. Bytes the device has not been given yet, and kWriteOnly bytes,
+  /// come from the shadow either way.
+  void Read(intptr_t address,
+            size_t size,
+            uint8_t * data,
+            ReadFnt read_from_device)
+  {
+    if (IsHeld(address, size, Flags::kValid))
+    {
+      memcpy(data, &values_[address], size);
+      return;
+    }
+    read_from_device(address, size, data);
+    for (size_t i = 0; IsInRange(address, size) && i < size; i++)
+    {
+      CachePolicy policy = GetPolicy(address + i);
+      if (policy == CachePolicy::kVolatile)
+      {
+        continue;
+      }
+      if (policy == CachePolicy::kWriteOnly ||
+          (flags_[address + i] & Flags::kDirty))
+      {
+        data[i] = values_[address + i];
+      }
+      else
+      {
+        values_[address + i] = data[i];
+        flags_[address + i] |= Flags::kValid;
+      }
+    }
+  }
+
+  /// Write every byte changed since the last commit to the device, as one
+  /// burst per run of contiguous bytes.
+  ///
+  /// @param write_to_device - writes a burst to the device
+  /// @param max_burst - most bytes write_to_device takes at once
+  /// @return false if any burst failed, in which case its bytes stay dirty
+  bool Commit(WriteFnt write_to_device, size_t max_burst = kSize)
+  {
+    bool success   = true;
+    size_t address = 0;
+    while (address < kSize)
+    {
+      if (!(flags_[address] & Flags::kDirty))
+      {
+        address++;
+        continue;
+      }
+      size_t length = 1;
+      while (address + length < kSize && length < max_burst &&
+             (flags_[address + length] & Flags::kDirty))
+      {
+        length++;
+      }
+      if (write_to_device(address, length, &values_[address]))
+      {
+        for (size_t i = address; i < address + length; i++)
+        {
+          flags_[i] &= static_cast<uint8_t>(~Flags::kDirty);
+        }
+      }
+      else
+      {
+        success = false;
+      }
+      address += length;
+    }
+    return success;
+  }
+
+  /// Forget every value held, and drop writes that were not committed. For
+  /// when the device has been reset.
+  void Invalidate()
+  {
+    for (size_t i = 0; i < kSize; i++)
+    {
+      SetPolicy(i, 1, GetPolicy(i));
+    }
+  }
+
+ private:
+  enum Flags : uint8_t
+  {
+    kPolicy = 0b0011,
+    kValid  = 0b0100,
+    kDirty  = 0b1000,
+  };
+
+  static constexpr bool IsInRange(intptr_t address, size_t size)
+  {
+    return address >= 0 && static_cast<size_t>(address) + size <= kSize;
+  }
+
+  /// @return true if every byte is in range, is not kVolatile, and has all
+  ///         of the flags given
+  bool IsHeld(intptr_t address, size_t size, uint8_t required_flags) const
+  {
+    if (!IsInRange(address, size))
+    {
+      return false;
+    }
+    for (size_t i = 0; i < size; i++)
+    {
+      if (GetPolicy(address + i) == CachePolicy::kVolatile ||
+          (flags_[address + i] & required_flags) != required_flags)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  uint8_t values_[kSize] = {};
+  uint8_t flags_[kSize]  = {};
+};
+
 }  // namespace device
 
 template <class DeviceProtocol, device::Endian endianess,
@@ -236,27 +447,125 @@ class I2cDevice
                     endianess, MemoryMap>
 {
  public:
+  /// Register addresses are sent as a single byte
+  static constexpr size_t kRegisterSpace    = 256;
+  static constexpr size_t kMaxPayloadLength = 128;
+  using Shadow = device::ShadowCache<kRegisterSpace>;
+
   inline static const I2c * i2c = nullptr;
-  // Standard Write transaction for most I2C devices
+  /// Fastest SCL frequency the device supports, 0_Hz if it keeps up with any
+  /// bus clock. The bus slows down to this for the device's transactions.
+  inline static units::frequency::hertz_t max_frequency = 0_Hz;
+  /// Optional copy of the device's registers, see device::ShadowCache
+  inline static Shadow * shadow = nullptr;
+
   static bool Write(intptr_t address, size_t size, uint8_t * target)
   {
-    constexpr size_t kMaxPayloadLength = 128;
+    if (shadow != nullptr)
+    {
+      return shadow->Write(address, size, target, WriteToDevice);
+    }
+    return WriteToDevice(address, size, target);
+  }
+  static void Read(intptr_t address, size_t size, uint8_t * target)
+  {
+    if (shadow != nullptr)
+    {
+      shadow->Read(address, size, target, ReadFromDevice);
+      return;
+    }
+    ReadFromDevice(address, size, target);
+  }
+  // Standard Write transaction for most I2C devices
+  static bool WriteToDevice(intptr_t address, size_t size, uint8_t * target)
+  {
     uint8_t payload[kMaxPayloadLength];
     payload[0] = static_cast<uint8_t>(address);
     memcpy(&payload[1], target, size);
     // Size + 1 to account for the 1-byte register address
-    Status status = i2c->Write(kDeviceAddress, payload, size + 1);
+    Status status = i2c->Transaction({
+        .operation     = I2c::Operation::kWrite,
+        .address       = kDeviceAddress,
+        .data_out      = payload,
+        .out_length    = size + 1,
+        .data_in       = nullptr,
+        .in_length     = 0,
+        .position      = 0,
+        .repeated      = false,
+        .busy          = true,
+        .timeout       = I2c::kI2cTimeout,
+        .status        = Status::kSuccess,
+        .max_frequency = max_frequency,
+    });
     return (status == Status::kSuccess);
   }
   // Standard Read transaction for most I2C devices
-  static void Read(intptr_t address, size_t size, uint8_t * target)
+  static void ReadFromDevice(intptr_t address, size_t size, uint8_t * target)
   {
     uint8_t register_address = static_cast<uint8_t>(address);
-    i2c->WriteThenRead(kDeviceAddress, &register_address, 1, target, size);
+    i2c->Transaction({
+        .operation     = I2c::Operation::kWrite,
+        .address       = kDeviceAddress,
+        .data_out      = &register_address,
+        .out_length    = 1,
+        .data_in       = target,
+        .in_length     = size,
+        .position      = 0,
+        .repeated      = true,
+        .busy          = true,
+        .timeout       = I2c::kI2cTimeout,
+        .status        = Status::kSuccess,
+        .max_frequency = max_frequency,
+    });
+  }
+  /// @param i2c_peripheral - bus the device is on
+  /// @param maximum_frequency - fastest SCL frequency the device supports,
+  ///        such as I2c::kFastMode, or 0_Hz for no limit
+  /// @param shadow_cache - copy of the registers to read from and hold
+  ///        writes in, for registers given a policy with SetCachePolicy()
+  explicit I2cDevice(const I2c * i2c_peripheral,
+                     units::frequency::hertz_t maximum_frequency = 0_Hz,
+                     Shadow * shadow_cache = nullptr)
+  {
+    i2c           = i2c_peripheral;
+    max_frequency = maximum_frequency;
+    shadow        = shadow_cache;
   }
-  explicit I2cDevice(const I2c * i2c_peripheral)
+  /// Set the cache policy of the registers from first through last, such as
+  /// `SetCachePolicy(memory.control, memory.threshold, kCached)`. Does
+  /// nothing without a shadow.
+  template <typename First, typename Last>
+  void SetCachePolicy(const First & first,
+                      const Last & last,
+                      device::CachePolicy policy)
   {
-    i2c = i2c_peripheral;
+    intptr_t start = reinterpret_cast<intptr_t>(&first);
+    intptr_t end   = reinterpret_cast<intptr_t>(&last) + sizeof(last);
+    if (shadow != nullptr)
+    {
+      shadow->SetPolicy(start, static_cast<size_t>(end - start), policy);
+    }
+  }
+  template <typename Register>
+  void SetCachePolicy(const Register & reg, device::CachePolicy policy)
+  {
+    SetCachePolicy(reg, reg, policy);
+  }
+  /// Write the register changes held in the shadow to the device.
+  ///
+  /// @return false if any of the writes failed
+  bool Commit()
+  {
+    return shadow == nullptr ||
+           shadow->Commit(WriteToDevice, kMaxPayloadLength - 1);
+  }
+  /// Forget the register values held in the shadow, such as after a reset.
+  void Invalidate()
+  {
+    if (shadow != nullptr)
+    {
+      shadow->Invalidate();
+    }
   }
 };
 }  // namespace sjsu
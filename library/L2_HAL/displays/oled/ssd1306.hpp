@@ -53,17 +53,20 @@ class Ssd1306 final : public PixelDisplay
 
   void Write(uint32_t data, Transaction transaction, size_t size = 1)
   {
-    dc_.Set(static_cast<sjsu::Gpio::State>(transaction));
-    cs_.Set(sjsu::Gpio::State::kLow);
+    SJ2_ASSERT_FATAL(size <= sizeof(data),
+                     "Ssd1306 Write() can send at most 4 bytes at a time.");
+    uint8_t payload[sizeof(data)];
     for (size_t i = 0; i < size; i++)
     {
-      uint8_t send = static_cast<uint8_t>(data >> (((size - 1) - i) * 8));
+      payload[i] = static_cast<uint8_t>(data >> (((size - 1) - i) * 8));
       if (transaction == Transaction::kCommand)
       {
-        LOG_DEBUG("send = 0x%X", send);
+        LOG_DEBUG("send = 0x%X", payload[i]);
       }
-      spi_.Transfer(send);
     }
+    dc_.Set(static_cast<sjsu::Gpio::State>(transaction));
+    cs_.Set(sjsu::Gpio::State::kLow);
+    spi_.Write(payload, size);
     cs_.Set(sjsu::Gpio::State::kHigh);
   }
 
@@ -184,13 +187,14 @@ class Ssd1306 final : public PixelDisplay
   void Update() override
   {
     SetHorizontalAddressMode();
+    // Stream the whole frame in a single transaction, one page at a time.
+    dc_.Set(static_cast<sjsu::Gpio::State>(Transaction::kData));
+    cs_.Set(sjsu::Gpio::State::kLow);
     for (size_t row = 0; row < kRows; row++)
     {
-      for (size_t column = 0; column < kColumns; column++)
-      {
-        Write(bitmap_[row][column], Transaction::kData);
-      }
+      spi_.Write(bitmap_[row], kColumns);
     }
+    cs_.Set(sjsu::Gpio::State::kHigh);
   }
   void InvertScreenColor() __attribute__((used))
   {
@@ -0,0 +1,291 @@
+/// BlockLog appends fixed size records to a reserved region of an SD card,
+/// without a file system. Each record fills one 512-byte block and carries a
+/// sequence number and a CRC-32, and the region is used as a ring, so once it
+/// is full the oldest records are overwritten. Writes never touch anything
+/// but the blocks being logged, which avoids the FAT and directory updates
+/// that make FatFs latency spike at high logging rates.
+///
+///   - Records are staged in RAM and written kBurstBlocks at a time with a
+///     single multi-block write (CMD25).
+///   - Each erase group is erased just before the first record is written
+///     into it, so the card writes into blocks it has already erased.
+///   - Mount() finds where the log left off with a binary search, reading
+///     about log2(block_count) blocks.
+///
+/// Block n of the region always holds a record whose sequence number is
+/// n modulo block_count. Records written on the current pass through the ring
+/// are therefore numbered consecutively from block 0, and the first block
+/// that breaks that run is where the next record goes.
+///
+/// Sequence numbers go back to 0 after the largest multiple of block_count
+/// that fits in 32 bits, rather than at 2^32, so that they keep lining up with
+/// their blocks. At 1000 records a second that happens after about 49 days.
+///
+/// tools/block_log_reader.py extracts the records from an image of the card.
+///
+/// Order of function calls should be as follows:
+///
+///     1. Constructor (create object)
+///     2. Mount()
+///     3. Append(...) as many times as needed
+///     4. Flush() to write out the staged records
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "L2_HAL/memory/sd.hpp"
+#include "utility/crc.hpp"
+#include "utility/log.hpp"
+#include "utility/status.hpp"
+
+namespace sjsu
+{
+template <size_t kBurstBlocks = 8>
+class BlockLog
+{
+ public:
+  static_assert(kBurstBlocks > 0, "kBurstBlocks must be at least one block");
+
+  static constexpr size_t kBlockSize = 512;
+  /// "SJBL" in little endian
+  static constexpr uint32_t kMagic = 0x4C42'4A53;
+
+  /// Layout of each block, stored little endian. The CRC-32 covers every
+  /// byte before it.
+  struct Record_t
+  {
+    static constexpr size_t kPayloadSize = kBlockSize - 16;
+
+    uint32_t magic;
+    uint32_t sequence;
+    /// Number of payload bytes used
+    uint16_t length;
+    uint16_t reserved;
+    uint8_t payload[kPayloadSize];
+    uint32_t crc;
+  };
+  static_assert(sizeof(Record_t) == kBlockSize,
+                "Record_t must fill exactly one block");
+
+  /// @param card - mounted card to log to
+  /// @param first_block - first block of the region reserved for the log
+  /// @param block_count - number of blocks reserved for the log
+  /// @param erase_blocks - size of the card's erase group in blocks, see
+  ///        Csd_t::GetEraseBlockSize(). The region should start on an erase
+  ///        group boundary.
+  constexpr BlockLog(SdInterface & card,
+                     uint32_t first_block,
+                     uint32_t block_count,
+                     uint32_t erase_blocks = 64)
+      : card_(card),
+        first_block_(first_block),
+        block_count_(block_count),
+        erase_blocks_(erase_blocks)
+  {
+  }
+
+  /// Find the end of the log so that Append() carries on from it.
+  ///
+  /// @return Status::kInvalidParameters if the region is empty, otherwise
+  ///         Status::kSuccess.
+  Status Mount()
+  {
+    if (block_count_ == 0 || erase_blocks_ == 0)
+    {
+      return Status::kInvalidParameters;
+    }
+    staged_ = 0;
+
+    Record_t & record = staging_[0];
+    if (!ReadRecord(0, &record))
+    {
+      // Either nothing has been logged, or a new pass through the ring was
+      // interrupted before its first record was written.
+      next_sequence_ = 0;
+      if (ReadRecord(block_count_ - 1, &record))
+      {
+        next_sequence_ = Advance(record.sequence, 1);
+      }
+    }
+    else
+    {
+      // Blocks [0, head) hold this pass's records, numbered on from block 0.
+      // The search keeps low inside that run and high past its end. A pass
+      // starts on a multiple of block_count, so its numbers never wrap.
+      uint32_t first_sequence = record.sequence;
+      uint32_t low            = 0;
+      uint32_t high           = block_count_;
+      while (high - low > 1)
+      {
+        uint32_t middle = low + (high - low) / 2;
+        if (ReadRecord(middle, &record) &&
+            record.sequence == first_sequence + middle)
+        {
+          low = middle;
+        }
+        else
+        {
+          high = middle;
+        }
+      }
+      next_sequence_ = Advance(first_sequence, high);
+    }
+
+    is_mounted_ = true;
+    LOG_DEBUG("Block log resumes at record %" PRIu32 " (block %" PRIu32 ")",
+              next_sequence_, next_sequence_ % block_count_);
+    return Status::kSuccess;
+  }
+
+  /// Add one record to the log. Records are written out once kBurstBlocks
+  /// have been staged, or the end of the region is reached.
+  ///
+  /// @param data - payload of the record
+  /// @param length - payload length, at most Record_t::kPayloadSize bytes
+  /// @return Status::kInvalidParameters if the payload does not fit,
+  ///         Status::kNotReadyYet if the log has not been mounted,
+  ///         Status::kBusError if the card rejected a write or erase, in which
+  ///         case the staged records are kept and written on the next call,
+  ///         otherwise Status::kSuccess.
+  Status Append(const void * data, size_t length)
+  {
+    if (length > Record_t::kPayloadSize || (data == nullptr && length > 0))
+    {
+      return Status::kInvalidParameters;
+    }
+    if (!is_mounted_)
+    {
+      return Status::kNotReadyYet;
+    }
+    if (staged_ == kBurstBlocks ||
+        (staged_ > 0 && BlockOf(next_sequence_) == 0))
+    {
+      // A previous write failed, so make room before taking another record.
+      // Records staged up to the end of the region must go out first, since
+      // the next record starts over at block 0.
+      Status status = Flush();
+      if (status != Status::kSuccess)
+      {
+        return status;
+      }
+    }
+
+    Record_t & record = staging_[staged_++];
+    record.magic      = kMagic;
+    record.sequence   = next_sequence_;
+    record.length     = static_cast<uint16_t>(length);
+    record.reserved   = 0;
+    memcpy(record.payload, data, length);
+    memset(&record.payload[length], 0, Record_t::kPayloadSize - length);
+    record.crc = crc::Crc32::Calculate(reinterpret_cast<uint8_t *>(&record),
+                                       offsetof(Record_t, crc));
+    next_sequence_ = Advance(next_sequence_, 1);
+
+    if (staged_ == kBurstBlocks || BlockOf(next_sequence_) == 0)
+    {
+      return Flush();
+    }
+    return Status::kSuccess;
+  }
+
+  /// Write out the staged records.
+  ///
+  /// @return Status::kBusError if the card rejected a write or erase,
+  ///         Status::kInvalidSettings if the staged records run past the end
+  ///         of the region, otherwise Status::kSuccess.
+  Status Flush()
+  {
+    if (staged_ == 0)
+    {
+      return Status::kSuccess;
+    }
+
+    // Append() never stages records past the end of the region. Writing them
+    // anyway would erase and overwrite whatever follows the region.
+    uint32_t first = BlockOf(staging_[0].sequence);
+    uint32_t end   = first + static_cast<uint32_t>(staged_);
+    if (end > block_count_)
+    {
+      LOG_ERROR("Block log staged records past the end of its region");
+      return Status::kInvalidSettings;
+    }
+    for (uint32_t block = first; block < end; block++)
+    {
+      if (block % erase_blocks_ == 0)
+      {
+        uint32_t last = block + erase_blocks_ - 1;
+        if (last >= block_count_)
+        {
+          last = block_count_ - 1;
+        }
+        if (card_.DeleteBlock(first_block_ + block, first_block_ + last) != 0)
+        {
+          LOG_ERROR("Block log could not erase block %" PRIu32, block);
+          return Status::kBusError;
+        }
+      }
+    }
+
+    uint8_t r1 =
+        card_.WriteBlock(first_block_ + first,
+                         reinterpret_cast<const uint8_t *>(staging_),
+                         static_cast<uint32_t>(staged_));
+    if (r1 != 0)
+    {
+      LOG_ERROR("Block log write at block %" PRIu32 " failed [R1: 0x%02X]",
+                first, r1);
+      return Status::kBusError;
+    }
+    staged_ = 0;
+    return Status::kSuccess;
+  }
+
+  /// @return the sequence number the next appended record will be given
+  uint32_t GetNextSequence() const
+  {
+    return next_sequence_;
+  }
+
+ private:
+  uint32_t BlockOf(uint32_t sequence) const
+  {
+    return sequence % block_count_;
+  }
+
+  /// @return the sequence number count records after sequence
+  uint32_t Advance(uint32_t sequence, uint32_t count) const
+  {
+    uint64_t limit = ((uint64_t{ 1 } << 32) / block_count_) * block_count_;
+    return static_cast<uint32_t>((uint64_t{ sequence } + count) % limit);
+  }
+
+  /// Read a block of the region and return true if it holds an intact record
+  /// that belongs in it.
+  bool ReadRecord(uint32_t block, Record_t * record)
+  {
+    if (card_.ReadBlock(first_block_ + block,
+                        reinterpret_cast<uint8_t *>(record)) != 0)
+    {
+      return false;
+    }
+    return record->magic == kMagic &&
+           record->length <= Record_t::kPayloadSize &&
+           BlockOf(record->sequence) == block &&
+           record->crc ==
+               crc::Crc32::Calculate(reinterpret_cast<uint8_t *>(record),
+                                     offsetof(Record_t, crc));
+  }
+
+  SdInterface & card_;
+  uint32_t first_block_;
+  uint32_t block_count_;
+  uint32_t erase_blocks_;
+  bool is_mounted_        = false;
+  uint32_t next_sequence_ = 0;
+  size_t staged_          = 0;
+  Record_t staging_[kBurstBlocks];
+};
+}  // namespace sjsu
@@ -1,10 +1,13 @@
 #pragma once
 
 #include <cstdint>
-#include <type_traits>
+#include <cstring>
+#include <iterator>
 
+#include "L1_Peripheral/crc.hpp"
 #include "L1_Peripheral/lpc40xx/gpio.hpp"
 #include "L1_Peripheral/lpc40xx/spi.hpp"
+#include "utility/crc.hpp"
 #include "utility/log.hpp"
 
 namespace sjsu
@@ -93,13 +96,25 @@ class SdInterface
     kReset = 0x40 | 0,         // CMD0: reset the sd card (force it to go
                                // to the idle state)
     kInit  = 0x40 | 1,         // CMD1: starts an initiation of the card
+    kGetCid = 0x40 | 2,        // CMD2: request the sd card's CID (card
+                               // identification) register (native mode)
+    kGetRelativeAddress = 0x40 | 3,  // CMD3: ask the card to publish a
+                                     // relative card address (native mode)
+    kSwitchFunction = 0x40 | 6,  // CMD6: check or switch the card's
+                                 // function, i.e. high speed mode
+    kSetBusWidth = 0x40 | 6,   // ACMD6: set the data bus width (native
+                               // mode, must precede with CMD55)
+    kSelectCard = 0x40 | 7,    // CMD7: move the addressed card to the
+                               // transfer state (native mode)
     kGetOp = 0x40 | 8,         // CMD8: request the sd card's support of
                                // the provided host's voltage ranges
     kGetCsd = 0x40 | 9,        // CMD9: request the sd card's CSD
                                // (card-specific data) register
+    kSendCid = 0x40 | 10,      // CMD10: request the sd card's CID
+                               // register (SPI mode)
     kStopTrans = 0x40 | 12,    // CMD12: terminates a multi-block read or
                                // write operation
-    kGetStatus = 0x04 | 13,    // CMD13: get status register
+    kGetStatus = 0x40 | 13,    // CMD13: get status register
     kChgBlkLen = 0x40 | 16,    // CMD16: change block length (only
                                // effective in SDSC cards; SDHC/SDXC
                                // cards are locked to 512-byte blocks)
@@ -132,107 +147,146 @@ class SdInterface
     kNo  = false
   };
 
-  /// @description     A template housing a CRC7 or CRC16 table for the SD
-  ///                  card, using either an 8-bit or 16-bit data type
-  template <typename T>
-  struct CrcTableConfig_t
+  /// @description     A 128-bit card register, such as the CID or CSD, stored
+  ///                  most significant byte first as sent by the card
+  struct CardRegister_t
   {
-    static constexpr size_t kTableSize   = 256;
-    static constexpr uint32_t kPoly16bit = (1 << 16 | 1 << 12 | 1 << 5) + 1;
-    static constexpr uint8_t kPoly8bit   = 0x89;
-
-    // Compile-time check for appropriate crc table type
-    static_assert(
-        std::is_same<T, uint16_t>::value || std::is_same<T, uint8_t>::value,
-        "Incompatibility: SD CRC table only accepts uint8_t or uint16_t");
-    T crc_table[kTableSize] = { 0 };
-  };
+    uint8_t byte[16];
 
-  /// @description     Structure for recording information about the SD Card
-  // TODO(#350): Add support for CID/CSD Registers
-  struct CardInfo_t
-  {
-    union {
-      uint32_t dWord;
-      uint16_t word[2];
-      uint8_t byte[4];
-    } ocr;
-    Type type;
-    Response_t response;
+    /// @description     Extracts a field from the register
+    /// @parameter       high         The field's most significant bit
+    /// @parameter       low          The field's least significant bit
+    /// @returns         The value of bits [high:low]
+    constexpr uint32_t Extract(uint8_t high, uint8_t low) const
+    {
+      uint32_t value = 0;
+      for (int bit = high; bit >= low; bit--)
+      {
+        uint8_t register_byte = byte[(127 - bit) / 8];
+        value = (value << 1) | ((register_byte >> (bit % 8)) & 0x01);
+      }
+      return value;
+    }
   };
 
-  /// @description     This function acts as a compile-time CRC-7 table
-  ///                  generator
-  /// @returns         tableInfo
-  ///                  The configured CRC-7 table container.
-  template <typename T>
-  constexpr static CrcTableConfig_t<T> GenerateCrc7Table()
+  /// @description     The card's CSD (card-specific data) register (See
+  ///                  Physical Layer V6.00 p.180)
+  struct Csd_t : public CardRegister_t
   {
-    CrcTableConfig_t<T> crc_table = CrcTableConfig_t<T>();
-    size_t i = 0, j = 0;
-    // generate a table value for all 256 possible byte values
-    for (i = 0; i < 0xFF; i++)
+    /// @returns         0 for CSD version 1.0 (SDSC), 1 for version 2.0
+    ///                  (SDHC/SDXC)
+    constexpr uint32_t Version() const
     {
-      bool most_significant_bit_set = static_cast<bool>(i & 0x80);
-      uint8_t polynomial_compare =
-          static_cast<uint8_t>(i) ^ crc_table.kPoly8bit;
+      return Extract(127, 126);
+    }
 
-      crc_table.crc_table[i] = (most_significant_bit_set)
-                                   ? static_cast<T>(polynomial_compare)
-                                   : static_cast<T>(i);
+    /// @returns         The capacity of the card in 512-byte blocks
+    constexpr uint32_t GetBlockCount() const
+    {
+      if (Version() == 0)
+      {
+        // capacity = (C_SIZE + 1) * 2^(C_SIZE_MULT + 2) * 2^READ_BL_LEN
+        uint32_t size       = Extract(73, 62);
+        uint32_t multiplier = Extract(49, 47);
+        uint32_t block_len  = Extract(83, 80);
+        return (size + 1) << (multiplier + 2 + block_len - 9);
+      }
+      // capacity = (C_SIZE + 1) * 512KiB
+      return (Extract(69, 48) + 1) * 1024;
+    }
 
-      for (j = 1; j < 8; j++)
+    /// @returns         The size of an erasable sector in 512-byte blocks.
+    ///                  Version 2.0 cards always report 64KiB.
+    constexpr uint32_t GetEraseBlockSize() const
+    {
+      uint32_t sector_size = Extract(45, 39) + 1;
+      uint32_t write_len   = Extract(25, 22);
+      return (write_len > 9) ? sector_size << (write_len - 9) : sector_size;
+    }
+
+    /// @returns         The fastest clock the card accepts in default speed
+    ///                  mode, decoded from the TRAN_SPEED field, or 0_Hz if
+    ///                  the field holds a reserved value
+    constexpr units::frequency::hertz_t GetMaxClock() const
+    {
+      // Time value in tenths and transfer rate unit in bits/s
+      constexpr uint32_t kTimeValue[] = { 0,  10, 12, 13, 15, 20, 25, 30,
+                                          35, 40, 45, 50, 55, 60, 70, 80 };
+      constexpr uint32_t kRateUnit[]  = { 100'000, 1'000'000, 10'000'000,
+                                         100'000'000 };
+      uint32_t tran_speed = Extract(103, 96);
+      uint32_t unit       = tran_speed & 0b111;
+      if (unit >= std::size(kRateUnit))
       {
-        crc_table.crc_table[i] = static_cast<T>(crc_table.crc_table[i] << 1);
-        if (crc_table.crc_table[i] & 0x80)
-        {
-          crc_table.crc_table[i] ^= crc_table.kPoly8bit;
-        }
+        return 0_Hz;
       }
+      return units::frequency::hertz_t(static_cast<float>(
+          kRateUnit[unit] / 10 * kTimeValue[(tran_speed >> 3) & 0xF]));
     }
-    return crc_table;
-  }
 
-  /// @description     This function acts as a compile-time CRC-16 table
-  ///                  generator
-  /// @parameter       n/a
-  /// @returns         tableInfo
-  ///                  The configured CCITT CRC-16 table container.
-  constexpr static CrcTableConfig_t<uint16_t> GenerateCrc16Table()
+    /// @returns         true if the card supports the command class, i.e.
+    ///                  class 10 for CMD6 switch functions
+    constexpr bool SupportsCommandClass(uint8_t command_class) const
+    {
+      return Extract(static_cast<uint8_t>(84 + command_class),
+                     static_cast<uint8_t>(84 + command_class));
+    }
+  };
+
+  /// @description     The card's CID (card identification) register (See
+  ///                  Physical Layer V6.00 p.178)
+  struct Cid_t : public CardRegister_t
   {
-    // Create a place to store our table data
-    CrcTableConfig_t<uint16_t> table;
+    constexpr uint8_t GetManufacturerId() const
+    {
+      return static_cast<uint8_t>(Extract(127, 120));
+    }
 
-    for (uint16_t i = 0; i < 256; i++)
+    /// @description     Copies the 5 character product name into name and
+    ///                  terminates it
+    void GetProductName(char name[6]) const
     {
-      // Initialize the CRC for this byte
-      uint16_t crc = static_cast<uint16_t>(i << 8);
+      memcpy(name, &byte[3], 5);
+      name[5] = '\0';
+    }
 
-      // Check each bit
-      for (uint16_t j = 0; j < 8; j++)
-      {
-        // Check if we will need to add the polynomial with no carry
-        // (i.e. XOR it)
-        bool xor_is_needed = crc & (1 << 15);
+    /// @returns         The product revision, i.e. 0x12 for revision 1.2
+    constexpr uint8_t GetRevision() const
+    {
+      return static_cast<uint8_t>(Extract(63, 56));
+    }
 
-        // Left-shift the crc
-        crc = static_cast<uint16_t>(crc << 1);
+    constexpr uint32_t GetSerialNumber() const
+    {
+      return Extract(55, 24);
+    }
 
-        // Check if msb is 1
-        if (xor_is_needed)
-        {
-          // XOR it with the polynomial
-          crc ^= static_cast<uint16_t>(table.kPoly16bit);
-        }
-      }
+    constexpr uint32_t GetManufactureYear() const
+    {
+      return 2000 + Extract(19, 12);
+    }
 
-      // Add crc to the table
-      table.crc_table[i] = crc;
+    constexpr uint32_t GetManufactureMonth() const
+    {
+      return Extract(11, 8);
     }
+  };
 
-    // Return the CRC-16 table
-    return table;
-  }
+  /// @description     Structure for recording information about the SD Card
+  struct CardInfo_t
+  {
+    union {
+      uint32_t dWord;
+      uint16_t word[2];
+      uint8_t byte[4];
+    } ocr;
+    Type type;
+    Csd_t csd;
+    Cid_t cid;
+    /// Clock rate of the bus after the card was mounted
+    units::frequency::hertz_t clock;
+    Response_t response;
+  };
 
   /// @description     sends a command frame to the SD Card and sets the
   ///                  response
@@ -271,26 +325,21 @@ class SdInterface
 
   /// @description     reads any number of 512-byte blocks from the SD Card
   ///                  and returns the received block
-  ///                  This function assumes the block length is locked to
-  ///                  512-bytes (as is the case for SDHC/SDXC cards).
+  ///                  The block length is 512-bytes, which is set on
+  ///                  SDSC cards when they are mounted.
   ///                  SD Command 17 and 18 are are used for single and multi
   ///                  block reads, respectively.
-  /// @parameter       address      The address of the starting
-  ///                               block to read from. Note that
-  ///                               this address must be aligned
-  ///                               with a block boundary. By
-  ///                               assuming block size of 512-
-  ///                               bytes, valid addresses must be
-  ///                               multiples of 512.
-  ///                               Some Valid Examples:
+  /// @parameter       address      The number of the first 512-
+  ///                               byte block to read from, on
+  ///                               every type of card. It is
+  ///                               converted to the byte address
+  ///                               that standard capacity (SDSC)
+  ///                               cards expect.
+  ///                               Some SDSC Examples:
   ///                               0x00000000 --> byte addr 0
-  ///                               0x00000200 --> byte addr 512
-  ///                               0x00000400 --> byte addr 1024
-  ///                               0x00000600 --> byte addr 1536
-  ///                               Some Invalid Examples:
-  ///                               0x00000001 --> byte addr 1
-  ///                               0x000001FF --> byte addr 511
-  ///                               0x00000300 --> byte addr 768
+  ///                               0x00000001 --> byte addr 512
+  ///                               0x00000002 --> byte addr 1024
+  ///                               0x00000003 --> byte addr 1536
   /// @parameter       array        A pointer to an array where
   ///                               the bytes read will be stored.
   ///                               The array must be able to hold
@@ -316,24 +365,19 @@ class SdInterface
 
   /// @description     writes any number of 512-byte blocks to the SD Card
   ///                  and returns the status of the operation.
-  ///                  This function assumes the block length is locked to
-  ///                  512-bytes (as is the case for SDHC/SDXC cards).
-  /// @parameter       address      The address of the starting
-  ///                               block to write to. Note that
-  ///                               this address must be aligned
-  ///                               with a block boundary. By
-  ///                               assuming block size of 512-
-  ///                               bytes, valid addresses must be
-  ///                               multiples of 512.
-  ///                               Some Valid Examples:
+  ///                  The block length is 512-bytes, which is set on
+  ///                  SDSC cards when they are mounted.
+  /// @parameter       address      The number of the first 512-
+  ///                               byte block to write to, on
+  ///                               every type of card. It is
+  ///                               converted to the byte address
+  ///                               that standard capacity (SDSC)
+  ///                               cards expect.
+  ///                               Some SDSC Examples:
   ///                               0x00000000 --> byte addr 0
-  ///                               0x00000200 --> byte addr 512
-  ///                               0x00000400 --> byte addr 1024
-  ///                               0x00000600 --> byte addr 1536
-  ///                               Some Invalid Examples:
-  ///                               0x00000001 --> byte addr 1
-  ///                               0x000001FF --> byte addr 511
-  ///                               0x00000300 --> byte addr 768
+  ///                               0x00000001 --> byte addr 512
+  ///                               0x00000002 --> byte addr 1024
+  ///                               0x00000003 --> byte addr 1536
   /// @parameter       array        A pointer to an array where
   ///                               the bytes to write are stored.
   ///                               The array must be able to hold
@@ -358,33 +402,26 @@ class SdInterface
                              uint32_t blocks = 1) = 0;
 
   /// @description     Deletes any number of 512-byte blocks from the SD Card
-  ///                  This function assumes the block length is locked to
-  ///                  512-bytes (as is the case for SDHC/SDXC cards).
-  /// @parameter       start        The address of the block to
-  ///                               start deleting from. Note that
-  ///                               this address must be aligned
-  ///                               with a block boundary. By
-  ///                               assuming block size of 512-
-  ///                               bytes, valid addresses must be
-  ///                               multiples of 512.
-  ///                               Some Valid Examples:
-  ///                               0x00000000 --> byte addr 0
-  ///                               0x00000200 --> byte addr 512
-  ///                               0x00000400 --> byte addr 1024
-  ///                               0x00000600 --> byte addr 1536
-  ///                               Some Invalid Examples:
-  ///                               0x00000001 --> byte addr 1
-  ///                               0x000001FF --> byte addr 511
-  ///                               0x00000300 --> byte addr 768
-  /// @parameter       end          The address of the last block
-  ///                               to delete. Must also align
-  ///                               with a block boundary.
+  ///                  The block length is 512-bytes, which is set on
+  ///                  SDSC cards when they are mounted.
+  /// @parameter       start        The number of the first 512-
+  ///                               byte block to delete, on every
+  ///                               type of card. It is converted
+  ///                               to the byte address that
+  ///                               standard capacity (SDSC) cards
+  ///                               expect.
+  /// @parameter       end          The number of the last block
+  ///                               to delete.
   /// @returns         status        Returns the R1b-type command
   ///                               response byte returned from
   ///                               the card after the final
   ///                               erase command is sent.
   virtual uint8_t DeleteBlock(uint32_t start, uint32_t end) = 0;
 
+  /// @description     Blocks until the card has finished programming or
+  ///                  erasing, such that data written to it is persistent
+  virtual void WaitWhileBusy() = 0;
+
   /// @description     This function performs a CRC-7 Add Operation
   /// @parameter       CRC          The CRC to add upon
   /// @parameter       message_byte The byte to use when
@@ -427,13 +464,16 @@ class Sd final : public SdInterface
 
   // Enforcing block-size cross-compatibility
   static constexpr uint16_t kBlockSize = 512;
-  static constexpr CrcTableConfig_t<uint8_t> kCrcTable8 =
-      GenerateCrc7Table<uint8_t>();
-  static constexpr CrcTableConfig_t<uint16_t> kCrcTable16 =
-      GenerateCrc16Table();
-
-  explicit constexpr Sd(const Spi & spi, const Gpio & chip_select)
-      : spi_(spi), chip_select_(chip_select)
+  // Cards must be identified with a clock of 400kHz or less
+  static constexpr units::frequency::hertz_t kIdentificationClock = 400_kHz;
+  static constexpr units::frequency::hertz_t kHighSpeedClock      = 50_MHz;
+
+  /// @param crc - calculates the CRC-16 of data blocks. Boards with a CRC
+  ///        engine can pass it here to offload the block checks.
+  explicit constexpr Sd(const Spi & spi,
+                        const Gpio & chip_select,
+                        const sjsu::Crc & crc = DefaultCrc())
+      : spi_(spi), chip_select_(chip_select), crc_(crc)
   {
   }
 
@@ -447,7 +487,7 @@ class Sd final : public SdInterface
     LOG_DEBUG("Initializing SPI Clock Speed...");
     spi_.Initialize();
     LOG_DEBUG("Setting SPI Clock Speed...");
-    spi_.SetClock(12_MHz);
+    spi_.SetClock(kIdentificationClock);
     LOG_DEBUG("Setting Peripheral Mode...");
     spi_.SetDataSize(Spi::DataSize::kEight);
     LOG_DEBUG("Starting SPI Peripheral...");
@@ -562,6 +602,7 @@ class Sd final : public SdInterface
       LOG_DEBUG("SD Card is SC");
       sd->type = Type::kSDSC;
     }
+    type_ = sd->type;
 
     // Store OCR information
     for (int i = 0; i < 4; i++)
@@ -579,9 +620,65 @@ class Sd final : public SdInterface
                   sd->response.data.byte, 0, KeepAlive::kYes);
     }
 
+    // Read the CSD register, which holds the card's capacity and erase
+    // block size
+    LOG_DEBUG("Reading Card Specific Data...");
+    if (!ReadRegister(Command::kGetCsd, 0, sd->csd.byte,
+                      sizeof(sd->csd.byte)))
+    {
+      LOG_ERROR("Failed to read the CSD register. Aborting!");
+      return false;
+    }
+    LOG_DEBUG("Reading Card Identification...");
+    if (!ReadRegister(Command::kSendCid, 0, sd->cid.byte,
+                      sizeof(sd->cid.byte)))
+    {
+      LOG_WARNING("Failed to read the CID register.");
+    }
+
+    // The card has left the identification state, so run the bus as fast as
+    // the card allows.
+    units::frequency::hertz_t max_clock = sd->csd.GetMaxClock();
+    constexpr uint8_t kSwitchCommandClass = 10;
+    if (sd->csd.SupportsCommandClass(kSwitchCommandClass) &&
+        SwitchToHighSpeed())
+    {
+      max_clock = kHighSpeedClock;
+    }
+    if (max_clock == 0_Hz)
+    {
+      // The card's limit is unknown, so stay at the identification clock,
+      // which every card accepts.
+      LOG_WARNING("CSD TRAN_SPEED 0x%02" PRIX32
+                  " is reserved, keeping the identification clock.",
+                  sd->csd.Extract(103, 96));
+    }
+    else
+    {
+      spi_.SetClock(max_clock);
+    }
+    sd->clock = spi_.GetClock();
+    LOG_DEBUG("SD Card clock is %" PRIu32 "Hz (card limit %" PRIu32 "Hz)",
+              sd->clock.to<uint32_t>(), max_clock.to<uint32_t>());
+
     return true;
   }
 
+  // Asks the card to switch to high speed mode (CMD6 function group 1,
+  // function 1). Returns true if the card is now in high speed mode.
+  bool SwitchToHighSpeed()
+  {
+    constexpr uint32_t kSwitchToHighSpeed = 0x80FF'FFF1;
+    uint8_t switch_status[64];
+    if (!ReadRegister(Command::kSwitchFunction, kSwitchToHighSpeed,
+                      switch_status, sizeof(switch_status)))
+    {
+      return false;
+    }
+    // Bits [379:376] hold the function group 1 function now in use
+    return (switch_status[16] & 0x0F) == 0x01;
+  }
+
   // Returns string to represent a boolean value
   const char * ToBool(bool condition)
   {
@@ -589,8 +686,8 @@ class Sd final : public SdInterface
   }
 
   // Waits for the card to respond after a single or multi block read cmd is
-  // sent.
-  void WaitToReadBlock()
+  // sent. Returns true if the card is about to send the block.
+  bool WaitToReadBlock()
   {
     // Since the command encountered no errors, we can now begin to
     // read data. The card will enter "BUSY" mode following reception
@@ -628,11 +725,37 @@ class Sd final : public SdInterface
       LOG_DEBUG("CC Error?: %s", ToBool(wait_byte & 0x02));
       LOG_DEBUG("Error?: %s", ToBool(wait_byte & 0x01));
     }
+    return wait_byte == 0xFE;
   }
 
   // Waits for the card to be ready to receive a new block after one has
-  // been written or erased
-  void WaitWhileBusy()
+  // been written or erased. The card only drives its busy signal while it is
+  // selected.
+  void WaitWhileBusy() override
+  {
+    chip_select_.Set(Gpio::State::kLow);
+    PollWhileBusy();
+    chip_select_.Set(Gpio::State::kHigh);
+  }
+
+  // Returns the address of a block as the card expects it. SDSC cards are
+  // addressed in bytes, SDHC/SDXC cards in blocks.
+  uint32_t ToCardAddress(uint32_t block) const
+  {
+    return (type_ == Type::kSDSC) ? block * kBlockSize : block;
+  }
+
+  // Selects the card and waits for it to finish a previous write or erase,
+  // so that a new command can be sent
+  void SelectWhenReady()
+  {
+    chip_select_.Set(Gpio::State::kLow);
+    PollWhileBusy();
+  }
+
+  // Clocks the card, which must already be selected, until it is no longer
+  // busy
+  void PollWhileBusy()
   {
     // Wait for the card to finish programming (i.e. when the
     // bytes return to 0xFF)
@@ -645,137 +768,139 @@ class Sd final : public SdInterface
     LOG_DEBUG("Card finished!");
   }
 
-  // Read any number of blocks from the SD card
+  // Reads a register that the card sends as a data block, such as the CSD.
+  // Returns true if the register was received with a valid CRC.
+  bool ReadRegister(Command command,
+                    uint32_t argument,
+                    uint8_t * data,
+                    uint16_t length)
+  {
+    uint8_t r1        = 0xFF;
+    bool is_valid     = false;
+    uint32_t response = SendCmd(command, argument, &r1, 0, KeepAlive::kYes);
+    if (response != static_cast<uint32_t>(-1) && r1 == 0x00 &&
+        WaitToReadBlock())
+    {
+      spi_.Read(data, length);
+      uint8_t crc_bytes[2];
+      spi_.Read(crc_bytes, sizeof(crc_bytes));
+      uint16_t crc = static_cast<uint16_t>((crc_bytes[0] << 8) | crc_bytes[1]);
+      is_valid     = (crc == GetCrc16(data, length));
+    }
+    chip_select_.Set(Gpio::State::kHigh);
+    return is_valid;
+  }
+
+  // Reads one data block, and its CRC, of an ongoing single or multi block
+  // read into block. Returns true if the block arrived with a valid CRC.
+  bool ReadDataBlock(uint8_t * block)
+  {
+    // Wait for the card to respond with a ready signal
+    if (!WaitToReadBlock())
+    {
+      return false;
+    }
+
+    // Read all the bytes of a single block straight into the caller's
+    // buffer. If the SPI bus has DMA enabled, the block is streamed by
+    // the DMA while this task sleeps.
+    spi_.Read(block, kBlockSize);
+
+    // Then read the block's 16-bit CRC (i.e. read two bytes)
+    uint8_t crc_bytes[2];
+    spi_.Read(crc_bytes, sizeof(crc_bytes));
+    uint16_t block_crc =
+        static_cast<uint16_t>((crc_bytes[0] << 8) | crc_bytes[1]);
+
+    // Verify the block in place now that the transfer, or the DMA, has
+    // finished. The slice-by-8 CRC-16 reads the block 8 bytes at a time.
+    uint16_t expected_block_crc = GetCrc16(block, kBlockSize);
+    if (expected_block_crc != block_crc)
+    {
+      LOG_ERROR("Block CRC16 expected '0x%04X', got '0x%04X'",
+                expected_block_crc, block_crc);
+      return false;
+    }
+    return true;
+  }
+
+  // Ends a multi-block read with CMD12, while the card is still selected.
+  void StopStream()
+  {
+    LOG_DEBUG("Stopping read stream");
+    uint8_t r1 = 0xFF;
+    SendCmd(Command::kStopTrans, 0, &r1, 0, KeepAlive::kYes);
+    // CMD12 has an R1b response, the card is busy until it returns to 0xFF
+    PollWhileBusy();
+  }
+
+  // Read any number of blocks from the SD card.
+  //
+  // A single block is read with CMD17, so an isolated read costs one command.
+  // More blocks are streamed with one CMD18, which is stopped with CMD12
+  // before the card is deselected. No read is left open when this returns,
+  // so other devices on the bus never clock an open stream.
   uint8_t ReadBlock(uint32_t address,
                     uint8_t * array,
                     uint32_t blocks = 1) override
   {
     LOG_DEBUG("Block %" PRId32 " :: 0x%" PRIX32 " for %" PRId32 " blocks",
               address, address, blocks);
-    // Wait for a previous command to finish
-    WaitWhileBusy();
+    uint8_t r1 = 0x00;
 
-    // Create a temporary storage location to store sd command responses
-    Sd::CardInfo_t sd;
-    bool payload_had_bad_crc = false;
+    // Wait for a previous command to finish
+    SelectWhenReady();
 
-    // Create a temporary place to store blocks of 512 bytes (this is now
-    // possible because the constructor enforces block size cross-
-    // compatibility)
-    uint8_t block_store[512] = { 0 };
-
-    // Determine appropriate command to send
-    Command read_cmd;
-    if (blocks > 1)
-    {
-      read_cmd = Command::kReadMulti;
-    }
-    else
-    {
-      read_cmd = Command::kReadSingle;
-    }
+    Command read_cmd =
+        (blocks > 1) ? Command::kReadMulti : Command::kReadSingle;
 
     // Send initial read command
-    sd.response.length =
-        SendCmd(read_cmd, address, sd.response.data.byte, 100, KeepAlive::kYes);
+    uint32_t response =
+        SendCmd(read_cmd, ToCardAddress(address), &r1, 0, KeepAlive::kYes);
     LOG_DEBUG("Sent Read Cmd");
-    LOG_DEBUG("[R1 Response:0x%02X]", sd.response.data.byte[0]);
+    LOG_DEBUG("[R1 Response:0x%02X]", r1);
 
     // Check if the command was acknowledged properly
-    if (sd.response.data.byte[0] == 0x00)
+    if (response == static_cast<uint32_t>(-1) || r1 != 0x00)
     {
-      // For every block requested
-      uint16_t block_count;
-      for (block_count = 0; block_count < blocks; block_count++)
-      {
-        // Wait for the card to respond with a ready signal
-        WaitToReadBlock();
-
-        // Calculate the block address offset
-        uint16_t block_addr_offset =
-            static_cast<uint16_t>(block_count * kBlockSize);
-
-        // Read all the bytes of a single block
-        for (uint16_t byte_count = 0; byte_count < kBlockSize; byte_count++)
-        {
-          // Calculate the current storage index
-          uint16_t storage_index =
-              static_cast<uint16_t>(block_addr_offset + byte_count);
-
-          // Transfer a byte to read a block from the SD card
-          array[storage_index] = static_cast<uint8_t>(spi_.Transfer(0xFF));
-
-          // Copy that byte into our temporary block store
-          block_store[byte_count] = array[storage_index];
-        }
-
-        // Then read the block's 16-bit CRC (i.e. read two bytes)
-        uint16_t block_crc = static_cast<uint16_t>((spi_.Transfer(0xFF) << 8) |
-                                                   spi_.Transfer(0xFF));
-
-        // Run a CRC-16 calculation on the message to determine if the
-        // received CRCs match (i.e. checks if the block data is
-        // valid).
-        uint16_t expected_block_crc = GetCrc16(block_store, 512);
-
-        LOG_DEBUG("Block #%d @ 0x%" PRIX32 " acquired", block_count, address);
-        LOG_DEBUG("Expecting block crc16 '0x%04X'", expected_block_crc);
-        LOG_DEBUG("Got '0x%04X'", block_crc);
-        if (expected_block_crc != block_crc)
-        {
-          // If they do not match, set the bad crc status
-          payload_had_bad_crc = true;
-          LOG_ERROR("While Reading Block #%d CRC16:", block_count);
-          LOG_ERROR("Expected '0x%04X'", expected_block_crc);
-          LOG_ERROR("Got '0x%04X'", block_crc);
-        }
-      }
-
-      // After reading multiple blocks, send the stop command to terminate the
-      // transaction (i.e. no keep-alive)
-      if (blocks > 1)
-      {
-        sd.response.length =
-            SendCmd(Command::kStopTrans, 0xFFFFFFFF, sd.response.data.byte, 100,
-                    KeepAlive::kNo);
-      }
-
-      // DEBUG: Print out the latest response byte
-      LOG_DEBUG("Response Byte");
-      LOG_DEBUG("0x%02X", sd.response.data.byte[0]);
+      LOG_ERROR("Read Cmd was not acknowledged properly!");
+      LOG_ERROR("Parameter Err: %s", ToBool(r1 & 0x40));
+      LOG_ERROR("Addr Err: %s", ToBool(r1 & 0x20));
+      LOG_ERROR("Erase Seq Err: %s", ToBool(r1 & 0x10));
+      LOG_ERROR("Com CRC Err: %s", ToBool(r1 & 0x08));
+      LOG_ERROR("Illegal Cmd Err: %s", ToBool(r1 & 0x04));
+      LOG_ERROR("Erase Reset: %s", ToBool(r1 & 0x02));
+      LOG_ERROR("In Idle: %s", ToBool(r1 & 0x01));
+      chip_select_.Set(Gpio::State::kHigh);
+      return r1;
+    }
 
-      // If there was a bad crc from the payload, manually set the
-      // CRC error flag in the command response byte
-      if (payload_had_bad_crc)
+    bool payload_is_valid = true;
+    for (uint32_t block_count = 0; block_count < blocks; block_count++)
+    {
+      uint8_t * block = &array[block_count * kBlockSize];
+      if (!ReadDataBlock(block))
       {
-        sd.response.data.byte[0] |= 0x08;
+        LOG_ERROR("While Reading Block #%" PRIu32 " @ 0x%" PRIX32,
+                  block_count, address);
+        payload_is_valid = false;
       }
     }
-    else
+
+    if (read_cmd == Command::kReadMulti)
     {
-      LOG_ERROR("Read Cmd was not acknowledged properly!");
-      LOG_ERROR("Parameter Err: %s", ToBool(sd.response.data.byte[0] & 0x40));
-      LOG_ERROR("Addr Err: %s", ToBool(sd.response.data.byte[0] & 0x20));
-      LOG_ERROR("Erase Seq Err: %s", ToBool(sd.response.data.byte[0] & 0x10));
-      LOG_ERROR("Com CRC Err: %s", ToBool(sd.response.data.byte[0] & 0x08));
-      LOG_ERROR("Illegal Cmd Err: %s", ToBool(sd.response.data.byte[0] & 0x04));
-      LOG_ERROR("Erase Reset: %s", ToBool(sd.response.data.byte[0] & 0x02));
-      LOG_ERROR("In Idle: %s", ToBool(sd.response.data.byte[0] & 0x01));
+      StopStream();
     }
+    chip_select_.Set(Gpio::State::kHigh);
 
-    // Wait for the SD card to go out of idle state
-    LOG_DEBUG("Now waiting for SD Card to exit Idle Mode...");
-    do
+    // If there was a bad crc from the payload, manually set the
+    // CRC error flag in the command response byte
+    if (!payload_is_valid)
     {
-      // Query the status register
-      sd.response.length = SendCmd(Command::kGetStatus, 32,
-                                   sd.response.data.byte, 0, KeepAlive::kNo);
-    } while (sd.response.data.byte[0] & 0x01);
-    LOG_DEBUG("SD Card is out of Idle Mode!");
-
-    // Return the status
-    LOG_DEBUG("Read Complete! [R1 Response: 0x%02X]", sd.response.data.byte[0]);
-    return sd.response.data.byte[0];
+      r1 |= 0x08;
+    }
+    LOG_DEBUG("Read Complete! [R1 Response: 0x%02X]", r1);
+    return r1;
   }
 
   // Writes any number of 512-byte blocks to the SD Card
@@ -784,10 +909,11 @@ class Sd final : public SdInterface
                      uint32_t blocks = 1) override
   {
     // Wait for a previous command to finish
-    WaitWhileBusy();
+    SelectWhenReady();
 
     // Create a temporary storage location to store sd command responses
     Sd::CardInfo_t sd;
+    bool write_error = false;
 
     // Determine appropriate command and start token to send
     Command write_cmd;
@@ -804,8 +930,8 @@ class Sd final : public SdInterface
     }
 
     // Send initial write command
-    sd.response.length = SendCmd(write_cmd, address, sd.response.data.byte, 100,
-                                 KeepAlive::kYes);
+    sd.response.length = SendCmd(write_cmd, ToCardAddress(address),
+                                 sd.response.data.byte, 0, KeepAlive::kYes);
     LOG_DEBUG("Sent Write Cmd");
     LOG_DEBUG("[R1 Response:0x%02X]", sd.response.data.byte[0]);
 
@@ -825,55 +951,57 @@ class Sd final : public SdInterface
 
         // Write all 512-bytes of the given block
         LOG_DEBUG("Writing block #%d", current_block_num);
-        for (uint16_t current_byte = 0; current_byte < kBlockSize;
-             current_byte++)
-        {
-          spi_.Transfer(array[arr_offset + current_byte]);
-        }
-
-        // Read the data response token after writing the block
+        const uint8_t * block = &array[arr_offset];
+        spi_.Write(block, kBlockSize);
+
+        // Follow the block with its CRC-16. The card only checks it if CRC
+        // checking is on, but always expects the two bytes to be sent.
+        uint16_t block_crc =
+            GetCrc16(const_cast<uint8_t *>(block), kBlockSize);
+        uint8_t crc_bytes[] = { static_cast<uint8_t>(block_crc >> 8),
+                                static_cast<uint8_t>(block_crc) };
+        spi_.Write(crc_bytes, sizeof(crc_bytes));
+
+        // Read the data response token after writing the block. Its low 5
+        // bits are 0b00101 if the data was accepted, 0b01011 if it was
+        // rejected due to a CRC error and 0b01101 on a write error.
         uint8_t data_response_tkn = static_cast<uint8_t>(spi_.Transfer(0xFF));
-        LOG_DEBUG("Response Byte");
         LOG_DEBUG("[Data Response Token: 0x%02X]", data_response_tkn);
-        LOG_DEBUG("Data Accepted?: %s", ToBool(data_response_tkn & 0x05));
-        LOG_DEBUG("Data Rejected (bad crc)?: %s",
-                  ToBool(data_response_tkn & 0x0B));
-        LOG_DEBUG("Data Rejected (write err)?: %s",
-                  ToBool(data_response_tkn & 0x0D));
-
-        // If writing multiple blocks and the previous block was rejected
-        if (blocks > 1 && !(data_response_tkn & 0x05))
+        PollWhileBusy();
+
+        if ((data_response_tkn & 0x1F) != 0x05)
         {
-          // Send an immediate stop (CMD12)
-          sd.response.length =
-              SendCmd(Command::kStopTrans, 0xFFFFFFFF, sd.response.data.byte,
-                      100, KeepAlive::kYes);
-          LOG_DEBUG("Stopped Transmission due to rejection...");
-          LOG_DEBUG("[R1 Response: 0x%02X]", sd.response.data.byte[0]);
-
-          // In the case of a write error, ask for the reason why
-          if (data_response_tkn & 0x0D)
-          {
-            sd.response.length =
-                SendCmd(Command::kGetStatus, 0xFFFFFFFF, sd.response.data.byte,
-                        100, KeepAlive::kYes);
-            LOG_DEBUG(
-                "Checking Status Register to see cause of Write Error...");
-            LOG_DEBUG("[R2 Response: 0x%04" PRIX32 "]",
-                      sd.response.data.dWord.lo);
-          }
+          LOG_ERROR("Block #%d was rejected [Data Response Token: 0x%02X]",
+                    current_block_num, data_response_tkn);
+          // Report the rejection through the CRC error flag, as ReadBlock()
+          // does for a bad block
+          sd.response.data.byte[0] |= 0x08;
+          write_error = ((data_response_tkn & 0x1F) == 0x0D);
+          break;
         }
-        WaitWhileBusy();
       }
 
+      // A multi-block write is ended with the stop token, even if a block
+      // was rejected
       if (blocks > 1)
       {
         constexpr uint8_t kStopToken = 0xFD;
         spi_.Transfer(kStopToken);
+        // One byte goes by before the card starts programming
+        spi_.Transfer(0xFF);
 
         // Wait for the card's programming to complete before
         // reselecting it (i.e. to prevent corruption)
-        WaitWhileBusy();
+        PollWhileBusy();
+      }
+
+      // In the case of a write error, ask for the reason why
+      if (write_error)
+      {
+        uint8_t status[2] = { 0 };
+        SendCmd(Command::kGetStatus, 0, status, 0, KeepAlive::kYes);
+        LOG_ERROR("Write error [R2 Response: 0x%02X%02X]", status[0],
+                  status[1]);
       }
     }
     else
@@ -888,6 +1016,8 @@ class Sd final : public SdInterface
       LOG_DEBUG("In Idle: %s", ToBool(sd.response.data.byte[0] & 0x01));
     }
 
+    // Deselect the card, which lets other devices use the bus
+    chip_select_.Set(Gpio::State::kHigh);
     return sd.response.data.byte[0];
   }
 
@@ -895,7 +1025,7 @@ class Sd final : public SdInterface
   uint8_t DeleteBlock(uint32_t start, uint32_t end) override
   {
     // Wait for a previous command to finish
-    WaitWhileBusy();
+    SelectWhenReady();
 
     // Create a temporary storage location to store sd command responses
     Sd::CardInfo_t sd;
@@ -903,11 +1033,11 @@ class Sd final : public SdInterface
 
     // Set the delete start address
     LOG_DEBUG("Setting Delete Start Address...");
-    sd.response.length = SendCmd(Command::kDelFrom, start,
-                                 sd.response.data.byte, 100, KeepAlive::kYes);
+    sd.response.length = SendCmd(Command::kDelFrom, ToCardAddress(start),
+                                 sd.response.data.byte, 0, KeepAlive::kYes);
 
     // Wait while the writing the start address
-    WaitWhileBusy();
+    PollWhileBusy();
 
     // Force return if an error occurred
     if (sd.response.data.byte[0] != 0x00)
@@ -920,12 +1050,12 @@ class Sd final : public SdInterface
     if (!delete_failed)
     {
       LOG_DEBUG("Setting Delete End Address...");
-      sd.response.length = SendCmd(Command::kDelTo, end, sd.response.data.byte,
-                                   100, KeepAlive::kYes);
+      sd.response.length = SendCmd(Command::kDelTo, ToCardAddress(end),
+                                   sd.response.data.byte, 0, KeepAlive::kYes);
     }
 
     // Wait while the writing the end address
-    WaitWhileBusy();
+    PollWhileBusy();
 
     // Force return if an error occurred
     if (sd.response.data.byte[0] != 0x00)
@@ -940,16 +1070,19 @@ class Sd final : public SdInterface
       // Issue the delete command to delete from our from:to range
       LOG_DEBUG("Issuing Delete Command...");
       sd.response.length = SendCmd(Command::kDel, 0xFFFFFFFF,
-                                   sd.response.data.byte, 100, KeepAlive::kYes);
+                                   sd.response.data.byte, 0, KeepAlive::kYes);
 
       // Wait while the deletion occurs
-      WaitWhileBusy();
+      PollWhileBusy();
 
       // Check response
       LOG_DEBUG("[R1 Response: 0x%02X]", sd.response.data.byte[0]);
       LOG_DEBUG("Deletion Complete...");
     }
 
+    // Deselect the card, which lets other devices use the bus
+    chip_select_.Set(Gpio::State::kHigh);
+
     // Return status
     return sd.response.data.byte[0];
   }
@@ -976,6 +1109,9 @@ class Sd final : public SdInterface
       case Command::kReset: res_type = ResponseType::kR1; break;
       case Command::kInit: res_type = ResponseType::kR1; break;
       case Command::kGetOp: res_type = ResponseType::kR7; break;
+      case Command::kSwitchFunction: res_type = ResponseType::kR1; break;
+      case Command::kGetCsd: res_type = ResponseType::kR1; break;
+      case Command::kSendCid: res_type = ResponseType::kR1; break;
       case Command::kStopTrans: res_type = ResponseType::kR1; break;
       case Command::kGetStatus: res_type = ResponseType::kR2; break;
       case Command::kAcBegin: res_type = ResponseType::kR1; break;
@@ -1018,19 +1154,13 @@ class Sd final : public SdInterface
       Delay(std::chrono::milliseconds(delay));
     }
 
-    // Send the desired command frame to the SD card board
-    // Begin by transfering the command byte
-    spi_.Transfer(static_cast<uint16_t>(sdc));
-    // Send arg byte [31:24]
-    spi_.Transfer(static_cast<uint16_t>(arg >> 24) & 0xFF);
-    // Send arg byte [23:16]
-    spi_.Transfer(static_cast<uint16_t>(arg >> 16) & 0xFF);
-    // Send arg byte [15:8]
-    spi_.Transfer(static_cast<uint16_t>(arg >> 8) & 0xFF);
-    // Send arg byte [7:0]
-    spi_.Transfer(static_cast<uint16_t>(arg >> 0) & 0xFF);
-    // Send 7-bit CRC and LSB stop addr (as b1)
-    spi_.Transfer(static_cast<uint16_t>(crc << 1) | 0x01);
+    // Send the desired command frame to the SD card board: the command byte
+    // and argument bytes [31:0] followed by the 7-bit CRC and LSB stop addr
+    // (as b1)
+    uint8_t frame[sizeof(msg) + 1];
+    memcpy(frame, msg, sizeof(msg));
+    frame[sizeof(msg)] = static_cast<uint8_t>((crc << 1) | 0x01);
+    spi_.Write(frame, sizeof(frame));
 
     // Write garbage while waiting for a response
     // Send at least 1 byte of garbage before checking for a response
@@ -1102,34 +1232,22 @@ class Sd final : public SdInterface
   // Adds a message byte to the current CRC-7 to get a the new CRC-7
   uint8_t Crc7Add(uint8_t crc, uint8_t message_byte) override
   {
-    return kCrcTable8.crc_table[(crc << 1) ^ message_byte];
+    uint8_t crc_register = crc::Crc7::ToRegister(crc);
+    crc_register = crc::Crc7::Slice1(crc_register, &message_byte, 1);
+    return crc::Crc7::Finalize(crc_register);
   }
 
   // Returns the CRC-7 for a message of "length" bytes
   uint8_t GetCrc7(uint8_t * message, uint8_t length) override
   {
-    uint8_t crc = 0;
-    for (int i = 0; i < length; i++)
-    {
-      crc = Crc7Add(crc, message[i]);
-    }
-    return crc;
+    return crc::Crc7::Calculate(message, length);
   }
 
-  // Returns CCITT CRC-16 for a message of "length" bytes
+  // Returns the CCITT CRC-16 for a message of "length" bytes
   uint16_t GetCrc16(uint8_t * message, uint16_t length) override
   {
-    uint64_t crc = 0x0000;
-    uint64_t temp;
-    uint64_t final_value = 0;
-
-    for (uint64_t count = 0; count < length; ++count)
-    {
-      temp = (*message++ ^ (crc >> 8)) & 0xff;
-      crc  = kCrcTable16.crc_table[temp] ^ (crc << 8);
-    }
-
-    return static_cast<uint16_t>(crc ^ final_value);
+    return static_cast<uint16_t>(
+        crc_.Calculate(sjsu::Crc::Algorithm::kCrc16Ccitt, message, length));
   }
 
  private:
@@ -1137,5 +1255,10 @@ class Sd final : public SdInterface
   const Spi & spi_;
   /// @description     the object reference to use when using CS (GPIO)
   const Gpio & chip_select_;
+  /// @description     the object reference used to check data blocks
+  const sjsu::Crc & crc_;
+  /// @description     the capacity class of the mounted card, which sets
+  ///                  how its blocks are addressed
+  Type type_ = Type::kSDHC;
 };
 }  // namespace sjsu
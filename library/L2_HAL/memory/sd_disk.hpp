@@ -0,0 +1,154 @@
+/// SdDisk is the glue between FatFs's disk_* functions and an SD card. It
+/// mounts the card, keeps a SectorCache in front of it and answers the
+/// disk_ioctl() commands FatFs uses. A platform's diskio.cpp forwards each
+/// disk_* call to its SdDisk and adds what only the board knows about, such as
+/// the card detect pin and locking. Host tests mount the same glue onto
+/// SdCardEmulator.
+///
+/// Usage:
+///
+///     SdDisk<8> disk(sd_card);
+///     disk.Initialize();
+///     disk.Read(buffer, sector, 1);
+#pragma once
+
+#include <diskio.h>
+#include <ff.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "L2_HAL/memory/sd.hpp"
+#include "L2_HAL/memory/sector_cache.hpp"
+#include "utility/status.hpp"
+
+namespace sjsu
+{
+template <size_t kCacheSectors>
+class SdDisk
+{
+ public:
+  /// @param card - card to mount
+  /// @param read_ahead - see SectorCache
+  explicit SdDisk(SdInterface & card, uint32_t read_ahead = 0)
+      : card_(card), cache_(card, read_ahead)
+  {
+  }
+
+  /// Initializes and mounts the card. May be called again to remount it.
+  ///
+  /// @returns 0 on success, STA_NOINIT if the card could not be mounted.
+  DSTATUS Initialize()
+  {
+    SdInterface::CardInfo_t mounted_card;
+    card_.Initialize();
+    if (!card_.Mount(&mounted_card))
+    {
+      return STA_NOINIT;
+    }
+    // Sectors the cache still holds dirty belong on this card, so they are
+    // written out before the cache is emptied. The only exception is a card
+    // with a different CID, which means the card was swapped, and the sectors
+    // belong to a card that is no longer there.
+    bool swapped = initialized_ && memcmp(mounted_card.cid.byte,
+                                          card_info_.cid.byte,
+                                          sizeof(card_info_.cid.byte)) != 0;
+    if (!swapped && cache_.Flush() != Status::kSuccess)
+    {
+      return STA_NOINIT;
+    }
+    cache_.Invalidate();
+    card_info_   = mounted_card;
+    initialized_ = true;
+    return 0;
+  }
+
+  bool IsInitialized() const
+  {
+    return initialized_;
+  }
+
+  DRESULT Read(BYTE * buffer, DWORD sector, UINT count)
+  {
+    Status status = cache_.Read(sector, buffer, static_cast<uint32_t>(count));
+    return (status == Status::kSuccess) ? RES_OK : RES_ERROR;
+  }
+
+  DRESULT Write(const BYTE * buffer, DWORD sector, UINT count)
+  {
+    Status status = cache_.Write(sector, buffer, static_cast<uint32_t>(count));
+    return (status == Status::kSuccess) ? RES_OK : RES_ERROR;
+  }
+
+  /// Handles the disk_ioctl() commands FatFs issues. The card's size comes
+  /// from the CSD register read when it was mounted.
+  DRESULT Ioctl(BYTE command, void * buffer)
+  {
+    if (!initialized_)
+    {
+      return RES_NOTRDY;
+    }
+
+    DRESULT result = RES_PARERR;
+    switch (command)
+    {
+      case CTRL_SYNC:
+      {
+        // Push out the cached sectors, then wait for the card to finish
+        // programming them.
+        Status status = cache_.Flush();
+        if (status == Status::kSuccess)
+        {
+          card_.WaitWhileBusy();
+        }
+        result = (status == Status::kSuccess) ? RES_OK : RES_ERROR;
+        break;
+      }
+      case GET_SECTOR_COUNT:
+        *static_cast<DWORD *>(buffer) = card_info_.csd.GetBlockCount();
+        result                        = RES_OK;
+        break;
+      case GET_SECTOR_SIZE:
+        *static_cast<WORD *>(buffer) = FF_MAX_SS;
+        result                       = RES_OK;
+        break;
+      case GET_BLOCK_SIZE:
+        *static_cast<DWORD *>(buffer) = card_info_.csd.GetEraseBlockSize();
+        result                        = RES_OK;
+        break;
+      case CTRL_TRIM:
+      {
+        // FatFs passes the first and last sector of the range to erase
+        const DWORD * range = static_cast<const DWORD *>(buffer);
+        cache_.Discard(range[0], range[1]);
+        uint8_t r1 = card_.DeleteBlock(range[0], range[1]);
+        result     = (r1 == 0x00) ? RES_OK : RES_ERROR;
+        break;
+      }
+      default: break;
+    }
+    return result;
+  }
+
+  SectorCache<kCacheSectors> & GetCache()
+  {
+    return cache_;
+  }
+
+  const SdInterface::CardInfo_t & GetCardInfo() const
+  {
+    return card_info_;
+  }
+
+ private:
+  SdInterface & card_;
+  /// FatFs re-reads and rewrites its FAT and directory sectors on nearly every
+  /// f_write(), so those accesses are absorbed by a write-back cache rather
+  /// than going to the card each time.
+  SectorCache<kCacheSectors> cache_;
+  /// Filled in when the card is mounted
+  SdInterface::CardInfo_t card_info_;
+  bool initialized_ = false;
+};
+}  // namespace sjsu
@@ -0,0 +1,948 @@
+/// SdMci talks to an SD card through the LPC40xx SD/MMC card interface (MCI)
+/// in native SD mode with a 4-bit data bus. Commands are sent by the MCI
+/// command path state machine and block data is moved between the MCI FIFO
+/// and memory by the GPDMA, with the MCI acting as the DMA flow controller.
+///
+/// Order of function calls should be as follows:
+///
+///     1. Constructor (create object)
+///     2. Initialize()
+///     3. Mount(...)
+///     4. ReadBlock(...), WriteBlock(...), DeleteBlock(...)
+///
+/// NOTE: The SJTwo board wires its SD card slot to SSP2, thus this driver is
+/// only used by sjtwo::SdCard() if SJ2_SD_USE_MCI is set to true.
+/// See chapter 30 of user manual UM10562 and the SD Physical Layer Simplified
+/// Specification V6.00 for more details.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+
+#include "L0_Platform/lpc40xx/LPC40xx.h"
+#include "L1_Peripheral/lpc40xx/dma.hpp"
+#include "L1_Peripheral/lpc40xx/pin.hpp"
+#include "L1_Peripheral/lpc40xx/system_controller.hpp"
+#include "L2_HAL/memory/sd.hpp"
+#include "utility/bit.hpp"
+#include "utility/crc.hpp"
+#include "utility/enum.hpp"
+#include "utility/log.hpp"
+#include "utility/status.hpp"
+#include "utility/time.hpp"
+
+namespace sjsu
+{
+namespace lpc40xx
+{
+class SdMci final : public sjsu::SdInterface
+{
+ public:
+  // MCIPower: Power Control Register
+  struct PowerRegister  // NOLINT
+  {
+    static constexpr bit::Mask kControl   = bit::CreateMaskFromRange(0, 1);
+    static constexpr bit::Mask kOpenDrain = bit::CreateMaskFromRange(6);
+    static constexpr bit::Mask kRod       = bit::CreateMaskFromRange(7);
+  };
+  // MCIClock: Clock Control Register
+  struct ClockRegister  // NOLINT
+  {
+    static constexpr bit::Mask kDivider   = bit::CreateMaskFromRange(0, 7);
+    static constexpr bit::Mask kEnable    = bit::CreateMaskFromRange(8);
+    static constexpr bit::Mask kPowerSave = bit::CreateMaskFromRange(9);
+    static constexpr bit::Mask kBypass    = bit::CreateMaskFromRange(10);
+    static constexpr bit::Mask kWideBus   = bit::CreateMaskFromRange(11);
+  };
+  // MCICommand: Command Register
+  struct CommandRegister  // NOLINT
+  {
+    static constexpr bit::Mask kIndex        = bit::CreateMaskFromRange(0, 5);
+    static constexpr bit::Mask kResponse     = bit::CreateMaskFromRange(6);
+    static constexpr bit::Mask kLongResponse = bit::CreateMaskFromRange(7);
+    static constexpr bit::Mask kInterrupt    = bit::CreateMaskFromRange(8);
+    static constexpr bit::Mask kPending      = bit::CreateMaskFromRange(9);
+    static constexpr bit::Mask kEnable       = bit::CreateMaskFromRange(10);
+  };
+  // MCIDataCtrl: Data Control Register
+  struct DataControlRegister  // NOLINT
+  {
+    static constexpr bit::Mask kEnable    = bit::CreateMaskFromRange(0);
+    static constexpr bit::Mask kDirection = bit::CreateMaskFromRange(1);
+    static constexpr bit::Mask kMode      = bit::CreateMaskFromRange(2);
+    static constexpr bit::Mask kDmaEnable = bit::CreateMaskFromRange(3);
+    static constexpr bit::Mask kBlockSize = bit::CreateMaskFromRange(4, 7);
+  };
+  // MCIStatus: Status Register
+  struct StatusRegister  // NOLINT
+  {
+    static constexpr bit::Mask kCommandCrcFail  = bit::CreateMaskFromRange(0);
+    static constexpr bit::Mask kDataCrcFail     = bit::CreateMaskFromRange(1);
+    static constexpr bit::Mask kCommandTimeOut  = bit::CreateMaskFromRange(2);
+    static constexpr bit::Mask kDataTimeOut     = bit::CreateMaskFromRange(3);
+    static constexpr bit::Mask kTransmitUnderrun = bit::CreateMaskFromRange(4);
+    static constexpr bit::Mask kReceiveOverrun  = bit::CreateMaskFromRange(5);
+    static constexpr bit::Mask kCommandResponseEnd =
+        bit::CreateMaskFromRange(6);
+    static constexpr bit::Mask kCommandSent  = bit::CreateMaskFromRange(7);
+    static constexpr bit::Mask kDataEnd      = bit::CreateMaskFromRange(8);
+    static constexpr bit::Mask kStartBitError = bit::CreateMaskFromRange(9);
+    static constexpr bit::Mask kDataBlockEnd = bit::CreateMaskFromRange(10);
+    static constexpr bit::Mask kReceiveDataAvailable =
+        bit::CreateMaskFromRange(21);
+    /// Every flag that can be cleared through the MCIClear register
+    static constexpr bit::Mask kClearable = bit::CreateMaskFromRange(0, 10);
+  };
+
+  /// Response formats the command path state machine can wait for
+  enum class Response : uint8_t
+  {
+    kNone,
+    kShort,
+    /// R3 responses have no CRC, so a CRC failure is expected
+    kShortWithoutCrc,
+    kLong,
+  };
+
+  struct Bus_t
+  {
+    const sjsu::Pin & clock;
+    const sjsu::Pin & command;
+    const sjsu::Pin & power;
+    const sjsu::Pin & data0;
+    const sjsu::Pin & data1;
+    const sjsu::Pin & data2;
+    const sjsu::Pin & data3;
+    uint8_t pin_function_id;
+  };
+
+  struct Bus  // NOLINT
+  {
+   private:
+    inline static const sjsu::lpc40xx::Pin kClock =
+        sjsu::lpc40xx::Pin::CreatePin<1, 2>();
+    inline static const sjsu::lpc40xx::Pin kCommand =
+        sjsu::lpc40xx::Pin::CreatePin<1, 3>();
+    inline static const sjsu::lpc40xx::Pin kPower =
+        sjsu::lpc40xx::Pin::CreatePin<1, 5>();
+    inline static const sjsu::lpc40xx::Pin kData0 =
+        sjsu::lpc40xx::Pin::CreatePin<1, 6>();
+    inline static const sjsu::lpc40xx::Pin kData1 =
+        sjsu::lpc40xx::Pin::CreatePin<1, 7>();
+    inline static const sjsu::lpc40xx::Pin kData2 =
+        sjsu::lpc40xx::Pin::CreatePin<1, 11>();
+    inline static const sjsu::lpc40xx::Pin kData3 =
+        sjsu::lpc40xx::Pin::CreatePin<1, 12>();
+
+   public:
+    inline static const Bus_t kSdCard = {
+      .clock           = kClock,
+      .command         = kCommand,
+      .power           = kPower,
+      .data0           = kData0,
+      .data1           = kData1,
+      .data2           = kData2,
+      .data3           = kData3,
+      .pin_function_id = 0b010,
+    };
+  };
+
+  static constexpr uint16_t kBlockSize = 512;
+  /// Number of attempts made while waiting for the card to power up
+  static constexpr uint8_t kBusTimeout = 250;
+  /// A single GPDMA descriptor moves at most kMaxTransferSize words
+  static constexpr uint32_t kMaxBlocksPerTransfer =
+      (sjsu::lpc40xx::Dma::kMaxTransferSize * sizeof(uint32_t)) / kBlockSize;
+  static constexpr units::frequency::hertz_t kIdentificationClock = 400_kHz;
+  static constexpr units::frequency::hertz_t kDefaultSpeedClock   = 25_MHz;
+  static constexpr units::frequency::hertz_t kHighSpeedClock      = 50_MHz;
+  static constexpr std::chrono::microseconds kCommandTimeout      = 10ms;
+  static constexpr std::chrono::microseconds kDataTimeout         = 500ms;
+
+  inline static LPC_MCI_TypeDef * mci = LPC_MCI;
+
+  explicit constexpr SdMci(const Bus_t & bus,
+                           const sjsu::lpc40xx::Dma & dma,
+                           const sjsu::SystemController & system_controller =
+                               DefaultSystemController())
+      : bus_(bus), dma_(dma), system_controller_(system_controller)
+  {
+  }
+
+  /// Powers on the MCI, activates the MCI pins and takes a GPDMA channel for
+  /// block transfers.
+  void Initialize() override
+  {
+    system_controller_.PowerUpPeripheral(
+        sjsu::lpc40xx::SystemController::Peripherals::kSdCard);
+
+    bus_.clock.SetPinFunction(bus_.pin_function_id);
+    bus_.command.SetPinFunction(bus_.pin_function_id);
+    bus_.power.SetPinFunction(bus_.pin_function_id);
+    bus_.data0.SetPinFunction(bus_.pin_function_id);
+    bus_.data1.SetPinFunction(bus_.pin_function_id);
+    bus_.data2.SetPinFunction(bus_.pin_function_id);
+    bus_.data3.SetPinFunction(bus_.pin_function_id);
+
+    mci->MASK0 = 0;
+    mci->CLEAR = ToFlags(StatusRegister::kClearable);
+
+    if (channel_ == sjsu::lpc40xx::Dma::kInvalidChannel)
+    {
+      dma_.Initialize();
+      channel_ = dma_.AllocateChannel();
+    }
+  }
+
+  /// Runs the native mode identification sequence, then switches the card to
+  /// a 4-bit bus and, if the card supports it, high speed mode.
+  bool Mount(CardInfo_t * sd) override
+  {
+    // Ramp up the card's supply, then drive the bus in open drain mode at
+    // less than 400kHz during identification.
+    mci->POWER = bit::Insert(uint32_t{ 0 }, 0b10, PowerRegister::kControl);
+    Delay(2ms);
+    mci->POWER = bit::Insert(mci->POWER, 0b11, PowerRegister::kControl);
+    mci->POWER = bit::Set(mci->POWER, PowerRegister::kOpenDrain.position);
+    SetClock(kIdentificationClock, false);
+    // Give the card at least 74 clock cycles to finish powering up
+    Delay(1ms);
+
+    relative_address_ = 0;
+    IssueCommand(Command::kReset, 0, Response::kNone);
+
+    // Version 2.00 cards echo back the check pattern, older cards do not
+    // respond to CMD8 at all.
+    constexpr uint32_t kVoltageCheck = 0x1AA;
+    uint32_t response[4]             = { 0 };
+    bool is_version2 =
+        IssueCommand(Command::kGetOp, kVoltageCheck, Response::kShort,
+                     response) == Status::kSuccess &&
+        (response[0] & 0xFFF) == kVoltageCheck;
+
+    // Ask for 2.7V to 3.6V and advertise high capacity support
+    constexpr uint32_t kVoltageWindow = 0x00FF8000;
+    uint32_t operating_conditions =
+        (is_version2) ? (kVoltageWindow | (1 << util::Value(Ocr::kCcs)))
+                      : kVoltageWindow;
+    bool is_powered_up = false;
+    for (uint8_t tries = 0; tries < kBusTimeout && !is_powered_up; tries++)
+    {
+      is_powered_up =
+          IssueApplicationCommand(Command::kAcInit, operating_conditions,
+                                  Response::kShortWithoutCrc,
+                                  response) == Status::kSuccess &&
+          bit::Read(response[0], util::Value(Ocr::kPwrUpComplete));
+      if (!is_powered_up)
+      {
+        Delay(10ms);
+      }
+    }
+    if (!is_powered_up)
+    {
+      LOG_ERROR("SD Card did not finish powering up. Aborting!");
+      return false;
+    }
+
+    sd->ocr.byte[0] = static_cast<uint8_t>(response[0] >> 24);
+    sd->ocr.byte[1] = static_cast<uint8_t>(response[0] >> 16);
+    sd->ocr.byte[2] = static_cast<uint8_t>(response[0] >> 8);
+    sd->ocr.byte[3] = static_cast<uint8_t>(response[0] >> 0);
+    sd->type = (bit::Read(response[0], util::Value(Ocr::kCcs))) ? Type::kSDHC
+                                                                 : Type::kSDSC;
+    type_    = sd->type;
+
+    // Move the card from identification to stand-by state
+    if (IssueCommand(Command::kGetCid, 0, Response::kLong, response) !=
+        Status::kSuccess)
+    {
+      LOG_ERROR("SD Card did not send its identification. Aborting!");
+      return false;
+    }
+    CopyRegister(response, &sd->cid);
+    if (IssueCommand(Command::kGetRelativeAddress, 0, Response::kShort,
+                     response) != Status::kSuccess)
+    {
+      LOG_ERROR("SD Card did not publish a relative address. Aborting!");
+      return false;
+    }
+    relative_address_ = response[0] & 0xFFFF'0000;
+
+    // The CSD can only be read while the card is in the stand-by state
+    if (IssueCommand(Command::kGetCsd, relative_address_, Response::kLong,
+                     response) != Status::kSuccess)
+    {
+      LOG_ERROR("Failed to read the CSD register. Aborting!");
+      return false;
+    }
+    CopyRegister(response, &sd->csd);
+
+    // Identification is over, the bus can now run in push-pull mode as fast
+    // as the card's TRAN_SPEED allows.
+    units::frequency::hertz_t max_clock = sd->csd.GetMaxClock();
+    if (max_clock == 0_Hz)
+    {
+      max_clock = kDefaultSpeedClock;
+    }
+    mci->POWER = bit::Clear(mci->POWER, PowerRegister::kOpenDrain.position);
+    SetClock(max_clock, false);
+
+    if (IssueCommand(Command::kSelectCard, relative_address_, Response::kShort,
+                     response) != Status::kSuccess)
+    {
+      LOG_ERROR("Failed to select the SD Card. Aborting!");
+      return false;
+    }
+
+    constexpr uint32_t kFourBitBus = 0b10;
+    if (IssueApplicationCommand(Command::kSetBusWidth, kFourBitBus,
+                                Response::kShort,
+                                response) == Status::kSuccess)
+    {
+      SetClock(max_clock, true);
+    }
+    else
+    {
+      LOG_WARNING("SD Card rejected the 4-bit bus, staying with 1-bit.");
+    }
+
+    if (type_ == Type::kSDSC)
+    {
+      IssueCommand(Command::kChgBlkLen, kBlockSize, Response::kShort, response);
+    }
+
+    constexpr uint8_t kSwitchCommandClass = 10;
+    if (sd->csd.SupportsCommandClass(kSwitchCommandClass) &&
+        SwitchToHighSpeed())
+    {
+      SetClock(kHighSpeedClock, wide_bus_);
+    }
+    sd->clock = GetClock();
+
+    sd->response.length = sizeof(uint32_t);
+    sd->response.data.byte[0] = static_cast<uint8_t>(response[0] >> 24);
+    sd->response.data.byte[1] = static_cast<uint8_t>(response[0] >> 16);
+    sd->response.data.byte[2] = static_cast<uint8_t>(response[0] >> 8);
+    sd->response.data.byte[3] = static_cast<uint8_t>(response[0] >> 0);
+    return true;
+  }
+
+  /// Reads blocks from the card. The address is a block number, which is
+  /// converted to a byte address for standard capacity cards.
+  ///
+  /// @returns an SPI mode style R1 byte, 0x00 on success.
+  uint8_t ReadBlock(uint32_t address,
+                    uint8_t * array,
+                    uint32_t blocks = 1) override
+  {
+    return TransferBlocks(Direction::kRead, address, array, blocks);
+  }
+
+  /// Writes blocks to the card. The address is a block number, which is
+  /// converted to a byte address for standard capacity cards.
+  ///
+  /// @returns an SPI mode style R1 byte, 0x00 on success.
+  uint8_t WriteBlock(uint32_t address,
+                     const uint8_t * array,
+                     uint32_t blocks = 1) override
+  {
+    return TransferBlocks(Direction::kWrite, address,
+                          const_cast<uint8_t *>(array), blocks);
+  }
+
+  /// Erases the blocks from start to end inclusively.
+  ///
+  /// @returns an SPI mode style R1 byte, 0x00 on success.
+  uint8_t DeleteBlock(uint32_t start, uint32_t end) override
+  {
+    if (!WaitUntilReady())
+    {
+      return kR1Timeout;
+    }
+
+    uint32_t response[4]  = { 0 };
+    const Command kSequence[] = { Command::kDelFrom, Command::kDelTo,
+                                  Command::kDel };
+    const uint32_t kArguments[] = { ToCardAddress(start), ToCardAddress(end),
+                                    0 };
+    for (size_t i = 0; i < std::size(kSequence); i++)
+    {
+      Status status = IssueCommand(kSequence[i], kArguments[i],
+                                   Response::kShort, response);
+      if (status != Status::kSuccess)
+      {
+        return ToR1(status);
+      }
+      uint8_t r1 = ToR1(response[0]);
+      if (r1 != 0)
+      {
+        return r1;
+      }
+    }
+
+    // CMD38 holds DAT0 low until the erase has completed
+    return (WaitUntilReady()) ? 0x00 : kR1Timeout;
+  }
+
+  /// Polls the card's status until it has finished programming or erasing.
+  void WaitWhileBusy() override
+  {
+    if (!WaitUntilReady())
+    {
+      LOG_ERROR("SD Card is still busy!");
+    }
+  }
+
+  /// Sends a command to the card and copies its response into
+  /// response_buffer, most significant byte first. Short responses are 4
+  /// bytes long, while the CID and CSD registers returned by CMD2 and CMD9 are
+  /// 16 bytes long. The delay and keep_alive parameters only matter for SPI
+  /// mode and are ignored.
+  ///
+  /// @returns the number of bytes in the response or -1 on failure.
+  uint32_t SendCmd(Command sdc,
+                   uint32_t arg,
+                   uint8_t response_buffer[],
+                   [[maybe_unused]] uint32_t delay,
+                   [[maybe_unused]] KeepAlive keep_alive) override
+  {
+    Response format;
+    switch (sdc)
+    {
+      case Command::kReset: format = Response::kNone; break;
+      case Command::kGetCid:
+      case Command::kGetCsd: format = Response::kLong; break;
+      case Command::kAcInit: format = Response::kShortWithoutCrc; break;
+      case Command::kGarbage:
+      case Command::kGetOcr:
+        LOG_ERROR("Command is only supported in SPI mode. Aborting!");
+        return -1;
+      default: format = Response::kShort; break;
+    }
+
+    uint32_t response[4] = { 0 };
+    if (IssueCommand(sdc, arg, format, response) != Status::kSuccess)
+    {
+      return -1;
+    }
+
+    uint32_t length = 0;
+    switch (format)
+    {
+      case Response::kNone: length = 0; break;
+      case Response::kLong: length = 16; break;
+      default: length = 4; break;
+    }
+    if (response_buffer != nullptr)
+    {
+      for (uint32_t i = 0; i < length; i++)
+      {
+        response_buffer[i] =
+            static_cast<uint8_t>(response[i / 4] >> (24 - 8 * (i % 4)));
+      }
+    }
+    return length;
+  }
+
+  /// Program the MCI clock divider for the desired card clock. The card clock
+  /// is never set faster than the requested frequency.
+  ///
+  /// @param frequency - desired card clock frequency
+  /// @param wide_bus - use all 4 data lines rather than just DAT0
+  void SetClock(units::frequency::hertz_t frequency, bool wide_bus)
+  {
+    // MCLK = PCLK / (2 * (divider + 1)), see table 568 of UM10562
+    auto peripheral_frequency = system_controller_.GetPeripheralFrequency(
+        sjsu::lpc40xx::SystemController::Peripherals::kSdCard);
+    uint32_t peripheral_hz = peripheral_frequency.to<uint32_t>();
+    uint32_t target_hz     = frequency.to<uint32_t>();
+
+    uint32_t clock = 0;
+    if (peripheral_hz <= target_hz)
+    {
+      clock = bit::Set(clock, ClockRegister::kBypass.position);
+      clock_frequency_ = peripheral_frequency;
+    }
+    else
+    {
+      uint32_t twice_target = 2 * target_hz;
+      uint32_t divider = (peripheral_hz + twice_target - 1) / twice_target;
+      divider          = (divider > 0) ? divider - 1 : 0;
+      divider          = (divider > 0xFF) ? 0xFF : divider;
+      clock            = bit::Insert(clock, divider, ClockRegister::kDivider);
+      clock_frequency_ = units::frequency::hertz_t(
+          static_cast<float>(peripheral_hz / (2 * (divider + 1))));
+    }
+    clock      = bit::Insert(clock, wide_bus, ClockRegister::kWideBus);
+    clock      = bit::Set(clock, ClockRegister::kEnable.position);
+    mci->CLOCK = clock;
+    wide_bus_  = wide_bus;
+  }
+
+  /// @returns the card clock frequency set by the last call to SetClock().
+  units::frequency::hertz_t GetClock() const
+  {
+    return clock_frequency_;
+  }
+
+  uint8_t Crc7Add(uint8_t crc, uint8_t message_byte) override
+  {
+    uint8_t crc_register = crc::Crc7::ToRegister(crc);
+    crc_register = crc::Crc7::Slice1(crc_register, &message_byte, 1);
+    return crc::Crc7::Finalize(crc_register);
+  }
+
+  uint8_t GetCrc7(uint8_t * message, uint8_t length) override
+  {
+    return crc::Crc7::Calculate(message, length);
+  }
+
+  uint16_t GetCrc16(uint8_t * message, uint16_t length) override
+  {
+    return crc::Crc16Ccitt::Calculate(message, length);
+  }
+
+ private:
+  enum class Direction : uint8_t
+  {
+    kWrite = 0,
+    kRead  = 1,
+  };
+
+  /// R1 style error bits returned by the block functions, matching the SPI
+  /// mode driver.
+  static constexpr uint8_t kR1Timeout            = 0xFF;
+  static constexpr uint8_t kR1ParameterError     = 0x40;
+  static constexpr uint8_t kR1AddressError       = 0x20;
+  static constexpr uint8_t kR1EraseSequenceError = 0x10;
+  static constexpr uint8_t kR1CrcError           = 0x08;
+  static constexpr uint8_t kR1IllegalCommand     = 0x04;
+  static constexpr uint8_t kR1EraseReset         = 0x02;
+
+  /// Native mode card status bits, see section 4.10.1 of the Physical Layer
+  /// specification.
+  struct CardStatus  // NOLINT
+  {
+    static constexpr bit::Mask kOutOfRange   = bit::CreateMaskFromRange(31);
+    static constexpr bit::Mask kAddressError = bit::CreateMaskFromRange(30);
+    static constexpr bit::Mask kBlockLengthError = bit::CreateMaskFromRange(29);
+    static constexpr bit::Mask kEraseSequenceError =
+        bit::CreateMaskFromRange(28);
+    static constexpr bit::Mask kEraseParameter = bit::CreateMaskFromRange(27);
+    static constexpr bit::Mask kCrcError       = bit::CreateMaskFromRange(23);
+    static constexpr bit::Mask kIllegalCommand = bit::CreateMaskFromRange(22);
+    static constexpr bit::Mask kEraseReset     = bit::CreateMaskFromRange(13);
+    static constexpr bit::Mask kCurrentState = bit::CreateMaskFromRange(9, 12);
+    static constexpr bit::Mask kReadyForData = bit::CreateMaskFromRange(8);
+  };
+  static constexpr uint32_t kTransferState = 4;
+
+  /// @returns the register bits covered by the mask
+  static constexpr uint32_t ToFlags(bit::Mask mask)
+  {
+    return ((uint32_t{ 1 } << mask.width) - 1) << mask.position;
+  }
+
+  static uint8_t ToR1(uint32_t card_status)
+  {
+    uint8_t r1 = 0;
+    auto is_set = [card_status](bit::Mask mask) {
+      return bit::Read(card_status, mask.position);
+    };
+    if (is_set(CardStatus::kOutOfRange) ||
+        is_set(CardStatus::kBlockLengthError) ||
+        is_set(CardStatus::kEraseParameter))
+    {
+      r1 |= kR1ParameterError;
+    }
+    if (is_set(CardStatus::kAddressError))
+    {
+      r1 |= kR1AddressError;
+    }
+    if (is_set(CardStatus::kEraseSequenceError))
+    {
+      r1 |= kR1EraseSequenceError;
+    }
+    if (is_set(CardStatus::kCrcError))
+    {
+      r1 |= kR1CrcError;
+    }
+    if (is_set(CardStatus::kIllegalCommand))
+    {
+      r1 |= kR1IllegalCommand;
+    }
+    if (is_set(CardStatus::kEraseReset))
+    {
+      r1 |= kR1EraseReset;
+    }
+    return r1;
+  }
+
+  static uint8_t ToR1(Status status)
+  {
+    switch (status)
+    {
+      case Status::kSuccess: return 0x00;
+      case Status::kBusError: return kR1CrcError;
+      case Status::kInvalidParameters: return kR1ParameterError;
+      default: return kR1Timeout;
+    }
+  }
+
+  /// Copies a long response, i.e. the CID or CSD, into the register most
+  /// significant byte first.
+  static void CopyRegister(const uint32_t response[4],
+                           CardRegister_t * card_register)
+  {
+    for (size_t i = 0; i < sizeof(card_register->byte); i++)
+    {
+      card_register->byte[i] =
+          static_cast<uint8_t>(response[i / 4] >> (24 - 8 * (i % 4)));
+    }
+  }
+
+  uint32_t ToCardAddress(uint32_t block) const
+  {
+    return (type_ == Type::kSDSC) ? block * kBlockSize : block;
+  }
+
+  Status IssueCommand(Command command,
+                      uint32_t argument,
+                      Response format,
+                      uint32_t * response = nullptr)
+  {
+    uint32_t register_value = 0;
+    register_value          = bit::Insert(register_value,
+                                 util::Value(command) & 0x3F,
+                                 CommandRegister::kIndex);
+    register_value = bit::Insert(register_value, format != Response::kNone,
+                                 CommandRegister::kResponse);
+    register_value = bit::Insert(register_value, format == Response::kLong,
+                                 CommandRegister::kLongResponse);
+    register_value =
+        bit::Set(register_value, CommandRegister::kEnable.position);
+
+    mci->CLEAR    = ToFlags(StatusRegister::kClearable);
+    mci->ARGUMENT = argument;
+    mci->COMMAND  = register_value;
+
+    uint32_t finished_mask =
+        (format == Response::kNone)
+            ? ToFlags(StatusRegister::kCommandSent)
+            : (ToFlags(StatusRegister::kCommandResponseEnd) |
+               ToFlags(StatusRegister::kCommandTimeOut) |
+               ToFlags(StatusRegister::kCommandCrcFail));
+    uint32_t status = 0;
+    Status result   = Wait(kCommandTimeout, [&status, finished_mask]() {
+      status = mci->STATUS;
+      return (status & finished_mask) != 0;
+    });
+
+    mci->CLEAR = ToFlags(StatusRegister::kClearable);
+
+    if (result != Status::kSuccess ||
+        bit::Read(status, StatusRegister::kCommandTimeOut.position))
+    {
+      return Status::kTimedOut;
+    }
+    if (bit::Read(status, StatusRegister::kCommandCrcFail.position) &&
+        format != Response::kShortWithoutCrc)
+    {
+      return Status::kBusError;
+    }
+    if (response != nullptr)
+    {
+      response[0] = mci->RESP0;
+      response[1] = mci->RESP1;
+      response[2] = mci->RESP2;
+      response[3] = mci->RESP3;
+    }
+    return Status::kSuccess;
+  }
+
+  Status IssueApplicationCommand(Command command,
+                                 uint32_t argument,
+                                 Response format,
+                                 uint32_t * response)
+  {
+    Status status = IssueCommand(Command::kAcBegin, relative_address_,
+                                 Response::kShort, response);
+    if (status == Status::kSuccess)
+    {
+      status = IssueCommand(command, argument, format, response);
+    }
+    return status;
+  }
+
+  /// Polls CMD13 until the card is back in the transfer state and ready for
+  /// data, i.e. it has finished programming or erasing.
+  bool WaitUntilReady()
+  {
+    uint32_t response[4] = { 0 };
+    Status status        = Wait(kDataTimeout, [this, &response]() {
+      return IssueCommand(Command::kGetStatus, relative_address_,
+                          Response::kShort, response) == Status::kSuccess &&
+             bit::Read(response[0], CardStatus::kReadyForData.position) &&
+             bit::Extract(response[0], CardStatus::kCurrentState) ==
+                 kTransferState;
+    });
+    return status == Status::kSuccess;
+  }
+
+  /// Ask the card to switch to high speed mode (CMD6 function group 1,
+  /// function 1). Cards that predate the version 1.10 specification do not
+  /// support CMD6, in which case the card stays at the default speed.
+  ///
+  /// @returns true if the card is now running in high speed mode.
+  bool SwitchToHighSpeed()
+  {
+    constexpr uint32_t kSwitchToHighSpeed = 0x80FF'FFF1;
+    constexpr size_t kStatusWords         = 64 / sizeof(uint32_t);
+    constexpr uint8_t kStatusBlockSizeLog2 = 6;
+
+    uint32_t switch_status[kStatusWords] = { 0 };
+    mci->DATATMR  = DataTimeoutClocks();
+    mci->DATALEN  = sizeof(switch_status);
+    mci->DATACTRL = CreateDataControl(Direction::kRead, kStatusBlockSizeLog2,
+                                      false);
+
+    uint32_t response[4] = { 0 };
+    if (IssueCommand(Command::kSwitchFunction, kSwitchToHighSpeed,
+                     Response::kShort, response) != Status::kSuccess ||
+        ToR1(response[0]) != 0)
+    {
+      mci->DATACTRL = 0;
+      return false;
+    }
+
+    constexpr uint32_t kDataErrors = ToFlags(StatusRegister::kDataCrcFail) |
+                                     ToFlags(StatusRegister::kDataTimeOut) |
+                                     ToFlags(StatusRegister::kReceiveOverrun) |
+                                     ToFlags(StatusRegister::kStartBitError);
+    size_t words_read = 0;
+    while (words_read < kStatusWords)
+    {
+      uint32_t status = 0;
+      Wait(kDataTimeout, [&status]() {
+        status = mci->STATUS;
+        return (status & (ToFlags(StatusRegister::kReceiveDataAvailable) |
+                          kDataErrors)) != 0;
+      });
+      if (!bit::Read(status, StatusRegister::kReceiveDataAvailable.position))
+      {
+        break;
+      }
+      switch_status[words_read++] = mci->FIFO[0];
+    }
+    mci->DATACTRL = 0;
+    mci->CLEAR    = ToFlags(StatusRegister::kClearable);
+
+    // Bits [379:376] of the status hold the function selected for group 1.
+    // The card sends the most significant byte first and the FIFO packs the
+    // first byte received into the low byte of each word.
+    uint8_t status_bytes[sizeof(switch_status)];
+    memcpy(status_bytes, switch_status, sizeof(status_bytes));
+    constexpr size_t kGroup1SelectionByte = 16;
+    return words_read == kStatusWords &&
+           (status_bytes[kGroup1SelectionByte] & 0xF) == 1;
+  }
+
+  uint32_t DataTimeoutClocks() const
+  {
+    // DATATMR is in card bus clock periods
+    return clock_frequency_.to<uint32_t>() /
+           static_cast<uint32_t>(1s / kDataTimeout);
+  }
+
+  static uint32_t CreateDataControl(Direction direction,
+                                    uint8_t block_size_log2,
+                                    bool use_dma)
+  {
+    uint32_t control = 0;
+    control = bit::Set(control, DataControlRegister::kEnable.position);
+    control = bit::Insert(control, util::Value(direction),
+                          DataControlRegister::kDirection);
+    control = bit::Insert(control, use_dma, DataControlRegister::kDmaEnable);
+    control =
+        bit::Insert(control, block_size_log2, DataControlRegister::kBlockSize);
+    return control;
+  }
+
+  uint8_t TransferBlocks(Direction direction,
+                         uint32_t block,
+                         uint8_t * array,
+                         uint32_t blocks)
+  {
+    // The GPDMA moves whole words, thus unaligned buffers are staged through
+    // an aligned block buffer one block at a time.
+    bool is_aligned = (reinterpret_cast<uintptr_t>(array) % 4) == 0;
+    uint32_t transferred = 0;
+    while (transferred < blocks)
+    {
+      uint32_t remaining = blocks - transferred;
+      uint32_t count     = (remaining < kMaxBlocksPerTransfer)
+                           ? remaining
+                           : kMaxBlocksPerTransfer;
+      uint8_t * data = &array[transferred * kBlockSize];
+      if (!is_aligned)
+      {
+        count = 1;
+        if (direction == Direction::kWrite)
+        {
+          memcpy(bounce_buffer_, data, kBlockSize);
+        }
+      }
+
+      uint8_t r1 = TransferChunk(direction, block + transferred,
+                                 (is_aligned) ? data : bounce_buffer_, count);
+      if (r1 != 0)
+      {
+        return r1;
+      }
+      if (!is_aligned && direction == Direction::kRead)
+      {
+        memcpy(data, bounce_buffer_, kBlockSize);
+      }
+      transferred += count;
+    }
+    return 0x00;
+  }
+
+  uint8_t TransferChunk(Direction direction,
+                        uint32_t block,
+                        uint8_t * data,
+                        uint32_t blocks)
+  {
+    constexpr uint8_t kBlockSizeLog2 = 9;
+
+    if (channel_ == sjsu::lpc40xx::Dma::kInvalidChannel)
+    {
+      LOG_ERROR("No DMA channel available for the SD Card!");
+      return kR1Timeout;
+    }
+    // Wait for the card to finish programming a previous write
+    if (!WaitUntilReady())
+    {
+      return kR1Timeout;
+    }
+
+    using sjsu::lpc40xx::Dma;
+    Dma::Transfer_t transfer = {
+      .length = (blocks * kBlockSize) / sizeof(uint32_t),
+      .width  = Dma::Width::kWord,
+      .burst  = Dma::Burst::k8,
+    };
+    if (direction == Direction::kRead)
+    {
+      transfer.type = Dma::TransferType::kPeripheralToMemoryByPeripheral;
+      transfer.source           = mci->FIFO;
+      transfer.destination      = data;
+      transfer.increment_source = false;
+      transfer.source_request   = Dma::Request::kSdCard;
+    }
+    else
+    {
+      transfer.type = Dma::TransferType::kMemoryToPeripheralByPeripheral;
+      transfer.source                = data;
+      transfer.destination           = mci->FIFO;
+      transfer.increment_destination = false;
+      transfer.destination_request   = Dma::Request::kSdCard;
+    }
+
+    Command command;
+    if (direction == Direction::kRead)
+    {
+      command = (blocks > 1) ? Command::kReadMulti : Command::kReadSingle;
+    }
+    else
+    {
+      command = (blocks > 1) ? Command::kWriteMulti : Command::kWriteSingle;
+    }
+
+    mci->CLEAR   = ToFlags(StatusRegister::kClearable);
+    mci->DATATMR = DataTimeoutClocks();
+    mci->DATALEN = blocks * kBlockSize;
+    Status status = dma_.Start(channel_, transfer);
+    if (status != Status::kSuccess)
+    {
+      return ToR1(status);
+    }
+
+    uint32_t data_control =
+        CreateDataControl(direction, kBlockSizeLog2, true);
+    // The data path must be waiting for the card's start bit before a read
+    // command is sent, while a write must not start until the card has
+    // accepted the command.
+    if (direction == Direction::kRead)
+    {
+      mci->DATACTRL = data_control;
+    }
+    uint32_t response[4] = { 0 };
+    status = IssueCommand(command, ToCardAddress(block), Response::kShort,
+                          response);
+    uint8_t r1 =
+        (status == Status::kSuccess) ? ToR1(response[0]) : ToR1(status);
+    if (r1 != 0)
+    {
+      mci->DATACTRL = 0;
+      dma_.Stop(channel_);
+      return r1;
+    }
+    if (direction == Direction::kWrite)
+    {
+      mci->DATACTRL = data_control;
+    }
+
+    constexpr uint32_t kDataErrors =
+        ToFlags(StatusRegister::kDataCrcFail) |
+        ToFlags(StatusRegister::kDataTimeOut) |
+        ToFlags(StatusRegister::kTransmitUnderrun) |
+        ToFlags(StatusRegister::kReceiveOverrun) |
+        ToFlags(StatusRegister::kStartBitError);
+    uint32_t data_status = 0;
+    status = Wait(kDataTimeout, [&data_status]() {
+      data_status = mci->STATUS;
+      return (data_status &
+              (ToFlags(StatusRegister::kDataEnd) | kDataErrors)) != 0;
+    });
+    if (status == Status::kSuccess && (data_status & kDataErrors) == 0)
+    {
+      // The last burst may still be on its way to memory
+      status = Wait(kDataTimeout, [this]() { return !dma_.IsBusy(channel_); });
+    }
+    else if (status == Status::kSuccess)
+    {
+      LOG_ERROR("SD Card data transfer failed [MCI Status: 0x%08" PRIX32 "]",
+                data_status);
+      status = bit::Read(data_status, StatusRegister::kDataTimeOut.position)
+                   ? Status::kTimedOut
+                   : Status::kBusError;
+    }
+    mci->DATACTRL = 0;
+    mci->CLEAR    = ToFlags(StatusRegister::kClearable);
+    if (status != Status::kSuccess)
+    {
+      dma_.Stop(channel_);
+    }
+
+    if (blocks > 1)
+    {
+      IssueCommand(Command::kStopTrans, 0, Response::kShort, response);
+    }
+    return ToR1(status);
+  }
+
+  const Bus_t & bus_;
+  const sjsu::lpc40xx::Dma & dma_;
+  const sjsu::SystemController & system_controller_;
+  uint8_t channel_            = sjsu::lpc40xx::Dma::kInvalidChannel;
+  Type type_                  = Type::kSDHC;
+  uint32_t relative_address_  = 0;
+  bool wide_bus_              = false;
+  units::frequency::hertz_t clock_frequency_ = 0_Hz;
+  alignas(4) uint8_t bounce_buffer_[kBlockSize] = { 0 };
+};
+}  // namespace lpc40xx
+}  // namespace sjsu
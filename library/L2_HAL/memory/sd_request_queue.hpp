@@ -0,0 +1,296 @@
+/// SdRequestQueue lets tasks read, write and erase an SD card without waiting
+/// for it. A task fills in a Request_t and submits it, then carries on while a
+/// single worker task, which owns the card, carries out the requests in the
+/// order they were submitted. The card can stay busy for tens of milliseconds
+/// after a write, and only the worker task waits for it.
+///
+///   - Completion is reported through Request_t::status, an optional handler
+///     called from the worker task and an optional task notification.
+///   - Requests of the same kind that continue from one another, such as a
+///     logger writing consecutive blocks from two alternating buffers, are
+///     merged into a single multi-block command (CMD18 or CMD25) of up to
+///     kBatchBlocks blocks.
+///
+/// Order of function calls should be as follows:
+///
+///     1. Constructor (create object)
+///     2. Initialize()
+///     3. Submit(...) from any task as many times as needed
+///     4. Service(...) repeatedly from the worker task, see SdWorkerTask
+///
+/// The card must be mounted before requests are submitted, and must not be
+/// used directly while the queue is in use.
+#pragma once
+
+#include <FreeRTOS.h>
+#include <queue.h>
+
+#include <cinttypes>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "L2_HAL/memory/sd.hpp"
+#include "utility/log.hpp"
+#include "utility/rtos.hpp"
+#include "utility/status.hpp"
+
+namespace sjsu
+{
+template <size_t kDepth = 16, size_t kBatchBlocks = 8>
+class SdRequestQueue
+{
+ public:
+  static_assert(kDepth > 0, "SdRequestQueue must hold at least one request");
+  static_assert(kBatchBlocks > 0, "kBatchBlocks must be at least one block");
+
+  static constexpr size_t kBlockSize = 512;
+
+  enum class Operation : uint8_t
+  {
+    kRead = 0,
+    kWrite,
+    /// Erases blocks "block" through "block + count - 1". The data pointer is
+    /// not used.
+    kDelete,
+  };
+
+  struct Request_t;
+
+  /// Called from the worker task after the request has completed. When a
+  /// handler is used, the request belongs to it until it returns, and it may
+  /// resubmit the request.
+  using CompletionHandler = void (*)(Request_t * request);
+
+  /// Description of one request. It is owned by the submitter and must stay
+  /// alive, along with its data, until the request has completed.
+  struct Request_t
+  {
+    Operation operation = Operation::kRead;
+    /// First block to access
+    uint32_t block = 0;
+    /// Number of blocks to access
+    uint32_t count = 1;
+    /// count * kBlockSize bytes to read into or write from
+    uint8_t * data = nullptr;
+    /// Optional function called when the request completes
+    CompletionHandler handler = nullptr;
+    /// Optional pointer for use by the handler
+    void * context = nullptr;
+    /// Optional task given a notification (xTaskNotifyGive) when the request
+    /// completes, allowing it to sleep with ulTaskNotifyTake().
+    TaskHandle_t task = nullptr;
+    /// Status::kNotReadyYet until the request completes, then either
+    /// Status::kSuccess or Status::kBusError if the card reported an error.
+    volatile Status status = Status::kSuccess;
+  };
+
+  /// Counters used to check how well requests are being merged. Requests and
+  /// blocks count what was submitted, commands count how many card accesses
+  /// were needed to carry them out.
+  struct Statistics_t
+  {
+    uint32_t requests = 0;
+    uint32_t blocks   = 0;
+    uint32_t commands = 0;
+  };
+
+  /// @param card - mounted card to carry out the requests on
+  explicit constexpr SdRequestQueue(SdInterface & card) : card_(card) {}
+
+  /// Create the queue of requests. Safe to call more than once.
+  Status Initialize()
+  {
+    if (queue_ == nullptr)
+    {
+      queue_ = xQueueCreateStatic(kDepth, sizeof(Request_t *), queue_storage_,
+                                  &queue_buffer_);
+    }
+    return (queue_ != nullptr) ? Status::kSuccess : Status::kNotReadyYet;
+  }
+
+  /// Add a request to the end of the queue and return without waiting for it
+  /// to be carried out.
+  ///
+  /// @param request - request to carry out
+  /// @param timeout - number of ticks to wait for space if the queue is full
+  /// @return Status::kInvalidParameters if the request is malformed,
+  ///         Status::kNotReadyYet if the queue is not initialized or is full,
+  ///         otherwise Status::kSuccess.
+  Status Submit(Request_t * request, TickType_t timeout = 0)
+  {
+    if (request == nullptr || request->count == 0 ||
+        (request->operation != Operation::kDelete && request->data == nullptr))
+    {
+      return Status::kInvalidParameters;
+    }
+    if (queue_ == nullptr)
+    {
+      return Status::kNotReadyYet;
+    }
+
+    request->status = Status::kNotReadyYet;
+    if (xQueueSend(queue_, &request, timeout) != pdTRUE)
+    {
+      request->status = Status::kSuccess;
+      return Status::kNotReadyYet;
+    }
+    return Status::kSuccess;
+  }
+
+  /// Carry out the next request along with any requests queued behind it
+  /// that can be merged into the same command. Called by the worker task.
+  ///
+  /// @param timeout - number of ticks to wait for a request to arrive
+  /// @return false if no request arrived before the timeout.
+  bool Service(TickType_t timeout)
+  {
+    Request_t * first = pending_;
+    pending_          = nullptr;
+    if (first == nullptr && !Receive(&first, timeout))
+    {
+      return false;
+    }
+
+    size_t length   = 1;
+    uint32_t blocks = first->count;
+    batch_[0]       = first;
+    if (first->operation != Operation::kDelete)
+    {
+      // Only take what has already been queued. Waiting for more requests
+      // would delay the ones that have already arrived.
+      Request_t * next;
+      while (length < kBatchBlocks && Receive(&next, 0))
+      {
+        if (next->operation != first->operation ||
+            next->block != first->block + blocks ||
+            blocks + next->count > kBatchBlocks)
+        {
+          pending_ = next;
+          break;
+        }
+        batch_[length++] = next;
+        blocks += next->count;
+      }
+    }
+
+    Status status = Execute(length, blocks);
+    for (size_t i = 0; i < length; i++)
+    {
+      Complete(batch_[i], status);
+    }
+    return true;
+  }
+
+  const Statistics_t & GetStatistics() const
+  {
+    return statistics_;
+  }
+
+ private:
+  bool Receive(Request_t ** request, TickType_t timeout)
+  {
+    return xQueueReceive(queue_, request, timeout) == pdTRUE;
+  }
+
+  /// Carry out the first "length" requests in batch_, which access "blocks"
+  /// consecutive blocks, with a single card command.
+  Status Execute(size_t length, uint32_t blocks)
+  {
+    Request_t * first = batch_[0];
+    uint8_t r1        = 0;
+    statistics_.requests += static_cast<uint32_t>(length);
+    statistics_.blocks += blocks;
+    statistics_.commands++;
+
+    switch (first->operation)
+    {
+      case Operation::kRead:
+        if (length == 1)
+        {
+          r1 = card_.ReadBlock(first->block, first->data, blocks);
+        }
+        else
+        {
+          r1 = card_.ReadBlock(first->block, staging_[0], blocks);
+          Scatter(length);
+        }
+        break;
+      case Operation::kWrite:
+        if (length == 1)
+        {
+          r1 = card_.WriteBlock(first->block, first->data, blocks);
+        }
+        else
+        {
+          Gather(length);
+          r1 = card_.WriteBlock(first->block, staging_[0], blocks);
+        }
+        break;
+      case Operation::kDelete:
+        r1 = card_.DeleteBlock(first->block, first->block + blocks - 1);
+        break;
+    }
+
+    if (r1 != 0)
+    {
+      LOG_ERROR("SD request for block %" PRIu32 " failed [R1: 0x%02X]",
+                first->block, r1);
+      return Status::kBusError;
+    }
+    return Status::kSuccess;
+  }
+
+  /// Copy the data of each request into the staging buffer for one write
+  void Gather(size_t length)
+  {
+    uint8_t * destination = staging_[0];
+    for (size_t i = 0; i < length; i++)
+    {
+      size_t bytes = batch_[i]->count * kBlockSize;
+      memcpy(destination, batch_[i]->data, bytes);
+      destination += bytes;
+    }
+  }
+
+  /// Copy the staging buffer out to each request after one read
+  void Scatter(size_t length)
+  {
+    const uint8_t * source = staging_[0];
+    for (size_t i = 0; i < length; i++)
+    {
+      size_t bytes = batch_[i]->count * kBlockSize;
+      memcpy(batch_[i]->data, source, bytes);
+      source += bytes;
+    }
+  }
+
+  void Complete(Request_t * request, Status status)
+  {
+    // The submitter may reuse the request as soon as its status changes, so
+    // read everything needed before setting it.
+    CompletionHandler handler = request->handler;
+    TaskHandle_t task         = request->task;
+    request->status           = status;
+    if (handler != nullptr)
+    {
+      handler(request);
+    }
+    if (task != nullptr)
+    {
+      xTaskNotifyGive(task);
+    }
+  }
+
+  SdInterface & card_;
+  QueueHandle_t queue_ = nullptr;
+  StaticQueue_t queue_buffer_;
+  uint8_t queue_storage_[kDepth * sizeof(Request_t *)];
+  /// Request taken from the queue that could not be merged into the last
+  /// command. It is carried out first on the next call to Service().
+  Request_t * pending_ = nullptr;
+  Request_t * batch_[kBatchBlocks];
+  uint8_t staging_[kBatchBlocks][kBlockSize];
+  Statistics_t statistics_;
+};
+}  // namespace sjsu
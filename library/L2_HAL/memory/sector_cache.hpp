@@ -0,0 +1,403 @@
+/// SectorCache sits between a file system and an SdInterface and keeps the
+/// most recently used 512-byte sectors in RAM. File systems such as FatFs
+/// read and rewrite the same FAT and directory sectors over and over when
+/// appending small records. Keeping those sectors cached turns most of that
+/// traffic into memory copies.
+///
+///   - Writes are held in the cache (write-back) until the sector is evicted
+///     or Flush() is called.
+///   - When the cache is full, the least recently used sectors are evicted.
+///   - A miss that continues a sequential read pulls in the following sectors
+///     with a single multi-block read (read-ahead).
+///   - Accesses spanning the whole cache or more bypass it, so large reads
+///     and writes do not flush out the file system's metadata.
+///
+/// Order of function calls should be as follows:
+///
+///     1. Constructor (create object)
+///     2. Read(...), Write(...) as many times as needed
+///     3. Flush() before the card is removed or powered down
+///     4. Discard(...) when the file system trims sectors
+///     5. Invalidate() if a different card may have been inserted
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "L2_HAL/memory/sd.hpp"
+#include "utility/log.hpp"
+#include "utility/status.hpp"
+
+namespace sjsu
+{
+template <size_t kSectors>
+class SectorCache
+{
+ public:
+  static_assert(kSectors > 0, "SectorCache must hold at least one sector");
+
+  static constexpr size_t kSectorSize = 512;
+
+  /// Counters for tuning the cache size. Hits and misses are counted per
+  /// sector requested by the file system. The card counters are the number of
+  /// sectors actually moved over the bus.
+  struct Statistics_t
+  {
+    uint32_t hits        = 0;
+    uint32_t misses      = 0;
+    uint32_t read_ahead  = 0;
+    uint32_t card_reads  = 0;
+    uint32_t card_writes = 0;
+  };
+
+  /// @param card - card to cache the sectors of
+  /// @param read_ahead - number of extra sectors to read when a miss continues
+  ///        a sequential read. Set to 0 to disable read-ahead.
+  explicit constexpr SectorCache(SdInterface & card, uint32_t read_ahead = 0)
+      : card_(card), read_ahead_(read_ahead)
+  {
+  }
+
+  /// Copy sectors into the buffer, loading any missing sectors from the card.
+  Status Read(uint32_t sector, uint8_t * buffer, uint32_t count)
+  {
+    if (count >= kSectors)
+    {
+      return ReadAround(sector, buffer, count);
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+      uint32_t current = sector + i;
+      size_t line      = Find(current);
+      if (line == kNotCached)
+      {
+        statistics_.misses++;
+        Status status = Load(current);
+        if (status != Status::kSuccess)
+        {
+          return status;
+        }
+        line = Find(current);
+      }
+      else
+      {
+        statistics_.hits++;
+      }
+      Touch(line);
+      memcpy(&buffer[i * kSectorSize], data_[line], kSectorSize);
+      next_sequential_sector_ = current + 1;
+    }
+    return Status::kSuccess;
+  }
+
+  /// Copy sectors into the cache and mark them dirty. The card is only
+  /// written when the sectors are evicted or flushed.
+  Status Write(uint32_t sector, const uint8_t * buffer, uint32_t count)
+  {
+    if (count >= kSectors)
+    {
+      return WriteAround(sector, buffer, count);
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+      uint32_t current = sector + i;
+      size_t line      = Find(current);
+      if (line == kNotCached)
+      {
+        // Whole sectors are written, so there is no need to read the sector
+        // from the card first.
+        statistics_.misses++;
+        line          = SelectVictims(1);
+        Status status = Evict(line, 1);
+        if (status != Status::kSuccess)
+        {
+          return status;
+        }
+        lines_[line].sector = current;
+        lines_[line].valid  = true;
+      }
+      else
+      {
+        statistics_.hits++;
+      }
+      memcpy(data_[line], &buffer[i * kSectorSize], kSectorSize);
+      lines_[line].dirty = true;
+      Touch(line);
+    }
+    return Status::kSuccess;
+  }
+
+  /// Write every dirty sector back to the card. Dirty sectors that sit next to
+  /// each other both on the card and in the cache are written with a single
+  /// multi-block write.
+  Status Flush()
+  {
+    while (true)
+    {
+      // Find the lowest dirty sector
+      size_t first = kNotCached;
+      for (size_t i = 0; i < kSectors; i++)
+      {
+        if (lines_[i].dirty &&
+            (first == kNotCached || lines_[i].sector < lines_[first].sector))
+        {
+          first = i;
+        }
+      }
+      if (first == kNotCached)
+      {
+        return Status::kSuccess;
+      }
+
+      size_t length = 1;
+      while (first + length < kSectors && lines_[first + length].dirty &&
+             lines_[first + length].sector == lines_[first].sector + length)
+      {
+        length++;
+      }
+
+      // On failure the sectors stay dirty, so a later flush can try again
+      Status status = WriteBack(first, length);
+      if (status != Status::kSuccess)
+      {
+        return status;
+      }
+    }
+  }
+
+  /// Drop every cached sector, including dirty sectors that have not been
+  /// flushed.
+  void Invalidate()
+  {
+    for (auto & line : lines_)
+    {
+      line = Line_t{};
+    }
+    next_sequential_sector_ = kNoSector;
+  }
+
+  /// Drop the cached copies of sectors first through last, e.g. after the
+  /// file system has trimmed them. Dirty sectors in the range are dropped
+  /// rather than written back, as their contents are no longer needed.
+  void Discard(uint32_t first, uint32_t last)
+  {
+    for (auto & line : lines_)
+    {
+      if (line.valid && first <= line.sector && line.sector <= last)
+      {
+        line = Line_t{};
+      }
+    }
+  }
+
+  /// @returns true if the sector is in the cache and differs from the card.
+  bool IsDirty(uint32_t sector) const
+  {
+    size_t line = Find(sector);
+    return line != kNotCached && lines_[line].dirty;
+  }
+
+  const Statistics_t & GetStatistics() const
+  {
+    return statistics_;
+  }
+
+  void ResetStatistics()
+  {
+    statistics_ = Statistics_t{};
+  }
+
+ private:
+  static constexpr size_t kNotCached  = SIZE_MAX;
+  static constexpr uint32_t kNoSector = UINT32_MAX;
+
+  struct Line_t
+  {
+    uint32_t sector    = kNoSector;
+    /// Value of use_counter_ when the line was last used, 0 if never used
+    uint32_t last_used = 0;
+    bool valid         = false;
+    bool dirty         = false;
+  };
+
+  size_t Find(uint32_t sector) const
+  {
+    for (size_t i = 0; i < kSectors; i++)
+    {
+      if (lines_[i].valid && lines_[i].sector == sector)
+      {
+        return i;
+      }
+    }
+    return kNotCached;
+  }
+
+  void Touch(size_t line)
+  {
+    lines_[line].last_used = ++use_counter_;
+  }
+
+  /// Multi-block transfers need their sectors to sit next to each other in
+  /// the cache, thus victims are chosen as a run of lines. The run whose most
+  /// recent use is the oldest is evicted.
+  ///
+  /// @returns index of the first line of the run
+  size_t SelectVictims(size_t length) const
+  {
+    size_t best        = 0;
+    uint32_t best_used = UINT32_MAX;
+    for (size_t start = 0; start + length <= kSectors; start++)
+    {
+      uint32_t newest = 0;
+      for (size_t i = start; i < start + length; i++)
+      {
+        newest = (lines_[i].last_used > newest) ? lines_[i].last_used : newest;
+      }
+      if (newest < best_used)
+      {
+        best      = start;
+        best_used = newest;
+      }
+    }
+    return best;
+  }
+
+  /// Write back any dirty lines in the run and mark the run as empty.
+  Status Evict(size_t first, size_t length)
+  {
+    for (size_t i = first; i < first + length; i++)
+    {
+      if (lines_[i].dirty)
+      {
+        Status status = WriteBack(i, 1);
+        if (status != Status::kSuccess)
+        {
+          return status;
+        }
+      }
+      lines_[i] = Line_t{};
+    }
+    return Status::kSuccess;
+  }
+
+  Status WriteBack(size_t first, size_t length)
+  {
+    uint8_t r1 = card_.WriteBlock(lines_[first].sector, data_[first],
+                                  static_cast<uint32_t>(length));
+    if (r1 != 0)
+    {
+      LOG_ERROR("Failed to write back sector %" PRIu32 " [R1: 0x%02X]",
+                lines_[first].sector, r1);
+      return Status::kBusError;
+    }
+    statistics_.card_writes += static_cast<uint32_t>(length);
+    for (size_t i = first; i < first + length; i++)
+    {
+      lines_[i].dirty = false;
+    }
+    return Status::kSuccess;
+  }
+
+  /// Load a missing sector, along with the sectors that follow it if this
+  /// miss continues a sequential read.
+  Status Load(uint32_t sector)
+  {
+    size_t length = 1;
+    if (sector == next_sequential_sector_)
+    {
+      size_t limit = (read_ahead_ + 1 < kSectors) ? read_ahead_ + 1 : kSectors;
+      while (length < limit &&
+             Find(sector + static_cast<uint32_t>(length)) == kNotCached)
+      {
+        length++;
+      }
+    }
+
+    size_t first  = SelectVictims(length);
+    Status status = Evict(first, length);
+    if (status != Status::kSuccess)
+    {
+      return status;
+    }
+
+    uint8_t r1 =
+        card_.ReadBlock(sector, data_[first], static_cast<uint32_t>(length));
+    if (r1 != 0)
+    {
+      LOG_ERROR("Failed to read sector %" PRIu32 " [R1: 0x%02X]", sector, r1);
+      return Status::kBusError;
+    }
+    statistics_.card_reads += static_cast<uint32_t>(length);
+    statistics_.read_ahead += static_cast<uint32_t>(length - 1);
+
+    for (size_t i = 0; i < length; i++)
+    {
+      lines_[first + i].sector = sector + static_cast<uint32_t>(i);
+      lines_[first + i].valid  = true;
+      // Read-ahead sectors are the first to go if they are never used
+      lines_[first + i].last_used = 0;
+    }
+    return Status::kSuccess;
+  }
+
+  /// Read straight into the caller's buffer, then copy cached sectors over
+  /// the result as they may be newer than the card.
+  Status ReadAround(uint32_t sector, uint8_t * buffer, uint32_t count)
+  {
+    uint8_t r1 = card_.ReadBlock(sector, buffer, count);
+    if (r1 != 0)
+    {
+      return Status::kBusError;
+    }
+    statistics_.card_reads += count;
+    statistics_.misses += count;
+    for (size_t i = 0; i < kSectors; i++)
+    {
+      if (lines_[i].valid && lines_[i].sector >= sector &&
+          lines_[i].sector - sector < count)
+      {
+        memcpy(&buffer[(lines_[i].sector - sector) * kSectorSize], data_[i],
+               kSectorSize);
+      }
+    }
+    next_sequential_sector_ = sector + count;
+    return Status::kSuccess;
+  }
+
+  /// Write straight to the card, then refresh any cached copies so they
+  /// match the card again.
+  Status WriteAround(uint32_t sector, const uint8_t * buffer, uint32_t count)
+  {
+    uint8_t r1 = card_.WriteBlock(sector, buffer, count);
+    if (r1 != 0)
+    {
+      return Status::kBusError;
+    }
+    statistics_.card_writes += count;
+    statistics_.misses += count;
+    for (size_t i = 0; i < kSectors; i++)
+    {
+      if (lines_[i].valid && lines_[i].sector >= sector &&
+          lines_[i].sector - sector < count)
+      {
+        memcpy(data_[i], &buffer[(lines_[i].sector - sector) * kSectorSize],
+               kSectorSize);
+        lines_[i].dirty = false;
+      }
+    }
+    return Status::kSuccess;
+  }
+
+  SdInterface & card_;
+  uint32_t read_ahead_;
+  uint32_t use_counter_            = 0;
+  uint32_t next_sequential_sector_ = kNoSector;
+  Statistics_t statistics_         = {};
+  Line_t lines_[kSectors]          = {};
+  /// Word aligned so that DMA capable drivers can move sectors directly
+  alignas(4) uint8_t data_[kSectors][kSectorSize] = {};
+};
+}  // namespace sjsu
@@ -0,0 +1,225 @@
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "L2_HAL/memory/block_log.hpp"
+#include "L4_Testing/fake_sd_card.hpp"
+#include "L4_Testing/testing_frameworks.hpp"
+
+namespace sjsu
+{
+namespace
+{
+constexpr size_t kBlockSize = 512;
+
+using Log    = BlockLog<8>;
+using Record = Log::Record_t;
+
+constexpr uint32_t kFirstBlock  = 16;
+constexpr uint32_t kRegionSize  = 64;
+constexpr uint32_t kEraseBlocks = 16;
+
+const Record & RecordAt(const FakeSdCard & card, uint32_t block)
+{
+  return *reinterpret_cast<const Record *>(
+      &card.memory[(kFirstBlock + block) * kBlockSize]);
+}
+
+void AppendRecords(Log & log, uint32_t count)
+{
+  for (uint32_t i = 0; i < count; i++)
+  {
+    uint32_t payload = log.GetNextSequence() * 3;
+    REQUIRE(log.Append(&payload, sizeof(payload)) == Status::kSuccess);
+  }
+}
+}  // namespace
+
+TEST_CASE("Testing SD Card block log", "[block-log]")
+{
+  FakeSdCard card(128);
+  Log log(card, kFirstBlock, kRegionSize, kEraseBlocks);
+
+  SECTION("Records are rejected until the log is mounted")
+  {
+    uint8_t payload[Record::kPayloadSize + 1] = { 0 };
+
+    CHECK(log.Append(payload, 4) == Status::kNotReadyYet);
+    REQUIRE(log.Mount() == Status::kSuccess);
+    CHECK(log.Append(payload, sizeof(payload)) ==
+          Status::kInvalidParameters);
+    CHECK(log.Append(payload, Record::kPayloadSize) == Status::kSuccess);
+  }
+  SECTION("An empty region starts at record 0")
+  {
+    REQUIRE(log.Mount() == Status::kSuccess);
+
+    CHECK(log.GetNextSequence() == 0);
+  }
+  SECTION("Records are written in erased bursts")
+  {
+    REQUIRE(log.Mount() == Status::kSuccess);
+    card.commands.clear();
+
+    AppendRecords(log, 8);
+
+    REQUIRE(card.commands.size() == 2);
+    CHECK(card.commands[0].operation == 'D');
+    CHECK(card.commands[0].block == kFirstBlock);
+    CHECK(card.commands[0].count == kEraseBlocks);
+    CHECK(card.commands[1].operation == 'W');
+    CHECK(card.commands[1].block == kFirstBlock);
+    CHECK(card.commands[1].count == 8);
+    for (uint32_t i = 0; i < 8; i++)
+    {
+      const Record & record = RecordAt(card, i);
+      uint32_t payload;
+      memcpy(&payload, record.payload, sizeof(payload));
+      CHECK(record.magic == Log::kMagic);
+      CHECK(record.sequence == i);
+      CHECK(record.length == sizeof(payload));
+      CHECK(payload == i * 3);
+    }
+  }
+  SECTION("Flush writes a partial burst")
+  {
+    REQUIRE(log.Mount() == Status::kSuccess);
+    AppendRecords(log, 3);
+    CHECK(card.Count('W') == 0);
+
+    CHECK(log.Flush() == Status::kSuccess);
+    CHECK(log.Flush() == Status::kSuccess);
+
+    REQUIRE(card.Count('W') == 1);
+    CHECK(card.commands.back().count == 3);
+  }
+  SECTION("Mount finds the end of the log with a binary search")
+  {
+    REQUIRE(log.Mount() == Status::kSuccess);
+    for (uint32_t written : { 1, 5, 17, 40, 63, 64, 65, 100, 128, 150 })
+    {
+      AppendRecords(log, written - log.GetNextSequence());
+      REQUIRE(log.Flush() == Status::kSuccess);
+      card.commands.clear();
+
+      Log remounted(card, kFirstBlock, kRegionSize, kEraseBlocks);
+      REQUIRE(remounted.Mount() == Status::kSuccess);
+
+      CHECK(remounted.GetNextSequence() == written);
+      CHECK(card.Count('R') <= 8);
+    }
+  }
+  SECTION("Records wrap around to the start of the region")
+  {
+    REQUIRE(log.Mount() == Status::kSuccess);
+    AppendRecords(log, kRegionSize + 4);
+    REQUIRE(log.Flush() == Status::kSuccess);
+
+    CHECK(RecordAt(card, 0).sequence == kRegionSize);
+    CHECK(RecordAt(card, 3).sequence == kRegionSize + 3);
+    // Erased along with the rest of the first erase group
+    CHECK(RecordAt(card, 4).magic == 0xFFFF'FFFF);
+    CHECK(RecordAt(card, kEraseBlocks).sequence == kEraseBlocks);
+    // Bursts are cut short at the end of the region
+    for (const auto & command : card.commands)
+    {
+      if (command.operation == 'W')
+      {
+        CHECK(command.block + command.count <= kFirstBlock + kRegionSize);
+      }
+    }
+  }
+  SECTION("A pass interrupted after its first erase resumes at its start")
+  {
+    REQUIRE(log.Mount() == Status::kSuccess);
+    AppendRecords(log, kRegionSize);
+    card.DeleteBlock(kFirstBlock, kFirstBlock + kEraseBlocks - 1);
+
+    Log remounted(card, kFirstBlock, kRegionSize, kEraseBlocks);
+    REQUIRE(remounted.Mount() == Status::kSuccess);
+
+    CHECK(remounted.GetNextSequence() == kRegionSize);
+  }
+  SECTION("Torn records are not counted")
+  {
+    REQUIRE(log.Mount() == Status::kSuccess);
+    AppendRecords(log, 24);
+    card.memory[(kFirstBlock + 20) * kBlockSize + 100] ^= 0x01;
+
+    Log remounted(card, kFirstBlock, kRegionSize, kEraseBlocks);
+    REQUIRE(remounted.Mount() == Status::kSuccess);
+
+    CHECK(remounted.GetNextSequence() == 20);
+  }
+  SECTION("Records are kept after a failed write")
+  {
+    REQUIRE(log.Mount() == Status::kSuccess);
+    card.r1 = 0x04;
+    AppendRecords(log, 7);
+    uint32_t payload = 0;
+
+    CHECK(log.Append(&payload, sizeof(payload)) == Status::kBusError);
+    CHECK(log.Append(&payload, sizeof(payload)) == Status::kBusError);
+
+    card.r1 = 0x00;
+    CHECK(log.Append(&payload, sizeof(payload)) == Status::kSuccess);
+    CHECK(RecordAt(card, 7).sequence == 7);
+    CHECK(log.GetNextSequence() == 9);
+  }
+  SECTION("A failed write at the end of the region is not staged past it")
+  {
+    REQUIRE(log.Mount() == Status::kSuccess);
+    // Leave fewer than a burst of records to fill the region
+    AppendRecords(log, kRegionSize - 6);
+    REQUIRE(log.Flush() == Status::kSuccess);
+    card.r1 = 0x04;
+    uint32_t payload = 0;
+    for (int i = 0; i < 5; i++)
+    {
+      CHECK(log.Append(&payload, sizeof(payload)) == Status::kSuccess);
+    }
+    // The last record of the region is flushed right away and fails
+    CHECK(log.Append(&payload, sizeof(payload)) == Status::kBusError);
+    // The next record belongs in block 0, so it waits for that write
+    CHECK(log.Append(&payload, sizeof(payload)) == Status::kBusError);
+    CHECK(log.GetNextSequence() == kRegionSize);
+
+    card.r1 = 0x00;
+    card.commands.clear();
+    CHECK(log.Append(&payload, sizeof(payload)) == Status::kSuccess);
+    REQUIRE(log.Flush() == Status::kSuccess);
+
+    CHECK(RecordAt(card, kRegionSize - 1).sequence == kRegionSize - 1);
+    CHECK(RecordAt(card, 0).sequence == kRegionSize);
+    for (const auto & command : card.commands)
+    {
+      CHECK(command.block >= kFirstBlock);
+      CHECK(command.block + command.count <= kFirstBlock + kRegionSize);
+    }
+  }
+  SECTION("Sequence numbers wrap on a multiple of the region size")
+  {
+    // 2^32 is not a multiple of 60
+    constexpr uint32_t kOddRegionSize = 60;
+    constexpr uint32_t kLimit =
+        static_cast<uint32_t>((uint64_t{ 1 } << 32) / kOddRegionSize *
+                              kOddRegionSize);
+    Log odd_log(card, kFirstBlock, kOddRegionSize, kEraseBlocks);
+    Record & last = *reinterpret_cast<Record *>(
+        &card.memory[(kFirstBlock + kOddRegionSize - 1) * kBlockSize]);
+    last.magic    = Log::kMagic;
+    last.sequence = kLimit - 1;
+    last.length   = 0;
+    last.crc      = crc::Crc32::Calculate(reinterpret_cast<uint8_t *>(&last),
+                                     offsetof(Record, crc));
+
+    REQUIRE(odd_log.Mount() == Status::kSuccess);
+    CHECK(odd_log.GetNextSequence() == 0);
+
+    AppendRecords(odd_log, 1);
+    REQUIRE(odd_log.Flush() == Status::kSuccess);
+    CHECK(RecordAt(card, 0).sequence == 0);
+    CHECK(odd_log.GetNextSequence() == 1);
+  }
+}
+}  // namespace sjsu
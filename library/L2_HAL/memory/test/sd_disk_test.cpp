@@ -0,0 +1,156 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "L2_HAL/memory/sd.hpp"
+#include "L2_HAL/memory/sd_disk.hpp"
+#include "L4_Testing/host_disk.hpp"
+#include "L4_Testing/sd_card_emulator.hpp"
+#include "L4_Testing/testing_frameworks.hpp"
+#include "utility/rtos.hpp"
+
+namespace sjsu
+{
+namespace
+{
+constexpr size_t kSectorSize = 512;
+
+QueueHandle_t CreateMutexStatic(uint8_t, StaticQueue_t * buffer)
+{
+  return reinterpret_cast<QueueHandle_t>(buffer);
+}
+
+/// An emulated card behind the same SdDisk glue that the board's diskio.cpp
+/// uses, mounted as the host's drive, so FatFs reaches the card through
+/// disk_*, SdDisk, SectorCache and Sd, down to the SPI bytes.
+class EmulatedSdDrive final : public HostDisk
+{
+ public:
+  explicit EmulatedSdDrive(std::FILE * image)
+      : card(image), sd(card, card.GetChipSelect()), disk(sd)
+  {
+  }
+
+  DSTATUS Status() override
+  {
+    return disk.IsInitialized() ? 0 : STA_NOINIT;
+  }
+  DSTATUS Initialize() override
+  {
+    return disk.Initialize();
+  }
+  DRESULT Read(BYTE * buffer, DWORD sector, UINT count) override
+  {
+    return disk.Read(buffer, sector, count);
+  }
+  DRESULT Write(const BYTE * buffer, DWORD sector, UINT count) override
+  {
+    return disk.Write(buffer, sector, count);
+  }
+  DRESULT Ioctl(BYTE command, void * buffer) override
+  {
+    return disk.Ioctl(command, buffer);
+  }
+
+  SdCardEmulator card;
+  Sd sd;
+  SdDisk<8> disk;
+};
+}  // namespace
+
+TEST_CASE("Testing SD disk", "[sd-disk]")
+{
+  // FatFs creates its volume mutex, but does not lock it before the scheduler
+  // starts.
+  RESET_FAKE(xTaskGetSchedulerState);
+  RESET_FAKE(xQueueCreateMutexStatic);
+  xTaskGetSchedulerState_fake.return_val   = taskSCHEDULER_NOT_STARTED;
+  xQueueCreateMutexStatic_fake.custom_fake = CreateMutexStatic;
+
+  // 2 MiB blank image
+  constexpr uint32_t kImageBlocks = 4 * SdCardEmulator::kCapacityUnit;
+  std::FILE * image               = std::tmpfile();
+  REQUIRE(image != nullptr);
+  std::vector<uint8_t> blank(kImageBlocks * kSectorSize, 0x00);
+  std::fwrite(blank.data(), 1, blank.size(), image);
+
+  EmulatedSdDrive drive(image);
+
+  SECTION("Commands need a mounted card")
+  {
+    DWORD sector_count = 0;
+    WORD sector_size   = 0;
+
+    CHECK(disk_status(0) == STA_NOINIT);
+    CHECK(disk_ioctl(0, GET_SECTOR_COUNT, &sector_count) == RES_NOTRDY);
+
+    REQUIRE(disk_initialize(0) == 0);
+
+    CHECK(disk_status(0) == 0);
+    CHECK(disk_ioctl(0, GET_SECTOR_COUNT, &sector_count) == RES_OK);
+    CHECK(sector_count == kImageBlocks);
+    CHECK(disk_ioctl(0, GET_SECTOR_SIZE, &sector_size) == RES_OK);
+    CHECK(sector_size == kSectorSize);
+  }
+  SECTION("Remounting the same card writes out its cached sectors")
+  {
+    uint8_t data[kSectorSize];
+    for (size_t i = 0; i < sizeof(data); i++)
+    {
+      data[i] = static_cast<uint8_t>(i * 7);
+    }
+    REQUIRE(disk_initialize(0) == 0);
+    drive.card.ResetStatistics();
+
+    CHECK(disk_write(0, data, 10, 1) == RES_OK);
+    CHECK(drive.disk.GetCache().IsDirty(10));
+    CHECK(drive.card.GetStatistics().blocks_written == 0);
+
+    CHECK(disk_initialize(0) == 0);
+
+    CHECK(!drive.disk.GetCache().IsDirty(10));
+    CHECK(drive.card.GetStatistics().blocks_written == 1);
+    uint8_t read_back[kSectorSize];
+    CHECK(drive.sd.ReadBlock(10, read_back) == 0x00);
+    CHECK(memcmp(read_back, data, sizeof(data)) == 0);
+  }
+  SECTION("FatFs files reach the card")
+  {
+    uint8_t work[kSectorSize];
+    REQUIRE(f_mkfs("", FM_ANY | FM_SFD, 0, work, sizeof(work)) == FR_OK);
+    FATFS fat_fs;
+    REQUIRE(f_mount(&fat_fs, "", 1) == FR_OK);
+
+    std::vector<uint8_t> data(10000);
+    for (size_t i = 0; i < data.size(); i++)
+    {
+      data[i] = static_cast<uint8_t>(i * 31 + i / 256);
+    }
+    FIL file;
+    UINT written = 0;
+    REQUIRE(f_open(&file, "log.bin", FA_CREATE_ALWAYS | FA_WRITE) == FR_OK);
+    CHECK(f_write(&file, data.data(), static_cast<UINT>(data.size()),
+                  &written) == FR_OK);
+    CHECK(written == data.size());
+    CHECK(f_close(&file) == FR_OK);
+    f_mount(nullptr, "", 0);
+
+    // f_close() syncs the disk, so nothing may be left only in the cache.
+    // Dropping the cache and remounting must find the file intact.
+    drive.disk.GetCache().Invalidate();
+    REQUIRE(f_mount(&fat_fs, "", 1) == FR_OK);
+
+    std::vector<uint8_t> read_back(data.size());
+    UINT read = 0;
+    REQUIRE(f_open(&file, "log.bin", FA_READ) == FR_OK);
+    CHECK(f_size(&file) == data.size());
+    CHECK(f_read(&file, read_back.data(), static_cast<UINT>(read_back.size()),
+                 &read) == FR_OK);
+    CHECK(read == data.size());
+    CHECK(read_back == data);
+    CHECK(f_close(&file) == FR_OK);
+    f_mount(nullptr, "", 0);
+  }
+}
+}  // namespace sjsu
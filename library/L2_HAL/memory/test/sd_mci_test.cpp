@@ -0,0 +1,219 @@
+#include <cstdint>
+#include <cstring>
+
+#include "L0_Platform/lpc40xx/LPC40xx.h"
+#include "L2_HAL/memory/sd_mci.hpp"
+#include "L4_Testing/testing_frameworks.hpp"
+
+namespace sjsu::lpc40xx
+{
+EMIT_ALL_METHODS(SdMci);
+
+TEST_CASE("Testing lpc40xx SD Card MCI Driver", "[lpc40xx-sd-mci]")
+{
+  // Simulate local version of the MCI, GPDMA and system controller
+  LPC_MCI_TypeDef local_mci;
+  LPC_GPDMA_TypeDef local_gpdma;
+  LPC_GPDMACH_TypeDef local_channels[Dma::kNumberOfChannels];
+  LPC_SC_TypeDef local_sc;
+  memset(&local_mci, 0, sizeof(local_mci));
+  memset(&local_gpdma, 0, sizeof(local_gpdma));
+  memset(&local_channels, 0, sizeof(local_channels));
+  memset(&local_sc, 0, sizeof(local_sc));
+
+  SdMci::mci = &local_mci;
+  Dma::gpdma = &local_gpdma;
+  for (uint8_t i = 0; i < Dma::kNumberOfChannels; i++)
+  {
+    Dma::channels[i] = &local_channels[i];
+  }
+  Dma::allocated_channels             = 0;
+  SystemController::system_controller = &local_sc;
+
+  // These registers are read only, thus the cast.
+  using Register = volatile uint32_t;
+  // Every command receives a response and every data transfer ends. The card
+  // reports that it is ready for data and in the transfer state.
+  constexpr uint32_t kCardIsReady = (1 << 8) | (4 << 9);
+  *const_cast<Register *>(&local_mci.STATUS) =
+      (1 << 6) | (1 << 7) | (1 << 8);
+  *const_cast<Register *>(&local_mci.RESP0) = kCardIsReady;
+
+  constexpr units::frequency::hertz_t kPeripheralFrequency = 48_MHz;
+  Mock<sjsu::SystemController> mock_system_controller;
+  Fake(Method(mock_system_controller, PowerUpPeripheral));
+  When(Method(mock_system_controller, GetSystemFrequency))
+      .AlwaysReturn(kPeripheralFrequency);
+  When(Method(mock_system_controller, GetPeripheralClockDivider))
+      .AlwaysReturn(1);
+
+  Mock<sjsu::InterruptController> mock_interrupt_controller;
+  Fake(Method(mock_interrupt_controller, Register));
+
+  Mock<sjsu::Pin> mock_pin;
+  Fake(Method(mock_pin, SetPinFunction));
+
+  const SdMci::Bus_t kMockBus = {
+    .clock           = mock_pin.get(),
+    .command         = mock_pin.get(),
+    .power           = mock_pin.get(),
+    .data0           = mock_pin.get(),
+    .data1           = mock_pin.get(),
+    .data2           = mock_pin.get(),
+    .data3           = mock_pin.get(),
+    .pin_function_id = 0b010,
+  };
+
+  Dma dma(mock_system_controller.get(), mock_interrupt_controller.get());
+  SdMci test_subject(kMockBus, dma, mock_system_controller.get());
+  test_subject.Initialize();
+
+  SECTION("Initialize")
+  {
+    Verify(Method(mock_system_controller, PowerUpPeripheral)
+               .Matching([](sjsu::SystemController::PeripheralID id) {
+                 return SystemController::Peripherals::kSdCard.device_id ==
+                        id.device_id;
+               }));
+    Verify(Method(mock_pin, SetPinFunction).Using(kMockBus.pin_function_id))
+        .Exactly(7);
+    // The driver should have taken a DMA channel for block transfers
+    CHECK(Dma::allocated_channels == 0b1);
+  }
+  SECTION("SetClock")
+  {
+    // 48MHz / (2 * (59 + 1)) = 400kHz
+    test_subject.SetClock(400_kHz, false);
+    CHECK(bit::Extract(local_mci.CLOCK, SdMci::ClockRegister::kDivider) == 59);
+    CHECK(bit::Read(local_mci.CLOCK, SdMci::ClockRegister::kEnable.position));
+    CHECK(!bit::Read(local_mci.CLOCK, SdMci::ClockRegister::kWideBus.position));
+    CHECK(test_subject.GetClock() == 400_kHz);
+
+    // The card clock must never run faster than requested
+    test_subject.SetClock(25_MHz, true);
+    CHECK(bit::Extract(local_mci.CLOCK, SdMci::ClockRegister::kDivider) == 0);
+    CHECK(bit::Read(local_mci.CLOCK, SdMci::ClockRegister::kWideBus.position));
+    CHECK(test_subject.GetClock() == 24_MHz);
+
+    // The peripheral clock is slower than 50MHz, so it is passed straight
+    // through to the card.
+    test_subject.SetClock(50_MHz, true);
+    CHECK(bit::Read(local_mci.CLOCK, SdMci::ClockRegister::kBypass.position));
+    CHECK(test_subject.GetClock() == kPeripheralFrequency);
+  }
+  SECTION("SendCmd")
+  {
+    *const_cast<Register *>(&local_mci.RESP0) = 0x1234'5678;
+    *const_cast<Register *>(&local_mci.RESP1) = 0x9ABC'DEF0;
+    uint8_t response[16] = { 0 };
+
+    CHECK(test_subject.SendCmd(SdInterface::Command::kSelectCard, 0xAAAA'0000,
+                               response, 0,
+                               SdInterface::KeepAlive::kNo) == 4);
+    CHECK(local_mci.ARGUMENT == 0xAAAA'0000);
+    CHECK(bit::Extract(local_mci.COMMAND, SdMci::CommandRegister::kIndex) ==
+          7);
+    CHECK(bit::Read(local_mci.COMMAND,
+                    SdMci::CommandRegister::kResponse.position));
+    CHECK(!bit::Read(local_mci.COMMAND,
+                     SdMci::CommandRegister::kLongResponse.position));
+    CHECK(bit::Read(local_mci.COMMAND,
+                    SdMci::CommandRegister::kEnable.position));
+    CHECK(response[0] == 0x12);
+    CHECK(response[3] == 0x78);
+
+    CHECK(test_subject.SendCmd(SdInterface::Command::kGetCsd, 0, response, 0,
+                               SdInterface::KeepAlive::kNo) == 16);
+    CHECK(bit::Read(local_mci.COMMAND,
+                    SdMci::CommandRegister::kLongResponse.position));
+    CHECK(response[4] == 0x9A);
+    CHECK(response[7] == 0xF0);
+
+    // SPI only commands cannot be sent in native mode
+    CHECK(test_subject.SendCmd(SdInterface::Command::kGetOcr, 0, response, 0,
+                               SdInterface::KeepAlive::kNo) ==
+          static_cast<uint32_t>(-1));
+  }
+  SECTION("ReadBlock")
+  {
+    alignas(4) uint8_t buffer[SdMci::kBlockSize];
+
+    CHECK(test_subject.ReadBlock(5, buffer) == 0x00);
+
+    // CMD17 should be sent with the block number as the address
+    CHECK(bit::Extract(local_mci.COMMAND, SdMci::CommandRegister::kIndex) ==
+          17);
+    CHECK(local_mci.ARGUMENT == 5);
+    CHECK(local_mci.DATALEN == SdMci::kBlockSize);
+
+    // The GPDMA should move words from the MCI FIFO into the buffer, with the
+    // MCI deciding when the transfer is done.
+    LPC_GPDMACH_TypeDef & channel = local_channels[0];
+    auto fifo_address = reinterpret_cast<uintptr_t>(local_mci.FIFO);
+    CHECK(channel.CSrcAddr == static_cast<uint32_t>(fifo_address));
+    CHECK(channel.CDestAddr ==
+          static_cast<uint32_t>(reinterpret_cast<uintptr_t>(buffer)));
+    CHECK(bit::Extract(channel.CControl, Dma::Control::kTransferSize) ==
+          SdMci::kBlockSize / 4);
+    CHECK(!bit::Read(channel.CControl,
+                     Dma::Control::kSourceIncrement.position));
+    CHECK(bit::Extract(channel.CConfig, Dma::ChannelConfig::kTransferType) ==
+          0b110);
+    CHECK(bit::Extract(channel.CConfig,
+                       Dma::ChannelConfig::kSourcePeripheral) ==
+          Dma::Request::kSdCard.line);
+  }
+  SECTION("Multiple block read is stopped with CMD12")
+  {
+    alignas(4) uint8_t buffer[SdMci::kBlockSize * 2];
+
+    CHECK(test_subject.ReadBlock(0, buffer, 2) == 0x00);
+
+    CHECK(bit::Extract(local_mci.COMMAND, SdMci::CommandRegister::kIndex) ==
+          12);
+    CHECK(local_mci.DATALEN == sizeof(buffer));
+    CHECK(bit::Extract(local_channels[0].CControl,
+                       Dma::Control::kTransferSize) == sizeof(buffer) / 4);
+  }
+  SECTION("WriteBlock stages unaligned buffers")
+  {
+    alignas(4) uint8_t storage[SdMci::kBlockSize + 1];
+    uint8_t * unaligned = &storage[1];
+
+    CHECK(test_subject.WriteBlock(0, unaligned) == 0x00);
+
+    CHECK(bit::Extract(local_mci.COMMAND, SdMci::CommandRegister::kIndex) ==
+          24);
+    LPC_GPDMACH_TypeDef & channel = local_channels[0];
+    CHECK(channel.CSrcAddr % 4 == 0);
+    auto fifo_address = reinterpret_cast<uintptr_t>(local_mci.FIFO);
+    CHECK(channel.CDestAddr == static_cast<uint32_t>(fifo_address));
+    CHECK(!bit::Read(channel.CControl,
+                     Dma::Control::kDestinationIncrement.position));
+    CHECK(bit::Extract(channel.CConfig, Dma::ChannelConfig::kTransferType) ==
+          0b101);
+  }
+  SECTION("Data CRC failure is reported")
+  {
+    alignas(4) uint8_t buffer[SdMci::kBlockSize];
+    *const_cast<Register *>(&local_mci.STATUS) =
+        (1 << 1) | (1 << 6) | (1 << 7);
+
+    // Reported like an SPI mode R1 communication CRC error
+    CHECK(test_subject.ReadBlock(0, buffer) == 0x08);
+  }
+
+  SdMci::mci              = LPC_MCI;
+  Dma::allocated_channels = 0;
+  Dma::gpdma              = LPC_GPDMA;
+  Dma::channels[0]        = LPC_GPDMACH0;
+  Dma::channels[1]        = LPC_GPDMACH1;
+  Dma::channels[2]        = LPC_GPDMACH2;
+  Dma::channels[3]        = LPC_GPDMACH3;
+  Dma::channels[4]        = LPC_GPDMACH4;
+  Dma::channels[5]        = LPC_GPDMACH5;
+  Dma::channels[6]        = LPC_GPDMACH6;
+  Dma::channels[7]        = LPC_GPDMACH7;
+  sjsu::lpc40xx::SystemController::system_controller = LPC_SC;
+}
+}  // namespace sjsu::lpc40xx
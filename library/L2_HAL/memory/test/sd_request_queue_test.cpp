@@ -0,0 +1,246 @@
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+#include "L2_HAL/memory/sd_request_queue.hpp"
+#include "L4_Testing/fake_sd_card.hpp"
+#include "L4_Testing/testing_frameworks.hpp"
+
+namespace sjsu
+{
+namespace
+{
+constexpr size_t kBlockSize = 512;
+
+/// Stands in for the FreeRTOS queue of request pointers
+std::deque<void *> fake_queue;
+
+BaseType_t FakeQueueSend(QueueHandle_t,
+                         const void * item,
+                         TickType_t,
+                         BaseType_t)
+{
+  fake_queue.push_back(*static_cast<void * const *>(item));
+  return pdTRUE;
+}
+
+BaseType_t FakeQueueReceive(QueueHandle_t, void * item, TickType_t)
+{
+  if (fake_queue.empty())
+  {
+    return pdFALSE;
+  }
+  *static_cast<void **>(item) = fake_queue.front();
+  fake_queue.pop_front();
+  return pdTRUE;
+}
+
+void CountCompletion(SdRequestQueue<>::Request_t * request)
+{
+  (*static_cast<int *>(request->context))++;
+}
+}  // namespace
+
+TEST_CASE("Testing SD Card request queue", "[sd-request-queue]")
+{
+  using Queue   = SdRequestQueue<>;
+  using Request = Queue::Request_t;
+
+  RESET_FAKE(xQueueGenericCreateStatic);
+  RESET_FAKE(xQueueGenericSend);
+  RESET_FAKE(xQueueReceive);
+  RESET_FAKE(xTaskGenericNotify);
+  fake_queue.clear();
+
+  StaticQueue_t queue_handle;
+  xQueueGenericCreateStatic_fake.return_val =
+      reinterpret_cast<QueueHandle_t>(&queue_handle);
+  xQueueGenericSend_fake.custom_fake = FakeQueueSend;
+  xQueueReceive_fake.custom_fake     = FakeQueueReceive;
+
+  FakeSdCard card(64);
+  Queue queue(card);
+
+  SECTION("Requests are rejected until the queue is initialized")
+  {
+    uint8_t block[kBlockSize];
+    Request request = { .operation = Queue::Operation::kWrite, .data = block };
+
+    CHECK(queue.Submit(&request) == Status::kNotReadyYet);
+    REQUIRE(queue.Initialize() == Status::kSuccess);
+    CHECK(queue.Submit(&request) == Status::kSuccess);
+    CHECK(request.status == Status::kNotReadyYet);
+  }
+  SECTION("Malformed requests are rejected")
+  {
+    REQUIRE(queue.Initialize() == Status::kSuccess);
+    Request no_data  = { .operation = Queue::Operation::kRead };
+    Request no_count = { .count = 0 };
+
+    CHECK(queue.Submit(nullptr) == Status::kInvalidParameters);
+    CHECK(queue.Submit(&no_data) == Status::kInvalidParameters);
+    CHECK(queue.Submit(&no_count) == Status::kInvalidParameters);
+    CHECK(fake_queue.empty());
+  }
+  SECTION("Service returns when no request arrives")
+  {
+    REQUIRE(queue.Initialize() == Status::kSuccess);
+    CHECK(!queue.Service(0));
+    CHECK(card.commands.empty());
+  }
+  SECTION("Consecutive writes from separate buffers become one command")
+  {
+    REQUIRE(queue.Initialize() == Status::kSuccess);
+    uint8_t blocks[4][kBlockSize];
+    Request requests[4];
+    for (uint8_t i = 0; i < 4; i++)
+    {
+      memset(blocks[i], 0xA0 + i, kBlockSize);
+      requests[i] = { .operation = Queue::Operation::kWrite,
+                      .block     = 10u + i,
+                      .data      = blocks[i] };
+      REQUIRE(queue.Submit(&requests[i]) == Status::kSuccess);
+    }
+
+    CHECK(queue.Service(0));
+
+    REQUIRE(card.commands.size() == 1);
+    CHECK(card.commands[0].operation == 'W');
+    CHECK(card.commands[0].block == 10);
+    CHECK(card.commands[0].count == 4);
+    for (uint8_t i = 0; i < 4; i++)
+    {
+      CHECK(requests[i].status == Status::kSuccess);
+      CHECK(memcmp(&card.memory[(10 + i) * kBlockSize], blocks[i],
+                   kBlockSize) == 0);
+    }
+    CHECK(queue.GetStatistics().requests == 4);
+    CHECK(queue.GetStatistics().commands == 1);
+  }
+  SECTION("Consecutive reads are scattered to each buffer")
+  {
+    REQUIRE(queue.Initialize() == Status::kSuccess);
+    for (size_t i = 0; i < card.memory.size(); i++)
+    {
+      card.memory[i] = static_cast<uint8_t>(i / kBlockSize);
+    }
+    uint8_t first[2 * kBlockSize];
+    uint8_t second[kBlockSize];
+    Request requests[] = {
+      { .operation = Queue::Operation::kRead,
+        .block     = 5,
+        .count     = 2,
+        .data      = first },
+      { .operation = Queue::Operation::kRead, .block = 7, .data = second },
+    };
+    REQUIRE(queue.Submit(&requests[0]) == Status::kSuccess);
+    REQUIRE(queue.Submit(&requests[1]) == Status::kSuccess);
+
+    CHECK(queue.Service(0));
+
+    REQUIRE(card.commands.size() == 1);
+    CHECK(card.commands[0].count == 3);
+    CHECK(first[0] == 5);
+    CHECK(first[kBlockSize] == 6);
+    CHECK(second[kBlockSize - 1] == 7);
+  }
+  SECTION("Requests that cannot be merged are carried out in order")
+  {
+    REQUIRE(queue.Initialize() == Status::kSuccess);
+    uint8_t block[kBlockSize];
+    Request requests[] = {
+      { .operation = Queue::Operation::kWrite, .block = 10, .data = block },
+      { .operation = Queue::Operation::kWrite, .block = 20, .data = block },
+      { .operation = Queue::Operation::kRead, .block = 21, .data = block },
+      { .operation = Queue::Operation::kDelete, .block = 30, .count = 8 },
+      { .operation = Queue::Operation::kDelete, .block = 38, .count = 8 },
+    };
+    for (auto & request : requests)
+    {
+      REQUIRE(queue.Submit(&request) == Status::kSuccess);
+    }
+
+    while (queue.Service(0))
+    {
+      continue;
+    }
+
+    // Erases are not merged as each one can already cover any range
+    REQUIRE(card.commands.size() == 5);
+    CHECK(card.commands[0].block == 10);
+    CHECK(card.commands[1].block == 20);
+    CHECK(card.commands[2].operation == 'R');
+    CHECK(card.commands[3].operation == 'D');
+    CHECK(card.commands[3].count == 8);
+    CHECK(card.commands[4].block == 38);
+  }
+  SECTION("Merged commands are limited to the batch size")
+  {
+    using SmallBatchQueue = SdRequestQueue<16, 4>;
+    SmallBatchQueue small_batch_queue(card);
+    REQUIRE(small_batch_queue.Initialize() == Status::kSuccess);
+    uint8_t block[kBlockSize];
+    SmallBatchQueue::Request_t requests[10];
+    for (uint8_t i = 0; i < 10; i++)
+    {
+      requests[i] = { .operation = SmallBatchQueue::Operation::kWrite,
+                      .block     = i,
+                      .data      = block };
+      REQUIRE(small_batch_queue.Submit(&requests[i]) == Status::kSuccess);
+    }
+
+    while (small_batch_queue.Service(0))
+    {
+      continue;
+    }
+
+    REQUIRE(card.commands.size() == 3);
+    CHECK(card.commands[0].count == 4);
+    CHECK(card.commands[1].count == 4);
+    CHECK(card.commands[2].count == 2);
+  }
+  SECTION("Completion calls the handler and notifies the task")
+  {
+    REQUIRE(queue.Initialize() == Status::kSuccess);
+    StaticTask_t task;
+    int completions = 0;
+    uint8_t block[kBlockSize];
+    Request request = { .operation = Queue::Operation::kWrite,
+                        .data      = block,
+                        .handler   = CountCompletion,
+                        .context   = &completions,
+                        .task      = reinterpret_cast<TaskHandle_t>(&task) };
+    REQUIRE(queue.Submit(&request) == Status::kSuccess);
+
+    CHECK(queue.Service(0));
+
+    CHECK(completions == 1);
+    CHECK(xTaskGenericNotify_fake.call_count == 1);
+    CHECK(xTaskGenericNotify_fake.arg0_val ==
+          reinterpret_cast<TaskHandle_t>(&task));
+  }
+  SECTION("Card errors are reported to every merged request")
+  {
+    REQUIRE(queue.Initialize() == Status::kSuccess);
+    card.r1 = 0x04;
+    uint8_t block[kBlockSize];
+    Request requests[] = {
+      { .operation = Queue::Operation::kWrite, .block = 1, .data = block },
+      { .operation = Queue::Operation::kWrite, .block = 2, .data = block },
+    };
+    REQUIRE(queue.Submit(&requests[0]) == Status::kSuccess);
+    REQUIRE(queue.Submit(&requests[1]) == Status::kSuccess);
+
+    CHECK(queue.Service(0));
+
+    CHECK(requests[0].status == Status::kBusError);
+    CHECK(requests[1].status == Status::kBusError);
+  }
+
+  RESET_FAKE(xQueueGenericCreateStatic);
+  RESET_FAKE(xQueueGenericSend);
+  RESET_FAKE(xQueueReceive);
+  RESET_FAKE(xTaskGenericNotify);
+}
+}  // namespace sjsu
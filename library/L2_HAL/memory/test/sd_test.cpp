@@ -1,12 +1,515 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <vector>
+
 #include "L2_HAL/memory/sd.hpp"
+#include "L4_Testing/sd_card_emulator.hpp"
 #include "L4_Testing/testing_frameworks.hpp"
+#include "utility/crc.hpp"
 
 namespace sjsu
 {
 EMIT_ALL_METHODS(Sd);
 
+namespace
+{
+/// Byte level model of a card in SPI mode that answers read commands and
+/// records every command it receives. Block n is filled with the bytes
+/// n * 7 + i.
+class FakeSpiCard final : public Spi
+{
+ public:
+  struct Command_t
+  {
+    uint8_t index;
+    uint32_t argument;
+  };
+
+  static uint8_t BlockByte(uint32_t block, size_t i)
+  {
+    return static_cast<uint8_t>(block * 7 + i);
+  }
+
+  Status Initialize() const override
+  {
+    return Status::kSuccess;
+  }
+  uint16_t Transfer(uint16_t data) const override
+  {
+    if (output_.empty() && streaming_)
+    {
+      QueueBlock(next_block_++);
+    }
+    uint8_t response = 0xFF;
+    if (!output_.empty())
+    {
+      response = output_.front();
+      output_.pop_front();
+    }
+    Receive(static_cast<uint8_t>(data));
+    return response;
+  }
+  void Transfer(const uint8_t * transmit,
+                uint8_t * receive,
+                size_t length,
+                uint8_t fill_byte) const override
+  {
+    for (size_t i = 0; i < length; i++)
+    {
+      uint8_t byte = static_cast<uint8_t>(
+          Transfer((transmit != nullptr) ? transmit[i] : fill_byte));
+      if (receive != nullptr)
+      {
+        receive[i] = byte;
+      }
+    }
+  }
+  void SetDataSize(DataSize) const override {}
+  void SetClock(units::frequency::hertz_t, bool, bool) const override {}
+  units::frequency::hertz_t GetClock() const override
+  {
+    return 0_Hz;
+  }
+
+  mutable std::vector<Command_t> commands;
+  /// Set to send a bad CRC with this block
+  mutable uint32_t corrupt_block = 0xFFFF'FFFF;
+
+ private:
+  void Receive(uint8_t byte) const
+  {
+    if (frame_.empty() && (byte & 0xC0) != 0x40)
+    {
+      return;
+    }
+    frame_.push_back(byte);
+    if (frame_.size() < 6)
+    {
+      return;
+    }
+
+    Command_t command = {
+      .index    = static_cast<uint8_t>(frame_[0] & 0x3F),
+      .argument = static_cast<uint32_t>((frame_[1] << 24) | (frame_[2] << 16) |
+                                        (frame_[3] << 8) | frame_[4]),
+    };
+    frame_.clear();
+    commands.push_back(command);
+
+    switch (command.index)
+    {
+      case 12:
+        // Stuff byte, R1 and then one busy byte
+        streaming_ = false;
+        output_    = { 0xFF, 0xFF, 0x00, 0x00 };
+        break;
+      case 17:
+        output_ = { 0xFF, 0x00 };
+        QueueBlock(command.argument);
+        break;
+      case 18:
+        output_     = { 0xFF, 0x00 };
+        streaming_  = true;
+        next_block_ = command.argument;
+        break;
+      default: output_ = { 0xFF, 0x00, 0x00 }; break;
+    }
+  }
+
+  void QueueBlock(uint32_t block) const
+  {
+    uint8_t data[512];
+    for (size_t i = 0; i < sizeof(data); i++)
+    {
+      data[i] = BlockByte(block, i);
+    }
+    uint16_t crc = crc::Crc16Ccitt::Calculate(data, sizeof(data));
+    if (block == corrupt_block)
+    {
+      crc = static_cast<uint16_t>(~crc);
+    }
+
+    output_.push_back(0xFF);
+    output_.push_back(0xFF);
+    output_.push_back(0xFE);
+    output_.insert(output_.end(), std::begin(data), std::end(data));
+    output_.push_back(static_cast<uint8_t>(crc >> 8));
+    output_.push_back(static_cast<uint8_t>(crc));
+  }
+
+  mutable std::deque<uint8_t> output_;
+  mutable std::vector<uint8_t> frame_;
+  mutable bool streaming_      = false;
+  mutable uint32_t next_block_ = 0;
+};
+
+bool BlocksMatch(const uint8_t * data, uint32_t block, uint32_t blocks)
+{
+  for (size_t i = 0; i < blocks * Sd::kBlockSize; i++)
+  {
+    uint32_t block_number = block + static_cast<uint32_t>(i / Sd::kBlockSize);
+    if (data[i] != FakeSpiCard::BlockByte(block_number, i % Sd::kBlockSize))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace
+
 TEST_CASE("Testing SD Card Driver Class", "[sd]")
 {
   Mock<Spi> mock_spi;
+
+  SECTION("CSD version 1.0")
+  {
+    // 2GB SDSC card: C_SIZE = 3839, C_SIZE_MULT = 7, READ_BL_LEN = 10,
+    // SECTOR_SIZE = 31 and WRITE_BL_LEN = 10
+    constexpr SdInterface::Csd_t kCsd = { { 0x00, 0x26, 0x00, 0x32, 0x5B,
+                                            0x5A, 0x03, 0xBF, 0xC0, 0x03,
+                                            0xCF, 0x80, 0x02, 0x80, 0x00,
+                                            0x01 } };
+
+    CHECK(kCsd.Version() == 0);
+    CHECK(kCsd.Extract(73, 62) == 3839);
+    CHECK(kCsd.GetBlockCount() == 3'932'160);
+    CHECK(kCsd.GetEraseBlockSize() == 64);
+  }
+  SECTION("CSD version 2.0")
+  {
+    // 8GB SDHC card: C_SIZE = 15159
+    constexpr SdInterface::Csd_t kCsd = { { 0x40, 0x0E, 0x00, 0x32, 0x5B,
+                                            0x59, 0x00, 0x00, 0x3B, 0x37,
+                                            0x7F, 0x80, 0x0A, 0x40, 0x40,
+                                            0xAF } };
+
+    CHECK(kCsd.Version() == 1);
+    CHECK(kCsd.GetBlockCount() == 15'523'840);
+    CHECK(kCsd.GetEraseBlockSize() == 128);
+    // TRAN_SPEED = 0x32, i.e. 2.5 * 10Mbit/s
+    CHECK(kCsd.GetMaxClock() == 25_MHz);
+    // Transfer rate units 4 to 7 and time value 0 are reserved
+    SdInterface::Csd_t reserved = kCsd;
+    reserved.byte[3]            = 0x34;
+    CHECK(reserved.GetMaxClock() == 0_Hz);
+    reserved.byte[3] = 0x02;
+    CHECK(reserved.GetMaxClock() == 0_Hz);
+    // Command class 10 (switch) is supported, class 11 is reserved
+    CHECK(kCsd.SupportsCommandClass(10));
+    CHECK(!kCsd.SupportsCommandClass(11));
+  }
+  SECTION("CID")
+  {
+    constexpr SdInterface::Cid_t kCid = { { 0x03, 0x53, 0x44, 0x53, 0x55,
+                                            0x30, 0x38, 0x47, 0x80, 0x12,
+                                            0x34, 0x56, 0x78, 0x01, 0x1A,
+                                            0x01 } };
+    char name[6];
+    kCid.GetProductName(name);
+
+    CHECK(kCid.GetManufacturerId() == 0x03);
+    CHECK(strcmp(name, "SU08G") == 0);
+    CHECK(kCid.GetRevision() == 0x80);
+    CHECK(kCid.GetSerialNumber() == 0x1234'5678);
+    CHECK(kCid.GetManufactureYear() == 2017);
+    CHECK(kCid.GetManufactureMonth() == 10);
+  }
+}
+
+TEST_CASE("Testing SD Card block reads", "[sd]")
+{
+  FakeSpiCard card;
+  Mock<Gpio> mock_chip_select;
+  Fake(Method(mock_chip_select, Set));
+  Sd test_subject(card, mock_chip_select.get());
+
+  uint8_t data[4 * Sd::kBlockSize];
+
+  SECTION("A single block read costs one command")
+  {
+    CHECK(test_subject.ReadBlock(10, data) == 0x00);
+
+    CHECK(BlocksMatch(data, 10, 1));
+    REQUIRE(card.commands.size() == 1);
+    CHECK(card.commands[0].index == 17);
+    CHECK(card.commands[0].argument == 10);
+    Verify(Method(mock_chip_select, Set).Using(Gpio::State::kHigh)).Once();
+  }
+  SECTION("Multi-block reads are stopped before the card is deselected")
+  {
+    size_t commands_at_deselect = 0;
+    When(Method(mock_chip_select, Set))
+        .AlwaysDo([&card, &commands_at_deselect](Gpio::State state) {
+          if (state == Gpio::State::kHigh)
+          {
+            commands_at_deselect = card.commands.size();
+          }
+        });
+
+    CHECK(test_subject.ReadBlock(14, data, 4) == 0x00);
+
+    CHECK(BlocksMatch(data, 14, 4));
+    REQUIRE(card.commands.size() == 2);
+    CHECK(card.commands[0].index == 18);
+    CHECK(card.commands[0].argument == 14);
+    CHECK(card.commands[1].index == 12);
+    // Another device on the bus cannot clock an open stream
+    CHECK(commands_at_deselect == 2);
+  }
+  SECTION("Each read sends its own command")
+  {
+    CHECK(test_subject.ReadBlock(20, data, 2) == 0x00);
+    CHECK(test_subject.ReadBlock(22, data) == 0x00);
+
+    CHECK(BlocksMatch(data, 22, 1));
+    REQUIRE(card.commands.size() == 3);
+    CHECK(card.commands[0].index == 18);
+    CHECK(card.commands[1].index == 12);
+    CHECK(card.commands[2].index == 17);
+    CHECK(card.commands[2].argument == 22);
+  }
+  SECTION("Bad blocks are reported")
+  {
+    card.corrupt_block = 21;
+
+    CHECK(test_subject.ReadBlock(20, data, 2) == 0x08);
+    CHECK(test_subject.ReadBlock(22, data) == 0x00);
+
+    CHECK(BlocksMatch(data, 22, 1));
+    REQUIRE(card.commands.size() == 3);
+    CHECK(card.commands[1].index == 12);
+    CHECK(card.commands[2].index == 17);
+  }
+}
+
+TEST_CASE("Testing SD Card driver with an emulated card", "[sd]")
+{
+  // 1 MiB image, every byte of block n set to n
+  constexpr uint32_t kImageBlocks = 2 * SdCardEmulator::kCapacityUnit;
+  std::FILE * image               = std::tmpfile();
+  REQUIRE(image != nullptr);
+  uint8_t block[Sd::kBlockSize];
+  for (uint32_t i = 0; i < kImageBlocks; i++)
+  {
+    memset(block, static_cast<uint8_t>(i), sizeof(block));
+    std::fwrite(block, 1, sizeof(block), image);
+  }
+
+  SdCardEmulator card(image);
+  Sd test_subject(card, card.GetChipSelect());
+  Sd::CardInfo_t card_info;
+  test_subject.Initialize();
+  REQUIRE(test_subject.Mount(&card_info));
+
+  uint8_t data[8 * Sd::kBlockSize];
+
+  SECTION("Mount identifies the card")
+  {
+    CHECK(card_info.type == Sd::Type::kSDHC);
+    CHECK(card_info.csd.GetBlockCount() == kImageBlocks);
+    CHECK(card_info.cid.GetManufacturerId() == 0x53);
+    // The card agreed to switch to high speed mode
+    CHECK(card_info.clock == Sd::kHighSpeedClock);
+  }
+  SECTION("Blocks written are read back")
+  {
+    for (size_t i = 0; i < sizeof(data); i++)
+    {
+      data[i] = static_cast<uint8_t>(i * 13);
+    }
+    card.ResetStatistics();
+
+    CHECK(test_subject.WriteBlock(100, data) == 0x00);
+    CHECK(test_subject.WriteBlock(200, data, 8) == 0x00);
+
+    CHECK(card.GetStatistics().commands == 2);
+    CHECK(card.GetStatistics().blocks_written == 9);
+
+    uint8_t read_back[sizeof(data)];
+    CHECK(test_subject.ReadBlock(100, read_back) == 0x00);
+    CHECK(memcmp(read_back, data, Sd::kBlockSize) == 0);
+    CHECK(test_subject.ReadBlock(200, read_back, 8) == 0x00);
+    CHECK(memcmp(read_back, data, sizeof(data)) == 0);
+    CHECK(test_subject.ReadBlock(199, read_back) == 0x00);
+    CHECK(read_back[0] == 199);
+  }
+  SECTION("Written blocks are followed by their CRC-16")
+  {
+    // Setup: A CRC engine that gets every CRC wrong, so that the card only
+    //        accepts the block if it ignores the CRC bytes.
+    Mock<sjsu::Crc> mock_crc;
+    When(Method(mock_crc, Calculate))
+        .AlwaysDo([](sjsu::Crc::Algorithm, const void * bytes, size_t length) {
+          return static_cast<uint32_t>(static_cast<uint16_t>(
+              ~crc::Crc16Ccitt::Calculate(
+                  static_cast<const uint8_t *>(bytes), length)));
+        });
+    Sd bad_crc_sd(card, card.GetChipSelect(), mock_crc.get());
+    memset(data, 0x5A, Sd::kBlockSize);
+    card.ResetStatistics();
+
+    // Exercise
+    uint8_t bad_crc_r1 = bad_crc_sd.WriteBlock(100, data);
+    uint8_t r1         = test_subject.WriteBlock(101, data);
+
+    // Verify: The block with the wrong CRC is rejected and reported through
+    //         the CRC error flag, the one with the right CRC is written.
+    CHECK(bad_crc_r1 == 0x08);
+    CHECK(r1 == 0x00);
+    CHECK(card.GetStatistics().blocks_written == 1);
+    uint8_t read_back[2 * Sd::kBlockSize];
+    CHECK(test_subject.ReadBlock(100, read_back, 2) == 0x00);
+    CHECK(read_back[0] == 100);
+    CHECK(read_back[Sd::kBlockSize] == 0x5A);
+  }
+  SECTION("Multi-block writes wait for the card to program the last block")
+  {
+    card.ResetStatistics();
+
+    CHECK(test_subject.WriteBlock(300, data, 2) == 0x00);
+
+    // The card is busy for write_busy_bytes after each block, and again after
+    // the stop token. The byte the card sends before it goes busy after the
+    // stop token must not end the wait.
+    constexpr SdCardEmulator::Timing_t kTiming;
+    CHECK(card.GetStatistics().busy_bytes == 3 * kTiming.write_busy_bytes);
+  }
+  SECTION("Burst writes and erases run at bus speed")
+  {
+    constexpr uint32_t kBurstBlocks = 64;
+    std::vector<uint8_t> burst(kBurstBlocks * Sd::kBlockSize, 0xA5);
+    card.ResetStatistics();
+
+    CHECK(test_subject.WriteBlock(1500, burst.data(), kBurstBlocks) == 0x00);
+    CHECK(test_subject.DeleteBlock(1500, 1500 + kBurstBlocks - 1) == 0x00);
+
+    // Only the card's busy signal is waited on, so the burst and its erase
+    // take little more time than clocking the payload at full speed.
+    const auto & statistics = card.GetStatistics();
+    CHECK(statistics.blocks_written == kBurstBlocks);
+    CHECK(statistics.blocks_erased == kBurstBlocks);
+    CHECK(statistics.commands == 4);
+    double clock   = card_info.clock.to<double>();
+    double seconds = static_cast<double>(statistics.bytes) * 8.0 / clock;
+    double bytes_per_second = static_cast<double>(burst.size()) / seconds;
+    CHECK(bytes_per_second > 0.9 * clock / 8.0);
+  }
+  SECTION("Multi-block reads cost a read and a stop command")
+  {
+    card.ResetStatistics();
+    REQUIRE(test_subject.ReadBlock(1000, data, 8) == 0x00);
+    for (uint32_t i = 0; i < 8; i++)
+    {
+      CHECK(data[i * Sd::kBlockSize] == static_cast<uint8_t>(1000 + i));
+    }
+    CHECK(card.GetStatistics().commands == 2);
+    // Chip select reads high once the card is deselected
+    CHECK(card.GetChipSelect().Read());
+
+    // The stream is over, so the card takes the next command
+    memset(data, 0x5A, Sd::kBlockSize);
+    CHECK(test_subject.WriteBlock(1008, data) == 0x00);
+    CHECK(test_subject.ReadBlock(1008, data) == 0x00);
+    CHECK(data[0] == 0x5A);
+  }
+  SECTION("Deleted blocks read back as erased")
+  {
+    CHECK(test_subject.DeleteBlock(4, 7) == 0x00);
+
+    CHECK(test_subject.ReadBlock(3, data, 6) == 0x00);
+    CHECK(data[0] == 3);
+    CHECK(data[Sd::kBlockSize] == SdCardEmulator::kErasedByte);
+    CHECK(data[5 * Sd::kBlockSize - 1] == SdCardEmulator::kErasedByte);
+    CHECK(data[5 * Sd::kBlockSize] == 8);
+    CHECK(card.GetStatistics().blocks_erased == 4);
+  }
+  SECTION("Out of range accesses are rejected")
+  {
+    CHECK(test_subject.WriteBlock(kImageBlocks, data) != 0x00);
+    CHECK(test_subject.ReadBlock(kImageBlocks, data) != 0x00);
+    // A multi-block write that runs off the end of the card fails on its
+    // last block, and the card is asked why with CMD13.
+    card.ResetStatistics();
+    CHECK((test_subject.WriteBlock(kImageBlocks - 1, data, 2) & 0x08) != 0);
+    CHECK(card.GetStatistics().blocks_written == 1);
+    CHECK(card.GetStatistics().commands == 2);
+    // The card still works afterwards
+    CHECK(test_subject.ReadBlock(kImageBlocks - 1, data) == 0x00);
+  }
+
+  std::fclose(image);
+}
+
+TEST_CASE("Testing SD Card driver with an emulated SDSC card", "[sd]")
+{
+  // 1 MiB image, every byte of block n set to n
+  constexpr uint32_t kImageBlocks = 2 * SdCardEmulator::kCapacityUnit;
+  std::FILE * image               = std::tmpfile();
+  REQUIRE(image != nullptr);
+  uint8_t block[Sd::kBlockSize];
+  for (uint32_t i = 0; i < kImageBlocks; i++)
+  {
+    memset(block, static_cast<uint8_t>(i), sizeof(block));
+    std::fwrite(block, 1, sizeof(block), image);
+  }
+
+  // A standard capacity card is addressed in bytes, and rejects addresses
+  // that are not on a block boundary
+  SdCardEmulator card(image);
+  card.SetCapacity(SdCardEmulator::Capacity::kStandard);
+  Sd test_subject(card, card.GetChipSelect());
+  Sd::CardInfo_t card_info;
+  test_subject.Initialize();
+  REQUIRE(test_subject.Mount(&card_info));
+
+  uint8_t data[8 * Sd::kBlockSize];
+
+  SECTION("Mount identifies the card")
+  {
+    CHECK(card_info.type == Sd::Type::kSDSC);
+    CHECK(card_info.csd.Version() == 0);
+    CHECK(card_info.csd.GetBlockCount() == kImageBlocks);
+  }
+  SECTION("Blocks are addressed by number")
+  {
+    CHECK(test_subject.ReadBlock(3, data) == 0x00);
+    CHECK(data[0] == 3);
+    CHECK(test_subject.ReadBlock(199, data, 2) == 0x00);
+    CHECK(data[0] == 199);
+    CHECK(data[Sd::kBlockSize] == 200);
+
+    memset(data, 0x5A, sizeof(data));
+    CHECK(test_subject.WriteBlock(100, data) == 0x00);
+    CHECK(test_subject.WriteBlock(200, data, 8) == 0x00);
+    CHECK(card.GetStatistics().blocks_written == 9);
+
+    CHECK(test_subject.ReadBlock(99, data, 2) == 0x00);
+    CHECK(data[0] == 99);
+    CHECK(data[Sd::kBlockSize] == 0x5A);
+    CHECK(test_subject.ReadBlock(207, data, 2) == 0x00);
+    CHECK(data[0] == 0x5A);
+    CHECK(data[Sd::kBlockSize] == 208);
+  }
+  SECTION("Deleted blocks read back as erased")
+  {
+    CHECK(test_subject.DeleteBlock(4, 7) == 0x00);
+
+    CHECK(test_subject.ReadBlock(3, data, 6) == 0x00);
+    CHECK(data[0] == 3);
+    CHECK(data[Sd::kBlockSize] == SdCardEmulator::kErasedByte);
+    CHECK(data[5 * Sd::kBlockSize - 1] == SdCardEmulator::kErasedByte);
+    CHECK(data[5 * Sd::kBlockSize] == 8);
+    CHECK(card.GetStatistics().blocks_erased == 4);
+  }
+  SECTION("Out of range accesses are rejected")
+  {
+    CHECK(test_subject.ReadBlock(kImageBlocks - 1, data) == 0x00);
+    CHECK(data[0] == static_cast<uint8_t>(kImageBlocks - 1));
+    CHECK(test_subject.ReadBlock(kImageBlocks, data) != 0x00);
+  }
+
+  std::fclose(image);
 }
 }  // namespace sjsu
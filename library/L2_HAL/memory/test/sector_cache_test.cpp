@@ -0,0 +1,364 @@
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "L2_HAL/memory/sd.hpp"
+#include "L2_HAL/memory/sector_cache.hpp"
+#include "L4_Testing/fake_sd_card.hpp"
+#include "L4_Testing/sd_card_emulator.hpp"
+#include "L4_Testing/testing_frameworks.hpp"
+
+namespace sjsu
+{
+namespace
+{
+constexpr size_t kSectorSize = 512;
+
+/// One disk_read (R), disk_write (W) or disk_ioctl(CTRL_SYNC) (S) call made
+/// by FatFs.
+struct Access_t
+{
+  char operation;
+  uint32_t sector;
+  uint32_t count;
+};
+
+/// Replays a trace against the cache and against a card accessed directly,
+/// checking that every read returns the same data through both paths.
+template <size_t kSectors>
+void Replay(const std::vector<Access_t> & trace,
+            SectorCache<kSectors> & cache,
+            FakeSdCard & direct)
+{
+  std::vector<uint8_t> expected;
+  std::vector<uint8_t> actual;
+  uint8_t fill = 0;
+  for (const auto & access : trace)
+  {
+    size_t length = access.count * kSectorSize;
+    switch (access.operation)
+    {
+      case 'R':
+        expected.assign(length, 0);
+        actual.assign(length, 0xAA);
+        direct.ReadBlock(access.sector, expected.data(), access.count);
+        CHECK(cache.Read(access.sector, actual.data(), access.count) ==
+              Status::kSuccess);
+        CHECK(expected == actual);
+        break;
+      case 'W':
+        expected.assign(length, ++fill);
+        direct.WriteBlock(access.sector, expected.data(), access.count);
+        CHECK(cache.Write(access.sector, expected.data(), access.count) ==
+              Status::kSuccess);
+        break;
+      case 'S': CHECK(cache.Flush() == Status::kSuccess); break;
+    }
+  }
+}
+
+/// Disk accesses made by FatFs while appending 32-byte records to a log file
+/// and calling f_sync() after each one. The FAT is in sector 10, the
+/// directory entry in sector 40 and the file data starts at sector 100 with 4
+/// sectors per cluster.
+std::vector<Access_t> SmallRecordAppendTrace()
+{
+  constexpr uint32_t kFatSector       = 10;
+  constexpr uint32_t kDirectorySector = 40;
+  constexpr uint32_t kDataSector      = 100;
+  constexpr uint32_t kRecordsPerSector  = 16;
+  constexpr uint32_t kSectorsPerCluster = 4;
+
+  std::vector<Access_t> trace;
+  for (uint32_t record = 0; record < 128; record++)
+  {
+    uint32_t sector = kDataSector + (record / kRecordsPerSector);
+    if (record % (kRecordsPerSector * kSectorsPerCluster) == 0)
+    {
+      // Allocate the next cluster
+      trace.push_back({ 'R', kFatSector, 1 });
+      trace.push_back({ 'W', kFatSector, 1 });
+    }
+    if (record % kRecordsPerSector != 0)
+    {
+      // Partial sector, so FatFs reloads it before appending
+      trace.push_back({ 'R', sector, 1 });
+    }
+    // f_sync(): data sector, then the directory entry's size and timestamp
+    trace.push_back({ 'W', sector, 1 });
+    trace.push_back({ 'R', kDirectorySector, 1 });
+    trace.push_back({ 'W', kDirectorySector, 1 });
+    trace.push_back({ 'S', 0, 0 });
+  }
+  return trace;
+}
+
+/// Disk accesses made by FatFs while reading a 128 KiB file one sector at a
+/// time, as f_read() does when given a buffer smaller than a cluster.
+std::vector<Access_t> SequentialReadTrace()
+{
+  std::vector<Access_t> trace;
+  for (uint32_t sector = 100; sector < 356; sector++)
+  {
+    trace.push_back({ 'R', sector, 1 });
+  }
+  return trace;
+}
+
+/// Replays a trace on an emulated card through sjsu::Sd, optionally with a
+/// sector cache in front of it, and prints the bus traffic it took.
+template <size_t kSectors>
+SdCardEmulator::Statistics_t Benchmark(const char * name,
+                                       const std::vector<Access_t> & trace,
+                                       std::FILE * image,
+                                       bool use_cache,
+                                       uint32_t read_ahead = 0)
+{
+  SdCardEmulator emulator(image);
+  Sd sd(emulator, emulator.GetChipSelect());
+  Sd::CardInfo_t card_info;
+  sd.Initialize();
+  REQUIRE(sd.Mount(&card_info));
+  SectorCache<kSectors> cache(sd, read_ahead);
+  emulator.ResetStatistics();
+
+  std::vector<uint8_t> buffer;
+  for (const auto & access : trace)
+  {
+    buffer.assign(access.count * kSectorSize, 0x3C);
+    switch (access.operation)
+    {
+      case 'R':
+        if (use_cache)
+        {
+          CHECK(cache.Read(access.sector, buffer.data(), access.count) ==
+                Status::kSuccess);
+        }
+        else
+        {
+          CHECK(sd.ReadBlock(access.sector, buffer.data(), access.count) ==
+                0x00);
+        }
+        break;
+      case 'W':
+        if (use_cache)
+        {
+          CHECK(cache.Write(access.sector, buffer.data(), access.count) ==
+                Status::kSuccess);
+        }
+        else
+        {
+          CHECK(sd.WriteBlock(access.sector, buffer.data(), access.count) ==
+                0x00);
+        }
+        break;
+      case 'S':
+        if (use_cache)
+        {
+          CHECK(cache.Flush() == Status::kSuccess);
+        }
+        sd.WaitWhileBusy();
+        break;
+    }
+  }
+
+  // Time the same traffic would take on a 25 MHz bus
+  const auto & statistics = emulator.GetStatistics();
+  double milliseconds =
+      static_cast<double>(statistics.bytes) * 8.0 / 25'000.0;
+  printf("  %-32s %8" PRIu64 " bytes %5" PRIu32 " commands %8.2f ms\n", name,
+         statistics.bytes, statistics.commands, milliseconds);
+  return statistics;
+}
+}  // namespace
+
+TEST_CASE("Testing SD Card sector cache", "[sector-cache]")
+{
+  FakeSdCard card(256);
+  FakeSdCard direct(256);
+
+  SECTION("Small record appends are served from the cache")
+  {
+    SectorCache<8> cache(card);
+    auto trace = SmallRecordAppendTrace();
+
+    Replay(trace, cache, direct);
+
+    uint32_t trace_sectors = 0;
+    uint32_t trace_writes  = 0;
+    for (const auto & access : trace)
+    {
+      trace_sectors += access.count;
+      trace_writes += (access.operation == 'W') ? access.count : 0;
+    }
+    // Only the FAT and directory sectors are ever read from the card. Data
+    // sectors are reloaded by FatFs right after being written, so they hit.
+    const auto & statistics = cache.GetStatistics();
+    CHECK(statistics.card_reads == 2);
+    CHECK(statistics.hits + statistics.misses == trace_sectors);
+    CHECK(statistics.hits > 4 * statistics.misses);
+    // Each sync still writes back the data and directory sectors, plus the
+    // FAT when a cluster has been allocated.
+    CHECK(statistics.card_writes == trace_writes);
+    CHECK(card.memory == direct.memory);
+  }
+  SECTION("Small record appends without sync are absorbed by the cache")
+  {
+    SectorCache<8> cache(card);
+    std::vector<Access_t> trace;
+    for (const auto & access : SmallRecordAppendTrace())
+    {
+      if (access.operation != 'S')
+      {
+        trace.push_back(access);
+      }
+    }
+    trace.push_back({ 'S', 0, 0 });
+
+    Replay(trace, cache, direct);
+
+    // Every sector is written once: 8 data sectors, the FAT and the directory
+    CHECK(cache.GetStatistics().card_writes == 8 + 2);
+    CHECK(card.memory == direct.memory);
+  }
+  SECTION("Writes are held until sync")
+  {
+    SectorCache<8> cache(card);
+
+    Replay<8>({ { 'W', 10, 1 }, { 'W', 10, 1 }, { 'W', 40, 1 } }, cache,
+              direct);
+    CHECK(cache.IsDirty(10));
+    CHECK(card.Count('W') == 0);
+
+    Replay<8>({ { 'S', 0, 0 } }, cache, direct);
+    CHECK(!cache.IsDirty(10));
+    CHECK(card.Count('W') == 2);
+    CHECK(card.memory == direct.memory);
+  }
+  SECTION("Flush coalesces adjacent dirty sectors")
+  {
+    SectorCache<8> cache(card);
+
+    Replay<8>(
+        { { 'W', 50, 1 }, { 'W', 51, 1 }, { 'W', 52, 1 }, { 'S', 0, 0 } },
+        cache, direct);
+
+    CHECK(card.Count('W') == 1);
+    CHECK(cache.GetStatistics().card_writes == 3);
+    CHECK(card.memory == direct.memory);
+  }
+  SECTION("Least recently used sector is evicted")
+  {
+    SectorCache<4> cache(card);
+
+    // Fill the cache, then use sector 1 again so sector 2 becomes the least
+    // recently used.
+    Replay<4>({ { 'R', 1, 1 },
+                { 'R', 2, 1 },
+                { 'R', 3, 1 },
+                { 'W', 4, 1 },
+                { 'R', 1, 1 },
+                { 'R', 5, 1 } },
+              cache, direct);
+    CHECK(card.Count('R') == 4);
+
+    // Sector 1 is still cached, sector 2 has to be read again
+    Replay<4>({ { 'R', 1, 1 } }, cache, direct);
+    CHECK(card.Count('R') == 4);
+    Replay<4>({ { 'R', 2, 1 } }, cache, direct);
+    CHECK(card.Count('R') == 5);
+
+    // Sector 4 is now the least recently used. It is dirty, thus it must be
+    // written back when evicted.
+    CHECK(cache.IsDirty(4));
+    Replay<4>({ { 'R', 6, 1 } }, cache, direct);
+    CHECK(!cache.IsDirty(4));
+    CHECK(card.Count('W') == 1);
+    CHECK(card.memory == direct.memory);
+  }
+  SECTION("Sequential reads trigger read-ahead")
+  {
+    constexpr uint32_t kReadAhead = 3;
+    SectorCache<8> cache(card, kReadAhead);
+    std::vector<Access_t> trace;
+    for (uint32_t sector = 200; sector < 232; sector++)
+    {
+      trace.push_back({ 'R', sector, 1 });
+    }
+
+    Replay(trace, cache, direct);
+
+    // The first read cannot be known to be sequential, after that every miss
+    // loads 4 sectors. The last miss reads one sector past the end.
+    CHECK(card.Count('R') == 1 + 8);
+    CHECK(cache.GetStatistics().card_reads == 33);
+    CHECK(cache.GetStatistics().read_ahead == 24);
+    CHECK(cache.GetStatistics().hits > cache.GetStatistics().misses);
+  }
+  SECTION("Discarded sectors are dropped without being written back")
+  {
+    SectorCache<4> cache(card);
+
+    Replay<4>({ { 'W', 30, 1 }, { 'W', 31, 1 }, { 'W', 35, 1 } }, cache,
+              direct);
+    cache.Discard(30, 34);
+    CHECK(!cache.IsDirty(30));
+    CHECK(!cache.IsDirty(31));
+    CHECK(cache.IsDirty(35));
+
+    CHECK(cache.Flush() == Status::kSuccess);
+    CHECK(card.Count('W') == 1);
+    CHECK(cache.GetStatistics().card_writes == 1);
+  }
+  SECTION("Large accesses bypass the cache and stay coherent")
+  {
+    SectorCache<4> cache(card);
+
+    Replay<4>({ { 'W', 21, 1 },
+                { 'R', 20, 8 },
+                { 'W', 20, 8 },
+                { 'R', 21, 1 },
+                { 'S', 0, 0 } },
+              cache, direct);
+
+    CHECK(card.memory == direct.memory);
+  }
+}
+
+TEST_CASE("Benchmarking SD Card sector cache on an emulated card",
+          "[sector-cache]")
+{
+  std::FILE * image = std::tmpfile();
+  REQUIRE(image != nullptr);
+  std::vector<uint8_t> blank(SdCardEmulator::kCapacityUnit * kSectorSize, 0);
+  std::fwrite(blank.data(), 1, blank.size(), image);
+
+  SECTION("Small record appends")
+  {
+    auto trace  = SmallRecordAppendTrace();
+    auto direct = Benchmark<8>("Appends, no cache", trace, image, false);
+    auto cached = Benchmark<8>("Appends, 8 sector cache", trace, image, true);
+
+    CHECK(cached.blocks_read < direct.blocks_read);
+    CHECK(cached.bytes < direct.bytes);
+  }
+  SECTION("Sequential reads")
+  {
+    auto trace    = SequentialReadTrace();
+    auto direct   = Benchmark<8>("Sequential, no cache", trace, image, false);
+    auto prefetch = Benchmark<16>("Sequential, 8 sector read-ahead", trace,
+                                  image, true, 8);
+
+    // Without the cache every sector is a read command of its own. Read-ahead
+    // turns them into multi-block reads, each a read and a stop command.
+    CHECK(direct.commands == trace.size());
+    CHECK(direct.blocks_read == trace.size());
+    CHECK(prefetch.blocks_read >= trace.size());
+    CHECK(prefetch.commands < direct.commands / 2);
+  }
+
+  std::fclose(image);
+}
+}  // namespace sjsu
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <cstdint>
+#include <cstring>
 #include <limits>
 
 #include "L1_Peripheral/uart.hpp"
@@ -57,6 +58,42 @@ class TFMini final : public DistanceSensor
   static constexpr uint8_t kShortDistMode16 = 0x00;
   static constexpr uint8_t kMidDistMode16   = 0x03;
 
+  /// Contents of a measurement frame
+  struct Measurement_t
+  {
+    units::length::millimeter_t distance;
+    uint16_t strength;
+  };
+
+  /// Check and decode a kDeviceDataLength byte measurement frame. Handy for
+  /// frames that arrive on their own, such as from a UART that hands out
+  /// whole frames while the TFMini streams measurements.
+  ///
+  /// @returns Status::kDeviceNotFound if the frame header is wrong
+  /// @returns Status::kBusError if the checksum does not match
+  /// @returns Status::kSuccess if measurement was filled in
+  static Status ParseFrame(const uint8_t * frame, Measurement_t * measurement)
+  {
+    if ((frame[0] != kFrameHeader) || (frame[1] != kFrameHeader))
+    {
+      return sjsu::Status::kDeviceNotFound;
+    }
+    uint8_t checksum = 0;
+    for (int i = 0; i < 8; i++)
+    {
+      checksum += frame[i];
+    }
+    if (checksum != frame[8])
+    {
+      return sjsu::Status::kBusError;
+    }
+    uint32_t dist = frame[2];
+    dist |= frame[3] << 8;
+    measurement->distance = units::length::millimeter_t(dist);
+    measurement->strength = static_cast<uint16_t>(frame[4] | frame[5] << 8);
+    return sjsu::Status::kSuccess;
+  }
+
   explicit constexpr TFMini(Uart & uart) : uart_pin_(uart) {}
   /// Initialize and enable hardware. This must be called before any other
   /// method in this interface is called.
@@ -105,37 +142,26 @@ class TFMini final : public DistanceSensor
   ///
   /// @returns Status::kDeviceNotFound if device is not recognized
   /// @returns Status::kBusError if data read from device is inconsistent
+  /// @returns Status::kTimedOut if the device did not send a whole frame
   /// @returns Status::kSuccess if device is successfully read from
   Status GetDistance(units::length::millimeter_t * distance) const override
   {
-    Status success = sjsu::Status::kSuccess;
     uint8_t device_data[kDeviceDataLength];
+    Measurement_t measurement;
 
     uart_pin_.Write(kPromptMeasurementCommand, kCommandLength);
-    uart_pin_.Read(device_data, kDeviceDataLength, kTimeout);
-    if ((device_data[0] != kFrameHeader) || (device_data[1] != kFrameHeader))
+    Status success = ReadFrame(device_data);
+    if (success == sjsu::Status::kSuccess)
     {
-      success = sjsu::Status::kDeviceNotFound;
-      *distance = std::numeric_limits<units::length::millimeter_t>::max();
+      success = ParseFrame(device_data, &measurement);
+    }
+    if (success == sjsu::Status::kSuccess)
+    {
+      *distance = measurement.distance;
     }
     else
     {
-      uint8_t checksum = 0;
-      for (int i = 0; i < 8; i++)
-      {
-        checksum += device_data[i];
-      }
-      if (checksum == device_data[8])
-      {
-        uint32_t dist = device_data[2];
-        dist |= device_data[3] << 8;
-        *distance = units::length::millimeter_t(dist);
-      }
-      else
-      {
-        success   = sjsu::Status::kBusError;
-        *distance = std::numeric_limits<units::length::millimeter_t>::max();
-      }
+      *distance = std::numeric_limits<units::length::millimeter_t>::max();
     }
     return success;
   }
@@ -147,37 +173,27 @@ class TFMini final : public DistanceSensor
   ///
   /// @returns Status::kDeviceNotFound if device is not recognized
   /// @returns Status::kBusError if data read from device is inconsistent
+  /// @returns Status::kTimedOut if the device did not send a whole frame
   /// @returns Status::kSuccess if device is successfully read from
   Status GetSignalStrengthPercent(float * strength) const override
   {
-    Status success = sjsu::Status::kSuccess;
     uint8_t device_data[kDeviceDataLength];
+    Measurement_t measurement;
 
     uart_pin_.Write(kPromptMeasurementCommand, kCommandLength);
-    uart_pin_.Read(device_data, kDeviceDataLength, kTimeout);
-    if ((device_data[0] != kFrameHeader) || (device_data[1] != kFrameHeader))
+    Status success = ReadFrame(device_data);
+    if (success == sjsu::Status::kSuccess)
     {
-      success   = sjsu::Status::kDeviceNotFound;
-      *strength = -1;
+      success = ParseFrame(device_data, &measurement);
+    }
+    if (success == sjsu::Status::kSuccess)
+    {
+      uint32_t stren = measurement.strength;
+      *strength      = (stren / kStrengthUpperBound);
     }
     else
     {
-      uint8_t checksum = 0;
-      for (int i = 0; i < 8; i++)
-      {
-        checksum += device_data[i];
-      }
-      if (checksum == device_data[8])
-      {
-        uint32_t stren = device_data[4];
-        stren |= device_data[5] << 8;
-        *strength = (stren / kStrengthUpperBound);
-      }
-      else
-      {
-        success   = sjsu::Status::kBusError;
-        *strength = -1;
-      }
+      *strength = -1;
     }
     return success;
   }
@@ -225,6 +241,46 @@ class TFMini final : public DistanceSensor
  private:
   const Uart & uart_pin_;
   uint8_t min_threshold_ = 20;
+
+  /// Read a measurement frame. If a byte went missing earlier, the frame
+  /// header shows up part way into the data read, in which case the rest of
+  /// the frame is read to get back in line with the device.
+  ///
+  /// @returns the status of the UART read if it failed, such as
+  ///          Status::kTimedOut, as the frame then holds stale bytes
+  /// @returns Status::kDeviceNotFound if there is no frame header in the data
+  Status ReadFrame(uint8_t * frame) const
+  {
+    Status status = uart_pin_.Read(frame, kDeviceDataLength, kTimeout);
+    if (status != sjsu::Status::kSuccess)
+    {
+      return status;
+    }
+
+    size_t start = 0;
+    while (start < kDeviceDataLength && !IsHeaderAt(frame, start))
+    {
+      start++;
+    }
+    if (start == kDeviceDataLength)
+    {
+      return sjsu::Status::kDeviceNotFound;
+    }
+    if (start != 0)
+    {
+      size_t kept = kDeviceDataLength - start;
+      memmove(frame, &frame[start], kept);
+      status = uart_pin_.Read(&frame[kept], start, kTimeout);
+    }
+    return status;
+  }
+  /// The last byte read may be the first half of a header
+  static bool IsHeaderAt(const uint8_t * data, size_t position)
+  {
+    return data[position] == kFrameHeader &&
+           (position + 1 == kDeviceDataLength ||
+            data[position + 1] == kFrameHeader);
+  }
   bool SendCommandAndCheckEcho(const uint8_t * command) const
   {
     bool success = true;
@@ -215,6 +215,17 @@ class Apds9960
     constexpr uint16_t kAlsInterruptThreshold = (kAilt << 8) | (kAilt);
     if (FindDevice())
     {
+      // Configuration registers are only changed by this driver, so they are
+      // kept in the shadow and written in a few bursts. GCONF4 stays
+      // volatile, as the device clears its GMODE bit when a gesture ends.
+      gesture_.SetCachePolicy(gesture_.memory.enable,
+                              gesture_.memory.configuration_2,
+                              device::CachePolicy::kCached);
+      gesture_.SetCachePolicy(
+          gesture_.memory.proximity_offset_up_right_down_left_photodiodes,
+          gesture_.memory.gesture_right_offset,
+          device::CachePolicy::kCached);
+
       gesture_.memory.enable                       = kNoMode;
       gesture_.memory.adc_integration_time         = kAtime;
       gesture_.memory.wait_time_nongesture         = kWtime;
@@ -237,7 +248,8 @@ class Apds9960
       gesture_.memory.gesture_left_offset               = kGoffsetLeftRight;
       gesture_.memory.gesture_right_offset              = kGoffsetLeftRight;
       gesture_.memory.gesture_pulse_count_and_length    = kGPulse;
-      gesture_.memory.gesture_configuration_3_4         = kGestureConfig3And4;
+      gesture_.Commit();
+      gesture_.memory.gesture_configuration_3_4 = kGestureConfig3And4;
     }
     else
     {
@@ -253,23 +265,8 @@ class Apds9960
   /// @return -> true if successful; false otherwise
   virtual bool SetMode(Mode mode, bool enable)
   {
-    bool result   = true;
-    int reg_value = 0;
-    reg_value     = gesture_.memory.enable;
-
-    if (mode > 7)
-    {
-      result = false;
-    }
-    if (enable)
-    {
-      reg_value |= (1 << mode);
-    }
-    else
-    {
-      reg_value &= ~(1 << mode);
-    }
-    gesture_.memory.enable = static_cast<uint8_t>(reg_value);
+    bool result = UpdateMode(mode, enable);
+    gesture_.Commit();
     return result;
   }
   virtual void EnableGesture()
@@ -284,11 +281,14 @@ class Apds9960
         kK16UsPulseLengthAnd10PulseCount;
     gesture_.memory.configuration_2 =
         kClearProximityLedInterruptChannelAndLedBoost150;
+    // Configure before powering on
+    gesture_.Commit();
 
-    SetMode(Mode::kPOWERON, true);
-    SetMode(Mode::kWAIT, true);
-    SetMode(Mode::kPROXIMITYDETECT, true);
-    SetMode(Mode::kGESTURE, true);
+    UpdateMode(Mode::kPOWERON, true);
+    UpdateMode(Mode::kWAIT, true);
+    UpdateMode(Mode::kPROXIMITYDETECT, true);
+    UpdateMode(Mode::kGESTURE, true);
+    gesture_.Commit();
   }
   virtual bool DisableGesture()
   {
@@ -480,9 +480,36 @@ class Apds9960
   }
 
  private:
+  using GestureDevice = I2cDevice<0x39, device::Endian::kLittle, MemoryMap_t>;
+
+  /// Set or clear a bit of the ENABLE register in the shadow, to be written
+  /// by the next commit
+  bool UpdateMode(Mode mode, bool enable)
+  {
+    bool result   = true;
+    int reg_value = 0;
+    reg_value     = gesture_.memory.enable;
+
+    if (mode > 7)
+    {
+      result = false;
+    }
+    if (enable)
+    {
+      reg_value |= (1 << mode);
+    }
+    else
+    {
+      reg_value &= ~(1 << mode);
+    }
+    gesture_.memory.enable = static_cast<uint8_t>(reg_value);
+    return result;
+  }
+
   const I2c & i2c_;
-  I2cDevice<0x39, device::Endian::kLittle, MemoryMap_t> gesture_ =
-      I2cDevice<0x39, device::Endian::kLittle, MemoryMap_t>(&i2c_);
+  GestureDevice::Shadow shadow_;
+  // The APDS-9960 supports fast mode, but not fast mode plus.
+  GestureDevice gesture_ = GestureDevice(&i2c_, I2c::kFastMode, &shadow_);
 
   int8_t up_sensitivity_;
   int8_t down_sensitivity_;
@@ -1,3 +1,7 @@
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
 #include "L2_HAL/device_memory_map.hpp"
 #include "L4_Testing/testing_frameworks.hpp"
 
@@ -35,6 +39,39 @@ TestMemoryMap_t
 
 lpc40xx::I2c test_i2c(lpc40xx::I2c::Bus::kI2c0);
 
+/// A burst written to the fake device
+struct DeviceWrite_t
+{
+  intptr_t address;
+  std::vector<uint8_t> data;
+
+  bool operator==(const DeviceWrite_t & other) const
+  {
+    return address == other.address && data == other.data;
+  }
+};
+
+std::vector<DeviceWrite_t> device_writes;
+size_t device_reads = 0;
+uint8_t device_registers[16];
+
+bool WriteToDevice(intptr_t address, size_t size, uint8_t * data)
+{
+  device_writes.push_back({ address, std::vector<uint8_t>(data, data + size) });
+  memcpy(&device_registers[address], data, size);
+  return true;
+}
+
+bool FailToWriteToDevice(intptr_t, size_t, uint8_t *)
+{
+  return false;
+}
+
+void ReadFromDevice(intptr_t address, size_t size, uint8_t * data)
+{
+  device_reads++;
+  memcpy(data, &device_registers[address], size);
+}
 }  // namespace
 
 TEST_CASE("Testing Device Memory Map", "[device_memory_map]")
@@ -42,4 +79,218 @@ TEST_CASE("Testing Device Memory Map", "[device_memory_map]")
   I2cDevice<0x39, device::Endian::kLittle, TestMemoryMap_t> test(&test_i2c);
   SECTION("Initialize") {}
 }
+
+TEST_CASE("Testing Device Shadow Cache", "[device_memory_map]")
+{
+  device_writes.clear();
+  device_reads = 0;
+  memset(device_registers, 0, sizeof(device_registers));
+  device::ShadowCache<sizeof(device_registers)> shadow;
+  uint8_t data[4] = { 0 };
+
+  SECTION("Volatile registers go straight to the device")
+  {
+    data[0] = 0x11;
+
+    CHECK(shadow.Write(2, 1, data, WriteToDevice));
+    shadow.Read(2, 1, data, ReadFromDevice);
+    shadow.Read(2, 1, data, ReadFromDevice);
+
+    CHECK(device_writes == std::vector<DeviceWrite_t>{ { 2, { 0x11 } } });
+    CHECK(device_reads == 2);
+    CHECK(shadow.GetPolicy(2) == device::CachePolicy::kVolatile);
+  }
+  SECTION("Cached registers are read from the device once")
+  {
+    shadow.SetPolicy(4, 2, device::CachePolicy::kCached);
+    device_registers[4] = 0x12;
+    device_registers[5] = 0x34;
+
+    shadow.Read(4, 2, data, ReadFromDevice);
+    CHECK(data[0] == 0x12);
+    CHECK(data[1] == 0x34);
+    device_registers[4] = 0x00;
+    shadow.Read(4, 1, data, ReadFromDevice);
+
+    CHECK(data[0] == 0x12);
+    CHECK(device_reads == 1);
+  }
+  SECTION("Writes are held until committed, in one burst per run")
+  {
+    shadow.SetPolicy(0, 8, device::CachePolicy::kCached);
+    uint8_t first[]  = { 0xA0 };
+    uint8_t second[] = { 0xA1, 0xA2 };
+    uint8_t third[]  = { 0xA5 };
+
+    CHECK(shadow.Write(0, 1, first, WriteToDevice));
+    CHECK(shadow.Write(1, 2, second, WriteToDevice));
+    CHECK(shadow.Write(5, 1, third, WriteToDevice));
+    // Reads see the writes that have not been committed
+    shadow.Read(1, 1, data, ReadFromDevice);
+    CHECK(data[0] == 0xA1);
+    CHECK(device_writes.empty());
+    CHECK(device_reads == 0);
+
+    CHECK(shadow.Commit(WriteToDevice));
+
+    CHECK(device_writes == std::vector<DeviceWrite_t>{
+                               { 0, { 0xA0, 0xA1, 0xA2 } },
+                               { 5, { 0xA5 } },
+                           });
+    // Nothing is left to write
+    device_writes.clear();
+    CHECK(shadow.Commit(WriteToDevice));
+    CHECK(device_writes.empty());
+  }
+  SECTION("Commit splits runs longer than the largest burst")
+  {
+    shadow.SetPolicy(0, 3, device::CachePolicy::kCached);
+    uint8_t values[] = { 1, 2, 3 };
+    CHECK(shadow.Write(0, 3, values, WriteToDevice));
+
+    CHECK(shadow.Commit(WriteToDevice, 2));
+
+    CHECK(device_writes == std::vector<DeviceWrite_t>{
+                               { 0, { 1, 2 } },
+                               { 2, { 3 } },
+                           });
+  }
+  SECTION("Failed commits keep their bytes to write again")
+  {
+    shadow.SetPolicy(0, 1, device::CachePolicy::kCached);
+    data[0] = 0x55;
+    CHECK(shadow.Write(0, 1, data, WriteToDevice));
+
+    CHECK(!shadow.Commit(FailToWriteToDevice));
+    CHECK(shadow.Commit(WriteToDevice));
+
+    CHECK(device_writes == std::vector<DeviceWrite_t>{ { 0, { 0x55 } } });
+  }
+  SECTION("Writes that cover a volatile byte go through at once")
+  {
+    shadow.SetPolicy(3, 1, device::CachePolicy::kCached);
+    uint8_t values[] = { 0x33, 0x44 };
+
+    CHECK(shadow.Write(3, 2, values, WriteToDevice));
+    CHECK(device_writes.size() == 1);
+
+    // The cached byte is up to date on the device, and read from the shadow
+    device_writes.clear();
+    CHECK(shadow.Commit(WriteToDevice));
+    CHECK(device_writes.empty());
+    device_registers[3] = 0x00;
+    shadow.Read(3, 1, data, ReadFromDevice);
+    CHECK(data[0] == 0x33);
+    CHECK(device_reads == 0);
+  }
+  SECTION("Reads that cover a volatile byte see pending writes")
+  {
+    shadow.SetPolicy(6, 1, device::CachePolicy::kCached);
+    device_registers[6] = 0x66;
+    device_registers[7] = 0x77;
+    data[0]             = 0x60;
+    CHECK(shadow.Write(6, 1, data, WriteToDevice));
+
+    shadow.Read(6, 2, data, ReadFromDevice);
+
+    CHECK(device_reads == 1);
+    CHECK(data[0] == 0x60);
+    CHECK(data[1] == 0x77);
+  }
+  SECTION("Write only registers are never read from the device")
+  {
+    shadow.SetPolicy(8, 2, device::CachePolicy::kWriteOnly);
+    device_registers[8] = 0xFF;
+
+    shadow.Read(8, 1, data, ReadFromDevice);
+    CHECK(data[0] == 0x00);
+    data[0] = 0x88;
+    CHECK(shadow.Write(8, 1, data, WriteToDevice));
+    data[0] = 0x00;
+    shadow.Read(8, 1, data, ReadFromDevice);
+    CHECK(data[0] == 0x88);
+
+    CHECK(device_reads == 0);
+    CHECK(device_writes.empty());
+  }
+  SECTION("Invalidate forgets values and pending writes")
+  {
+    shadow.SetPolicy(0, 2, device::CachePolicy::kCached);
+    shadow.Read(0, 1, data, ReadFromDevice);
+    data[0] = 0x99;
+    CHECK(shadow.Write(1, 1, data, WriteToDevice));
+
+    shadow.Invalidate();
+    shadow.Read(0, 1, data, ReadFromDevice);
+
+    CHECK(device_reads == 2);
+    CHECK(shadow.Commit(WriteToDevice));
+    CHECK(device_writes.empty());
+    CHECK(shadow.GetPolicy(0) == device::CachePolicy::kCached);
+  }
+  SECTION("Addresses past the end of the shadow are volatile")
+  {
+    shadow.SetPolicy(15, 2, device::CachePolicy::kCached);
+
+    CHECK(shadow.GetPolicy(15) == device::CachePolicy::kVolatile);
+    CHECK(shadow.GetPolicy(16) == device::CachePolicy::kVolatile);
+  }
+}
+
+TEST_CASE("Testing I2cDevice with a shadow", "[device_memory_map]")
+{
+  using ShadowedDevice =
+      I2cDevice<0x40, device::Endian::kLittle, TestMemoryMap_t>;
+  constexpr uint8_t kDeviceValue = 0x0F;
+
+  std::vector<std::vector<uint8_t>> bus_writes;
+  size_t bus_reads = 0;
+  Mock<sjsu::I2c> mock_i2c;
+  When(Method(mock_i2c, Transaction))
+      .AlwaysDo([&](I2c::Transaction_t transaction) {
+        CHECK(transaction.address == 0x40);
+        CHECK(transaction.max_frequency == I2c::kFastMode);
+        if (transaction.in_length != 0)
+        {
+          bus_reads++;
+          memset(transaction.data_in, kDeviceValue, transaction.in_length);
+        }
+        else
+        {
+          bus_writes.emplace_back(
+              transaction.data_out,
+              transaction.data_out + transaction.out_length);
+        }
+        return Status::kSuccess;
+      });
+
+  ShadowedDevice::Shadow shadow;
+  ShadowedDevice test(&mock_i2c.get(), I2c::kFastMode, &shadow);
+  test.SetCachePolicy(test.memory.register2, test.memory.register4,
+                      device::CachePolicy::kCached);
+  const uint8_t kRegister3Address =
+      static_cast<uint8_t>(reinterpret_cast<intptr_t>(&test.memory.register3));
+
+  // Read-modify-write operations only read the register the first time
+  test.memory.register3 |= 0x30;
+  test.memory.register3 &= static_cast<uint8_t>(~0x01);
+  test.memory.register4 = 0x44;
+  uint8_t register3     = test.memory.register3;
+
+  CHECK(register3 == 0x3E);
+  CHECK(bus_reads == 1);
+  CHECK(bus_writes.empty());
+
+  CHECK(test.Commit());
+
+  CHECK(bus_writes == std::vector<std::vector<uint8_t>>{
+                          { kRegister3Address, 0x3E, 0x44 },
+                      });
+
+  // Registers without a policy are still read every time
+  uint8_t register0 = test.memory.register0;
+  register0         = test.memory.register0;
+  CHECK(register0 == kDeviceValue);
+  CHECK(bus_reads == 3);
+}
 }  // namespace sjsu
@@ -8,3 +8,4 @@ TESTS += $(LIBRARY_DIR)/L3_Application/test/task_scheduler_test.cpp
 TESTS += $(LIBRARY_DIR)/L3_Application/test/commandline_test.cpp
 TESTS += $(LIBRARY_DIR)/L3_Application/test/graphics_test.cpp
 TESTS += $(LIBRARY_DIR)/L3_Application/test/periodic_scheduler_test.cpp
+TESTS += $(LIBRARY_DIR)/L3_Application/test/telemetry_link_test.cpp
@@ -0,0 +1,47 @@
+// This file contains the SdWorkerTask class, the task that owns an SD card
+// and carries out the requests submitted to an SdRequestQueue.
+//
+// Usage:
+//      sjsu::SdRequestQueue<> sd_queue(sjtwo::SdCard());
+//      sjsu::rtos::SdWorkerTask<decltype(sd_queue)> sd_worker(sd_queue);
+//      sjsu::rtos::TaskScheduler::Instance().Start();
+//
+// Give the worker a lower priority than time critical tasks. It spends most
+// of its time waiting on the card, and a higher priority task that submits a
+// request is never held up by it.
+#pragma once
+
+#include <cstddef>
+
+#include "L2_HAL/memory/sd_request_queue.hpp"
+#include "L3_Application/task.hpp"
+#include "utility/rtos.hpp"
+
+namespace sjsu
+{
+namespace rtos
+{
+template <class RequestQueue, size_t kStackSize = 512>
+class SdWorkerTask final : public Task<kStackSize>
+{
+ public:
+  explicit SdWorkerTask(RequestQueue & queue,
+                        Priority priority = Priority::kLow)
+      : Task<kStackSize>("SD Worker", priority), queue_(queue)
+  {
+  }
+  bool Setup() override
+  {
+    return queue_.Initialize() == Status::kSuccess;
+  }
+  bool Run() override
+  {
+    queue_.Service(portMAX_DELAY);
+    return true;
+  }
+
+ private:
+  RequestQueue & queue_;
+};
+}  // namespace rtos
+}  // namespace sjsu
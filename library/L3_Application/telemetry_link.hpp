@@ -0,0 +1,347 @@
+/// TelemetryLink carries binary frames over the same byte stream as the text
+/// printed to stdout, so a task can stream raw structs off the board instead
+/// of formatting them with printf.
+///
+/// Each frame is laid out as follows, then COBS encoded (see utility/cobs.hpp)
+/// and sent with a zero byte on either side of it:
+///
+///     | channel | sequence | payload ...           | CRC16 low | CRC16 high |
+///
+///   - channel says what the payload is, see Channel.
+///   - sequence counts up by one with every frame the board sends, so the
+///     host can tell when frames went missing.
+///   - The CRC is crc::Crc16Ccitt of the channel, sequence and payload.
+///
+/// Text never contains a zero byte, so it ends up between frames. The host
+/// decoder (tools/telemetry_link.py) treats anything between two zero bytes
+/// that does not decode into a frame with a good CRC as text.
+///
+/// printf() takes no lock, so other tasks are kept from running while a frame
+/// is written, and their text cannot land inside it. The stream's writer
+/// must not sleep while the scheduler is suspended, which the stdout backends
+/// do not. Text printed from an interrupt can still split a frame, and the
+/// host drops such a frame for its bad CRC.
+///
+/// The host can also run any command of a CommandList_t by sending a request
+/// frame with the command line as its payload. Feed the bytes received from
+/// the host to Receive(), and the command runs in that task:
+///
+///     TelemetryLink link(WriteToUart0, &command_list.commands);
+///     while (true)
+///     {
+///       link.Receive(static_cast<uint8_t>(getchar()));
+///     }
+///
+/// Anything the command prints goes out as text, and its return code goes
+/// back in a response frame.
+#pragma once
+
+#include <FreeRTOS.h>
+#include <semphr.h>
+#include <task.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "L1_Peripheral/cortex/interrupt.hpp"
+#include "L3_Application/commandline.hpp"
+#include "newlib/newlib.hpp"
+#include "third_party/etl/vector.h"
+#include "utility/cobs.hpp"
+#include "utility/crc.hpp"
+#include "utility/enum.hpp"
+#include "utility/rtos.hpp"
+#include "utility/status.hpp"
+
+namespace sjsu
+{
+class TelemetryLink
+{
+ public:
+  /// Function that puts bytes on the stream, such as the stdout backend
+  using Write = newlib::Stdout;
+
+  enum class Channel : uint8_t
+  {
+    /// Text, for logs that should not get mixed up with other output
+    kLog = 0,
+    /// An id byte saying which struct follows, then the struct's bytes
+    kTelemetry = 1,
+    /// From the host: a request id byte, then a command line
+    kRequest = 2,
+    /// To the host: the request id byte, then the command's return code as a
+    /// little endian int32_t
+    kResponse = 3,
+  };
+
+  static constexpr uint8_t kDelimiter = 0x00;
+  static constexpr size_t kHeaderSize = 2;
+  static constexpr size_t kCrcSize    = 2;
+  /// Keeps a whole frame within a single COBS run, so encoding only ever
+  /// adds one byte
+  static constexpr size_t kMaxPayloadSize =
+      cobs::kMaxRun - kHeaderSize - kCrcSize;
+  static constexpr size_t kMaxFrameSize =
+      kHeaderSize + kMaxPayloadSize + kCrcSize;
+  static constexpr size_t kMaxEncodedSize =
+      cobs::MaxEncodedLength(kMaxFrameSize);
+  /// Most words a requested command line is split into
+  static constexpr size_t kMaxArguments = 8;
+  /// Return code sent back when no command has the requested name, the same
+  /// as a shell would give
+  static constexpr int32_t kCommandNotFound = 127;
+
+  /// @param write - where to send frames
+  /// @param commands - commands the host may run, usually the commands member
+  ///        of the CommandList_t given to the CommandLine
+  explicit TelemetryLink(
+      Write write, etl::ivector<CommandInterface *> * commands = nullptr)
+      : write_(write), commands_(commands)
+  {
+  }
+
+  /// Send a frame. Must not be called from an interrupt.
+  ///
+  /// @return Status::kInvalidParameters if the payload is longer than
+  ///         kMaxPayloadSize, otherwise Status::kSuccess.
+  Status Send(Channel channel, const void * payload, size_t length)
+  {
+    return SendFrame(channel, nullptr, 0, payload, length);
+  }
+
+  Status SendLog(const char * text)
+  {
+    return Send(Channel::kLog, text, strlen(text));
+  }
+
+  /// Send the bytes of a struct as they are laid out in memory. The host
+  /// needs to know the layout that goes with each id.
+  template <typename T>
+  Status SendTelemetry(uint8_t id, const T & value)
+  {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "Telemetry is sent byte for byte, so T must be trivially "
+                  "copyable.");
+    static_assert(sizeof(T) + sizeof(id) <= kMaxPayloadSize,
+                  "T is too large to fit in a single frame.");
+    return SendFrame(Channel::kTelemetry, &id, sizeof(id), &value, sizeof(T));
+  }
+
+  /// Take in a byte from the host. When it completes a request frame, the
+  /// requested command runs before this returns.
+  void Receive(uint8_t byte)
+  {
+    if (byte != kDelimiter)
+    {
+      if (received_ < sizeof(receive_buffer_))
+      {
+        receive_buffer_[received_] = byte;
+      }
+      // One past the end marks the frame as too long to be valid.
+      if (received_ <= sizeof(receive_buffer_))
+      {
+        received_++;
+      }
+      return;
+    }
+    if (received_ > sizeof(receive_buffer_))
+    {
+      dropped_++;
+    }
+    else if (received_ != 0)
+    {
+      ProcessFrame();
+    }
+    received_ = 0;
+  }
+
+  /// @return the number of times bytes between two delimiters did not make a
+  ///         valid frame, such as text typed into a terminal
+  uint32_t GetDroppedFrameCount() const
+  {
+    return dropped_;
+  }
+
+ private:
+  Status SendFrame(Channel channel,
+                   const uint8_t * prefix,
+                   size_t prefix_length,
+                   const void * payload,
+                   size_t length)
+  {
+    if (prefix_length + length > kMaxPayloadSize)
+    {
+      return Status::kInvalidParameters;
+    }
+    bool is_locked      = Lock();
+    send_frame_[0]      = util::Value(channel);
+    send_frame_[1]      = sequence_++;
+    size_t frame_length = kHeaderSize;
+    if (prefix_length != 0)
+    {
+      memcpy(&send_frame_[frame_length], prefix, prefix_length);
+      frame_length += prefix_length;
+    }
+    if (length != 0)
+    {
+      memcpy(&send_frame_[frame_length], payload, length);
+      frame_length += length;
+    }
+    uint16_t crc = crc::Crc16Ccitt::Calculate(send_frame_, frame_length);
+    send_frame_[frame_length++] = static_cast<uint8_t>(crc);
+    send_frame_[frame_length++] = static_cast<uint8_t>(crc >> 8);
+
+    // The leading delimiter ends any text printed without a newline, so it
+    // does not corrupt the frame.
+    size_t encoded_length      = 0;
+    encoded_[encoded_length++] = kDelimiter;
+    encoded_length += cobs::Encode(send_frame_, frame_length, &encoded_[1]);
+    encoded_[encoded_length++] = kDelimiter;
+    WriteUninterrupted(encoded_, encoded_length);
+    Unlock(is_locked);
+    return Status::kSuccess;
+  }
+
+  void ProcessFrame()
+  {
+    size_t length = 0;
+    Status status =
+        cobs::Decode(receive_buffer_, received_, receive_buffer_, &length);
+    if (status != Status::kSuccess || length < kHeaderSize + kCrcSize)
+    {
+      dropped_++;
+      return;
+    }
+    size_t crc_position = length - kCrcSize;
+    uint16_t crc        = static_cast<uint16_t>(
+        receive_buffer_[crc_position] | receive_buffer_[crc_position + 1] << 8);
+    if (crc != crc::Crc16Ccitt::Calculate(receive_buffer_, crc_position))
+    {
+      dropped_++;
+      return;
+    }
+    // Log, telemetry and response frames only go from the board to the host.
+    if (receive_buffer_[0] == util::Value(Channel::kRequest))
+    {
+      HandleRequest(&receive_buffer_[kHeaderSize], crc_position - kHeaderSize);
+    }
+  }
+
+  /// The payload is followed by the CRC, which has been checked already, so
+  /// the command line is terminated by writing over it.
+  void HandleRequest(uint8_t * payload, size_t length)
+  {
+    if (length == 0)
+    {
+      return;
+    }
+    uint8_t response[1 + sizeof(int32_t)] = { payload[0] };
+    char * line = reinterpret_cast<char *>(&payload[1]);
+    line[length - 1] = '\0';
+
+    int32_t result = RunCommand(line);
+    for (size_t i = 0; i < sizeof(result); i++)
+    {
+      response[1 + i] = static_cast<uint8_t>(result >> (8 * i));
+    }
+    Send(Channel::kResponse, response, sizeof(response));
+  }
+
+  /// Split the line into words at each space and run the command named by
+  /// the first word.
+  int32_t RunCommand(char * line)
+  {
+    const char * argv[kMaxArguments];
+    int argc = 0;
+    while (*line != '\0' && argc < static_cast<int>(kMaxArguments))
+    {
+      if (*line == ' ')
+      {
+        *line++ = '\0';
+        continue;
+      }
+      argv[argc++] = line;
+      while (*line != '\0' && *line != ' ')
+      {
+        line++;
+      }
+    }
+    if (argc == 0 || commands_ == nullptr)
+    {
+      return kCommandNotFound;
+    }
+    // A CommandList_t that has not been through a CommandLine starts out
+    // holding a null entry.
+    for (CommandInterface * command : *commands_)
+    {
+      if (command != nullptr && strcmp(command->GetName(), argv[0]) == 0)
+      {
+        return command->Program(argc, argv);
+      }
+    }
+    return kCommandNotFound;
+  }
+
+  /// Write with the scheduler suspended, so that no other task prints while
+  /// the frame goes out
+  void WriteUninterrupted(const uint8_t * data, size_t length)
+  {
+    bool suspend = (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING);
+    if (suspend)
+    {
+      vTaskSuspendAll();
+    }
+    write_(reinterpret_cast<const char *>(data), length);
+    if (suspend)
+    {
+      xTaskResumeAll();
+    }
+  }
+
+  /// Before the scheduler starts there is only one thread of execution, so
+  /// there is nothing to lock against.
+  ///
+  /// @return true if the mutex was taken, to be passed on to Unlock()
+  bool Lock()
+  {
+    if (xTaskGetSchedulerState() != taskSCHEDULER_RUNNING)
+    {
+      return false;
+    }
+    xSemaphoreTake(Mutex(), portMAX_DELAY);
+    return true;
+  }
+  void Unlock(bool is_locked)
+  {
+    if (is_locked)
+    {
+      xSemaphoreGive(mutex_);
+    }
+  }
+
+  /// Created by the first frame sent once the scheduler is running, as
+  /// creating it earlier would mask interrupts until the scheduler starts.
+  SemaphoreHandle_t Mutex()
+  {
+    sjsu::cortex::InterruptLock lock;
+    if (mutex_ == nullptr)
+    {
+      mutex_ = xSemaphoreCreateMutexStatic(&mutex_buffer_);
+    }
+    return mutex_;
+  }
+
+  Write write_;
+  etl::ivector<CommandInterface *> * commands_;
+  StaticSemaphore_t mutex_buffer_ = {};
+  SemaphoreHandle_t mutex_        = nullptr;
+  uint8_t sequence_               = 0;
+  uint8_t send_frame_[kMaxFrameSize];
+  uint8_t encoded_[kMaxEncodedSize + 2];
+  uint8_t receive_buffer_[kMaxEncodedSize];
+  size_t received_  = 0;
+  uint32_t dropped_ = 0;
+};
+}  // namespace sjsu
@@ -0,0 +1,257 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "L3_Application/telemetry_link.hpp"
+#include "L4_Testing/testing_frameworks.hpp"
+
+namespace sjsu
+{
+namespace
+{
+/// Every byte the link has written
+std::vector<uint8_t> written;
+
+int Record(const char * data, size_t length)
+{
+  written.insert(written.end(), data, data + length);
+  return static_cast<int>(length);
+}
+
+/// Split what was written at each delimiter and decode each frame
+std::vector<std::vector<uint8_t>> WrittenFrames()
+{
+  std::vector<std::vector<uint8_t>> frames;
+  std::vector<uint8_t> segment;
+  for (uint8_t byte : written)
+  {
+    if (byte != TelemetryLink::kDelimiter)
+    {
+      segment.push_back(byte);
+      continue;
+    }
+    if (!segment.empty())
+    {
+      std::vector<uint8_t> frame(segment.size());
+      size_t length = 0;
+      CHECK(cobs::Decode(segment.data(), segment.size(), frame.data(),
+                         &length) == Status::kSuccess);
+      frame.resize(length);
+      frames.push_back(frame);
+      segment.clear();
+    }
+  }
+  CHECK(segment.empty());
+  return frames;
+}
+
+/// Add the CRC to a frame and encode it as the host would send it
+std::vector<uint8_t> HostFrame(std::vector<uint8_t> frame)
+{
+  uint16_t crc = crc::Crc16Ccitt::Calculate(frame.data(), frame.size());
+  frame.push_back(static_cast<uint8_t>(crc));
+  frame.push_back(static_cast<uint8_t>(crc >> 8));
+
+  std::vector<uint8_t> encoded(cobs::MaxEncodedLength(frame.size()) + 2);
+  encoded[0]    = TelemetryLink::kDelimiter;
+  size_t length = 1 + cobs::Encode(frame.data(), frame.size(), &encoded[1]);
+  encoded[length++] = TelemetryLink::kDelimiter;
+  encoded.resize(length);
+  return encoded;
+}
+
+std::vector<uint8_t> RequestFrame(uint8_t id, const std::string & line)
+{
+  std::vector<uint8_t> frame = {
+    util::Value(TelemetryLink::Channel::kRequest), 0, id
+  };
+  frame.insert(frame.end(), line.begin(), line.end());
+  return HostFrame(frame);
+}
+
+void Feed(TelemetryLink & link, const std::vector<uint8_t> & bytes)
+{
+  for (uint8_t byte : bytes)
+  {
+    link.Receive(byte);
+  }
+}
+
+/// Arguments the test command was last run with
+std::vector<std::string> arguments;
+
+int TestCommand(int argc, const char * const argv[])
+{
+  arguments.assign(argv, argv + argc);
+  return -2;
+}
+
+/// Whether the scheduler was suspended for the last write
+bool written_while_suspended = false;
+
+int RecordSuspended(const char *, size_t length)
+{
+  written_while_suspended =
+      vTaskSuspendAll_fake.call_count > xTaskResumeAll_fake.call_count;
+  return static_cast<int>(length);
+}
+
+struct [[gnu::packed]] Sample_t
+{
+  uint16_t counts;
+  float angle;
+};
+}  // namespace
+
+TEST_CASE("Testing TelemetryLink", "[telemetry-link]")
+{
+  written.clear();
+  arguments.clear();
+  CommandList_t<4> command_list;
+  Command test_command("test", "records its arguments", TestCommand);
+  command_list.commands.push_back(&test_command);
+
+  TelemetryLink link(Record, &command_list.commands);
+
+  SECTION("Send telemetry")
+  {
+    Sample_t sample = { .counts = 0x1234, .angle = 1.5f };
+
+    CHECK(link.SendTelemetry(0x42, sample) == Status::kSuccess);
+
+    // Frames are wrapped in delimiters on both sides
+    REQUIRE(written.size() > 2);
+    CHECK(written.front() == TelemetryLink::kDelimiter);
+    CHECK(written.back() == TelemetryLink::kDelimiter);
+
+    auto frames = WrittenFrames();
+    REQUIRE(frames.size() == 1);
+    auto & frame = frames[0];
+    REQUIRE(frame.size() == 2 + 1 + sizeof(Sample_t) + 2);
+    CHECK(frame[0] == util::Value(TelemetryLink::Channel::kTelemetry));
+    CHECK(frame[1] == 0);
+    CHECK(frame[2] == 0x42);
+    Sample_t sent;
+    memcpy(&sent, &frame[3], sizeof(sent));
+    CHECK(sent.counts == sample.counts);
+    CHECK(sent.angle == Approx(sample.angle));
+    uint16_t crc = crc::Crc16Ccitt::Calculate(frame.data(), frame.size() - 2);
+    CHECK(frame[frame.size() - 2] == static_cast<uint8_t>(crc));
+    CHECK(frame[frame.size() - 1] == static_cast<uint8_t>(crc >> 8));
+  }
+  SECTION("Sequence counts up with every frame")
+  {
+    CHECK(link.SendLog("first") == Status::kSuccess);
+    CHECK(link.SendLog("second") == Status::kSuccess);
+
+    auto frames = WrittenFrames();
+    REQUIRE(frames.size() == 2);
+    CHECK(frames[0][0] == util::Value(TelemetryLink::Channel::kLog));
+    CHECK(frames[0][1] == 0);
+    CHECK(frames[1][1] == 1);
+    CHECK(std::string(frames[1].begin() + 2, frames[1].end() - 2) ==
+          "second");
+  }
+  SECTION("The mutex waits for the scheduler")
+  {
+    RESET_FAKE(xQueueCreateMutexStatic);
+    RESET_FAKE(xQueueSemaphoreTake);
+    RESET_FAKE(xQueueGenericSend);
+    xQueueCreateMutexStatic_fake.custom_fake =
+        [](uint8_t, StaticQueue_t * buffer) {
+          return reinterpret_cast<QueueHandle_t>(buffer);
+        };
+    xTaskGetSchedulerState_fake.return_val = taskSCHEDULER_NOT_STARTED;
+
+    CHECK(link.SendLog("before") == Status::kSuccess);
+    CHECK(xQueueCreateMutexStatic_fake.call_count == 0);
+    CHECK(xQueueSemaphoreTake_fake.call_count == 0);
+
+    xTaskGetSchedulerState_fake.return_val = taskSCHEDULER_RUNNING;
+    CHECK(link.SendLog("first") == Status::kSuccess);
+    CHECK(link.SendLog("second") == Status::kSuccess);
+
+    CHECK(xQueueCreateMutexStatic_fake.call_count == 1);
+    CHECK(xQueueSemaphoreTake_fake.call_count == 2);
+    CHECK(xQueueGenericSend_fake.call_count == 2);
+    CHECK(WrittenFrames().size() == 3);
+    RESET_FAKE(xQueueCreateMutexStatic);
+    RESET_FAKE(xTaskGetSchedulerState);
+  }
+  SECTION("Other tasks cannot print while a frame is written")
+  {
+    RESET_FAKE(vTaskSuspendAll);
+    RESET_FAKE(xTaskResumeAll);
+    xTaskGetSchedulerState_fake.return_val = taskSCHEDULER_NOT_STARTED;
+    TelemetryLink suspending_link(RecordSuspended);
+
+    CHECK(suspending_link.SendLog("before") == Status::kSuccess);
+    CHECK(!written_while_suspended);
+    CHECK(vTaskSuspendAll_fake.call_count == 0);
+
+    xTaskGetSchedulerState_fake.return_val = taskSCHEDULER_RUNNING;
+    CHECK(suspending_link.SendLog("after") == Status::kSuccess);
+    CHECK(written_while_suspended);
+    CHECK(vTaskSuspendAll_fake.call_count == 1);
+    CHECK(xTaskResumeAll_fake.call_count == 1);
+    RESET_FAKE(xTaskGetSchedulerState);
+  }
+  SECTION("Payloads that do not fit in a frame")
+  {
+    uint8_t payload[TelemetryLink::kMaxPayloadSize + 1] = {};
+
+    CHECK(link.Send(TelemetryLink::Channel::kLog, payload,
+                    TelemetryLink::kMaxPayloadSize) == Status::kSuccess);
+    // The largest frame is a single COBS run plus the two delimiters
+    CHECK(written.size() == TelemetryLink::kMaxFrameSize + 3);
+
+    written.clear();
+    CHECK(link.Send(TelemetryLink::Channel::kLog, payload, sizeof(payload)) ==
+          Status::kInvalidParameters);
+    CHECK(written.empty());
+  }
+  SECTION("Run a requested command")
+  {
+    Feed(link, RequestFrame(7, "test  one two"));
+
+    CHECK(arguments == std::vector<std::string>{ "test", "one", "two" });
+    auto frames = WrittenFrames();
+    REQUIRE(frames.size() == 1);
+    CHECK(frames[0] ==
+          std::vector<uint8_t>{ util::Value(TelemetryLink::Channel::kResponse),
+                                0, 7, 0xFE, 0xFF, 0xFF, 0xFF,
+                                frames[0][7], frames[0][8] });
+    CHECK(link.GetDroppedFrameCount() == 0);
+  }
+  SECTION("Request a command that does not exist")
+  {
+    Feed(link, RequestFrame(9, "missing"));
+
+    CHECK(arguments.empty());
+    auto frames = WrittenFrames();
+    REQUIRE(frames.size() == 1);
+    CHECK(frames[0][2] == 9);
+    CHECK(frames[0][3] == TelemetryLink::kCommandNotFound);
+  }
+  SECTION("Drop text and corrupted frames")
+  {
+    std::vector<uint8_t> corrupted = RequestFrame(1, "test");
+    corrupted[3] ^= 0x01;
+    std::vector<uint8_t> text = { 'l', 's', '\n', 0 };
+    std::vector<uint8_t> too_long(TelemetryLink::kMaxEncodedSize + 1, 'x');
+    too_long.push_back(0);
+
+    Feed(link, corrupted);
+    Feed(link, text);
+    Feed(link, too_long);
+
+    CHECK(arguments.empty());
+    CHECK(written.empty());
+    CHECK(link.GetDroppedFrameCount() == 3);
+
+    // The link is back in step for the next frame
+    Feed(link, RequestFrame(2, "test"));
+    CHECK(arguments == std::vector<std::string>{ "test" });
+  }
+}
+}  // namespace sjsu
@@ -4,6 +4,7 @@ SOURCES +=
 
 TESTS += $(LIBRARY_DIR)/L4_Testing/freertos_mocks.cpp
 TESTS += $(LIBRARY_DIR)/L4_Testing/main_test.cpp
+TESTS += $(LIBRARY_DIR)/L4_Testing/host_disk.cpp
 
 USER_TESTS += $(LIBRARY_DIR)/L4_Testing/freertos_mocks.cpp
 USER_TESTS += $(LIBRARY_DIR)/L4_Testing/main_test.cpp
@@ -93,10 +93,7 @@ class FactoryTest
     sjsu::Delay(1ms);
     // Read Manufacturer ID
     spi2.Transfer(0x9F);
-    array[0] = static_cast<uint8_t>(spi2.Transfer(0x00));
-    array[1] = static_cast<uint8_t>(spi2.Transfer(0x00));
-    array[2] = static_cast<uint8_t>(spi2.Transfer(0x00));
-    array[3] = static_cast<uint8_t>(spi2.Transfer(0x00));
+    spi2.Read(array, 4, 0x00);
     LOG_INFO("Returned 0x%02X 0x%02X 0x%02X 0x%02X", array[0], array[1],
              array[2], array[3]);
     cs.SetHigh();
@@ -0,0 +1,117 @@
+/// FakeSdCard is an SdInterface backed by host memory, for testing code that
+/// sits on top of an SD card driver. Unlike SdCardEmulator, it does not speak
+/// the SPI protocol. Each ReadBlock(), WriteBlock() and DeleteBlock() call is
+/// recorded as one command, which lets a test check which commands, and how
+/// many, an access pattern costs.
+///
+/// Usage:
+///
+///     FakeSdCard card(64);
+///     SectorCache<8> cache(card);
+///     cache.Read(10, buffer, 1);
+///     CHECK(card.Count('R') == 1);
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "L2_HAL/memory/sd.hpp"
+
+namespace sjsu
+{
+class FakeSdCard final : public SdInterface
+{
+ public:
+  static constexpr size_t kBlockSize = 512;
+  /// Value of every byte of an erased block
+  static constexpr uint8_t kErasedByte = 0xFF;
+
+  /// A read (R), write (W) or delete (D) of count blocks starting at block
+  struct Command_t
+  {
+    char operation;
+    uint32_t block;
+    uint32_t count;
+  };
+
+  /// @param block_count - size of the card. Every block starts out zeroed.
+  explicit FakeSdCard(uint32_t block_count)
+      : memory(block_count * kBlockSize, 0x00)
+  {
+  }
+
+  uint8_t ReadBlock(uint32_t address, uint8_t * array, uint32_t blocks) override
+  {
+    commands.push_back({ 'R', address, blocks });
+    if (r1 == 0x00)
+    {
+      memcpy(array, &memory[address * kBlockSize], blocks * kBlockSize);
+    }
+    return r1;
+  }
+  uint8_t WriteBlock(uint32_t address,
+                     const uint8_t * array,
+                     uint32_t blocks) override
+  {
+    commands.push_back({ 'W', address, blocks });
+    if (r1 == 0x00)
+    {
+      memcpy(&memory[address * kBlockSize], array, blocks * kBlockSize);
+    }
+    return r1;
+  }
+  uint8_t DeleteBlock(uint32_t start, uint32_t end) override
+  {
+    commands.push_back({ 'D', start, end - start + 1 });
+    if (r1 == 0x00)
+    {
+      memset(&memory[start * kBlockSize], kErasedByte,
+             (end - start + 1) * kBlockSize);
+    }
+    return r1;
+  }
+  uint32_t SendCmd(Command, uint32_t, uint8_t[], uint32_t, KeepAlive) override
+  {
+    return 0;
+  }
+  void Initialize() override {}
+  bool Mount(CardInfo_t *) override
+  {
+    return true;
+  }
+  void WaitWhileBusy() override {}
+  uint8_t Crc7Add(uint8_t, uint8_t) override
+  {
+    return 0;
+  }
+  uint8_t GetCrc7(uint8_t[], uint8_t) override
+  {
+    return 0;
+  }
+  uint16_t GetCrc16(uint8_t[], uint16_t) override
+  {
+    return 0;
+  }
+
+  /// @returns the number of recorded commands of the given operation
+  size_t Count(char operation) const
+  {
+    size_t count = 0;
+    for (const auto & command : commands)
+    {
+      count += (command.operation == operation);
+    }
+    return count;
+  }
+
+  /// Contents of the card, kBlockSize bytes per block
+  std::vector<uint8_t> memory;
+  /// Every command received, in order
+  std::vector<Command_t> commands;
+  /// R1 response returned by every command. Any value other than 0x00 fails
+  /// the command, leaving memory untouched.
+  uint8_t r1 = 0x00;
+};
+}  // namespace sjsu
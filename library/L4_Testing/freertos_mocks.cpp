@@ -6,10 +6,18 @@ DEFINE_FAKE_VOID_FUNC(vTaskSuspend, TaskHandle_t);
 DEFINE_FAKE_VOID_FUNC(vTaskResume, TaskHandle_t);
 DEFINE_FAKE_VOID_FUNC(vTaskDelete, TaskHandle_t);
 DEFINE_FAKE_VOID_FUNC(vTaskDelayUntil, TickType_t *, TickType_t);
+DEFINE_FAKE_VOID_FUNC(vTaskSuspendAll);
+DEFINE_FAKE_VALUE_FUNC(BaseType_t, xTaskResumeAll);
 DEFINE_FAKE_VOID_FUNC(vApplicationGetIdleTaskMemory, StaticTask_t **,
                       StackType_t **, uint32_t *);
 
 DEFINE_FAKE_VALUE_FUNC(TickType_t, xTaskGetTickCount);
+DEFINE_FAKE_VALUE_FUNC(BaseType_t, xTaskGetSchedulerState);
+DEFINE_FAKE_VALUE_FUNC(TaskHandle_t, xTaskGetCurrentTaskHandle);
+DEFINE_FAKE_VALUE_FUNC(uint32_t, ulTaskNotifyTake, BaseType_t, TickType_t);
+DEFINE_FAKE_VOID_FUNC(vTaskNotifyGiveFromISR, TaskHandle_t, BaseType_t *);
+DEFINE_FAKE_VALUE_FUNC(BaseType_t, xTaskGenericNotify, TaskHandle_t, uint32_t,
+                       eNotifyAction, uint32_t *);
 DEFINE_FAKE_VALUE_FUNC(TaskHandle_t, xTaskCreateStatic, TaskFunction_t,
                        const char *, uint32_t, void *, UBaseType_t,
                        StackType_t *, StaticTask_t *);
@@ -24,8 +32,16 @@ DEFINE_FAKE_VALUE_FUNC(QueueHandle_t, xQueueGenericCreateStatic,
                        StaticQueue_t *, const uint8_t);
 DEFINE_FAKE_VALUE_FUNC(BaseType_t, xQueueGenericSend, QueueHandle_t,
                        const void *, TickType_t, BaseType_t);
+DEFINE_FAKE_VALUE_FUNC(BaseType_t, xQueueReceive, QueueHandle_t, void *,
+                       TickType_t);
+DEFINE_FAKE_VALUE_FUNC(BaseType_t, xQueueGiveFromISR, QueueHandle_t,
+                       BaseType_t *);
 DEFINE_FAKE_VALUE_FUNC(BaseType_t, xQueueSemaphoreTake, QueueHandle_t,
                        TickType_t);
+DEFINE_FAKE_VALUE_FUNC(QueueHandle_t, xQueueCreateMutexStatic, const uint8_t,
+                       StaticQueue_t *);
+DEFINE_FAKE_VALUE_FUNC(void *, xQueueGetMutexHolder, QueueHandle_t);
+DEFINE_FAKE_VOID_FUNC(vQueueDelete, QueueHandle_t);
 
 DEFINE_FAKE_VALUE_FUNC(TimerHandle_t, xTimerCreateStatic, const char *,
                        TickType_t, UBaseType_t, void *, TimerCallbackFunction_t,
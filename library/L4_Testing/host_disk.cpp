@@ -0,0 +1,64 @@
+#include "L4_Testing/host_disk.hpp"
+
+#include <diskio.h>
+#include <ff.h>
+
+using sjsu::HostDisk;
+
+// NOLINTNEXTLINE
+extern "C" DSTATUS disk_status([[maybe_unused]] BYTE drive_number)
+{
+  if (HostDisk::active == nullptr)
+  {
+    return STA_NOINIT;
+  }
+  return HostDisk::active->Status();
+}
+
+// NOLINTNEXTLINE
+extern "C" DSTATUS disk_initialize([[maybe_unused]] BYTE drive_number)
+{
+  if (HostDisk::active == nullptr)
+  {
+    return STA_NOINIT;
+  }
+  return HostDisk::active->Initialize();
+}
+
+// NOLINTNEXTLINE
+extern "C" DRESULT disk_read([[maybe_unused]] BYTE drive_number,
+                             BYTE * buffer,
+                             DWORD sector,
+                             UINT count)
+{
+  if (HostDisk::active == nullptr)
+  {
+    return RES_NOTRDY;
+  }
+  return HostDisk::active->Read(buffer, sector, count);
+}
+
+// NOLINTNEXTLINE
+extern "C" DRESULT disk_write([[maybe_unused]] BYTE drive_number,
+                              const BYTE * buffer,
+                              DWORD sector,
+                              UINT count)
+{
+  if (HostDisk::active == nullptr)
+  {
+    return RES_NOTRDY;
+  }
+  return HostDisk::active->Write(buffer, sector, count);
+}
+
+// NOLINTNEXTLINE
+extern "C" DRESULT disk_ioctl([[maybe_unused]] BYTE drive_number,
+                              BYTE command,
+                              void * buffer)
+{
+  if (HostDisk::active == nullptr)
+  {
+    return RES_NOTRDY;
+  }
+  return HostDisk::active->Ioctl(command, buffer);
+}
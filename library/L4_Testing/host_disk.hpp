@@ -0,0 +1,39 @@
+/// HostDisk is the drive that FatFs mounts in host tests. The disk_*
+/// functions, defined in host_disk.cpp, go to the HostDisk that was
+/// constructed last. See RamDisk for a disk held in memory.
+#pragma once
+
+#include <diskio.h>
+#include <ff.h>
+
+namespace sjsu
+{
+class HostDisk
+{
+ public:
+  /// The HostDisk that the disk_* functions use
+  inline static HostDisk * active = nullptr;
+
+  HostDisk()
+  {
+    active = this;
+  }
+
+  virtual ~HostDisk()
+  {
+    if (active == this)
+    {
+      active = nullptr;
+    }
+  }
+
+  HostDisk(const HostDisk &) = delete;
+  HostDisk & operator=(const HostDisk &) = delete;
+
+  virtual DSTATUS Status() = 0;
+  virtual DSTATUS Initialize() = 0;
+  virtual DRESULT Read(BYTE * buffer, DWORD sector, UINT count) = 0;
+  virtual DRESULT Write(const BYTE * buffer, DWORD sector, UINT count) = 0;
+  virtual DRESULT Ioctl(BYTE command, void * buffer) = 0;
+};
+}  // namespace sjsu
@@ -0,0 +1,119 @@
+/// RamDisk is a disk held in host memory that FatFs can mount, so that file
+/// system code can be tested and benchmarked on the host. Like every
+/// HostDisk, the RamDisk constructed last is the one FatFs accesses.
+///
+/// Usage:
+///
+///     RamDisk disk(8192);
+///     f_mkfs("", FM_ANY, 0, work, sizeof(work));
+///     f_mount(&fat_fs, "", 1);
+#pragma once
+
+#include <diskio.h>
+#include <ff.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "L4_Testing/host_disk.hpp"
+
+namespace sjsu
+{
+class RamDisk final : public HostDisk
+{
+ public:
+  static constexpr size_t kSectorSize = FF_MAX_SS;
+
+  /// Counters of the disk_* calls made by FatFs. A read or write is one
+  /// call, which may cover any number of sectors.
+  struct Statistics_t
+  {
+    uint32_t reads           = 0;
+    uint32_t writes          = 0;
+    uint32_t sectors_read    = 0;
+    uint32_t sectors_written = 0;
+    uint32_t syncs           = 0;
+  };
+
+  explicit RamDisk(uint32_t sector_count)
+      : memory_(sector_count * kSectorSize, 0)
+  {
+  }
+
+  DSTATUS Status() override
+  {
+    return 0;
+  }
+
+  DSTATUS Initialize() override
+  {
+    return 0;
+  }
+
+  DRESULT Read(BYTE * buffer, DWORD sector, UINT count) override
+  {
+    if (!Contains(sector, count))
+    {
+      return RES_PARERR;
+    }
+    statistics_.reads++;
+    statistics_.sectors_read += count;
+    memcpy(buffer, &memory_[sector * kSectorSize], count * kSectorSize);
+    return RES_OK;
+  }
+
+  DRESULT Write(const BYTE * buffer, DWORD sector, UINT count) override
+  {
+    if (!Contains(sector, count))
+    {
+      return RES_PARERR;
+    }
+    statistics_.writes++;
+    statistics_.sectors_written += count;
+    memcpy(&memory_[sector * kSectorSize], buffer, count * kSectorSize);
+    return RES_OK;
+  }
+
+  DRESULT Ioctl(BYTE command, void * buffer) override
+  {
+    switch (command)
+    {
+      case CTRL_SYNC: statistics_.syncs++; return RES_OK;
+      case GET_SECTOR_COUNT:
+        *static_cast<DWORD *>(buffer) = GetSectorCount();
+        return RES_OK;
+      case GET_SECTOR_SIZE:
+        *static_cast<WORD *>(buffer) = kSectorSize;
+        return RES_OK;
+      case GET_BLOCK_SIZE: *static_cast<DWORD *>(buffer) = 1; return RES_OK;
+      case CTRL_TRIM: return RES_OK;
+      default: return RES_PARERR;
+    }
+  }
+
+  uint32_t GetSectorCount() const
+  {
+    return static_cast<uint32_t>(memory_.size() / kSectorSize);
+  }
+
+  const Statistics_t & GetStatistics() const
+  {
+    return statistics_;
+  }
+
+  void ResetStatistics()
+  {
+    statistics_ = {};
+  }
+
+ private:
+  bool Contains(DWORD sector, UINT count) const
+  {
+    return sector + count <= GetSectorCount();
+  }
+
+  std::vector<uint8_t> memory_;
+  Statistics_t statistics_;
+};
+}  // namespace sjsu
@@ -0,0 +1,743 @@
+/// SdCardEmulator is an SDHC or SDSC card in SPI mode that runs on the host, behind
+/// the sjsu::Spi interface, and keeps its blocks in a disk image file. It
+/// lets sjsu::Sd, and anything built on it, run against a card that follows
+/// the protocol byte for byte, so host tests and benchmarks can check how
+/// many commands and bus bytes an access pattern costs.
+///
+/// The card answers CMD0, 1, 6, 8, 9, 10, 12, 13, 16, 17, 18, 24, 25, 32, 33,
+/// 38, 55, 58 and ACMD41 with the response formats, data tokens and CRCs of
+/// the SD physical layer specification:
+///
+///   - Command frames with a bad CRC-7 are answered with a CRC error.
+///   - Data blocks are sent with, and written blocks must carry, a valid
+///     CRC-16.
+///   - Reads start read_access_bytes after the response, writes and erases
+///     keep the card busy for write_busy_bytes and erase_busy_bytes. Bytes
+///     clocked while the card is busy are ignored, just as a real card does.
+///   - Nothing is sent or received while the chip select is high.
+///   - A standard capacity card is addressed in bytes, and rejects addresses
+///     that are not on a block boundary.
+///
+/// Time is counted in bytes clocked over the bus, see Statistics_t. Dividing
+/// by the bus rate gives the time the same traffic would take on hardware.
+///
+/// Usage:
+///
+///     SdCardEmulator card("card.img");
+///     Sd sd(card, card.GetChipSelect());
+///     sd.Initialize();
+///     sd.Mount(&card_info);
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <iterator>
+
+#include "L1_Peripheral/gpio.hpp"
+#include "L1_Peripheral/pin.hpp"
+#include "L1_Peripheral/spi.hpp"
+#include "utility/crc.hpp"
+#include "utility/log.hpp"
+#include "utility/status.hpp"
+#include "utility/units.hpp"
+
+namespace sjsu
+{
+class SdCardEmulator final : public Spi
+{
+ public:
+  using Spi::Transfer;
+
+  static constexpr size_t kBlockSize = 512;
+  /// SDHC capacity is counted in units of 512 KiB
+  static constexpr uint32_t kCapacityUnit = 1024;
+  /// Value of every byte of an erased block
+  static constexpr uint8_t kErasedByte = 0xFF;
+
+  enum class Capacity : uint8_t
+  {
+    /// SDSC: byte addressed, CSD version 1.0 and the OCR's CCS bit clear
+    kStandard = 0,
+    /// SDHC: block addressed, CSD version 2.0 and the OCR's CCS bit set
+    kHigh,
+  };
+
+  /// Card latencies, in bytes clocked over the bus
+  struct Timing_t
+  {
+    /// 0xFF bytes sent between a read command's response, or the previous
+    /// block of a multi-block read, and the data token. Must be at least 1.
+    uint32_t read_access_bytes = 2;
+    /// Busy bytes after each block written
+    uint32_t write_busy_bytes = 32;
+    /// Busy bytes after an erase
+    uint32_t erase_busy_bytes = 256;
+    /// Number of CMD1 or ACMD41 polls answered as still initializing
+    uint32_t initialization_polls = 2;
+  };
+
+  /// Counters of the traffic that has reached the card
+  struct Statistics_t
+  {
+    /// Every byte clocked while the card was selected
+    uint64_t bytes = 0;
+    /// Bytes clocked while the card was busy
+    uint64_t busy_bytes = 0;
+    uint32_t commands       = 0;
+    uint32_t blocks_read    = 0;
+    uint32_t blocks_written = 0;
+    uint32_t blocks_erased  = 0;
+  };
+
+  /// Chip select line of the emulated card, to be given to sjsu::Sd
+  class ChipSelect final : public Gpio
+  {
+   public:
+    explicit constexpr ChipSelect(const SdCardEmulator & card) : card_(card)
+    {
+    }
+    void SetDirection(Direction) const override {}
+    void Set(State output) const override
+    {
+      card_.selected_ = (output == State::kLow);
+    }
+    void Toggle() const override
+    {
+      card_.selected_ = !card_.selected_;
+    }
+    bool Read() const override
+    {
+      return !card_.selected_;
+    }
+    const sjsu::Pin & GetPin() const override
+    {
+      return pin_;
+    }
+    void AttachInterrupt(IsrPointer, Edge) const override {}
+    void DetachInterrupt() const override {}
+
+   private:
+    class UnusedPin final : public sjsu::Pin
+    {
+     public:
+      constexpr UnusedPin() : sjsu::Pin(0, 0) {}
+      void SetPinFunction(uint8_t) const override {}
+      void SetPull(Resistor) const override {}
+      void SetAsOpenDrain(bool) const override {}
+      void SetAsAnalogMode(bool) const override {}
+    };
+
+    const SdCardEmulator & card_;
+    UnusedPin pin_;
+  };
+
+  /// @param image_path - disk image holding the card's blocks. It is opened
+  ///        for reading and writing, and must hold at least 512 KiB.
+  /// @param timing - latencies of the card
+  SdCardEmulator(const char * image_path, Timing_t timing)
+      : SdCardEmulator(std::fopen(image_path, "r+b"), timing)
+  {
+    owns_image_ = true;
+  }
+
+  explicit SdCardEmulator(const char * image_path)
+      : SdCardEmulator(image_path, Timing_t{})
+  {
+  }
+
+  /// @param image - open disk image, such as one from std::tmpfile(). It is
+  ///        not closed by the emulator.
+  explicit SdCardEmulator(std::FILE * image)
+      : SdCardEmulator(image, Timing_t{})
+  {
+  }
+
+  SdCardEmulator(std::FILE * image, Timing_t timing)
+      : image_(image), timing_(timing), chip_select_(*this)
+  {
+    if (image_ != nullptr && std::fseek(image_, 0, SEEK_END) == 0)
+    {
+      long size = std::ftell(image_);  // NOLINT
+      if (size > 0)
+      {
+        block_count_ = static_cast<uint32_t>(size / kBlockSize);
+        // Only whole capacity units can be described by the CSD
+        block_count_ -= block_count_ % kCapacityUnit;
+      }
+    }
+    BuildRegisters();
+  }
+
+  ~SdCardEmulator()
+  {
+    if (owns_image_ && image_ != nullptr)
+    {
+      std::fclose(image_);
+    }
+  }
+
+  SdCardEmulator(const SdCardEmulator &) = delete;
+  SdCardEmulator & operator=(const SdCardEmulator &) = delete;
+
+  /// @return Status::kDeviceNotFound if the image could not be opened or is
+  ///         smaller than 512 KiB, otherwise Status::kSuccess.
+  Status Initialize() const override
+  {
+    if (image_ == nullptr || block_count_ == 0)
+    {
+      LOG_ERROR("SD card image is missing or smaller than 512 KiB");
+      return Status::kDeviceNotFound;
+    }
+    return Status::kSuccess;
+  }
+
+  uint16_t Transfer(uint16_t data) const override
+  {
+    if (!selected_)
+    {
+      // The card goes on with whatever it is doing, but leaves the bus alone
+      if (busy_ > 0)
+      {
+        busy_--;
+      }
+      return 0xFF;
+    }
+
+    statistics_.bytes++;
+    if (output_.empty() && busy_ > 0)
+    {
+      busy_--;
+      statistics_.busy_bytes++;
+      return 0x00;
+    }
+    if (output_.empty() && transfer_ == TransferState::kReadStream)
+    {
+      QueueReadBlock(next_block_++);
+    }
+
+    uint8_t response = 0xFF;
+    if (!output_.empty())
+    {
+      response = output_.front();
+      output_.pop_front();
+    }
+    Receive(static_cast<uint8_t>(data));
+    return response;
+  }
+
+  void Transfer(const uint8_t * transmit,
+                uint8_t * receive,
+                size_t length,
+                uint8_t fill_byte) const override
+  {
+    for (size_t i = 0; i < length; i++)
+    {
+      uint8_t byte = static_cast<uint8_t>(
+          Transfer((transmit != nullptr) ? transmit[i] : fill_byte));
+      if (receive != nullptr)
+      {
+        receive[i] = byte;
+      }
+    }
+  }
+
+  void SetDataSize(DataSize) const override {}
+
+  void SetClock(units::frequency::hertz_t frequency,
+                bool = false,
+                bool = false) const override
+  {
+    clock_ = frequency;
+  }
+
+  units::frequency::hertz_t GetClock() const override
+  {
+    return clock_;
+  }
+
+  /// Sets the capacity class the card reports, and how it is addressed.
+  /// Cards are SDHC unless this is called before they are mounted.
+  void SetCapacity(Capacity capacity)
+  {
+    capacity_ = capacity;
+    BuildRegisters();
+  }
+
+  const ChipSelect & GetChipSelect() const
+  {
+    return chip_select_;
+  }
+
+  uint32_t GetBlockCount() const
+  {
+    return block_count_;
+  }
+
+  const Statistics_t & GetStatistics() const
+  {
+    return statistics_;
+  }
+
+  void ResetStatistics() const
+  {
+    statistics_ = {};
+  }
+
+ private:
+  enum class TransferState : uint8_t
+  {
+    kNone = 0,
+    kReadStream,
+    kWriteSingle,
+    kWriteMulti,
+  };
+
+  // R1 response flags
+  static constexpr uint8_t kIdle            = 0x01;
+  static constexpr uint8_t kIllegalCommand  = 0x04;
+  static constexpr uint8_t kCommandCrcError = 0x08;
+  static constexpr uint8_t kEraseSequence   = 0x10;
+  static constexpr uint8_t kAddressError    = 0x20;
+  static constexpr uint8_t kParameterError  = 0x40;
+
+  static constexpr uint8_t kStartBlockToken      = 0xFE;
+  static constexpr uint8_t kStartMultiWriteToken = 0xFC;
+  static constexpr uint8_t kStopTransferToken    = 0xFD;
+  static constexpr uint8_t kOutOfRangeToken      = 0x08;
+  static constexpr uint8_t kDataAccepted         = 0xE5;
+  static constexpr uint8_t kDataCrcError         = 0xEB;
+  static constexpr uint8_t kDataWriteError       = 0xED;
+  /// Sent right after CMD12, while the card finishes the byte it was on
+  static constexpr uint8_t kStuffByte = 0xA5;
+  static constexpr uint32_t kNoAddress = 0xFFFF'FFFF;
+
+  void BuildRegisters()
+  {
+    // CSD version 2.0: 25 MHz TRAN_SPEED, command classes 0, 2, 4, 5, 7, 8
+    // and 10, 512 byte blocks and 64 KiB erase sectors
+    uint32_t c_size = (block_count_ / kCapacityUnit) - 1;
+    uint8_t csd[] = { 0x40,
+                      0x0E,
+                      0x00,
+                      0x32,
+                      0x5B,
+                      0x59,
+                      0x00,
+                      static_cast<uint8_t>((c_size >> 16) & 0x3F),
+                      static_cast<uint8_t>(c_size >> 8),
+                      static_cast<uint8_t>(c_size),
+                      0x7F,
+                      0x80,
+                      0x0A,
+                      0x40,
+                      0x00,
+                      0x00 };
+    if (capacity_ == Capacity::kStandard)
+    {
+      // CSD version 1.0 with the same fields, and the capacity counted as
+      // (C_SIZE + 1) * 2^(C_SIZE_MULT + 2) 512 byte blocks, C_SIZE_MULT = 7
+      c_size  = (block_count_ / 512) - 1;
+      csd[0]  = 0x00;
+      csd[1]  = 0x26;
+      csd[6]  = static_cast<uint8_t>((c_size >> 10) & 0x03);
+      csd[7]  = static_cast<uint8_t>(c_size >> 2);
+      csd[8]  = static_cast<uint8_t>((c_size & 0x03) << 6);
+      csd[9]  = 0x03;
+      csd[10] = 0xFF;
+    }
+    // "SJ" / "EMU01", revision 1.0, serial number 1, made 2019-10
+    uint8_t cid[] = { 0x53, 0x4A, 0x45, 0x45, 0x4D, 0x55, 0x30, 0x31,
+                      0x10, 0x00, 0x00, 0x00, 0x01, 0x01, 0x3A, 0x00 };
+    csd[15] = static_cast<uint8_t>((crc::Crc7::Calculate(csd, 15) << 1) | 1);
+    cid[15] = static_cast<uint8_t>((crc::Crc7::Calculate(cid, 15) << 1) | 1);
+    std::copy(std::begin(csd), std::end(csd), csd_);
+    std::copy(std::begin(cid), std::end(cid), cid_);
+  }
+
+  void Receive(uint8_t byte) const
+  {
+    if (write_index_ >= 0)
+    {
+      ReceiveWriteData(byte);
+      return;
+    }
+    if (frame_length_ == 0)
+    {
+      bool is_start_token =
+          (transfer_ == TransferState::kWriteSingle &&
+           byte == kStartBlockToken) ||
+          (transfer_ == TransferState::kWriteMulti &&
+           byte == kStartMultiWriteToken);
+      if (is_start_token)
+      {
+        write_index_ = 0;
+        return;
+      }
+      if (transfer_ == TransferState::kWriteMulti && byte == kStopTransferToken)
+      {
+        // One byte goes by before the card starts to program
+        transfer_ = TransferState::kNone;
+        output_.push_back(0xFF);
+        busy_ = timing_.write_busy_bytes;
+        return;
+      }
+      if ((byte & 0xC0) != 0x40)
+      {
+        return;
+      }
+    }
+
+    frame_[frame_length_++] = byte;
+    if (frame_length_ == sizeof(frame_))
+    {
+      frame_length_ = 0;
+      ExecuteCommand();
+    }
+  }
+
+  void ExecuteCommand() const
+  {
+    uint8_t index     = frame_[0] & 0x3F;
+    uint32_t argument = static_cast<uint32_t>(
+        (frame_[1] << 24) | (frame_[2] << 16) | (frame_[3] << 8) | frame_[4]);
+    bool is_app_command = app_command_;
+    app_command_        = false;
+    statistics_.commands++;
+
+    if (!in_spi_mode_ && index != 0)
+    {
+      return;
+    }
+    if ((frame_[5] >> 1) != crc::Crc7::Calculate(frame_, 5))
+    {
+      Respond(kCommandCrcError);
+      return;
+    }
+
+    if (transfer_ == TransferState::kReadStream && index == 12)
+    {
+      transfer_ = TransferState::kNone;
+      output_.clear();
+      output_.push_back(kStuffByte);
+      Respond(0x00);
+      busy_ = 1;
+      return;
+    }
+    // Any other command ends a transfer that has not started its data
+    transfer_ = TransferState::kNone;
+
+    if (is_app_command && index == 41)
+    {
+      PollInitialization();
+      return;
+    }
+
+    switch (index)
+    {
+      case 0:
+        in_spi_mode_         = true;
+        idle_                = true;
+        polls_remaining_     = timing_.initialization_polls;
+        erase_start_         = kNoAddress;
+        erase_end_           = kNoAddress;
+        Respond(0x00);
+        return;
+      case 1: PollInitialization(); return;
+      case 8:
+      {
+        uint8_t echo[] = { 0x00, 0x00, static_cast<uint8_t>(argument >> 8),
+                           static_cast<uint8_t>(argument) };
+        echo[2] &= 0x0F;
+        Respond(0x00, echo, sizeof(echo));
+        return;
+      }
+      case 55:
+        app_command_ = true;
+        Respond(0x00);
+        return;
+      case 58:
+      {
+        // Powered up (once initialized), the capacity class, 2.7V to 3.6V
+        uint8_t ccs = (capacity_ == Capacity::kHigh) ? 0x40 : 0x00;
+        uint8_t ocr[] = { static_cast<uint8_t>((idle_ ? 0x00 : 0x80) | ccs),
+                          0xFF, 0x80, 0x00 };
+        Respond(0x00, ocr, sizeof(ocr));
+        return;
+      }
+      default: break;
+    }
+
+    if (idle_)
+    {
+      Respond(kIllegalCommand);
+      return;
+    }
+
+    switch (index)
+    {
+      case 6: RespondWithSwitchStatus(argument); break;
+      case 9:
+        Respond(0x00);
+        QueueDataBlock(csd_, sizeof(csd_));
+        break;
+      case 10:
+        Respond(0x00);
+        QueueDataBlock(cid_, sizeof(cid_));
+        break;
+      case 12: Respond(0x00); break;
+      case 13:
+      {
+        uint8_t status = 0x00;
+        Respond(0x00, &status, 1);
+        break;
+      }
+      case 16:
+        Respond((argument == kBlockSize) ? 0x00 : kParameterError);
+        break;
+      case 17:
+      case 18:
+      case 24:
+      case 25:
+        if (!IsBlockAddress(argument))
+        {
+          Respond(kAddressError);
+          break;
+        }
+        if (ToBlock(argument) >= block_count_)
+        {
+          Respond(kParameterError);
+          break;
+        }
+        Respond(0x00);
+        next_block_ = ToBlock(argument);
+        if (index == 17)
+        {
+          QueueReadBlock(next_block_);
+        }
+        else if (index == 18)
+        {
+          transfer_ = TransferState::kReadStream;
+        }
+        else
+        {
+          transfer_ = (index == 24) ? TransferState::kWriteSingle
+                                    : TransferState::kWriteMulti;
+        }
+        break;
+      case 32:
+      case 33:
+        if (!IsBlockAddress(argument))
+        {
+          Respond(kAddressError);
+          break;
+        }
+        if (ToBlock(argument) >= block_count_)
+        {
+          Respond(kParameterError);
+          break;
+        }
+        ((index == 32) ? erase_start_ : erase_end_) = ToBlock(argument);
+        Respond(0x00);
+        break;
+      case 38: Erase(); break;
+      default: Respond(kIllegalCommand); break;
+    }
+  }
+
+  /// Standard capacity cards take byte addresses, which must fall on a block
+  bool IsBlockAddress(uint32_t argument) const
+  {
+    return capacity_ == Capacity::kHigh || (argument % kBlockSize) == 0;
+  }
+
+  uint32_t ToBlock(uint32_t argument) const
+  {
+    return (capacity_ == Capacity::kHigh) ? argument : argument / kBlockSize;
+  }
+
+  /// CMD1 and ACMD41: the card stays idle for a few polls
+  void PollInitialization() const
+  {
+    if (idle_ && polls_remaining_ > 0)
+    {
+      polls_remaining_--;
+    }
+    else
+    {
+      idle_ = false;
+    }
+    Respond(0x00);
+  }
+
+  void RespondWithSwitchStatus(uint32_t argument) const
+  {
+    // Function group 1 supports default and high speed. Switching takes
+    // effect immediately, as the emulated bus has no speed limit.
+    uint8_t status[64] = { 0x00, 0x64 };
+    status[13]         = 0x03;
+    bool wants_high_speed = (argument & 0x0F) == 0x01;
+    status[16]            = wants_high_speed ? 0x01 : 0x00;
+    Respond(0x00);
+    QueueDataBlock(status, sizeof(status));
+  }
+
+  void Erase() const
+  {
+    if (erase_start_ == kNoAddress || erase_end_ == kNoAddress ||
+        erase_start_ > erase_end_)
+    {
+      Respond(kEraseSequence);
+      return;
+    }
+
+    uint8_t erased[kBlockSize];
+    std::fill(std::begin(erased), std::end(erased), kErasedByte);
+    for (uint32_t block = erase_start_; block <= erase_end_; block++)
+    {
+      WriteImage(block, erased);
+      statistics_.blocks_erased++;
+    }
+    erase_start_ = kNoAddress;
+    erase_end_   = kNoAddress;
+    // R1b, the card is busy right after the response
+    Respond(0x00);
+    busy_ = timing_.erase_busy_bytes;
+  }
+
+  void ReceiveWriteData(uint8_t byte) const
+  {
+    if (static_cast<size_t>(write_index_) < sizeof(block_))
+    {
+      block_[write_index_++] = byte;
+      return;
+    }
+    write_crc_ = static_cast<uint16_t>((write_crc_ << 8) | byte);
+    if (static_cast<size_t>(++write_index_) < sizeof(block_) + 2)
+    {
+      return;
+    }
+
+    write_index_  = -1;
+    uint8_t token = kDataAccepted;
+    if (write_crc_ != crc::Crc16Ccitt::Calculate(block_, sizeof(block_)))
+    {
+      token = kDataCrcError;
+    }
+    else if (next_block_ >= block_count_)
+    {
+      token = kDataWriteError;
+    }
+    else
+    {
+      WriteImage(next_block_++, block_);
+      statistics_.blocks_written++;
+      busy_ = timing_.write_busy_bytes;
+    }
+    // A multi-block write carries on with the next token after an error, and
+    // the host is expected to stop it.
+    output_.push_back(token);
+    if (transfer_ == TransferState::kWriteSingle)
+    {
+      transfer_ = TransferState::kNone;
+    }
+  }
+
+  /// Queue an R1 response, and any bytes that follow it, after one byte of
+  /// command response time (N_CR).
+  void Respond(uint8_t r1,
+               const uint8_t * extra = nullptr,
+               size_t length        = 0) const
+  {
+    output_.push_back(0xFF);
+    output_.push_back(static_cast<uint8_t>(r1 | (idle_ ? kIdle : 0x00)));
+    output_.insert(output_.end(), extra, extra + length);
+  }
+
+  void QueueReadBlock(uint32_t block) const
+  {
+    if (block >= block_count_)
+    {
+      for (uint32_t i = 0; i < timing_.read_access_bytes; i++)
+      {
+        output_.push_back(0xFF);
+      }
+      output_.push_back(kOutOfRangeToken);
+      transfer_ = TransferState::kNone;
+      return;
+    }
+    ReadImage(block, block_);
+    statistics_.blocks_read++;
+    QueueDataBlock(block_, sizeof(block_));
+  }
+
+  /// Queue a data token, the data and its CRC-16 after the access time
+  void QueueDataBlock(const uint8_t * data, size_t length) const
+  {
+    for (uint32_t i = 0; i < timing_.read_access_bytes; i++)
+    {
+      output_.push_back(0xFF);
+    }
+    uint16_t crc = crc::Crc16Ccitt::Calculate(data, length);
+    output_.push_back(kStartBlockToken);
+    output_.insert(output_.end(), data, data + length);
+    output_.push_back(static_cast<uint8_t>(crc >> 8));
+    output_.push_back(static_cast<uint8_t>(crc));
+  }
+
+  void ReadImage(uint32_t block, uint8_t * data) const
+  {
+    long offset = static_cast<long>(block) * kBlockSize;  // NOLINT
+    if (std::fseek(image_, offset, SEEK_SET) != 0 ||
+        std::fread(data, 1, kBlockSize, image_) != kBlockSize)
+    {
+      LOG_ERROR("Could not read block %u of the SD card image",
+                static_cast<unsigned>(block));
+    }
+  }
+
+  void WriteImage(uint32_t block, const uint8_t * data) const
+  {
+    long offset = static_cast<long>(block) * kBlockSize;  // NOLINT
+    if (std::fseek(image_, offset, SEEK_SET) != 0 ||
+        std::fwrite(data, 1, kBlockSize, image_) != kBlockSize)
+    {
+      LOG_ERROR("Could not write block %u of the SD card image",
+                static_cast<unsigned>(block));
+    }
+  }
+
+  std::FILE * image_;
+  bool owns_image_ = false;
+  uint32_t block_count_ = 0;
+  Capacity capacity_    = Capacity::kHigh;
+  Timing_t timing_;
+  ChipSelect chip_select_;
+  uint8_t csd_[16];
+  uint8_t cid_[16];
+
+  mutable Statistics_t statistics_;
+  mutable units::frequency::hertz_t clock_ = 0_Hz;
+  mutable bool selected_                   = false;
+  mutable bool in_spi_mode_                = false;
+  mutable bool idle_                       = true;
+  mutable bool app_command_                = false;
+  mutable uint32_t polls_remaining_        = 0;
+  /// Bytes the card has queued to send
+  mutable std::deque<uint8_t> output_;
+  /// Busy bytes left to send once output_ is empty
+  mutable uint32_t busy_ = 0;
+  mutable uint8_t frame_[6];
+  mutable size_t frame_length_        = 0;
+  mutable TransferState transfer_     = TransferState::kNone;
+  mutable uint32_t next_block_        = 0;
+  mutable uint32_t erase_start_       = kNoAddress;
+  mutable uint32_t erase_end_         = kNoAddress;
+  mutable uint8_t block_[kBlockSize];
+  /// Bytes received of the block being written, or -1 if none
+  mutable int write_index_   = -1;
+  mutable uint16_t write_crc_ = 0;
+};
+}  // namespace sjsu
@@ -80,6 +80,80 @@ SJ2_DECLARE_CONSTANT(BAUD_RATE, uint32_t, kBaudRate);
 static_assert(4'800 <= kBaudRate && kBaudRate <= 4'000'000,
               "SJ2_BAUD_RATE must be between 4800 bits/s and 4 MBits/s");
 
+/// Used to set the size of the transmit and receive buffers of UARTs running
+/// from their interrupt (see lpc40xx::Uart::EnableInterrupts()). Writes that
+/// do not fit in the transmit buffer are dropped and counted, so it should
+/// hold the longest burst of output expected. Both must be powers of two.
+#if !defined(SJ2_UART_TRANSMIT_BUFFER_SIZE)
+#define SJ2_UART_TRANSMIT_BUFFER_SIZE 512
+#endif  // !defined(SJ2_UART_TRANSMIT_BUFFER_SIZE)
+SJ2_DECLARE_CONSTANT(UART_TRANSMIT_BUFFER_SIZE,
+                     size_t,
+                     kUartTransmitBufferSize);
+
+#if !defined(SJ2_UART_RECEIVE_BUFFER_SIZE)
+#define SJ2_UART_RECEIVE_BUFFER_SIZE 128
+#endif  // !defined(SJ2_UART_RECEIVE_BUFFER_SIZE)
+SJ2_DECLARE_CONSTANT(UART_RECEIVE_BUFFER_SIZE, size_t, kUartReceiveBufferSize);
+
+/// Used to set the size of each half of the double buffer a UART receives
+/// frames into with DMA (see lpc40xx::Uart::EnableFrameMode()). It limits the
+/// longest frame that can be received.
+#if !defined(SJ2_UART_FRAME_BUFFER_SIZE)
+#define SJ2_UART_FRAME_BUFFER_SIZE 64
+#endif  // !defined(SJ2_UART_FRAME_BUFFER_SIZE)
+SJ2_DECLARE_CONSTANT(UART_FRAME_BUFFER_SIZE, size_t, kUartFrameBufferSize);
+static_assert(0 < kUartFrameBufferSize && kUartFrameBufferSize <= 4095,
+              "SJ2_UART_FRAME_BUFFER_SIZE must fit in a single DMA transfer, "
+              "which is at most 4095 bytes.");
+
+/// Used to set how many transactions can wait for an I2C bus at once (see
+/// lpc40xx::I2c::Enqueue()). Blocking transactions from each task take up one
+/// entry while they wait.
+#if !defined(SJ2_I2C_QUEUE_DEPTH)
+#define SJ2_I2C_QUEUE_DEPTH 8
+#endif  // !defined(SJ2_I2C_QUEUE_DEPTH)
+SJ2_DECLARE_CONSTANT(I2C_QUEUE_DEPTH, size_t, kI2cQueueDepth);
+static_assert(kI2cQueueDepth > 0, "SJ2_I2C_QUEUE_DEPTH must be at least 1.");
+
+/// Used to set the SCL frequency I2C buses start out at, until they are given
+/// another with SetClock(). Devices that cannot keep up with it declare their
+/// own maximum (see I2cDevice).
+#if !defined(SJ2_I2C_CLOCK_RATE)
+#define SJ2_I2C_CLOCK_RATE 400_kHz
+#endif  // !defined(SJ2_I2C_CLOCK_RATE)
+SJ2_DECLARE_CONSTANT(I2C_CLOCK_RATE, units::frequency::hertz_t, kI2cClockRate);
+static_assert(0_Hz < kI2cClockRate && kI2cClockRate <= 1_MHz,
+              "SJ2_I2C_CLOCK_RATE must be between 1 Hz and 1 MHz.");
+
+/// Used to set the size of each half of the double buffer that stdout (printf,
+/// LOG_* and friends) is written into, on platforms that drain it to the
+/// serial port with DMA. Set to 0 to write stdout straight to the serial port.
+#if !defined(SJ2_STDOUT_BUFFER_SIZE)
+#define SJ2_STDOUT_BUFFER_SIZE 1024
+#endif  // !defined(SJ2_STDOUT_BUFFER_SIZE)
+SJ2_DECLARE_CONSTANT(STDOUT_BUFFER_SIZE, size_t, kStdoutBufferSize);
+static_assert(kStdoutBufferSize <= 4095,
+              "SJ2_STDOUT_BUFFER_SIZE must fit in a single DMA transfer, "
+              "which is at most 4095 bytes.");
+
+/// What to do with stdout data when both halves of the stdout buffer are full:
+///   - SJ2_STDOUT_DROP: drop the new data
+///   - SJ2_STDOUT_BLOCK: wait for the serial port to catch up
+///   - SJ2_STDOUT_OVERWRITE: drop the oldest data that has not been sent
+#define SJ2_STDOUT_DROP 0
+#define SJ2_STDOUT_BLOCK 1
+#define SJ2_STDOUT_OVERWRITE 2
+#if !defined(SJ2_STDOUT_FULL_POLICY)
+#define SJ2_STDOUT_FULL_POLICY SJ2_STDOUT_BLOCK
+#endif  // !defined(SJ2_STDOUT_FULL_POLICY)
+SJ2_DECLARE_CONSTANT(STDOUT_FULL_POLICY, uint8_t, kStdoutFullPolicy);
+static_assert(kStdoutFullPolicy == SJ2_STDOUT_DROP ||
+                  kStdoutFullPolicy == SJ2_STDOUT_BLOCK ||
+                  kStdoutFullPolicy == SJ2_STDOUT_OVERWRITE,
+              "SJ2_STDOUT_FULL_POLICY must be SJ2_STDOUT_DROP, "
+              "SJ2_STDOUT_BLOCK or SJ2_STDOUT_OVERWRITE.");
+
 /// Used to dump all the call stack when "PrintBacktrace" is called or an assert
 /// using PrintBacktrace is occurs.
 /// Disable this to omit getting these logs and reduce the binary size by ~5kB.
@@ -112,6 +186,41 @@ SJ2_DECLARE_CONSTANT(TASK_SCHEDULER_SIZE, uint8_t, kTaskSchedulerSize);
 #endif  // !defined(SJ2_ESP8266_BUFFER_SIZE)
 SJ2_DECLARE_CONSTANT(ESP8266_BUFFER_SIZE, size_t, kEsp8266BufferSize);
 
+/// Used to select the driver behind sjtwo::SdCard(). The SJTwo board wires its
+/// SD card slot to SSP2, so the SPI mode driver is the default. Boards that
+/// route the slot to the MCI pins can set this to true to use the 4-bit native
+/// mode driver instead.
+#if !defined(SJ2_SD_USE_MCI)
+#define SJ2_SD_USE_MCI false
+#endif  // !defined(SJ2_SD_USE_MCI)
+SJ2_DECLARE_CONSTANT(SD_USE_MCI, bool, kSdUseMci);
+
+/// Used to set the number of 512-byte sectors the FatFs disk layer keeps in
+/// its write-back cache. Each sector costs 512 bytes of RAM.
+#if !defined(SJ2_SD_CACHE_SECTORS)
+#define SJ2_SD_CACHE_SECTORS 8
+#endif  // !defined(SJ2_SD_CACHE_SECTORS)
+SJ2_DECLARE_CONSTANT(SD_CACHE_SECTORS, size_t, kSdCacheSectors);
+static_assert(1 <= kSdCacheSectors && kSdCacheSectors <= 128,
+              "SJ2_SD_CACHE_SECTORS must be between 1 and 128");
+
+/// Used to set the number of extra sectors the FatFs disk layer reads when a
+/// cache miss continues a sequential read. Set to 0 to disable read-ahead.
+#if !defined(SJ2_SD_CACHE_READ_AHEAD)
+#define SJ2_SD_CACHE_READ_AHEAD 3
+#endif  // !defined(SJ2_SD_CACHE_READ_AHEAD)
+SJ2_DECLARE_CONSTANT(SD_CACHE_READ_AHEAD, uint32_t, kSdCacheReadAhead);
+static_assert(kSdCacheReadAhead < kSdCacheSectors,
+              "SJ2_SD_CACHE_READ_AHEAD must be less than SJ2_SD_CACHE_SECTORS");
+
+/// Used to select the CRC engine used by drivers that check their data, such
+/// as the SD card driver. When true, boards with a hardware CRC engine use it,
+/// otherwise the lookup tables in utility/crc.hpp are used.
+#if !defined(SJ2_USE_HARDWARE_CRC)
+#define SJ2_USE_HARDWARE_CRC true
+#endif  // !defined(SJ2_USE_HARDWARE_CRC)
+SJ2_DECLARE_CONSTANT(USE_HARDWARE_CRC, bool, kUseHardwareCrc);
+
 /// Used to define the log level of the build
 #if !defined(SJ2_LOG_LEVEL)
 #define SJ2_LOG_LEVEL SJ2_LOG_LEVEL_INFO
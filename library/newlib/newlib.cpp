@@ -23,9 +23,11 @@ int DoNothingStdIn(char *, size_t)
 {
   return 0;
 }
+void DoNothingFlush() {}
 
 Stdout out                = DoNothingStdOut;
 Stdin in                  = DoNothingStdIn;
+Flush flush               = DoNothingFlush;
 bool echo_back_is_enabled = true;
 
 void SetStdout(Stdout stdout_handler)
@@ -36,6 +38,14 @@ void SetStdin(Stdin stdin_handler)
 {
   in = stdin_handler;
 }
+void SetStdoutFlush(Flush flush_handler)
+{
+  flush = flush_handler;
+}
+void FlushStdout()
+{
+  flush();
+}
 void StdinEchoBack(bool enable_echo)
 {
   echo_back_is_enabled = enable_echo;
@@ -8,9 +8,17 @@ namespace newlib
 {
 using Stdout = int (*)(const char *, size_t);
 using Stdin  = int (*)(char *, size_t);
+using Flush  = void (*)();
 
 void SetStdout(Stdout);
 void SetStdin(Stdin);
+/// Set the function that pushes out anything the stdout backend is holding on
+/// to. Backends that write synchronously do not need one.
+void SetStdoutFlush(Flush);
+/// Send everything buffered by the stdout backend and have it write
+/// synchronously from then on. Must work with interrupts masked, as the fault
+/// handlers call it before printing.
+void FlushStdout();
 /// Enables echo back when _read (stdin) is called.
 ///
 /// @param enable_echo - If true, enable echo, if false disable echo back.
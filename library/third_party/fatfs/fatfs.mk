@@ -6,3 +6,8 @@ LIBRARY_FATFS += $(LIBRARY_DIR)/third_party/fatfs/source/ffsystem.c
 LIBRARY_FATFS += $(LIBRARY_DIR)/third_party/fatfs/source/ffunicode.c
 
 $(eval $(call BUILD_LIRBARY,libfatfs,LIBRARY_FATFS))
+
+# FatFs is also run by the host tests, on the drives of L4_Testing/host_disk.cpp
+# and L4_Testing/ram_disk.hpp
+TESTS += $(LIBRARY_DIR)/third_party/fatfs/source/ff.c
+TESTS += $(LIBRARY_DIR)/third_party/fatfs/source/ffsystem.c
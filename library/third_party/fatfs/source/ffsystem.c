@@ -40,6 +40,25 @@ void ff_memfree (
 
 #if FF_FS_REENTRANT	/* Mutal exclusion */
 
+/* SJSU-Dev2: Each volume is guarded by a FreeRTOS mutex created in static
+/  storage, so mounting never touches the heap. The mutex gives priority
+/  inheritance to a task holding the volume. Before the scheduler starts there
+/  is only one thread of execution, so grants are given without touching the
+/  mutex, which lets f_mount() and file access run from main().
+/
+/  The mutex is created by the first grant requested once the scheduler is
+/  running. Creating it in f_mount(), which may run from main(), would mask
+/  interrupts until the scheduler starts.
+*/
+
+static FF_VOLUME_MUTEX volume_mutex[FF_VOLUMES];
+
+static int SchedulerIsRunning (void)
+{
+	return xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED;
+}
+
+
 /*------------------------------------------------------------------------*/
 /* Create a Synchronization Object                                        */
 /*------------------------------------------------------------------------*/
@@ -48,35 +67,14 @@ void ff_memfree (
 /  When a 0 is returned, the f_mount() function fails with FR_INT_ERR.
 */
 
-//const osMutexDef_t Mutex[FF_VOLUMES];	/* Table of CMSIS-RTOS mutex */
-
-
 int ff_cre_syncobj (	/* 1:Function succeeded, 0:Could not create the sync object */
 	BYTE vol,			/* Corresponding volume (logical drive number) */
 	FF_SYNC_t* sobj		/* Pointer to return the created sync object */
 )
 {
-	/* Win32 */
-	*sobj = CreateMutex(NULL, FALSE, NULL);
-	return (int)(*sobj != INVALID_HANDLE_VALUE);
-
-	/* uITRON */
-//	T_CSEM csem = {TA_TPRI,1,1};
-//	*sobj = acre_sem(&csem);
-//	return (int)(*sobj > 0);
-
-	/* uC/OS-II */
-//	OS_ERR err;
-//	*sobj = OSMutexCreate(0, &err);
-//	return (int)(err == OS_NO_ERR);
-
-	/* FreeRTOS */
-//	*sobj = xSemaphoreCreateMutex();
-//	return (int)(*sobj != NULL);
-
-	/* CMSIS-RTOS */
-//	*sobj = osMutexCreate(&Mutex[vol]);
-//	return (int)(*sobj != NULL);
+	/* Only the slot is handed out, the mutex is created by ff_req_grant() */
+	*sobj = &volume_mutex[vol];
+	return 1;
 }
 
 
@@ -92,23 +90,14 @@ int ff_del_syncobj (	/* 1:Function succeeded, 0:Could not delete due to an error
 	FF_SYNC_t sobj		/* Sync object tied to the logical drive to be deleted */
 )
 {
-	/* Win32 */
-	return (int)CloseHandle(sobj);
-
-	/* uITRON */
-//	return (int)(del_sem(sobj) == E_OK);
-
-	/* uC/OS-II */
-//	OS_ERR err;
-//	OSMutexDel(sobj, OS_DEL_ALWAYS, &err);
-//	return (int)(err == OS_NO_ERR);
-
-	/* FreeRTOS */
-//  vSemaphoreDelete(sobj);
-//	return 1;
-
-	/* CMSIS-RTOS */
-//	return (int)(osMutexDelete(sobj) == osOK);
+	/* The mutex lives in static storage, so this only unregisters it. A
+	/  volume never used with the scheduler running has no mutex. */
+	if (sobj->mutex != NULL)
+	{
+		vSemaphoreDelete(sobj->mutex);
+		sobj->mutex = NULL;
+	}
+	return 1;
 }
 
 
@@ -123,22 +112,19 @@ int ff_req_grant (	/* 1:Got a grant to access the volume, 0:Could not get a gran
 	FF_SYNC_t sobj	/* Sync object to wait */
 )
 {
-	/* Win32 */
-	return (int)(WaitForSingleObject(sobj, FF_FS_TIMEOUT) == WAIT_OBJECT_0);
-
-	/* uITRON */
-//	return (int)(wai_sem(sobj) == E_OK);
-
-	/* uC/OS-II */
-//	OS_ERR err;
-//	OSMutexPend(sobj, FF_FS_TIMEOUT, &err));
-//	return (int)(err == OS_NO_ERR);
-
-	/* FreeRTOS */
-//	return (int)(xSemaphoreTake(sobj, FF_FS_TIMEOUT) == pdTRUE);
-
-	/* CMSIS-RTOS */
-//	return (int)(osMutexWait(sobj, FF_FS_TIMEOUT) == osOK);
+	if (!SchedulerIsRunning()) return 1;
+	if (sobj->mutex == NULL)
+	{
+		/* Grants are only requested by tasks, so holding off the other
+		/  tasks is enough to keep two of them from both creating it */
+		vTaskSuspendAll();
+		if (sobj->mutex == NULL)
+		{
+			sobj->mutex = xSemaphoreCreateMutexStatic(&sobj->buffer);
+		}
+		xTaskResumeAll();
+	}
+	return (int)(xSemaphoreTake(sobj->mutex, FF_FS_TIMEOUT) == pdTRUE);
 }
 
 
@@ -152,20 +138,8 @@ void ff_rel_grant (
 	FF_SYNC_t sobj	/* Sync object to be signaled */
 )
 {
-	/* Win32 */
-	ReleaseMutex(sobj);
-
-	/* uITRON */
-//	sig_sem(sobj);
-
-	/* uC/OS-II */
-//	OSMutexPost(sobj);
-
-	/* FreeRTOS */
-//	xSemaphoreGive(sobj);
-
-	/* CMSIS-RTOS */
-//	osMutexRelease(sobj);
+	if (!SchedulerIsRunning() || sobj->mutex == NULL) return;
+	xSemaphoreGive(sobj->mutex);
 }
 
 #endif
@@ -0,0 +1,112 @@
+// Consistent Overhead Byte Stuffing (COBS) removes every zero byte from a
+// block of data, so that a zero byte can mark where one block ends and the
+// next begins on a byte stream, such as a UART. A receiver that joins the
+// stream part way through, or loses a byte, gets back in step at the next
+// zero.
+//
+// The encoding replaces each zero with the distance to the next one, and
+// adds one byte at the start plus one byte for every 254 non-zero bytes in a
+// row:
+//
+//     data:    11 22 00 33
+//     encoded: 03 11 22 02 33
+//
+// Neither function adds or expects the zero delimiter.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "utility/status.hpp"
+
+namespace sjsu
+{
+namespace cobs
+{
+/// Longest run of non-zero bytes a single code byte can describe
+constexpr size_t kMaxRun = 254;
+
+/// @return the most bytes Encode() can produce for length bytes of data
+constexpr size_t MaxEncodedLength(size_t length)
+{
+  return length + (length / kMaxRun) + 1;
+}
+
+/// Encode data so that it contains no zero bytes.
+///
+/// @param data - bytes to encode
+/// @param length - number of bytes in data
+/// @param output - where to put the encoded bytes, which must have room for
+///        MaxEncodedLength(length) bytes and must not overlap data
+/// @return the number of bytes written to output
+constexpr size_t Encode(const uint8_t * data, size_t length, uint8_t * output)
+{
+  size_t code_position = 0;
+  size_t position      = 1;
+  uint8_t code         = 1;
+  for (size_t i = 0; i < length; i++)
+  {
+    if (data[i] != 0)
+    {
+      output[position++] = data[i];
+      code++;
+    }
+    if (data[i] == 0 || code == kMaxRun + 1)
+    {
+      output[code_position] = code;
+      code_position         = position++;
+      code                  = 1;
+      // A full run that ends the data needs no code byte after it.
+      if (data[i] != 0 && i + 1 == length)
+      {
+        return code_position;
+      }
+    }
+  }
+  output[code_position] = code;
+  return position;
+}
+
+/// Decode bytes made by Encode(). The output may be the same buffer as the
+/// input, as decoding never writes ahead of what it has read.
+///
+/// @param encoded - bytes to decode, without the zero delimiter
+/// @param length - number of bytes in encoded
+/// @param output - where to put the data, which must have room for length
+///        bytes
+/// @param decoded_length - set to the number of bytes written to output
+/// @return Status::kBusError if the bytes could not have come from Encode(),
+///         otherwise Status::kSuccess.
+constexpr Status Decode(const uint8_t * encoded,
+                        size_t length,
+                        uint8_t * output,
+                        size_t * decoded_length)
+{
+  size_t position = 0;
+  size_t written  = 0;
+  while (position < length)
+  {
+    uint8_t code = encoded[position++];
+    if (code == 0 || position + code - 1 > length)
+    {
+      return Status::kBusError;
+    }
+    for (uint8_t i = 1; i < code; i++)
+    {
+      if (encoded[position] == 0)
+      {
+        return Status::kBusError;
+      }
+      output[written++] = encoded[position++];
+    }
+    // A full run is not followed by a zero, and neither is the last run.
+    if (code != kMaxRun + 1 && position < length)
+    {
+      output[written++] = 0;
+    }
+  }
+  *decoded_length = written;
+  return Status::kSuccess;
+}
+}  // namespace cobs
+}  // namespace sjsu
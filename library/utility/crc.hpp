@@ -0,0 +1,251 @@
+// Table driven CRC calculations for checking the integrity of data moved over
+// a bus, such as SD card commands and blocks.
+//
+// Every CRC offers three kernels that give the same result:
+//
+//   - Slice1() looks up one table entry per byte. Each lookup depends on the
+//     previous one.
+//   - Slice4() and Slice8() fold 4 or 8 bytes into the CRC with 4 or 8
+//     independent lookups, at the cost of 4 or 8 times the table size.
+//
+// Calculate() uses the fastest kernel. The kernels work on a raw CRC register
+// so that a CRC can be built up as data arrives:
+//
+//     uint16_t crc = crc::Crc16Ccitt::kInitialRegister;
+//     crc = crc::Crc16Ccitt::Slice8(crc, first_half, 256);
+//     crc = crc::Crc16Ccitt::Slice8(crc, second_half, 256);
+//     uint16_t result = crc::Crc16Ccitt::Finalize(crc);
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace sjsu
+{
+namespace crc
+{
+/// @tparam T - unsigned type that can hold the CRC
+/// @tparam kWidth - number of bits in the CRC
+/// @tparam kPolynomial - generator polynomial, most significant bit first and
+///         without the leading term (i.e. 0x1021 for x^16 + x^12 + x^5 + 1)
+/// @tparam kInitial - value of the CRC before any data is added
+/// @tparam kFinalXor - value XOR'd with the register to produce the result
+/// @tparam kReflected - true if the bits of each byte are added least
+///         significant bit first
+template <typename T,
+          uint8_t kWidth,
+          T kPolynomial,
+          T kInitial,
+          T kFinalXor,
+          bool kReflected>
+class Crc
+{
+ public:
+  static_assert(kWidth <= 8 * sizeof(T), "T is too small to hold the CRC");
+  static_assert(kWidth <= 32, "CRCs wider than 32 bits are not supported");
+
+  /// Number of tables, one for each byte folded in by Slice8()
+  static constexpr size_t kSlices = 8;
+
+  struct Table_t
+  {
+    /// entry[k][i] is the CRC of the byte i followed by k zero bytes
+    T entry[kSlices][256];
+  };
+
+  /// MSB first CRCs narrower than a byte are kept left aligned within a byte
+  /// so that whole bytes can be XOR'd into the register.
+  static constexpr uint8_t kRegisterWidth =
+      (kReflected || kWidth >= 8) ? kWidth : 8;
+  static constexpr uint8_t kShift = kRegisterWidth - kWidth;
+  static constexpr T kMask =
+      static_cast<T>((uint64_t{ 1 } << kRegisterWidth) - 1);
+
+ private:
+  /// Reverses the order of the CRC's bits
+  static constexpr T Reflect(T value)
+  {
+    T result = 0;
+    for (uint8_t bit = 0; bit < kWidth; bit++)
+    {
+      result = static_cast<T>((result << 1) | ((value >> bit) & 1));
+    }
+    return result;
+  }
+
+  /// Shifts a zero byte into the register. Used while generating the table,
+  /// before kTable exists.
+  static constexpr T AddZeroByte(T crc, const Table_t & table)
+  {
+    if constexpr (kReflected)
+    {
+      return static_cast<T>((crc >> 8) ^ table.entry[0][crc & 0xFF]);
+    }
+    else
+    {
+      T index = static_cast<T>((crc >> (kRegisterWidth - 8)) & 0xFF);
+      return static_cast<T>(((crc << 8) & kMask) ^ table.entry[0][index]);
+    }
+  }
+
+ public:
+  static constexpr T ToRegister(T crc)
+  {
+    return (kReflected) ? Reflect(crc) : static_cast<T>(crc << kShift);
+  }
+
+  static constexpr T kInitialRegister = ToRegister(kInitial);
+
+  static constexpr Table_t GenerateTable()
+  {
+    Table_t table = {};
+    for (uint32_t i = 0; i < 256; i++)
+    {
+      T crc = 0;
+      if constexpr (kReflected)
+      {
+        constexpr T kReflectedPolynomial = Reflect(kPolynomial);
+        crc                              = static_cast<T>(i);
+        for (int bit = 0; bit < 8; bit++)
+        {
+          crc = (crc & 1) ? static_cast<T>((crc >> 1) ^ kReflectedPolynomial)
+                          : static_cast<T>(crc >> 1);
+        }
+      }
+      else
+      {
+        constexpr T kTopBit            = T{ 1 } << (kRegisterWidth - 1);
+        constexpr T kAlignedPolynomial = static_cast<T>(kPolynomial << kShift);
+        crc = static_cast<T>(i << (kRegisterWidth - 8));
+        for (int bit = 0; bit < 8; bit++)
+        {
+          crc = (crc & kTopBit)
+                    ? static_cast<T>((crc << 1) ^ kAlignedPolynomial)
+                    : static_cast<T>(crc << 1);
+        }
+      }
+      table.entry[0][i] = static_cast<T>(crc & kMask);
+    }
+    for (size_t slice = 1; slice < kSlices; slice++)
+    {
+      for (size_t i = 0; i < 256; i++)
+      {
+        table.entry[slice][i] = AddZeroByte(table.entry[slice - 1][i], table);
+      }
+    }
+    return table;
+  }
+
+  static constexpr Table_t kTable = GenerateTable();
+
+  /// Adds bytes to the register one at a time.
+  static constexpr T Slice1(T crc, const uint8_t * data, size_t length)
+  {
+    for (size_t i = 0; i < length; i++)
+    {
+      if constexpr (kReflected)
+      {
+        uint8_t index = static_cast<uint8_t>(crc ^ data[i]);
+        crc = static_cast<T>((crc >> 8) ^ kTable.entry[0][index]);
+      }
+      else
+      {
+        uint8_t index =
+            static_cast<uint8_t>((crc >> (kRegisterWidth - 8)) ^ data[i]);
+        crc = static_cast<T>(((crc << 8) & kMask) ^ kTable.entry[0][index]);
+      }
+    }
+    return crc;
+  }
+
+  /// Adds bytes to the register 4 at a time.
+  static constexpr T Slice4(T crc, const uint8_t * data, size_t length)
+  {
+    size_t i = 0;
+    for (; i + 4 <= length; i += 4)
+    {
+      uint32_t x = Mix(crc, &data[i]);
+      crc        = Fold(x, 0);
+    }
+    return Slice1(crc, &data[i], length - i);
+  }
+
+  /// Adds bytes to the register 8 at a time.
+  static constexpr T Slice8(T crc, const uint8_t * data, size_t length)
+  {
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8)
+    {
+      uint32_t high = Mix(crc, &data[i]);
+      uint32_t low  = Mix(0, &data[i + 4]);
+      crc           = static_cast<T>(Fold(high, 4) ^ Fold(low, 0));
+    }
+    return Slice1(crc, &data[i], length - i);
+  }
+
+  /// @returns the CRC held in the register
+  static constexpr T Finalize(T crc)
+  {
+    // Reflected registers already hold their bits in output order
+    return static_cast<T>((crc >> kShift) ^ kFinalXor);
+  }
+
+  /// @returns the CRC of the data
+  static constexpr T Calculate(const uint8_t * data, size_t length)
+  {
+    return Finalize(Slice8(kInitialRegister, data, length));
+  }
+
+ private:
+  /// XORs the register into the next 4 bytes of data, giving the bytes that
+  /// must be folded through the tables.
+  static constexpr uint32_t Mix(T crc, const uint8_t * data)
+  {
+    if constexpr (kReflected)
+    {
+      uint32_t word = static_cast<uint32_t>(data[0]) |
+                      static_cast<uint32_t>(data[1]) << 8 |
+                      static_cast<uint32_t>(data[2]) << 16 |
+                      static_cast<uint32_t>(data[3]) << 24;
+      return word ^ crc;
+    }
+    else
+    {
+      uint32_t word = static_cast<uint32_t>(data[0]) << 24 |
+                      static_cast<uint32_t>(data[1]) << 16 |
+                      static_cast<uint32_t>(data[2]) << 8 |
+                      static_cast<uint32_t>(data[3]);
+      return word ^ (static_cast<uint32_t>(crc) << (32 - kRegisterWidth));
+    }
+  }
+
+  /// Folds 4 mixed bytes through the tables, where offset is the number of
+  /// bytes that follow them within the same step.
+  static constexpr T Fold(uint32_t x, size_t offset)
+  {
+    // The byte that was added first has the most bytes after it
+    constexpr int kFirst  = (kReflected) ? 0 : 24;
+    constexpr int kSecond = (kReflected) ? 8 : 16;
+    constexpr int kThird  = (kReflected) ? 16 : 8;
+    constexpr int kFourth = (kReflected) ? 24 : 0;
+    uint8_t first         = static_cast<uint8_t>(x >> kFirst);
+    uint8_t second        = static_cast<uint8_t>(x >> kSecond);
+    uint8_t third         = static_cast<uint8_t>(x >> kThird);
+    uint8_t fourth        = static_cast<uint8_t>(x >> kFourth);
+    return static_cast<T>(
+        kTable.entry[offset + 3][first] ^ kTable.entry[offset + 2][second] ^
+        kTable.entry[offset + 1][third] ^ kTable.entry[offset][fourth]);
+  }
+};
+
+/// CRC-7 used by SD and MMC command frames
+using Crc7 = Crc<uint8_t, 7, 0x09, 0x00, 0x00, false>;
+/// CRC-16-CCITT (XMODEM) used by SD card data blocks
+using Crc16Ccitt = Crc<uint16_t, 16, 0x1021, 0x0000, 0x0000, false>;
+/// CRC-16 (ARC) with the IBM polynomial, used by Modbus style protocols
+using Crc16 = Crc<uint16_t, 16, 0x8005, 0x0000, 0x0000, true>;
+/// CRC-32 used by Ethernet, zlib and PNG
+using Crc32 =
+    Crc<uint32_t, 32, 0x04C1'1DB7, 0xFFFF'FFFF, 0xFFFF'FFFF, true>;
+}  // namespace crc
+}  // namespace sjsu
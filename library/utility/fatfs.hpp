@@ -1,5 +1,9 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
 #include "third_party/fatfs/source/ff.h"
 
 namespace sjsu
@@ -35,4 +39,230 @@ inline const char * ToString(FRESULT result)
   return (result <= FR_INVALID_PARAMETER) ? k_result_string_table[result]
                                           : "Invalid!";
 }
+
+/// File is a FatFs file with a write-combining buffer in front of f_write().
+/// Small writes are gathered in the buffer and handed to FatFs a buffer at a
+/// time. Buffer flushes are kept on sector boundaries of the file, so FatFs
+/// writes them straight from the buffer with multi-sector disk_write() calls
+/// rather than copying them through its one sector window.
+///
+///   - A write that starts on a sector boundary while the buffer is empty,
+///     and is at least kBufferSize long, skips the buffer entirely.
+///   - Reads, seeks, Sync() and Close() write out the buffer first.
+///   - EnableFastSeek() builds a cluster link map, after which a seek looks
+///     up the cluster in the map rather than following the FAT chain. FatFs
+///     does not let a file grow while its link map is in use.
+///
+/// @tparam kBufferSize - size of the write buffer, a multiple of the sector
+///         size.
+template <size_t kBufferSize = 4 * FF_MAX_SS>
+class File
+{
+ public:
+  static_assert(kBufferSize > 0 && kBufferSize % FF_MAX_SS == 0,
+                "kBufferSize must be a multiple of the sector size");
+
+  File() = default;
+  File(const File &) = delete;
+  File & operator=(const File &) = delete;
+  ~File()
+  {
+    Close();
+  }
+
+  /// Same as f_open(), closing the file already open, if any
+  FRESULT Open(const char * path, BYTE mode)
+  {
+    Close();
+    FRESULT result = f_open(&file_, path, mode);
+    is_open_       = (result == FR_OK);
+    return result;
+  }
+
+  /// Write out the buffer and close the file
+  FRESULT Close()
+  {
+    if (!is_open_)
+    {
+      return FR_OK;
+    }
+    FRESULT result = Flush();
+    FRESULT closed = f_close(&file_);
+    is_open_       = false;
+    return (result != FR_OK) ? result : closed;
+  }
+
+  /// Add data at the current position. The data may stay in the buffer until
+  /// the buffer fills up or the file is synced, read, seeked or closed.
+  ///
+  /// @param written - if not null, set to the number of bytes taken, which is
+  ///        less than length if the disk is full or an error occurred.
+  FRESULT Write(const void * data, size_t length, size_t * written = nullptr)
+  {
+    const auto * bytes = static_cast<const uint8_t *>(data);
+    size_t remaining   = length;
+    FRESULT result     = FR_OK;
+    while (remaining > 0 && result == FR_OK)
+    {
+      if (buffered_ == 0 && f_tell(&file_) % FF_MAX_SS == 0 &&
+          remaining >= kBufferSize)
+      {
+        // Hand whole sectors to FatFs, which transfers them without copying
+        size_t direct    = remaining - (remaining % FF_MAX_SS);
+        size_t completed = 0;
+        result           = WriteThrough(bytes, direct, &completed);
+        bytes += completed;
+        remaining -= completed;
+        continue;
+      }
+
+      size_t space = Capacity() - buffered_;
+      size_t chunk = (remaining < space) ? remaining : space;
+      memcpy(&buffer_[buffered_], bytes, chunk);
+      buffered_ += chunk;
+      bytes += chunk;
+      remaining -= chunk;
+      if (buffered_ == Capacity())
+      {
+        result = Flush();
+      }
+    }
+    if (written != nullptr)
+    {
+      *written = length - remaining;
+    }
+    return result;
+  }
+
+  /// Same as f_read(), after writing out the buffer
+  FRESULT Read(void * data, size_t length, size_t * read)
+  {
+    FRESULT result = Flush();
+    UINT bytes_read = 0;
+    if (result == FR_OK)
+    {
+      result = f_read(&file_, data, static_cast<UINT>(length), &bytes_read);
+    }
+    *read = bytes_read;
+    return result;
+  }
+
+  /// Same as f_lseek(), after writing out the buffer. Takes constant time
+  /// once EnableFastSeek() has been called.
+  FRESULT Seek(FSIZE_t position)
+  {
+    FRESULT result = Flush();
+    return (result == FR_OK) ? f_lseek(&file_, position) : result;
+  }
+
+  /// Write out the buffer and commit the file to the disk with f_sync()
+  FRESULT Sync()
+  {
+    FRESULT result = Flush();
+    return (result == FR_OK) ? f_sync(&file_) : result;
+  }
+
+  /// Hand the buffered data to FatFs without syncing the file
+  FRESULT Flush()
+  {
+    size_t completed = 0;
+    FRESULT result   = WriteThrough(buffer_, buffered_, &completed);
+    buffered_ -= completed;
+    memmove(buffer_, &buffer_[completed], buffered_);
+    return result;
+  }
+
+  /// Build a cluster link map of the file in table, so that seeks no longer
+  /// follow the FAT chain. A file made of n fragments needs 2 * (n + 1)
+  /// entries.
+  ///
+  /// @return FR_NOT_ENOUGH_CORE if the table is too small, in which case
+  ///         table[0] holds the number of entries needed.
+  FRESULT EnableFastSeek(DWORD * table, size_t entries)
+  {
+    FRESULT result = Flush();
+    if (result != FR_OK)
+    {
+      return result;
+    }
+    table[0]     = static_cast<DWORD>(entries);
+    file_.cltbl = table;
+    result      = f_lseek(&file_, CREATE_LINKMAP);
+    if (result != FR_OK)
+    {
+      file_.cltbl = nullptr;
+    }
+    return result;
+  }
+
+  template <size_t kEntries>
+  FRESULT EnableFastSeek(DWORD (&table)[kEntries])
+  {
+    return EnableFastSeek(table, kEntries);
+  }
+
+  /// Go back to following the FAT chain, which allows the file to grow again
+  FRESULT DisableFastSeek()
+  {
+    FRESULT result = Flush();
+    file_.cltbl   = nullptr;
+    return result;
+  }
+
+  /// @return the current position, including buffered data
+  FSIZE_t Tell() const
+  {
+    return f_tell(&file_) + static_cast<FSIZE_t>(buffered_);
+  }
+
+  /// @return the size of the file, including buffered data
+  FSIZE_t Size() const
+  {
+    FSIZE_t end = Tell();
+    return (f_size(&file_) > end) ? f_size(&file_) : end;
+  }
+
+  size_t GetBuffered() const
+  {
+    return buffered_;
+  }
+
+  /// @return the FatFs file object, for calls this class does not wrap
+  FIL * GetFil()
+  {
+    return &file_;
+  }
+
+ private:
+  /// The buffer ends on a sector boundary of the file, so that every flush
+  /// after the first is sector aligned.
+  size_t Capacity() const
+  {
+    return kBufferSize - (f_tell(&file_) % FF_MAX_SS);
+  }
+
+  FRESULT WriteThrough(const uint8_t * data, size_t length, size_t * completed)
+  {
+    *completed = 0;
+    if (length == 0)
+    {
+      return FR_OK;
+    }
+    UINT bytes_written = 0;
+    FRESULT result =
+        f_write(&file_, data, static_cast<UINT>(length), &bytes_written);
+    *completed = bytes_written;
+    if (result == FR_OK && bytes_written < length)
+    {
+      // The volume is full
+      result = FR_DENIED;
+    }
+    return result;
+  }
+
+  FIL file_        = {};
+  bool is_open_    = false;
+  size_t buffered_ = 0;
+  uint8_t buffer_[kBufferSize];
+};
 }  // namespace sjsu
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace sjsu
+{
+/// Fixed size FIFO queue that is safe to share between exactly one producer
+/// and one consumer without a lock, such as a task and an interrupt handler.
+///
+/// The producer only ever writes the tail index and the consumer only ever
+/// writes the head index. Each publishes its index after touching the
+/// elements, so the other side never sees an element before it is ready.
+/// The indices run freely and wrap around on their own, which is why the
+/// capacity must be a power of two.
+///
+/// Usage:
+///
+///     RingBuffer<uint8_t, 64> buffer;
+///     buffer.Push(0xAA);      // producer
+///     uint8_t byte;
+///     buffer.Pop(&byte);      // consumer
+///
+/// @tparam T - type of the elements
+/// @tparam kCapacity - maximum number of elements held at once
+template <typename T, size_t kCapacity>
+class RingBuffer
+{
+ public:
+  static_assert(kCapacity > 0 && (kCapacity & (kCapacity - 1)) == 0,
+                "RingBuffer capacity must be a power of two.");
+
+  /// Producer side: add an element to the back of the queue
+  ///
+  /// @return false if the queue is full, in which case it is not changed
+  bool Push(const T & value)
+  {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) >= kCapacity)
+    {
+      return false;
+    }
+    storage_[tail & kMask] = value;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Producer side: add as many of the elements as fit
+  ///
+  /// @return the number of elements added
+  size_t Push(const T * values, size_t count)
+  {
+    size_t tail  = tail_.load(std::memory_order_relaxed);
+    size_t space = kCapacity - (tail - head_.load(std::memory_order_acquire));
+    if (count > space)
+    {
+      count = space;
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+      storage_[(tail + i) & kMask] = values[i];
+    }
+    tail_.store(tail + count, std::memory_order_release);
+    return count;
+  }
+
+  /// Consumer side: remove the element at the front of the queue
+  ///
+  /// @return false if the queue is empty, in which case value is not changed
+  bool Pop(T * value)
+  {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire))
+    {
+      return false;
+    }
+    *value = storage_[head & kMask];
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Consumer side: remove up to count elements from the front of the queue
+  ///
+  /// @return the number of elements removed
+  size_t Pop(T * values, size_t count)
+  {
+    size_t head      = head_.load(std::memory_order_relaxed);
+    size_t available = tail_.load(std::memory_order_acquire) - head;
+    if (count > available)
+    {
+      count = available;
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+      values[i] = storage_[(head + i) & kMask];
+    }
+    head_.store(head + count, std::memory_order_release);
+    return count;
+  }
+
+  /// @return the number of elements in the queue. Only exact when called by
+  ///         the producer or the consumer, as the other side may be changing
+  ///         it.
+  size_t Size() const
+  {
+    return tail_.load(std::memory_order_acquire) -
+           head_.load(std::memory_order_acquire);
+  }
+
+  bool IsEmpty() const
+  {
+    return Size() == 0;
+  }
+
+  bool IsFull() const
+  {
+    return Size() >= kCapacity;
+  }
+
+  static constexpr size_t Capacity()
+  {
+    return kCapacity;
+  }
+
+ private:
+  static constexpr size_t kMask = kCapacity - 1;
+
+  std::array<T, kCapacity> storage_ = {};
+  std::atomic<size_t> head_         = 0;
+  std::atomic<size_t> tail_         = 0;
+};
+}  // namespace sjsu
@@ -7,6 +7,8 @@
 
 #include <cstdint>
 
+#include "utility/build_info.hpp"
+
 #if defined HOST_TEST
 #include "event_groups.h"
 #include "semphr.h"
@@ -20,10 +22,18 @@ DECLARE_FAKE_VOID_FUNC(vTaskSuspend, TaskHandle_t);
 DECLARE_FAKE_VOID_FUNC(vTaskResume, TaskHandle_t);
 DECLARE_FAKE_VOID_FUNC(vTaskDelete, TaskHandle_t);
 DECLARE_FAKE_VOID_FUNC(vTaskDelayUntil, TickType_t *, TickType_t);
+DECLARE_FAKE_VOID_FUNC(vTaskSuspendAll);
+DECLARE_FAKE_VALUE_FUNC(BaseType_t, xTaskResumeAll);
 DECLARE_FAKE_VOID_FUNC(vApplicationGetIdleTaskMemory, StaticTask_t **,
                        StackType_t **, uint32_t *);
 
 DECLARE_FAKE_VALUE_FUNC(TickType_t, xTaskGetTickCount);
+DECLARE_FAKE_VALUE_FUNC(BaseType_t, xTaskGetSchedulerState);
+DECLARE_FAKE_VALUE_FUNC(TaskHandle_t, xTaskGetCurrentTaskHandle);
+DECLARE_FAKE_VALUE_FUNC(uint32_t, ulTaskNotifyTake, BaseType_t, TickType_t);
+DECLARE_FAKE_VOID_FUNC(vTaskNotifyGiveFromISR, TaskHandle_t, BaseType_t *);
+DECLARE_FAKE_VALUE_FUNC(BaseType_t, xTaskGenericNotify, TaskHandle_t, uint32_t,
+                        eNotifyAction, uint32_t *);
 DECLARE_FAKE_VALUE_FUNC(TaskHandle_t, xTaskCreateStatic, TaskFunction_t,
                         const char *, uint32_t, void *, UBaseType_t,
                         StackType_t *, StaticTask_t *);
@@ -37,8 +47,16 @@ DECLARE_FAKE_VALUE_FUNC(QueueHandle_t, xQueueGenericCreateStatic, UBaseType_t,
                         UBaseType_t, uint8_t *, StaticQueue_t *, uint8_t);
 DECLARE_FAKE_VALUE_FUNC(BaseType_t, xQueueGenericSend, QueueHandle_t,
                         const void *, TickType_t, BaseType_t);
+DECLARE_FAKE_VALUE_FUNC(BaseType_t, xQueueReceive, QueueHandle_t, void *,
+                        TickType_t);
+DECLARE_FAKE_VALUE_FUNC(BaseType_t, xQueueGiveFromISR, QueueHandle_t,
+                        BaseType_t *);
 DECLARE_FAKE_VALUE_FUNC(BaseType_t, xQueueSemaphoreTake, QueueHandle_t,
                         TickType_t);
+DECLARE_FAKE_VALUE_FUNC(QueueHandle_t, xQueueCreateMutexStatic, uint8_t,
+                        StaticQueue_t *);
+DECLARE_FAKE_VALUE_FUNC(void *, xQueueGetMutexHolder, QueueHandle_t);
+DECLARE_FAKE_VOID_FUNC(vQueueDelete, QueueHandle_t);
 
 DECLARE_FAKE_VALUE_FUNC(TimerHandle_t, xTimerCreateStatic, const char *,
                         TickType_t, UBaseType_t, void *,
@@ -89,6 +107,16 @@ inline intptr_t RetrieveParameter(void * parameter)
 {
   return reinterpret_cast<intptr_t>(parameter);
 }
+// Call at the end of an interrupt handler with the flag filled in by the
+// FromISR calls it made. If one of them woke a task of higher priority than
+// the one that was interrupted, the handler returns straight into that task.
+inline void YieldFromIsr(BaseType_t higher_priority_task_woken)
+{
+  if constexpr (build::kTarget != build::Target::HostTest)
+  {
+    portYIELD_FROM_ISR(higher_priority_task_woken);
+  }
+}
 
 }  // namespace rtos
 }  // namespace sjsu
@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "L4_Testing/testing_frameworks.hpp"
+#include "utility/cobs.hpp"
+
+namespace sjsu
+{
+namespace
+{
+std::vector<uint8_t> Encode(const std::vector<uint8_t> & data)
+{
+  std::vector<uint8_t> encoded(cobs::MaxEncodedLength(data.size()));
+  encoded.resize(cobs::Encode(data.data(), data.size(), encoded.data()));
+  return encoded;
+}
+
+std::vector<uint8_t> Decode(const std::vector<uint8_t> & encoded)
+{
+  std::vector<uint8_t> data(encoded.size());
+  size_t length = 0;
+  CHECK(cobs::Decode(encoded.data(), encoded.size(), data.data(), &length) ==
+        Status::kSuccess);
+  data.resize(length);
+  return data;
+}
+
+/// Bytes first, first + 1, ... with length bytes in total, wrapping at 256
+std::vector<uint8_t> Counting(uint8_t first, size_t length)
+{
+  std::vector<uint8_t> bytes(length);
+  for (size_t i = 0; i < length; i++)
+  {
+    bytes[i] = static_cast<uint8_t>(first + i);
+  }
+  return bytes;
+}
+
+std::vector<uint8_t> Join(std::vector<uint8_t> front,
+                          const std::vector<uint8_t> & back)
+{
+  front.insert(front.end(), back.begin(), back.end());
+  return front;
+}
+
+constexpr uint8_t kConstantData[]    = { 0x11, 0x22, 0x00, 0x33 };
+constexpr uint8_t kConstantEncoded[] = { 0x03, 0x11, 0x22, 0x02, 0x33 };
+
+constexpr bool EncodesAtCompileTime()
+{
+  uint8_t encoded[cobs::MaxEncodedLength(sizeof(kConstantData))] = {};
+  size_t length = cobs::Encode(kConstantData, sizeof(kConstantData), encoded);
+  bool matches  = (length == sizeof(kConstantEncoded));
+  for (size_t i = 0; i < sizeof(kConstantEncoded) && matches; i++)
+  {
+    matches = (encoded[i] == kConstantEncoded[i]);
+  }
+  return matches;
+}
+static_assert(EncodesAtCompileTime());
+}  // namespace
+
+TEST_CASE("Testing COBS", "[cobs]")
+{
+  SECTION("Encode known vectors")
+  {
+    struct Vector_t
+    {
+      std::vector<uint8_t> data;
+      std::vector<uint8_t> encoded;
+    };
+    const std::vector<Vector_t> kVectors = {
+      { {}, { 0x01 } },
+      { { 0x00 }, { 0x01, 0x01 } },
+      { { 0x00, 0x00 }, { 0x01, 0x01, 0x01 } },
+      { { 0x11, 0x22, 0x00, 0x33 }, { 0x03, 0x11, 0x22, 0x02, 0x33 } },
+      { { 0x11, 0x22, 0x33, 0x44 }, { 0x05, 0x11, 0x22, 0x33, 0x44 } },
+      { { 0x11, 0x00, 0x00, 0x00 }, { 0x02, 0x11, 0x01, 0x01, 0x01 } },
+      // Runs of 254 non-zero bytes need a code byte of their own
+      { Counting(0x01, 254), Join({ 0xFF }, Counting(0x01, 254)) },
+      { Counting(0x00, 255), Join({ 0x01, 0xFF }, Counting(0x01, 254)) },
+      { Counting(0x01, 255),
+        Join(Join({ 0xFF }, Counting(0x01, 254)), { 0x02, 0xFF }) },
+      { Join(Counting(0x02, 254), { 0x00 }),
+        Join(Join({ 0xFF }, Counting(0x02, 254)), { 0x01, 0x01 }) },
+      { Join(Counting(0x03, 253), { 0x00, 0x01 }),
+        Join(Join({ 0xFE }, Counting(0x03, 253)), { 0x02, 0x01 }) },
+    };
+
+    for (const auto & vector : kVectors)
+    {
+      INFO("data length " << vector.data.size());
+      CHECK(Encode(vector.data) == vector.encoded);
+      CHECK(Decode(vector.encoded) == vector.data);
+      CHECK(vector.encoded.size() <=
+            cobs::MaxEncodedLength(vector.data.size()));
+    }
+  }
+  SECTION("Round trip without zero bytes in the encoding")
+  {
+    uint32_t state = 0x1234'5678;
+    for (size_t length = 0; length < 600; length += 7)
+    {
+      std::vector<uint8_t> data(length);
+      for (auto & byte : data)
+      {
+        state = state * 1'103'515'245 + 12'345;
+        // Plenty of zeros and long non-zero runs
+        byte = (state >> 28 == 0) ? 0 : static_cast<uint8_t>(state >> 16);
+      }
+
+      std::vector<uint8_t> encoded = Encode(data);
+      INFO("data length " << length);
+      CHECK(std::count(encoded.begin(), encoded.end(), 0) == 0);
+      CHECK(Decode(encoded) == data);
+    }
+  }
+  SECTION("Decode in place")
+  {
+    std::vector<uint8_t> buffer = { 0x03, 0x11, 0x22, 0x02, 0x33 };
+    size_t length               = 0;
+
+    CHECK(cobs::Decode(buffer.data(), buffer.size(), buffer.data(), &length) ==
+          Status::kSuccess);
+    buffer.resize(length);
+    CHECK(buffer == std::vector<uint8_t>{ 0x11, 0x22, 0x00, 0x33 });
+  }
+  SECTION("Reject bytes that Encode could not have made")
+  {
+    const std::vector<std::vector<uint8_t>> kCorrupt = {
+      // Zero code byte
+      { 0x00 },
+      { 0x02, 0x11, 0x00 },
+      // Zero inside a run
+      { 0x03, 0x11, 0x00 },
+      // Run longer than the data
+      { 0x05, 0x11, 0x22 },
+    };
+    for (const auto & encoded : kCorrupt)
+    {
+      uint8_t output[8];
+      size_t length = 0xFFFF;
+      CHECK(cobs::Decode(encoded.data(), encoded.size(), output, &length) ==
+            Status::kBusError);
+      CHECK(length == 0xFFFF);
+    }
+  }
+}
+}  // namespace sjsu
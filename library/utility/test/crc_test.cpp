@@ -0,0 +1,142 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "L4_Testing/testing_frameworks.hpp"
+#include "utility/crc.hpp"
+
+namespace sjsu
+{
+namespace
+{
+constexpr uint8_t kCheckMessage[] = { '1', '2', '3', '4', '5',
+                                      '6', '7', '8', '9' };
+
+std::vector<uint8_t> PseudoRandomBytes(size_t length)
+{
+  std::vector<uint8_t> bytes(length);
+  uint32_t state = 0x1234'5678;
+  for (auto & byte : bytes)
+  {
+    state = state * 1'103'515'245 + 12'345;
+    byte  = static_cast<uint8_t>(state >> 16);
+  }
+  return bytes;
+}
+
+/// Checks that every kernel gives the same register for every length and
+/// alignment, and that feeding the data in pieces does not change the result.
+template <typename Crc>
+void CheckKernelsAgree()
+{
+  auto data = PseudoRandomBytes(64);
+  for (size_t offset = 0; offset < 8; offset++)
+  {
+    for (size_t length = 0; offset + length <= data.size(); length++)
+    {
+      const uint8_t * start = &data[offset];
+      auto expected = Crc::Slice1(Crc::kInitialRegister, start, length);
+      CHECK(Crc::Slice4(Crc::kInitialRegister, start, length) == expected);
+      CHECK(Crc::Slice8(Crc::kInitialRegister, start, length) == expected);
+
+      size_t half   = length / 2;
+      auto streamed = Crc::Slice8(Crc::kInitialRegister, start, half);
+      streamed      = Crc::Slice4(streamed, start + half, length - half);
+      CHECK(streamed == expected);
+    }
+  }
+}
+
+template <typename Kernel>
+void Benchmark(const char * name, Kernel kernel)
+{
+  // Enough SD card blocks to run for a measurable amount of time
+  constexpr size_t kBlockSize  = 512;
+  constexpr size_t kIterations = 20'000;
+  auto block                   = PseudoRandomBytes(kBlockSize);
+
+  uint32_t sink = 0;
+  auto start    = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < kIterations; i++)
+  {
+    sink += kernel(block.data(), block.size());
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  double seconds = std::chrono::duration<double>(end - start).count();
+  double megabytes_per_second =
+      (kBlockSize * kIterations) / seconds / 1'000'000.0;
+  printf("  %-22s %9.1f MB/s (0x%08X)\n", name, megabytes_per_second,
+         static_cast<unsigned>(sink));
+}
+}  // namespace
+
+TEST_CASE("Testing CRC", "[crc]")
+{
+  SECTION("Check values")
+  {
+    // CRC-7/MMC, CRC-16/XMODEM, CRC-16/ARC and CRC-32 of "123456789"
+    static_assert(crc::Crc7::Calculate(kCheckMessage, 9) == 0x75);
+    static_assert(crc::Crc16Ccitt::Calculate(kCheckMessage, 9) == 0x31C3);
+    static_assert(crc::Crc16::Calculate(kCheckMessage, 9) == 0xBB3D);
+    static_assert(crc::Crc32::Calculate(kCheckMessage, 9) == 0xCBF4'3926);
+    CHECK(crc::Crc7::Calculate(kCheckMessage, 9) == 0x75);
+    CHECK(crc::Crc16Ccitt::Calculate(kCheckMessage, 9) == 0x31C3);
+    CHECK(crc::Crc16::Calculate(kCheckMessage, 9) == 0xBB3D);
+    CHECK(crc::Crc32::Calculate(kCheckMessage, 9) == 0xCBF4'3926);
+  }
+  SECTION("SD card command frame")
+  {
+    // CMD0 and CMD8 frames end with the CRC7 bytes 0x95 and 0x87
+    constexpr uint8_t kReset[]        = { 0x40, 0x00, 0x00, 0x00, 0x00 };
+    constexpr uint8_t kVoltageCheck[] = { 0x48, 0x00, 0x00, 0x01, 0xAA };
+    CHECK(((crc::Crc7::Calculate(kReset, 5) << 1) | 1) == 0x95);
+    CHECK(((crc::Crc7::Calculate(kVoltageCheck, 5) << 1) | 1) == 0x87);
+  }
+  SECTION("Kernels agree")
+  {
+    CheckKernelsAgree<crc::Crc7>();
+    CheckKernelsAgree<crc::Crc16Ccitt>();
+    CheckKernelsAgree<crc::Crc16>();
+    CheckKernelsAgree<crc::Crc32>();
+  }
+}
+
+// Hidden from the regular test run. Run with: test.exe "[crc-benchmark]"
+TEST_CASE("Benchmark CRC kernels", "[.][crc-benchmark]")
+{
+  printf("CRC throughput over a 512 byte block:\n");
+  Benchmark("CRC-16 bitwise", [](const uint8_t * data, size_t length) {
+    uint16_t crc = 0;
+    for (size_t i = 0; i < length; i++)
+    {
+      crc = static_cast<uint16_t>(crc ^ (data[i] << 8));
+      for (int bit = 0; bit < 8; bit++)
+      {
+        crc = static_cast<uint16_t>((crc & 0x8000) ? (crc << 1) ^ 0x1021
+                                                   : (crc << 1));
+      }
+    }
+    return uint32_t{ crc };
+  });
+  Benchmark("CRC-16 slice-by-1", [](const uint8_t * data, size_t length) {
+    return uint32_t{ crc::Crc16Ccitt::Slice1(0, data, length) };
+  });
+  Benchmark("CRC-16 slice-by-4", [](const uint8_t * data, size_t length) {
+    return uint32_t{ crc::Crc16Ccitt::Slice4(0, data, length) };
+  });
+  Benchmark("CRC-16 slice-by-8", [](const uint8_t * data, size_t length) {
+    return uint32_t{ crc::Crc16Ccitt::Slice8(0, data, length) };
+  });
+  Benchmark("CRC-32 slice-by-1", [](const uint8_t * data, size_t length) {
+    return crc::Crc32::Slice1(crc::Crc32::kInitialRegister, data, length);
+  });
+  Benchmark("CRC-32 slice-by-4", [](const uint8_t * data, size_t length) {
+    return crc::Crc32::Slice4(crc::Crc32::kInitialRegister, data, length);
+  });
+  Benchmark("CRC-32 slice-by-8", [](const uint8_t * data, size_t length) {
+    return crc::Crc32::Slice8(crc::Crc32::kInitialRegister, data, length);
+  });
+}
+}  // namespace sjsu
@@ -1,11 +1,153 @@
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
 #include <cstdint>
+#include <cstdio>
 #include <cstring>
+#include <vector>
 
+#include "L4_Testing/ram_disk.hpp"
 #include "L4_Testing/testing_frameworks.hpp"
 #include "utility/fatfs.hpp"
+#include "utility/rtos.hpp"
 
 namespace sjsu
 {
+namespace
+{
+constexpr size_t kSectorSize = FF_MAX_SS;
+
+QueueHandle_t CreateMutexStatic(uint8_t, StaticQueue_t * buffer)
+{
+  return reinterpret_cast<QueueHandle_t>(buffer);
+}
+
+/// A freshly formatted FAT volume on a RAM disk, mounted as the default drive.
+/// The scheduler is reported as not started, so FatFs does not lock it.
+struct Volume
+{
+  explicit Volume(DWORD cluster_size, uint32_t sector_count = 8192)
+      : disk(sector_count)
+  {
+    RESET_FAKE(xTaskGetSchedulerState);
+    RESET_FAKE(xQueueCreateMutexStatic);
+    RESET_FAKE(xQueueSemaphoreTake);
+    RESET_FAKE(xQueueGenericSend);
+    RESET_FAKE(vTaskSuspendAll);
+    RESET_FAKE(xTaskResumeAll);
+    xTaskGetSchedulerState_fake.return_val = taskSCHEDULER_NOT_STARTED;
+    xQueueCreateMutexStatic_fake.custom_fake = CreateMutexStatic;
+
+    uint8_t work[kSectorSize];
+    REQUIRE(f_mkfs("", FM_ANY | FM_SFD, cluster_size, work, sizeof(work)) ==
+            FR_OK);
+    REQUIRE(f_mount(&fat_fs, "", 1) == FR_OK);
+    disk.ResetStatistics();
+  }
+  ~Volume()
+  {
+    f_mount(nullptr, "", 0);
+  }
+
+  RamDisk disk;
+  FATFS fat_fs;
+};
+
+/// Stands in for the volume mutex, and counts disk accesses made while it was
+/// not held.
+struct VolumeMutex
+{
+  static BaseType_t Take(QueueHandle_t, TickType_t)
+  {
+    const auto & statistics = disk->GetStatistics();
+    unlocked_accesses += (statistics.reads + statistics.writes) - released_at;
+    CHECK(!is_held);
+    is_held = true;
+    return pdTRUE;
+  }
+  static BaseType_t Give(QueueHandle_t, const void *, TickType_t, BaseType_t)
+  {
+    const auto & statistics = disk->GetStatistics();
+    released_at = statistics.reads + statistics.writes;
+    CHECK(is_held);
+    is_held = false;
+    return pdTRUE;
+  }
+
+  inline static const RamDisk * disk       = nullptr;
+  inline static bool is_held               = false;
+  inline static uint32_t released_at       = 0;
+  inline static uint32_t unlocked_accesses = 0;
+};
+
+std::vector<uint8_t> PseudoRandomBytes(size_t length)
+{
+  std::vector<uint8_t> bytes(length);
+  uint32_t state = 0x1234'5678;
+  for (auto & byte : bytes)
+  {
+    state = state * 1'103'515'245 + 12'345;
+    byte  = static_cast<uint8_t>(state >> 16);
+  }
+  return bytes;
+}
+
+std::vector<uint8_t> ReadBack(const char * path)
+{
+  FIL file;
+  REQUIRE(f_open(&file, path, FA_READ) == FR_OK);
+  std::vector<uint8_t> contents(f_size(&file));
+  UINT read = 0;
+  CHECK(f_read(&file, contents.data(), static_cast<UINT>(contents.size()),
+               &read) == FR_OK);
+  CHECK(read == contents.size());
+  f_close(&file);
+  return contents;
+}
+
+/// Write data to path in pieces of record_size bytes
+void WriteRecords(File<> & file,
+                  const char * path,
+                  const std::vector<uint8_t> & data,
+                  size_t record_size)
+{
+  REQUIRE(file.Open(path, FA_CREATE_ALWAYS | FA_WRITE) == FR_OK);
+  for (size_t i = 0; i < data.size(); i += record_size)
+  {
+    size_t length  = std::min(record_size, data.size() - i);
+    size_t written = 0;
+    REQUIRE(file.Write(&data[i], length, &written) == FR_OK);
+    REQUIRE(written == length);
+  }
+  REQUIRE(file.Close() == FR_OK);
+}
+
+/// Make two files whose clusters alternate across the volume, so that every
+/// cluster of each is a separate fragment.
+void WriteInterleaved(const char * first_path,
+                      const char * second_path,
+                      size_t clusters,
+                      size_t cluster_size)
+{
+  FIL first;
+  FIL second;
+  REQUIRE(f_open(&first, first_path, FA_CREATE_ALWAYS | FA_WRITE) == FR_OK);
+  REQUIRE(f_open(&second, second_path, FA_CREATE_ALWAYS | FA_WRITE) == FR_OK);
+  std::vector<uint8_t> cluster(cluster_size);
+  for (size_t i = 0; i < clusters; i++)
+  {
+    UINT written;
+    memset(cluster.data(), static_cast<int>(i), cluster.size());
+    REQUIRE(f_write(&first, cluster.data(), static_cast<UINT>(cluster.size()),
+                    &written) == FR_OK);
+    REQUIRE(f_write(&second, cluster.data(), static_cast<UINT>(cluster.size()),
+                    &written) == FR_OK);
+  }
+  f_close(&first);
+  f_close(&second);
+}
+}  // namespace
+
 TEST_CASE("Testing FatFS Utility", "[fatfs-utility]")
 {
   SECTION("ToString")
@@ -53,4 +195,289 @@ TEST_CASE("Testing FatFS Utility", "[fatfs-utility]")
                       "(19) Given parameter is invalid"));
   }
 }
+
+TEST_CASE("Testing FatFS buffered file", "[fatfs-utility]")
+{
+  Volume volume(4 * kSectorSize);
+  File<> file;
+
+  SECTION("Small writes are combined into whole sector writes")
+  {
+    auto data = PseudoRandomBytes(20'000);
+
+    WriteRecords(file, "records.bin", data, 10);
+    auto buffered_statistics = volume.disk.GetStatistics();
+    volume.disk.ResetStatistics();
+
+    FIL raw;
+    REQUIRE(f_open(&raw, "raw.bin", FA_CREATE_ALWAYS | FA_WRITE) == FR_OK);
+    for (size_t i = 0; i < data.size(); i += 10)
+    {
+      UINT written;
+      REQUIRE(f_write(&raw, &data[i], 10, &written) == FR_OK);
+    }
+    f_close(&raw);
+    auto raw_statistics = volume.disk.GetStatistics();
+
+    CHECK(ReadBack("records.bin") == data);
+    CHECK(ReadBack("raw.bin") == data);
+    CHECK(buffered_statistics.writes * 3 < raw_statistics.writes);
+  }
+  SECTION("Unaligned writes stay sector aligned after the first flush")
+  {
+    auto data = PseudoRandomBytes(10'000);
+    REQUIRE(file.Open("odd.bin", FA_CREATE_ALWAYS | FA_WRITE) == FR_OK);
+    REQUIRE(file.Write(data.data(), 100) == FR_OK);
+    REQUIRE(file.Sync() == FR_OK);
+    volume.disk.ResetStatistics();
+
+    for (size_t i = 100; i < data.size(); i += 300)
+    {
+      REQUIRE(file.Write(&data[i], std::min<size_t>(300, data.size() - i)) ==
+              FR_OK);
+      CHECK(file.Tell() == std::min<size_t>(i + 300, data.size()));
+    }
+    CHECK(file.Size() == data.size());
+    REQUIRE(file.Close() == FR_OK);
+
+    CHECK(ReadBack("odd.bin") == data);
+    // Each 2 KiB flush is a single transfer
+    CHECK(volume.disk.GetStatistics().writes <= 2 * (data.size() / 2048) + 4);
+  }
+  SECTION("Large aligned writes bypass the buffer")
+  {
+    auto data = PseudoRandomBytes(64 * kSectorSize);
+    REQUIRE(file.Open("large.bin", FA_CREATE_ALWAYS | FA_WRITE) == FR_OK);
+    volume.disk.ResetStatistics();
+    size_t written = 0;
+
+    REQUIRE(file.Write(data.data(), data.size(), &written) == FR_OK);
+
+    CHECK(written == data.size());
+    CHECK(file.GetBuffered() == 0);
+    // One transfer per cluster, plus the directory sector FatFs writes back
+    // when it first moves its window to the FAT
+    CHECK(volume.disk.GetStatistics().writes <= 17);
+    CHECK(volume.disk.GetStatistics().sectors_written <= 65);
+    REQUIRE(file.Close() == FR_OK);
+    CHECK(ReadBack("large.bin") == data);
+  }
+  SECTION("Reads and seeks see buffered data")
+  {
+    auto data = PseudoRandomBytes(1000);
+    REQUIRE(file.Open("mixed.bin", FA_CREATE_ALWAYS | FA_WRITE | FA_READ) ==
+            FR_OK);
+    REQUIRE(file.Write(data.data(), data.size()) == FR_OK);
+    CHECK(file.GetBuffered() == data.size());
+
+    uint8_t readback[100];
+    size_t read = 0;
+    REQUIRE(file.Seek(500) == FR_OK);
+    REQUIRE(file.Read(readback, sizeof(readback), &read) == FR_OK);
+
+    CHECK(read == sizeof(readback));
+    CHECK(0 == memcmp(readback, &data[500], sizeof(readback)));
+    CHECK(file.GetBuffered() == 0);
+    CHECK(file.Size() == data.size());
+  }
+  SECTION("Writes stop when the volume is full")
+  {
+    auto data = PseudoRandomBytes(8192 * kSectorSize);
+    REQUIRE(file.Open("full.bin", FA_CREATE_ALWAYS | FA_WRITE) == FR_OK);
+    size_t written = 0;
+
+    CHECK(file.Write(data.data(), data.size(), &written) == FR_DENIED);
+
+    CHECK(written < data.size());
+    CHECK(file.Tell() == written);
+  }
+}
+
+TEST_CASE("Testing FatFS volume locking", "[fatfs-utility]")
+{
+  Volume volume(4 * kSectorSize);
+  auto data = PseudoRandomBytes(8 * kSectorSize);
+  FIL file;
+  UINT written;
+
+  SECTION("The volume is not locked before the scheduler starts")
+  {
+    REQUIRE(f_open(&file, "early.bin", FA_CREATE_ALWAYS | FA_WRITE) == FR_OK);
+    CHECK(f_write(&file, data.data(), static_cast<UINT>(data.size()),
+                  &written) == FR_OK);
+    CHECK(f_close(&file) == FR_OK);
+
+    CHECK(xQueueCreateMutexStatic_fake.call_count == 0);
+    CHECK(xQueueSemaphoreTake_fake.call_count == 0);
+    CHECK(xQueueGenericSend_fake.call_count == 0);
+  }
+  SECTION("Each call holds the volume while it touches the disk")
+  {
+    xTaskGetSchedulerState_fake.return_val = taskSCHEDULER_RUNNING;
+    xQueueSemaphoreTake_fake.custom_fake   = VolumeMutex::Take;
+    xQueueGenericSend_fake.custom_fake     = VolumeMutex::Give;
+    VolumeMutex::disk                      = &volume.disk;
+    VolumeMutex::released_at               = 0;
+    VolumeMutex::unlocked_accesses         = 0;
+
+    REQUIRE(f_open(&file, "locked.bin", FA_CREATE_ALWAYS | FA_WRITE) == FR_OK);
+    CHECK(f_write(&file, data.data(), static_cast<UINT>(data.size()),
+                  &written) == FR_OK);
+    CHECK(f_close(&file) == FR_OK);
+    CHECK(ReadBack("locked.bin") == data);
+
+    CHECK(!VolumeMutex::is_held);
+    CHECK(VolumeMutex::unlocked_accesses == 0);
+    CHECK(xQueueSemaphoreTake_fake.call_count ==
+          xQueueGenericSend_fake.call_count);
+    CHECK(xQueueSemaphoreTake_fake.call_count >= 5);
+    CHECK(xQueueSemaphoreTake_fake.arg1_val == FF_FS_TIMEOUT);
+    CHECK(xQueueCreateMutexStatic_fake.call_count == 1);
+    CHECK(vTaskSuspendAll_fake.call_count == 1);
+    CHECK(xTaskResumeAll_fake.call_count == 1);
+  }
+  SECTION("Calls time out if the volume stays locked")
+  {
+    xTaskGetSchedulerState_fake.return_val = taskSCHEDULER_RUNNING;
+    xQueueSemaphoreTake_fake.return_val    = pdFALSE;
+
+    CHECK(f_open(&file, "late.bin", FA_CREATE_ALWAYS | FA_WRITE) ==
+          FR_TIMEOUT);
+    CHECK(xQueueGenericSend_fake.call_count == 0);
+  }
+  SECTION("A file open for writing cannot be opened again")
+  {
+    FIL second;
+    REQUIRE(f_open(&file, "shared.bin", FA_CREATE_ALWAYS | FA_WRITE) == FR_OK);
+
+    CHECK(f_open(&second, "shared.bin", FA_READ) == FR_LOCKED);
+    CHECK(f_unlink("shared.bin") == FR_LOCKED);
+    CHECK(f_close(&file) == FR_OK);
+    CHECK(f_open(&second, "shared.bin", FA_READ) == FR_OK);
+    CHECK(f_close(&second) == FR_OK);
+  }
+}
+
+TEST_CASE("Testing FatFS fast seek", "[fatfs-utility]")
+{
+  constexpr size_t kClusters = 1024;
+  Volume volume(kSectorSize);
+  WriteInterleaved("first.bin", "second.bin", kClusters, kSectorSize);
+  File<> file;
+  REQUIRE(file.Open("first.bin", FA_READ | FA_WRITE) == FR_OK);
+
+  SECTION("A table that is too small reports the size it needs")
+  {
+    DWORD table[16];
+
+    CHECK(file.EnableFastSeek(table) == FR_NOT_ENOUGH_CORE);
+
+    CHECK(table[0] == 2 * (kClusters + 1));
+    CHECK(file.GetFil()->cltbl == nullptr);
+  }
+  SECTION("Seeks do not read the FAT")
+  {
+    std::vector<DWORD> table(2 * (kClusters + 1));
+    REQUIRE(file.Seek(kClusters * kSectorSize - 1) == FR_OK);
+    volume.disk.ResetStatistics();
+    REQUIRE(file.Seek(0) == FR_OK);
+    REQUIRE(file.Seek(kClusters * kSectorSize - 1) == FR_OK);
+    uint32_t chain_reads = volume.disk.GetStatistics().reads;
+
+    REQUIRE(file.EnableFastSeek(table.data(), table.size()) == FR_OK);
+    volume.disk.ResetStatistics();
+    REQUIRE(file.Seek(0) == FR_OK);
+    REQUIRE(file.Seek(kClusters * kSectorSize - 1) == FR_OK);
+    uint8_t byte  = 0;
+    size_t read   = 0;
+    REQUIRE(file.Read(&byte, 1, &read) == FR_OK);
+
+    CHECK(chain_reads > 2);
+    // At most the sector being read
+    CHECK(volume.disk.GetStatistics().reads <= 1);
+    CHECK(byte == static_cast<uint8_t>(kClusters - 1));
+  }
+  SECTION("Random reads match the data written")
+  {
+    std::vector<DWORD> table(2 * (kClusters + 1));
+    REQUIRE(file.EnableFastSeek(table.data(), table.size()) == FR_OK);
+    for (size_t cluster : { 7, 1000, 3, 512, 1023, 0 })
+    {
+      uint8_t bytes[4];
+      size_t read = 0;
+      REQUIRE(file.Seek(static_cast<FSIZE_t>(cluster * kSectorSize + 100)) ==
+              FR_OK);
+      REQUIRE(file.Read(bytes, sizeof(bytes), &read) == FR_OK);
+      CHECK(read == sizeof(bytes));
+      CHECK(bytes[0] == static_cast<uint8_t>(cluster));
+      CHECK(bytes[3] == static_cast<uint8_t>(cluster));
+    }
+    CHECK(file.DisableFastSeek() == FR_OK);
+    CHECK(file.GetFil()->cltbl == nullptr);
+  }
+}
+
+TEST_CASE("Benchmark FatFS buffered file", "[.][fatfs-benchmark]")
+{
+  constexpr size_t kClusters = 2048;
+  auto data                  = PseudoRandomBytes(512 * 1024);
+
+  printf("Writing 512 KiB in 16 byte records:\n");
+  for (bool buffered : { false, true })
+  {
+    Volume volume(8 * kSectorSize);
+    File<> file;
+    FIL raw;
+    volume.disk.ResetStatistics();
+    auto start = std::chrono::steady_clock::now();
+    if (buffered)
+    {
+      WriteRecords(file, "bench.bin", data, 16);
+    }
+    else
+    {
+      REQUIRE(f_open(&raw, "bench.bin", FA_CREATE_ALWAYS | FA_WRITE) ==
+              FR_OK);
+      for (size_t i = 0; i < data.size(); i += 16)
+      {
+        UINT written;
+        REQUIRE(f_write(&raw, &data[i], 16, &written) == FR_OK);
+      }
+      f_close(&raw);
+    }
+    auto end       = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+    printf("  %-22s %9.1f MB/s %6" PRIu32 " disk writes\n",
+           buffered ? "File<2048>" : "f_write",
+           static_cast<double>(data.size()) / seconds / 1e6,
+           volume.disk.GetStatistics().writes);
+  }
+
+  Volume volume(kSectorSize);
+  WriteInterleaved("first.bin", "second.bin", kClusters, kSectorSize);
+  printf("1000 random seeks in a file of %zu fragments:\n", kClusters);
+  for (bool fast_seek : { false, true })
+  {
+    File<> file;
+    std::vector<DWORD> table(2 * (kClusters + 1));
+    REQUIRE(file.Open("first.bin", FA_READ) == FR_OK);
+    if (fast_seek)
+    {
+      REQUIRE(file.EnableFastSeek(table.data(), table.size()) == FR_OK);
+    }
+    volume.disk.ResetStatistics();
+    uint32_t state = 1;
+    auto start     = std::chrono::steady_clock::now();
+    for (int i = 0; i < 1000; i++)
+    {
+      state = state * 1'103'515'245 + 12'345;
+      REQUIRE(file.Seek((state >> 8) % (kClusters * kSectorSize)) == FR_OK);
+    }
+    auto end       = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+    printf("  %-22s %9.2f us/seek %6" PRIu32 " disk reads\n",
+           fast_seek ? "fast seek" : "FAT chain", seconds * 1e3,
+           volume.disk.GetStatistics().reads);
+  }
+}
 }  // namespace sjsu
@@ -0,0 +1,82 @@
+#include <cstdint>
+
+#include "L4_Testing/testing_frameworks.hpp"
+#include "utility/ring_buffer.hpp"
+
+namespace sjsu
+{
+TEST_CASE("Testing single producer single consumer ring buffer",
+          "[ring-buffer]")
+{
+  RingBuffer<uint8_t, 8> buffer;
+
+  SECTION("Starts empty")
+  {
+    uint8_t value = 0x55;
+
+    CHECK(buffer.IsEmpty());
+    CHECK(buffer.Size() == 0);
+    CHECK(!buffer.Pop(&value));
+    CHECK(value == 0x55);
+  }
+  SECTION("Elements come out in the order they went in")
+  {
+    for (uint8_t i = 0; i < 5; i++)
+    {
+      REQUIRE(buffer.Push(i));
+    }
+    CHECK(buffer.Size() == 5);
+    for (uint8_t i = 0; i < 5; i++)
+    {
+      uint8_t value;
+      REQUIRE(buffer.Pop(&value));
+      CHECK(value == i);
+    }
+    CHECK(buffer.IsEmpty());
+  }
+  SECTION("Push fails once the buffer is full")
+  {
+    for (uint8_t i = 0; i < decltype(buffer)::Capacity(); i++)
+    {
+      REQUIRE(buffer.Push(i));
+    }
+
+    CHECK(buffer.IsFull());
+    CHECK(!buffer.Push(0xFF));
+    uint8_t value;
+    REQUIRE(buffer.Pop(&value));
+    CHECK(value == 0);
+  }
+  SECTION("Block push and pop are cut short at the buffer limits")
+  {
+    const uint8_t kValues[12] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+    uint8_t values[12]        = { 0 };
+
+    CHECK(buffer.Push(kValues, 3) == 3);
+    CHECK(buffer.Push(kValues + 3, 9) == 5);
+    CHECK(buffer.Pop(values, 6) == 6);
+    CHECK(buffer.Push(kValues + 8, 4) == 4);
+    CHECK(buffer.Pop(values + 6, 12) == 6);
+
+    for (uint8_t i = 0; i < 8; i++)
+    {
+      CHECK(values[i] == i);
+    }
+    CHECK(values[8] == 8);
+    CHECK(values[11] == 11);
+  }
+  SECTION("Indices wrap around the storage")
+  {
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+      REQUIRE(buffer.Push(static_cast<uint8_t>(i)));
+      REQUIRE(buffer.Push(static_cast<uint8_t>(i + 1)));
+      uint8_t value;
+      REQUIRE(buffer.Pop(&value));
+      CHECK(value == static_cast<uint8_t>(i));
+      REQUIRE(buffer.Pop(&value));
+    }
+    CHECK(buffer.IsEmpty());
+  }
+}
+}  // namespace sjsu
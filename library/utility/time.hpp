@@ -14,7 +14,7 @@ using UptimeFunction = std::chrono::microseconds (*)();
 /// @returns the maximum possible delay time
 constexpr std::chrono::microseconds MaxDelay()
 {
-  return std::chrono::duration_values<std::chrono::microseconds>::max();
+  return std::chrono::microseconds::max();
 }
 
 inline std::chrono::microseconds DefaultUptime()
@@ -41,7 +41,10 @@ template <typename F>
 template <typename F>
 inline Status Wait(std::chrono::microseconds timeout, F is_done)
 {
-  std::chrono::microseconds timeout_time = Uptime() + timeout;
+  std::chrono::microseconds now = Uptime();
+  // Saturate rather than overflow, so that MaxDelay() waits forever
+  std::chrono::microseconds timeout_time =
+      (timeout < MaxDelay() - now) ? now + timeout : MaxDelay();
 
   Status status = Status::kTimedOut;
   while (Uptime() < timeout_time)
@@ -2,10 +2,13 @@ INCLUDES +=
 SYSTEM_INCLUDES +=
 SOURCES +=
 TESTS += $(LIBRARY_DIR)/utility/test/bit_test.cpp
+TESTS += $(LIBRARY_DIR)/utility/test/cobs_test.cpp
 TESTS += $(LIBRARY_DIR)/utility/test/constexpr_test.cpp
+TESTS += $(LIBRARY_DIR)/utility/test/crc_test.cpp
 TESTS += $(LIBRARY_DIR)/utility/test/debug_test.cpp
 TESTS += $(LIBRARY_DIR)/utility/test/enum_test.cpp
 TESTS += $(LIBRARY_DIR)/utility/test/fatfs_test.cpp
 TESTS += $(LIBRARY_DIR)/utility/test/map_test.cpp
+TESTS += $(LIBRARY_DIR)/utility/test/ring_buffer_test.cpp
 TESTS += $(LIBRARY_DIR)/utility/test/stopwatch_test.cpp
 TESTS += $(LIBRARY_DIR)/utility/math/test/average_test.cpp
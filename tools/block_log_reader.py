@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+"""Extract the records of a BlockLog (library/L2_HAL/memory/block_log.hpp)
+from an image of an SD card, such as one made with:
+
+    dd if=/dev/sdX of=card.img bs=512
+
+The payloads are written to the output file oldest first, and a summary of
+the log, including any records missing from it, is printed.
+"""
+
+import argparse
+import struct
+import sys
+import zlib
+
+BLOCK_SIZE = 512
+MAGIC = 0x4C424A53
+HEADER = struct.Struct('<IIHH')
+PAYLOAD_SIZE = BLOCK_SIZE - HEADER.size - 4
+
+
+def parse_record(block, index, block_count):
+    """Return (sequence, payload) if block holds a valid record for the index
+    it was read from, otherwise None."""
+    magic, sequence, length, _ = HEADER.unpack_from(block)
+    (crc,) = struct.unpack_from('<I', block, BLOCK_SIZE - 4)
+    if (magic != MAGIC or length > PAYLOAD_SIZE or
+            sequence % block_count != index or
+            zlib.crc32(block[:BLOCK_SIZE - 4]) != crc):
+        return None
+    return sequence, block[HEADER.size:HEADER.size + length]
+
+
+def read_log(image, first_block, block_count):
+    """Return the valid records of the region as (sequence, payload) pairs,
+    sorted by sequence number."""
+    records = []
+    image.seek(first_block * BLOCK_SIZE)
+    for index in range(block_count):
+        block = image.read(BLOCK_SIZE)
+        if len(block) < BLOCK_SIZE:
+            break
+        record = parse_record(block, index, block_count)
+        if record is not None:
+            records.append(record)
+    # Sequence numbers go back to 0 after the largest multiple of block_count
+    # that fits in 32 bits. If the log went past that point, the records
+    # numbered from 0 again are the newest.
+    limit = (1 << 32) // block_count * block_count
+    sequences = [sequence for sequence, _ in records]
+    if (any(sequence < block_count for sequence in sequences) and
+            any(sequence >= limit - block_count for sequence in sequences)):
+        records = [(sequence + limit if sequence < block_count else sequence,
+                    payload) for sequence, payload in records]
+    records.sort()
+    return records
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('image', help='image of the card')
+    parser.add_argument('--first-block', type=int, default=0,
+                        help='first block of the log region')
+    parser.add_argument('--block-count', type=int, default=None,
+                        help='number of blocks in the log region, defaults '
+                             'to the rest of the image')
+    parser.add_argument('-o', '--output', default=None,
+                        help='file to write the payloads to')
+    args = parser.parse_args()
+
+    with open(args.image, 'rb') as image:
+        block_count = args.block_count
+        if block_count is None:
+            image.seek(0, 2)
+            block_count = image.tell() // BLOCK_SIZE - args.first_block
+        if block_count <= 0:
+            sys.exit('The log region is empty')
+        records = read_log(image, args.first_block, block_count)
+
+    if not records:
+        print('No records found')
+        return
+
+    # Only the newest pass through the ring and the rest of the one before
+    # it survive, so anything older than a full ring back was overwritten.
+    newest = records[-1][0]
+    records = [r for r in records if newest - r[0] < block_count]
+    expected = newest - records[0][0] + 1
+    print('Records %d to %d: %d found, %d missing' %
+          (records[0][0], newest, len(records), expected - len(records)))
+
+    if args.output is not None:
+        with open(args.output, 'wb') as output:
+            for _, payload in records:
+                output.write(payload)
+
+
+if __name__ == '__main__':
+    main()
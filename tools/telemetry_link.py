@@ -0,0 +1,195 @@
+#!/usr/bin/env python3
+"""Decode the output of a TelemetryLink and send it commands.
+
+See library/L3_Application/telemetry_link.hpp for the frame layout.
+
+Text printed by the board is passed through as is, once the frame after it
+starts. Frames are printed one per line, with telemetry unpacked when its
+layout is given with --format, such as:
+
+    telemetry_link.py --port /dev/ttyUSB0 --format 1=Hf
+
+for id 1 being struct { uint16_t counts; float angle; } [[gnu::packed]].
+The layout uses the characters of Python's struct module, little endian and
+without padding.
+
+With --command, the command line is sent to the board, and the decoder exits
+once the command's return code comes back.
+"""
+
+import argparse
+import binascii
+import struct
+import sys
+
+DELIMITER = 0
+CHANNEL_LOG = 0
+CHANNEL_TELEMETRY = 1
+CHANNEL_REQUEST = 2
+CHANNEL_RESPONSE = 3
+MAX_RUN = 254
+
+
+def crc16(data):
+    """CRC16 CCITT with an initial value of zero (XMODEM), the same as
+    crc::Crc16Ccitt."""
+    return binascii.crc_hqx(data, 0)
+
+
+def cobs_encode(data):
+    encoded = bytearray()
+    run = bytearray()
+    for byte in data:
+        if byte != 0:
+            run.append(byte)
+        if byte == 0 or len(run) == MAX_RUN:
+            encoded.append(len(run) + 1)
+            encoded += run
+            run = bytearray()
+    # A full run that ends the data needs no code byte after it.
+    if run or not data or data[-1] == 0:
+        encoded.append(len(run) + 1)
+        encoded += run
+    return bytes(encoded)
+
+
+def cobs_decode(encoded):
+    """Return the decoded bytes, or None if they could not have come from
+    cobs_encode()."""
+    data = bytearray()
+    position = 0
+    while position < len(encoded):
+        code = encoded[position]
+        position += 1
+        run = encoded[position:position + code - 1]
+        if code == 0 or len(run) != code - 1 or DELIMITER in run:
+            return None
+        data += run
+        position += code - 1
+        if code != MAX_RUN + 1 and position < len(encoded):
+            data.append(0)
+    return bytes(data)
+
+
+def parse_frame(segment):
+    """Return (channel, sequence, payload) if the bytes between two delimiters
+    make a frame with a good CRC, otherwise None."""
+    frame = cobs_decode(segment)
+    if frame is None or len(frame) < 4:
+        return None
+    (crc,) = struct.unpack_from('<H', frame, len(frame) - 2)
+    if crc16(frame[:-2]) != crc:
+        return None
+    return frame[0], frame[1], frame[2:-2]
+
+
+def make_request(request_id, line, sequence=0):
+    frame = bytes([CHANNEL_REQUEST, sequence, request_id]) + line.encode()
+    frame += struct.pack('<H', crc16(frame))
+    return bytes([DELIMITER]) + cobs_encode(frame) + bytes([DELIMITER])
+
+
+class Decoder:
+    """Splits a byte stream into text and frames."""
+
+    def __init__(self, formats):
+        self.formats = formats
+        self.segment = bytearray()
+        self.sequence = None
+        self.missing = 0
+
+    def feed(self, data):
+        """Yield (channel, payload) for each frame completed by data, and
+        (None, text) for everything else."""
+        for byte in data:
+            if byte != DELIMITER:
+                self.segment.append(byte)
+                continue
+            if self.segment:
+                yield self.finish(bytes(self.segment))
+            self.segment = bytearray()
+
+    def finish(self, segment):
+        frame = parse_frame(segment)
+        if frame is None:
+            return None, segment
+        channel, sequence, payload = frame
+        if self.sequence is not None:
+            self.missing += (sequence - self.sequence - 1) % 256
+        self.sequence = sequence
+        return channel, payload
+
+    def describe(self, channel, payload):
+        if channel == CHANNEL_LOG:
+            return '[log] ' + payload.decode(errors='replace')
+        if channel == CHANNEL_TELEMETRY and payload:
+            layout = self.formats.get(payload[0])
+            if (layout is not None and
+                    struct.calcsize(layout) == len(payload) - 1):
+                values = struct.unpack(layout, payload[1:])
+                return '[telemetry %d] %s' % (
+                    payload[0], ' '.join(str(value) for value in values))
+            return '[telemetry %d] %s' % (payload[0], payload[1:].hex())
+        if channel == CHANNEL_RESPONSE and len(payload) == 5:
+            request_id, result = struct.unpack('<Bi', payload)
+            return '[response %d] %d' % (request_id, result)
+        return '[channel %d] %s' % (channel, payload.hex())
+
+
+def parse_format(text):
+    identifier, layout = text.split('=', 1)
+    return int(identifier, 0), '<' + layout
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument('--port', help='serial port the board is on')
+    source.add_argument('--input', help='file of captured output, - for stdin')
+    parser.add_argument('--baud', type=int, default=38400,
+                        help='baud rate of the serial port')
+    parser.add_argument('--format', action='append', default=[],
+                        type=parse_format, metavar='ID=LAYOUT',
+                        help='struct layout of a telemetry id')
+    parser.add_argument('--command', default=None,
+                        help='command line to run on the board')
+    args = parser.parse_args()
+
+    if args.port:
+        import serial  # pylint: disable=import-outside-toplevel
+        stream = serial.Serial(args.port, args.baud, timeout=0.1)
+    elif args.command:
+        parser.error('--command needs --port')
+    else:
+        stream = (sys.stdin.buffer if args.input == '-'
+                  else open(args.input, 'rb'))
+
+    request_id = 1
+    if args.command:
+        stream.write(make_request(request_id, args.command))
+
+    decoder = Decoder(dict(args.format))
+    output = sys.stdout.buffer
+    while True:
+        data = stream.read(256)
+        if not data and not args.port:
+            break
+        for channel, payload in decoder.feed(data):
+            if channel is None:
+                output.write(payload)
+                continue
+            output.write((decoder.describe(channel, payload) + '\n').encode())
+            if (args.command and channel == CHANNEL_RESPONSE and
+                    payload[0] == request_id):
+                output.flush()
+                return 0
+        output.flush()
+
+    output.write(bytes(decoder.segment))
+    if decoder.missing:
+        print('%d frames missing' % decoder.missing, file=sys.stderr)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())